@@ -152,6 +152,10 @@ fcc_status_e fcc_storage_delete()
     // We remove the external storage first because some of its metadata may be contained inside the internal storage,
     // and we may need access to it when deleting the external storage
     status = storage_reset();
+#if (PAL_USE_SSL_SESSION_RESUME == 1)
+    // Even a failed reset may have removed the stored SSL session that PAL keeps in RAM
+    pal_invalidateSslSessionCache();
+#endif
     SA_PV_ERR_RECOVERABLE_RETURN_IF((status == KCM_STATUS_ESFS_ERROR), FCC_STATUS_KCM_STORAGE_ERROR, "Failed in storage_reset. got ESFS error");
     SA_PV_ERR_RECOVERABLE_RETURN_IF((status != KCM_STATUS_SUCCESS), FCC_STATUS_ERROR, "Failed storage reset");
 
@@ -174,6 +174,13 @@ kcm_status_e kcm_item_delete(const uint8_t * kcm_item_name, size_t kcm_item_name
     kcm_status = delete_func(kcm_item_name, kcm_item_name_len, kcm_item_type, STORAGE_ITEM_PREFIX_KCM);
     SA_PV_ERR_RECOVERABLE_RETURN_IF((kcm_status != KCM_STATUS_SUCCESS), kcm_status, "Failed during storage_data_delete");
 
+#if (PAL_USE_SSL_SESSION_RESUME == 1)
+    // PAL keeps the stored SSL session, a configuration item, in RAM
+    if (kcm_item_type == KCM_CONFIG_ITEM) {
+        pal_invalidateSslSessionCache();
+    }
+#endif
+
     return kcm_status;
 }
 
@@ -216,6 +223,10 @@ kcm_status_e kcm_factory_reset(void)
     }
 
     status = storage_reset_to_factory_state();
+#if (PAL_USE_SSL_SESSION_RESUME == 1)
+    // Even a failed reset may have removed the stored SSL session
+    pal_invalidateSslSessionCache();
+#endif
     SA_PV_ERR_RECOVERABLE_RETURN_IF((status != KCM_STATUS_SUCCESS), status, "Failed perform factory reset");
 
     SA_PV_LOG_INFO_FUNC_EXIT_NO_ARGS();
@@ -55,6 +55,22 @@
     #define PAL_NET_TEST_MAX_ASYNC_SOCKETS 5
 #endif
 
+/*\brief  Use an epoll based async socket manager instead of SIGIO and ppoll().
+ * Sockets are registered once and the number of async sockets is not limited by PAL_NET_TEST_MAX_ASYNC_SOCKETS. */
+#ifndef PAL_NET_ASYNC_SOCKET_EPOLL
+    #define PAL_NET_ASYNC_SOCKET_EPOLL 0
+#endif
+
+//!< Send buffer lists with sendmsg() and datagram batches with sendmmsg()
+#ifndef PAL_NET_SCATTER_GATHER_SUPPORT
+    #define PAL_NET_SCATTER_GATHER_SUPPORT true
+#endif
+
+//!< Maximum number of socket events handled per wake-up of the epoll based async socket manager
+#ifndef PAL_NET_ASYNC_SOCKET_EPOLL_MAX_EVENTS
+    #define PAL_NET_ASYNC_SOCKET_EPOLL_MAX_EVENTS 32
+#endif
+
 // 16KB does not seem to be enough, some tests are failing with it
 #ifndef PAL_NET_TEST_ASYNC_SOCKET_MANAGER_THREAD_STACK_SIZE
     #define PAL_NET_TEST_ASYNC_SOCKET_MANAGER_THREAD_STACK_SIZE (1024 * 24)
@@ -131,6 +147,12 @@
     #define PAL_TIMER_SIGNAL (SIGRTMIN+0)
 #endif
 
+/*\brief  Drive all PAL timers from a min-heap and a single timerfd owned by the timer thread instead of
+ * one POSIX timer and PAL_TIMER_SIGNAL per timer. The number of timers is then not limited by the signal queue. */
+#ifndef PAL_RTOS_TIMER_TIMERFD
+    #define PAL_RTOS_TIMER_TIMERFD 0
+#endif
+
 // Sanity check for defined stack sizes
 #if (PAL_NET_TEST_ASYNC_SOCKET_MANAGER_THREAD_STACK_SIZE < PTHREAD_STACK_MIN)
 #warning "PAL_NET_TEST_ASYNC_SOCKET_MANAGER_THREAD_STACK_SIZE stack size is less than PTHREAD_STACK_MIN"
@@ -285,6 +285,32 @@ palStatus_t pal_sendTo(palSocket_t socket, const void* buffer, size_t length, co
     return result; // TODO(nirson01) ADD debug print for error propagation(once debug print infrastructure is finalized)
 }
 
+palStatus_t pal_sendToBatch(palSocket_t socket, const palSocketBuffer_t* datagrams, uint32_t count, const palSocketAddress_t* to, palSocketLength_t toLength, uint32_t* datagramsSent)
+{
+
+    PAL_VALIDATE_ARGUMENTS((NULL == datagrams) || (0 == count) || (count > PAL_NET_MAX_SEND_BUFFERS) || (NULL == to) || (NULL == datagramsSent));
+
+    palStatus_t result = PAL_SUCCESS;
+#if PAL_NET_SCATTER_GATHER_SUPPORT
+    result = pal_plat_sendToBatch(socket, datagrams, count, to, toLength, datagramsSent);
+#else
+    // One sendTo per datagram, stopping at the first one that is not sent
+    uint32_t sent = 0;
+    for (; sent < count; sent++) {
+        size_t bytesSent = 0;
+        result = pal_plat_sendTo(socket, datagrams[sent].buffer, datagrams[sent].length, to, toLength, &bytesSent);
+        if (PAL_SUCCESS != result) {
+            break;
+        }
+    }
+    if (sent > 0) {
+        result = PAL_SUCCESS;
+    }
+    *datagramsSent = sent;
+#endif
+    return result;
+}
+
 
 palStatus_t pal_close(palSocket_t* socket)
 {
@@ -370,6 +396,36 @@ palStatus_t pal_send(palSocket_t socket, const void* buf, size_t len, size_t* se
     return result; // TODO(nirson01) ADD debug print for error propagation(once debug print infrastructure is finalized)
 }
 
+palStatus_t pal_sendVector(palSocket_t socket, const palSocketBuffer_t* buffers, uint32_t count, size_t* sentDataSize)
+{
+
+    PAL_VALIDATE_ARGUMENTS((NULL == buffers) || (0 == count) || (count > PAL_NET_MAX_SEND_BUFFERS) || (NULL == sentDataSize));
+
+    palStatus_t result = PAL_SUCCESS;
+#if PAL_NET_SCATTER_GATHER_SUPPORT
+    result = pal_plat_sendVector(socket, buffers, count, sentDataSize);
+#else
+    // One send per buffer, stopping at the first one that is not sent in full
+    size_t sent = 0;
+    for (uint32_t index = 0; index < count; index++) {
+        size_t bytesSent = 0;
+        result = pal_plat_send(socket, buffers[index].buffer, buffers[index].length, &bytesSent);
+        if (PAL_SUCCESS != result) {
+            break;
+        }
+        sent += bytesSent;
+        if (bytesSent < buffers[index].length) {
+            break;
+        }
+    }
+    if (sent > 0) {
+        result = PAL_SUCCESS;
+    }
+    *sentDataSize = sent;
+#endif
+    return result;
+}
+
 
 #endif //PAL_NET_TCP_AND_TLS_SUPPORT
 
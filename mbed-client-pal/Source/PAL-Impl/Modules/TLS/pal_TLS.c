@@ -26,6 +26,28 @@
 #if (PAL_USE_SSL_SESSION_RESUME == 1)
 #include "key_config_manager.h"
 static const char* kcm_session_item_name = "sslsession";
+
+/** Stored session record: this header followed by the platform session buffer.
+    Fields are in host byte order. */
+#define PAL_SSL_SESSION_RECORD_VERSION 1
+#define PAL_SSL_SESSION_RECORD_HEADER_SIZE 16
+typedef struct palSslSessionRecordHeader
+{
+    uint8_t version;
+    uint8_t reserved[3];
+    uint32_t lifetime; // seconds
+    uint64_t savedAt; // seconds since epoch, zero if time was not set
+}palSslSessionRecordHeader_t;
+
+//! RAM copy of the stored record, so reconnects do not read the storage again.
+//! It is used only while the storage generation is the one it was read at, see pal_invalidateSslSessionCache().
+static uint8_t* g_sslSessionCache = NULL;
+static size_t g_sslSessionCacheSize = 0;
+static int32_t g_sslSessionCacheGeneration = 0;
+static int32_t g_sslSessionStorageGeneration = 0;
+
+static void pal_dropSslSessionCache(void);
+static const uint8_t* pal_getSslSessionRecord(size_t* recordSize);
 static void pal_loadSslSessionFromStorage(palTLSHandle_t palTLSHandle, palTLSConfHandle_t palTLSConf);
 static void pal_saveSslSessionToStorage(palTLSHandle_t palTLSHandle, palTLSConfHandle_t palTLSConf);
 static void pal_removeSslSessionFromStorage(palTLSConfHandle_t palTLSConf);
@@ -73,6 +95,9 @@ palStatus_t pal_cleanupTLS(void)
     {
         PAL_LOG_ERR("Failed to Delete TLS handshake Mutex error: %" PRId32 ".", status);
     }
+#if (PAL_USE_SSL_SESSION_RESUME == 1)
+    pal_dropSslSessionCache();
+#endif
     status = pal_plat_cleanupTLS();
     return status;
 }
@@ -464,7 +489,7 @@ palStatus_t pal_handShake(palTLSHandle_t palTLSHandle, palTLSConfHandle_t palTLS
                     status = PAL_ERR_X509_CERT_VERIFY_FAILED;
                     palTLSCtx->serverTime = 0;
 #if (PAL_USE_SSL_SESSION_RESUME == 1)
-                    pal_removeSslSessionFromStorage(palTLSConfCtx->platTlsConfHandle);
+                    pal_removeSslSessionFromStorage(palTLSConf);
 #endif
                 }
             }
@@ -488,7 +513,7 @@ palStatus_t pal_handShake(palTLSHandle_t palTLSHandle, palTLSConfHandle_t palTLS
             if (PAL_SUCCESS != status)
             {
 #if (PAL_USE_SSL_SESSION_RESUME == 1)
-                pal_removeSslSessionFromStorage(palTLSConfCtx->platTlsConfHandle);
+                pal_removeSslSessionFromStorage(palTLSConf);
 #endif
                 goto finish;
             }
@@ -542,6 +567,18 @@ palStatus_t pal_sslGetVerifyResultExtended(palTLSHandle_t palTLSHandle, int32_t*
 }
 
 
+palStatus_t pal_sslGetHandshakeTimes(palTLSHandle_t palTLSHandle, palTLSHandshakeTimes_t* times)
+{
+    palTLSService_t* palTLSCtx = NULL;
+
+    PAL_VALIDATE_ARGUMENTS((NULLPTR == palTLSHandle) || (NULL == times));
+
+    palTLSCtx = (palTLSService_t*)palTLSHandle;
+    PAL_VALIDATE_ARGUMENTS(NULLPTR == palTLSCtx->platTlsHandle);
+
+    return pal_plat_sslGetHandshakeTimes(palTLSCtx->platTlsHandle, times);
+}
+
 palStatus_t pal_sslGetVerifyResult(palTLSHandle_t palTLSHandle)
 {
     palStatus_t status = PAL_SUCCESS;
@@ -616,6 +653,71 @@ void pal_enableSslSessionStoring(palTLSConfHandle_t palTLSConf, bool enable)
     palTLSConfCtx->useSslSessionResume = enable;
 }
 
+void pal_invalidateSslSessionCache(void)
+{
+    // Only the generation changes here, the copy itself is dropped by the next handshake that uses it.
+    pal_osAtomicIncrement(&g_sslSessionStorageGeneration, 1);
+}
+
+void pal_dropSslSessionCache(void)
+{
+    free(g_sslSessionCache);
+    g_sslSessionCache = NULL;
+    g_sslSessionCacheSize = 0;
+}
+
+/*! Get the stored session record, from RAM if storage has not changed since it was read.
+*   Must be called with g_palTLSHandshakeMutex held. The returned record is valid until the next
+*   call to this function or pal_dropSslSessionCache(). Returns NULL if there is no stored record.
+*/
+const uint8_t* pal_getSslSessionRecord(size_t* recordSize)
+{
+    size_t act_size = 0;
+    size_t data_out = 0;
+    // Read before the storage, so that a change while reading is noticed on the next call
+    int32_t generation = pal_osAtomicIncrement(&g_sslSessionStorageGeneration, 0);
+    uint8_t *record;
+    kcm_status_e kcm_status;
+
+    if ((NULL != g_sslSessionCache) && (g_sslSessionCacheGeneration == generation))
+    {
+        *recordSize = g_sslSessionCacheSize;
+        return g_sslSessionCache;
+    }
+    pal_dropSslSessionCache();
+
+    kcm_status = kcm_item_get_data_size((uint8_t *)kcm_session_item_name,
+                                        strlen(kcm_session_item_name),
+                                        KCM_CONFIG_ITEM, &act_size);
+    if (kcm_status != KCM_STATUS_SUCCESS)
+    {
+        return NULL;
+    }
+
+    record = (uint8_t*)malloc(act_size);
+    if (!record)
+    {
+        PAL_LOG_ERR("pal_getSslSessionRecord - failed to allocate buffer!");
+        return NULL;
+    }
+
+    kcm_status = kcm_item_get_data((uint8_t *)kcm_session_item_name,
+                                   strlen(kcm_session_item_name),
+                                   KCM_CONFIG_ITEM, record, act_size, &data_out);
+    if (kcm_status != KCM_STATUS_SUCCESS)
+    {
+        PAL_LOG_ERR("pal_getSslSessionRecord - failed to get item!");
+        free(record);
+        return NULL;
+    }
+
+    g_sslSessionCache = record;
+    g_sslSessionCacheSize = data_out;
+    g_sslSessionCacheGeneration = generation;
+    *recordSize = data_out;
+    return record;
+}
+
 void pal_removeSslSessionFromStorage(palTLSConfHandle_t palTLSConf)
 {
     palTLSConfService_t* palTLSConfCtx = (palTLSConfService_t*)palTLSConf;
@@ -625,17 +727,26 @@ void pal_removeSslSessionFromStorage(palTLSConfHandle_t palTLSConf)
         return;
     }
 
+    pal_osMutexWait(g_palTLSHandshakeMutex, PAL_RTOS_WAIT_FOREVER);
+    pal_dropSslSessionCache();
     kcm_item_delete((uint8_t *)kcm_session_item_name,
                     strlen(kcm_session_item_name),
                     KCM_CONFIG_ITEM);
+    pal_osMutexRelease(g_palTLSHandshakeMutex);
 }
 
 void pal_saveSslSessionToStorage(palTLSHandle_t palTLSHandle, palTLSConfHandle_t palTLSConf)
 {
     palTLSService_t* palTLSCtx = (palTLSService_t*)palTLSHandle;
     palTLSConfService_t* palTLSConfCtx = (palTLSConfService_t*)palTLSConf;
+    palSslSessionRecordHeader_t header;
     uint8_t *session_data;
+    const uint8_t *stored;
+    uint8_t *record;
+    size_t stored_size = 0;
     size_t session_size = 0;
+    uint32_t lifetime = 0;
+    int32_t generation;
 
     if (!palTLSConfCtx->useSslSessionResume)
     {
@@ -643,76 +754,69 @@ void pal_saveSslSessionToStorage(palTLSHandle_t palTLSHandle, palTLSConfHandle_t
         return;
     }
 
-    session_data = pal_plat_GetSslSessionBuffer(palTLSCtx->platTlsHandle, &session_size);
+    session_data = pal_plat_GetSslSessionBuffer(palTLSCtx->platTlsHandle, &session_size, &lifetime);
     if (!session_data)
     {
         PAL_LOG_ERR("pal_saveSslSessionToStorage - failed to get session buffer!");
         return;
     }
 
-    bool replace = false;
-    size_t act_size = 0;
-    kcm_status_e kcm_status = kcm_item_get_data_size((uint8_t *)kcm_session_item_name,
-                                   strlen(kcm_session_item_name),
-                                   KCM_CONFIG_ITEM, &act_size);
+    pal_osMutexWait(g_palTLSHandshakeMutex, PAL_RTOS_WAIT_FOREVER);
 
-    if (kcm_status != KCM_STATUS_SUCCESS)
+    // A resumed session comes back unchanged. Keep its original save time so that its lifetime is not extended.
+    stored = pal_getSslSessionRecord(&stored_size);
+    if ((NULL != stored) &&
+        (stored_size == PAL_SSL_SESSION_RECORD_HEADER_SIZE + session_size) &&
+        (stored[0] == PAL_SSL_SESSION_RECORD_VERSION) &&
+        (0 == memcmp(stored + PAL_SSL_SESSION_RECORD_HEADER_SIZE, session_data, session_size)))
     {
-        replace = true;
+        PAL_LOG_DBG("pal_saveSslSessionToStorage - keep old session");
+        goto finish;
     }
 
-
-    // Check existing data before writing it again to storage
-    if (!replace)
+    record = (uint8_t*)malloc(PAL_SSL_SESSION_RECORD_HEADER_SIZE + session_size);
+    if (!record)
     {
-        replace = true;
-        uint8_t *existing_session = (uint8_t*)malloc(act_size);
-        if (!existing_session)
-        {
-            PAL_LOG_ERR("pal_saveSslSessionToStorage - failed to allocate buffer!");
-            free(session_data);
-            return;
-        }
-
-        size_t data_out = 0;
-        kcm_status = kcm_item_get_data((uint8_t *)kcm_session_item_name,
-                                       strlen(kcm_session_item_name),
-                                       KCM_CONFIG_ITEM, existing_session, act_size, &data_out);
-
-        if (kcm_status == KCM_STATUS_SUCCESS && memcmp(session_data, existing_session, act_size) == 0)
-        {
-            replace = false;
-        }
-
-        free(existing_session);
+        PAL_LOG_ERR("pal_saveSslSessionToStorage - failed to allocate buffer!");
+        goto finish;
     }
 
-    // Store only if session has changed or there is no data yet
-    if (replace)
-    {
-        PAL_LOG_DBG("pal_saveSslSessionToStorage - save a new session");
-        kcm_item_delete((uint8_t *)kcm_session_item_name,
-                                     strlen(kcm_session_item_name),
-                                     KCM_CONFIG_ITEM);
+    memset(&header, 0, sizeof(header));
+    header.version = PAL_SSL_SESSION_RECORD_VERSION;
+    header.lifetime = ((0 != lifetime) && (lifetime < PAL_SSL_SESSION_MAX_LIFETIME_SEC)) ? lifetime : PAL_SSL_SESSION_MAX_LIFETIME_SEC;
+    header.savedAt = pal_osGetTime();
+    memcpy(record, &header, PAL_SSL_SESSION_RECORD_HEADER_SIZE);
+    memcpy(record + PAL_SSL_SESSION_RECORD_HEADER_SIZE, session_data, session_size);
 
-        kcm_status = kcm_item_store((uint8_t *)kcm_session_item_name,
-                                    strlen(kcm_session_item_name),
-                                    KCM_CONFIG_ITEM,
-                                    false,
-                                    session_data,
-                                    session_size,
-                                    NULL);
+    PAL_LOG_DBG("pal_saveSslSessionToStorage - save a new session");
+    pal_dropSslSessionCache();
+    kcm_item_delete((uint8_t *)kcm_session_item_name,
+                                 strlen(kcm_session_item_name),
+                                 KCM_CONFIG_ITEM);
+
+    // The delete above changed the generation, a later delete or reset must change it again
+    generation = pal_osAtomicIncrement(&g_sslSessionStorageGeneration, 0);
+    kcm_status_e kcm_status = kcm_item_store((uint8_t *)kcm_session_item_name,
+                                             strlen(kcm_session_item_name),
+                                             KCM_CONFIG_ITEM,
+                                             false,
+                                             record,
+                                             PAL_SSL_SESSION_RECORD_HEADER_SIZE + session_size,
+                                             NULL);
 
-        if (kcm_status != KCM_STATUS_SUCCESS)
-        {
-            PAL_LOG_DBG("pal_saveSslSessionToStorage - failed to store data: %d", kcm_status);
-        }
-    }
-    else
+    if (kcm_status != KCM_STATUS_SUCCESS)
     {
-        PAL_LOG_DBG("pal_saveSslSessionToStorage - keep old session");
+        PAL_LOG_DBG("pal_saveSslSessionToStorage - failed to store data: %d", kcm_status);
+        free(record);
+        goto finish;
     }
 
+    g_sslSessionCache = record;
+    g_sslSessionCacheSize = PAL_SSL_SESSION_RECORD_HEADER_SIZE + session_size;
+    g_sslSessionCacheGeneration = generation;
+
+finish:
+    pal_osMutexRelease(g_palTLSHandshakeMutex);
     free(session_data);
 }
 
@@ -720,6 +824,10 @@ void pal_loadSslSessionFromStorage(palTLSHandle_t palTLSHandle, palTLSConfHandle
 {
     palTLSConfService_t* palTLSConfCtx = (palTLSConfService_t*)palTLSConf;
     palTLSService_t* palTLSCtx = (palTLSService_t*)palTLSHandle;
+    palSslSessionRecordHeader_t header;
+    const uint8_t *record;
+    size_t record_size = 0;
+    uint64_t now;
 
     if (!palTLSConfCtx->useSslSessionResume)
     {
@@ -727,38 +835,39 @@ void pal_loadSslSessionFromStorage(palTLSHandle_t palTLSHandle, palTLSConfHandle
         return;
     }
 
-    size_t act_size = 0;
-    kcm_status_e kcm_status = kcm_item_get_data_size((uint8_t *)kcm_session_item_name,
-                                   strlen(kcm_session_item_name),
-                                   KCM_CONFIG_ITEM, &act_size);
-
-    if (kcm_status != KCM_STATUS_SUCCESS)
+    // Called from pal_initTLS() with g_palTLSHandshakeMutex held
+    record = pal_getSslSessionRecord(&record_size);
+    if (!record)
     {
-        PAL_LOG_ERR("pal_loadSslSessionFromStorage - failed to get item size!");
+        PAL_LOG_DBG("pal_loadSslSessionFromStorage - no stored session");
         return;
     }
 
-    uint8_t *existing_session = (uint8_t*)malloc(act_size);
-    if (!existing_session)
+    // Sessions stored by older versions have no record header
+    if ((record_size <= PAL_SSL_SESSION_RECORD_HEADER_SIZE) ||
+        (record[0] != PAL_SSL_SESSION_RECORD_VERSION))
     {
-        PAL_LOG_ERR("pal_loadSslSessionFromStorage - failed to allocate buffer!");
+        PAL_LOG_DBG("pal_loadSslSessionFromStorage - unknown session format, removed");
+        pal_removeSslSessionFromStorage(palTLSConf);
         return;
     }
 
-    size_t data_out = 0;
-    kcm_status = kcm_item_get_data((uint8_t *)kcm_session_item_name,
-                                   strlen(kcm_session_item_name),
-                                   KCM_CONFIG_ITEM, existing_session, act_size, &data_out);
-
-    if (kcm_status != KCM_STATUS_SUCCESS)
+    memcpy(&header, record, PAL_SSL_SESSION_RECORD_HEADER_SIZE);
+    now = pal_osGetTime();
+    // Expiry can only be checked if the time was known both when saving and now
+    if ((0 != header.savedAt) && (now > header.savedAt) && ((now - header.savedAt) >= header.lifetime))
     {
-        PAL_LOG_ERR("pal_loadSslSessionFromStorage - failed to get item!");
-        free(existing_session);
+        PAL_LOG_DBG("pal_loadSslSessionFromStorage - session expired, removed");
+        pal_removeSslSessionFromStorage(palTLSConf);
         return;
     }
 
-    pal_plat_SetSslSession(palTLSCtx->platTlsHandle, existing_session);
-    free(existing_session);
+    if (PAL_SUCCESS != pal_plat_SetSslSession(palTLSCtx->platTlsHandle,
+                                              record + PAL_SSL_SESSION_RECORD_HEADER_SIZE,
+                                              record_size - PAL_SSL_SESSION_RECORD_HEADER_SIZE))
+    {
+        pal_removeSslSessionFromStorage(palTLSConf);
+    }
 }
 
 #endif //PAL_USE_SSL_SESSION_RESUME
@@ -53,6 +53,14 @@ typedef struct palTLSSocket{
 }palTLSSocket_t;
 
 
+//! Time spent in each phase of the last handshake, in milliseconds. Network round trips are included.
+typedef struct palTLSHandshakeTimes{
+    uint32_t hello; //!< ClientHello until the ServerHello is received, including a DTLS HelloVerifyRequest.
+    uint32_t certificate; //!< Receiving, parsing and verifying the server certificate.
+    uint32_t keyExchange; //!< ServerKeyExchange until CertificateVerify is sent (ECDHE and ECDSA computations).
+    uint32_t finished; //!< ChangeCipherSpec and Finished messages, including a session ticket.
+}palTLSHandshakeTimes_t;
+
 typedef struct palTLSBuffer{
     const void* buffer;
     uint32_t size;
@@ -204,9 +212,20 @@ palStatus_t pal_tlsSetSocket(palTLSConfHandle_t palTLSConf, palTLSSocket_t* sock
  * @param[in] palTLSConf: The TLS configuration context.
  *
  * \return PAL_SUCCESS on success, or a negative value indicating a specific error code in case of failure.
+ * \return PAL_ERR_TLS_HANDSHAKE_IN_PROGRESS if `PAL_TLS_HANDSHAKE_STEPWISE` is set and one handshake step was done.
+ *         Call the function again to continue.
  */
 palStatus_t pal_handShake(palTLSHandle_t palTLSHandle, palTLSConfHandle_t palTLSConf);
 
+/*! \brief Get the time spent in each phase of the last handshake.
+ *
+ * @param[in] palTLSHandle: The TLS context.
+ * @param[out] times: The phase times.
+ *
+ * \return PAL_SUCCESS on success, or a negative value indicating a specific error code in case of failure.
+ */
+palStatus_t pal_sslGetHandshakeTimes(palTLSHandle_t palTLSHandle, palTLSHandshakeTimes_t* times);
+
 /*! \brief Set the retransmit timeout values for the DTLS handshake.
  *  DTLS only, no effect on TLS.
  *
@@ -288,6 +307,16 @@ palStatus_t pal_sslDebugging(uint8_t turnOn);
  */
 void pal_enableSslSessionStoring(palTLSConfHandle_t palTLSConf, bool enable);
 
+/*! \brief Tell PAL that the stored SSL session may have been deleted or replaced.
+ *
+ * PAL keeps a RAM copy of the stored session so that a reconnect does not read the storage.
+ * After this call the copy is not used, and the next handshake reads the session from storage again.
+ *
+ * \note The key and configuration manager calls this function when it deletes a configuration item
+ *       or resets the storage. It may be called from any thread.
+ */
+void pal_invalidateSslSessionCache(void);
+
 #endif // PAL_USE_SSL_SESSION_RESUME
 
 #endif // _PAL_DTLS_H_
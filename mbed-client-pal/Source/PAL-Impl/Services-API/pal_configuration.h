@@ -98,6 +98,14 @@
     #define PAL_NET_SERVER_SOCKET_API                 true //!< Add PAL support for server socket.
 #endif
 
+#ifndef PAL_NET_SCATTER_GATHER_SUPPORT
+    #define PAL_NET_SCATTER_GATHER_SUPPORT      false //!< The platform sends buffer lists with one call, `pal_plat_sendVector()` and `pal_plat_sendToBatch()`.
+#endif
+
+#ifndef PAL_NET_MAX_SEND_BUFFERS
+    #define PAL_NET_MAX_SEND_BUFFERS            16 //!< The most buffers passed to `pal_sendVector()` or `pal_sendToBatch()` in one call.
+#endif
+
 #ifndef PAL_SUPPORT_IP_V4
     #define PAL_SUPPORT_IP_V4                 true //!< support IPV4 as default
 #endif
@@ -500,4 +508,19 @@
     #define PAL_USE_SSL_SESSION_RESUME 1
 #endif
 
+//! Run the TLS handshake one mbedTLS state machine step per `pal_handShake()` call. The call returns `PAL_ERR_TLS_HANDSHAKE_IN_PROGRESS` until the handshake is over.
+#ifndef PAL_TLS_HANDSHAKE_STEPWISE
+    #define PAL_TLS_HANDSHAKE_STEPWISE 0
+#endif
+
+//! Ask the server for a DTLS connection ID, so that it keeps the DTLS connection when the client address changes. Needs `MBEDTLS_SSL_DTLS_CONNECTION_ID` in the mbedTLS configuration.
+#ifndef PAL_USE_DTLS_CONNECTION_ID
+    #define PAL_USE_DTLS_CONNECTION_ID 1
+#endif
+
+//! Maximum time (in seconds) a stored SSL session is used for resumption. A shorter session ticket lifetime from the server takes precedence.
+#ifndef PAL_SSL_SESSION_MAX_LIFETIME_SEC
+    #define PAL_SSL_SESSION_MAX_LIFETIME_SEC 86400
+#endif
+
 #endif //_PAL_COFIGURATION_H
@@ -145,6 +145,7 @@ typedef enum {
     PAL_ERR_TLS_FAILED_TO_SET_CERT =                        PAL_ERR_TLS_ERROR_BASE + 12,
     PAL_ERR_TLS_PEER_CLOSE_NOTIFY =                         PAL_ERR_TLS_ERROR_BASE + 13,
     PAL_ERR_TLS_MULTIPLE_HANDSHAKE =                        PAL_ERR_TLS_ERROR_BASE + 14,
+    PAL_ERR_TLS_HANDSHAKE_IN_PROGRESS =                     PAL_ERR_TLS_ERROR_BASE + 15,
 
     //Update errors
     PAL_ERR_UPDATE_ERROR_BASE =                             PAL_ERR_MODULE_UPDATE_BASE,         /*! Generic error. */
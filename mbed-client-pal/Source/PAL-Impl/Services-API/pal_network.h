@@ -100,6 +100,12 @@ typedef uint8_t palIpV6Addr_t[PAL_IPV6_ADDRESS_SIZE];
 
 typedef void(*connectionStatusCallback) (palNetworkStatus_t status, void *client_arg);
 
+/*! \brief One buffer of a scatter/gather list, see `pal_sendVector()` and `pal_sendToBatch()`. */
+typedef struct palSocketBuffer {
+    const void* buffer; /*!< \brief The data to send. */
+    size_t length;      /*!< \brief The length of the data in bytes. */
+} palSocketBuffer_t;
+
 /*! \brief Register a network interface for use with PAL sockets.
  *
  * Must be called before other socket functions. Most APIs will not work before an interface is added.
@@ -210,6 +216,18 @@ palStatus_t pal_receiveFrom(palSocket_t socket, void* buffer, size_t length, pal
  */
 palStatus_t pal_sendTo(palSocket_t socket, const void* buffer, size_t length, const palSocketAddress_t* to, palSocketLength_t toLength, size_t* bytesSent);
 
+/*! \brief Send several datagrams to an address using a specific socket, with a single system call where the platform supports it.
+ * @param[in] socket The socket to use for sending the datagrams. The socket passed to this function should be of type `PAL_SOCK_DGRAM`.
+ * @param[in] datagrams The datagrams to send, each buffer is sent as one datagram.
+ * @param[in] count The number of datagrams, at most `PAL_NET_MAX_SEND_BUFFERS`.
+ * @param[in] to The address to which the datagrams should be sent.
+ * @param[in] toLength The length of the `to` address.
+ * @param[out] datagramsSent The number of datagrams sent, from the start of the list.
+ * \return PAL_SUCCESS (0) if at least one datagram was sent, or a specific negative error code if none was.
+ * \note When fewer than `count` datagrams are sent, the error that stopped the batch is returned by the next call.
+ */
+palStatus_t pal_sendToBatch(palSocket_t socket, const palSocketBuffer_t* datagrams, uint32_t count, const palSocketAddress_t* to, palSocketLength_t toLength, uint32_t* datagramsSent);
+
 /*! \brief Close a network socket.
  * @param[in,out] socket The socket to be closed.
  * \return PAL_SUCCESS (0) in case of success, or a specific negative error code in case of failure.
@@ -302,6 +320,15 @@ palStatus_t pal_recv(palSocket_t socket, void* buf, size_t len, size_t* recieved
  */
 palStatus_t pal_send(palSocket_t socket, const void* buf, size_t len, size_t* sentDataSize);
 
+/*! \brief Send a list of buffers as one stream write via a connected socket, with a single system call where the platform supports it.
+ * @param[in] socket The connected socket on which to send data. The socket passed to this function should be of type `PAL_SOCK_STREAM`.
+ * @param[in] buffers The buffers to send, in order.
+ * @param[in] count The number of buffers, at most `PAL_NET_MAX_SEND_BUFFERS`.
+ * @param[out] sentDataSize The length of the data sent in bytes, which may end in the middle of any buffer.
+ * \return PAL_SUCCESS (0) in case of success, or a specific negative error code in case of failure.
+ */
+palStatus_t pal_sendVector(palSocket_t socket, const palSocketBuffer_t* buffers, uint32_t count, size_t* sentDataSize);
+
 
 #endif //PAL_NET_TCP_AND_TLS_SUPPORT
 
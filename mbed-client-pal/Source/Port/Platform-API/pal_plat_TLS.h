@@ -199,6 +199,15 @@ palStatus_t pal_plat_sslSetup(palTLSHandle_t palTLSHandle, palTLSConfHandle_t pa
  */
 palStatus_t pal_plat_handShake(palTLSHandle_t palTLSHandle, uint64_t* serverTime);
 
+/*! \brief Get the time spent in each phase of the last handshake.
+ *
+ * @param[in] palTLSHandle: The TLS context.
+ * @param[out] times: The phase times in milliseconds.
+ *
+ * \return PAL_SUCCESS on success. A negative value indicating a specific error code in case of failure.
+ */
+palStatus_t pal_plat_sslGetHandshakeTimes(palTLSHandle_t palTLSHandle, palTLSHandshakeTimes_t* times);
+
 #if PAL_USE_SECURE_TIME
 /*! \brief Perform the TLS handshake renegotiation.
  *
@@ -317,21 +326,27 @@ palStatus_t pal_plat_SetLoggingCb(palTLSConfHandle_t palTLSConf, palLogFunc_f pa
 #if (PAL_USE_SSL_SESSION_RESUME == 1)
 
 /*! \brief Get the ssl session buffer.
+ *
+ * The buffer carries its own format version, including the session ticket if the server issued one.
  *
  * @param[in] palTLSHandle: The TLS context.
  * @param[out] buffer_size: Size of the session buffer.
+ * @param[out] lifetime: Lifetime hint of the session ticket in seconds, zero if there is none.
  *
  * \return Buffer containing the session data. NULL in case of failure.
  */
-uint8_t* pal_plat_GetSslSessionBuffer(palTLSHandle_t palTLSHandle, size_t *buffer_size);
+uint8_t* pal_plat_GetSslSessionBuffer(palTLSHandle_t palTLSHandle, size_t *buffer_size, uint32_t *lifetime);
 
 /*! \brief Set the ssl session.
  *
  * @param[in] palTLSHandle: The TLS context.
  * @param[in] session_buffer: Buffer containing the session data.
+ * @param[in] buffer_size: Size of the session buffer.
  *
+ * \return PAL_SUCCESS on success.
+ * \return PAL_ERR_TLS_BAD_INPUT_DATA if the buffer has an unknown format or cannot be used for resumption.
  */
-void pal_plat_SetSslSession(palTLSHandle_t palTLSHandle, const uint8_t *session_buffer);
+palStatus_t pal_plat_SetSslSession(palTLSHandle_t palTLSHandle, const uint8_t *session_buffer, size_t buffer_size);
 #endif
 #endif //_PAL_PLAT_TLS_H_
 
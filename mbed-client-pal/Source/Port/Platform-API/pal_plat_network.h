@@ -116,6 +116,19 @@ palStatus_t pal_plat_receiveFrom(palSocket_t socket, void* buffer, size_t length
  */
 palStatus_t pal_plat_sendTo(palSocket_t socket, const void* buffer, size_t length, const palSocketAddress_t* to, palSocketLength_t toLength, size_t* bytesSent);
 
+#if PAL_NET_SCATTER_GATHER_SUPPORT
+/*! \brief Send several datagrams to an address using a specific socket with one system call.
+ * @param[in] socket The socket to use for sending the datagrams. The socket passed to this function should be of type `PAL_SOCK_DGRAM`.
+ * @param[in] datagrams The datagrams to send, each buffer is sent as one datagram.
+ * @param[in] count The number of datagrams, at most `PAL_NET_MAX_SEND_BUFFERS`.
+ * @param[in] to The address to which the datagrams should be sent.
+ * @param[in] toLength The length of the `to` address.
+ * @param[out] datagramsSent The number of datagrams sent, from the start of the list.
+ * \return PAL_SUCCESS (0) if at least one datagram was sent. A specific negative error code if none was.
+ */
+palStatus_t pal_plat_sendToBatch(palSocket_t socket, const palSocketBuffer_t* datagrams, uint32_t count, const palSocketAddress_t* to, palSocketLength_t toLength, uint32_t* datagramsSent);
+#endif // PAL_NET_SCATTER_GATHER_SUPPORT
+
 /*! \brief Close a network socket.
  * \note The function recieves `palSocket_t*` and not `palSocket_t` so that it can zero the socket to avoid re-use.
  * @param[in,out] socket Pointer to the socket to release and zero.
@@ -190,6 +203,17 @@ palStatus_t pal_plat_recv(palSocket_t socket, void* buf, size_t len, size_t* rec
  */
 palStatus_t pal_plat_send(palSocket_t socket, const void* buf, size_t len, size_t* sentDataSize);
 
+#if PAL_NET_SCATTER_GATHER_SUPPORT
+/*! \brief Send a list of buffers via a specific connected socket with one system call.
+ * @param[in] socket The connected socket on which to send data. The socket passed to this function should be of type `PAL_SOCK_STREAM`.
+ * @param[in] buffers The buffers to send, in order.
+ * @param[in] count The number of buffers, at most `PAL_NET_MAX_SEND_BUFFERS`.
+ * @param[out] sentDataSize The length of the data sent in bytes.
+ * \return PAL_SUCCESS (0) in case of success, a specific negative error code in case of failure.
+ */
+palStatus_t pal_plat_sendVector(palSocket_t socket, const palSocketBuffer_t* buffers, uint32_t count, size_t* sentDataSize);
+#endif // PAL_NET_SCATTER_GATHER_SUPPORT
+
 /*! \brief Set listener for connection status events.
  * @param[in] interfaceIndex Index of the network interface to be listen.
  * @param[in] callback Callback that is called when network interface status change.
@@ -50,15 +50,13 @@ typedef mbedtls_ssl_context platTlsContext;
 typedef mbedtls_ssl_config platTlsConfigurationContext;
 
 #if (PAL_USE_SSL_SESSION_RESUME == 1)
-/** Following items need to be stored from mbedtls_ssl_session info structure
-    to do the ssl session resumption.*/
-//int ciphersuite;            /*!< chosen ciphersuite */
-//size_t id_len;              /*!< session id length  */
-//unsigned char id[32];       /*!< session identifier */
-//unsigned char master[48];   /*!< the master secret  */
-
-// Size of the session data
-static const int ssl_session_size = 92;
+/** Layout of the session buffer, all values in host byte order:
+    version (1), id_len (1), ticket_len (2), ciphersuite (4),
+    id (32), master (48), ticket (ticket_len) */
+#define PAL_SSL_SESSION_BUFFER_VERSION 2
+#define PAL_SSL_SESSION_ID_SIZE 32
+#define PAL_SSL_SESSION_MASTER_SIZE 48
+#define PAL_SSL_SESSION_FIXED_SIZE (1 + 1 + 2 + 4 + PAL_SSL_SESSION_ID_SIZE + PAL_SSL_SESSION_MASTER_SIZE)
 #endif
 
 PAL_PRIVATE mbedtls_entropy_context *g_entropy = NULL;
@@ -72,6 +70,15 @@ typedef struct palTimingDelayContext
 } palTimingDelayContext_t;
 
 
+//! Handshake phases for the timing counters, see palTLSHandshakeTimes_t.
+typedef enum palTLSHandshakePhase {
+    PAL_TLS_HANDSHAKE_PHASE_HELLO,
+    PAL_TLS_HANDSHAKE_PHASE_CERTIFICATE,
+    PAL_TLS_HANDSHAKE_PHASE_KEY_EXCHANGE,
+    PAL_TLS_HANDSHAKE_PHASE_FINISHED,
+    PAL_TLS_HANDSHAKE_PHASE_COUNT
+}palTLSHandshakePhase_t;
+
 //! the full structures will be defined later in the implemetation.
 typedef struct palTLS {
     platTlsContext tlsCtx;
@@ -79,6 +86,8 @@ typedef struct palTLS {
     char* psk; //NULL terminated
     char* identity; //NULL terminated
     bool wantReadOrWrite;
+    uint64_t handshakeLastTick;
+    uint64_t handshakePhaseTicks[PAL_TLS_HANDSHAKE_PHASE_COUNT];
 }palTLS_t;
 
 
@@ -748,22 +757,73 @@ palStatus_t pal_plat_sslSetup(palTLSHandle_t palTLSHandle, palTLSConfHandle_t pa
             goto finish;
         }
 #endif // #if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+
+#if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID) && (PAL_USE_DTLS_CONNECTION_ID == 1)
+        // An empty own CID: the client only uses the CID the server asks for, which lets the server
+        // keep this connection and its keys when the client address changes (e.g. NAT rebinding).
+        if (MBEDTLS_SSL_TRANSPORT_DATAGRAM == localConfigCtx->confCtx->transport)
+        {
+            platStatus = mbedtls_ssl_set_cid(&localTLSCtx->tlsCtx, MBEDTLS_SSL_CID_ENABLED, NULL, 0);
+            if (SSL_LIB_SUCCESS != platStatus)
+            {
+                PAL_LOG_ERR("SSL connection ID setup error code %" PRId32 ".", platStatus);
+                status = PAL_ERR_TLS_INIT;
+                goto finish;
+            }
+        }
+#endif // PAL_USE_DTLS_CONNECTION_ID
         localConfigCtx->tlsContext = localTLSCtx;
     }
 finish:
     return status;
 }
 
+PAL_PRIVATE palTLSHandshakePhase_t pal_plat_handshakePhase(int state)
+{
+    switch (state)
+    {
+        case MBEDTLS_SSL_HELLO_REQUEST:
+        case MBEDTLS_SSL_CLIENT_HELLO:
+        case MBEDTLS_SSL_SERVER_HELLO:
+            return PAL_TLS_HANDSHAKE_PHASE_HELLO;
+        case MBEDTLS_SSL_SERVER_CERTIFICATE:
+            return PAL_TLS_HANDSHAKE_PHASE_CERTIFICATE;
+        case MBEDTLS_SSL_SERVER_KEY_EXCHANGE:
+        case MBEDTLS_SSL_CERTIFICATE_REQUEST:
+        case MBEDTLS_SSL_SERVER_HELLO_DONE:
+        case MBEDTLS_SSL_CLIENT_CERTIFICATE:
+        case MBEDTLS_SSL_CLIENT_KEY_EXCHANGE:
+        case MBEDTLS_SSL_CERTIFICATE_VERIFY:
+            return PAL_TLS_HANDSHAKE_PHASE_KEY_EXCHANGE;
+        default:
+            return PAL_TLS_HANDSHAKE_PHASE_FINISHED;
+    }
+}
+
 palStatus_t pal_plat_handShake(palTLSHandle_t palTLSHandle, uint64_t* serverTime)
 {
     palStatus_t status = PAL_SUCCESS;
     palTLS_t* localTLSCtx = (palTLS_t*)palTLSHandle;
     int32_t platStatus = SSL_LIB_SUCCESS;
+    int state;
+    uint64_t now;
 
     while( (MBEDTLS_SSL_HANDSHAKE_OVER != localTLSCtx->tlsCtx.state) && (PAL_SUCCESS == status) )
     {
+        state = localTLSCtx->tlsCtx.state;
+        if (MBEDTLS_SSL_HELLO_REQUEST == state)
+        {
+            memset(localTLSCtx->handshakePhaseTicks, 0, sizeof(localTLSCtx->handshakePhaseTicks));
+            localTLSCtx->handshakeLastTick = pal_osKernelSysTick();
+        }
+
         platStatus = mbedtls_ssl_handshake_step( &localTLSCtx->tlsCtx );
 
+        // Time spent waiting for the peer in a state is counted when the state is next stepped
+        now = pal_osKernelSysTick();
+        localTLSCtx->handshakePhaseTicks[pal_plat_handshakePhase(state)] += now - localTLSCtx->handshakeLastTick;
+        localTLSCtx->handshakeLastTick = now;
+
         /* Extract the first 4 bytes of the ServerHello random */
         if( MBEDTLS_SSL_SERVER_HELLO_DONE == localTLSCtx->tlsCtx.state )
         {
@@ -778,11 +838,29 @@ palStatus_t pal_plat_handShake(palTLSHandle_t palTLSHandle, uint64_t* serverTime
         {
             status = translateTLSHandShakeErrToPALError(localTLSCtx, platStatus);
         }
+#if (PAL_TLS_HANDSHAKE_STEPWISE == 1)
+        else if (MBEDTLS_SSL_HANDSHAKE_OVER != localTLSCtx->tlsCtx.state)
+        {
+            // Give the caller a chance to run other work before the next, possibly expensive, step
+            status = PAL_ERR_TLS_HANDSHAKE_IN_PROGRESS;
+        }
+#endif
     }
 
     return status;
 }
 
+palStatus_t pal_plat_sslGetHandshakeTimes(palTLSHandle_t palTLSHandle, palTLSHandshakeTimes_t* times)
+{
+    palTLS_t* localTLSCtx = (palTLS_t*)palTLSHandle;
+
+    times->hello = (uint32_t)pal_osKernelSysMilliSecTick(localTLSCtx->handshakePhaseTicks[PAL_TLS_HANDSHAKE_PHASE_HELLO]);
+    times->certificate = (uint32_t)pal_osKernelSysMilliSecTick(localTLSCtx->handshakePhaseTicks[PAL_TLS_HANDSHAKE_PHASE_CERTIFICATE]);
+    times->keyExchange = (uint32_t)pal_osKernelSysMilliSecTick(localTLSCtx->handshakePhaseTicks[PAL_TLS_HANDSHAKE_PHASE_KEY_EXCHANGE]);
+    times->finished = (uint32_t)pal_osKernelSysMilliSecTick(localTLSCtx->handshakePhaseTicks[PAL_TLS_HANDSHAKE_PHASE_FINISHED]);
+    return PAL_SUCCESS;
+}
+
 #if PAL_USE_SECURE_TIME
 palStatus_t pal_plat_renegotiate(palTLSHandle_t palTLSHandle, uint64_t serverTime)
 {
@@ -1333,54 +1411,98 @@ int mbedtls_platform_std_nv_seed_write( unsigned char *buf, size_t buf_len )
 #endif //MBEDTLS_ENTROPY_NV_SEED
 
 #if (PAL_USE_SSL_SESSION_RESUME == 1)
-uint8_t* pal_plat_GetSslSessionBuffer(palTLSHandle_t palTLSHandle, size_t *buffer_size)
+uint8_t* pal_plat_GetSslSessionBuffer(palTLSHandle_t palTLSHandle, size_t *buffer_size, uint32_t *lifetime)
 {
     palTLS_t* localTLSCtx = (palTLS_t*)palTLSHandle;
-    uint8_t* session_buffer = (uint8_t*)malloc(ssl_session_size);
-    if (session_buffer == NULL)
+    uint8_t* session_buffer = NULL;
+    uint16_t ticket_len = 0;
+    int32_t ciphersuite = 0;
+
+    mbedtls_ssl_session saved_ssl_session = {0};
+    int32_t platStatus = mbedtls_ssl_get_session(&localTLSCtx->tlsCtx, &saved_ssl_session);
+    if (platStatus != SSL_LIB_SUCCESS)
     {
-        PAL_LOG_ERR("pal_plat_GetSslSessionBuffer - failed to allocate buffer");
+        PAL_LOG_ERR("pal_plat_GetSslSessionBuffer - failed to get ssl session %" PRId32, platStatus);
         return NULL;
     }
 
-    mbedtls_ssl_session saved_ssl_session = {0};
-    int32_t platStatus = mbedtls_ssl_get_session(&localTLSCtx->tlsCtx, &saved_ssl_session);
-    if (platStatus == SSL_LIB_SUCCESS)
+    *lifetime = 0;
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
+    if ((NULL != saved_ssl_session.ticket) && (saved_ssl_session.ticket_len <= UINT16_MAX))
     {
-        memcpy(session_buffer, (uint8_t*)&saved_ssl_session.id_len, sizeof(saved_ssl_session.id_len));
-        memcpy(session_buffer + sizeof(saved_ssl_session.id_len),
-               (uint8_t*)&saved_ssl_session.id, sizeof(saved_ssl_session.id));
-        memcpy(session_buffer + sizeof(saved_ssl_session.id_len) + sizeof(saved_ssl_session.id),
-               (uint8_t*)&saved_ssl_session.master, sizeof(saved_ssl_session.master));
-        memcpy(session_buffer + sizeof(saved_ssl_session.id_len) + sizeof(saved_ssl_session.id) + sizeof(saved_ssl_session.master),
-               (uint8_t*)&saved_ssl_session.ciphersuite, sizeof(saved_ssl_session.ciphersuite));
+        ticket_len = (uint16_t)saved_ssl_session.ticket_len;
+        *lifetime = saved_ssl_session.ticket_lifetime;
+    }
+#endif
 
+    session_buffer = (uint8_t*)malloc(PAL_SSL_SESSION_FIXED_SIZE + ticket_len);
+    if (session_buffer == NULL)
+    {
+        PAL_LOG_ERR("pal_plat_GetSslSessionBuffer - failed to allocate buffer");
         mbedtls_ssl_session_free(&saved_ssl_session);
+        return NULL;
     }
-    else
+
+    ciphersuite = saved_ssl_session.ciphersuite;
+    session_buffer[0] = PAL_SSL_SESSION_BUFFER_VERSION;
+    session_buffer[1] = (uint8_t)saved_ssl_session.id_len;
+    memcpy(session_buffer + 2, &ticket_len, sizeof(ticket_len));
+    memcpy(session_buffer + 4, &ciphersuite, sizeof(ciphersuite));
+    memcpy(session_buffer + 8, saved_ssl_session.id, PAL_SSL_SESSION_ID_SIZE);
+    memcpy(session_buffer + 8 + PAL_SSL_SESSION_ID_SIZE, saved_ssl_session.master, PAL_SSL_SESSION_MASTER_SIZE);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
+    if (ticket_len)
     {
-        PAL_LOG_ERR("pal_plat_GetSslSessionBuffer - failed to get ssl session %" PRId32, platStatus);
-        free(session_buffer);
-        return NULL;
+        memcpy(session_buffer + PAL_SSL_SESSION_FIXED_SIZE, saved_ssl_session.ticket, ticket_len);
     }
+#endif
+
+    mbedtls_ssl_session_free(&saved_ssl_session);
 
-    *buffer_size = ssl_session_size;
+    *buffer_size = PAL_SSL_SESSION_FIXED_SIZE + ticket_len;
     return session_buffer;
 }
 
-void pal_plat_SetSslSession(palTLSHandle_t palTLSHandle, const uint8_t *session_buffer)
+palStatus_t pal_plat_SetSslSession(palTLSHandle_t palTLSHandle, const uint8_t *session_buffer, size_t buffer_size)
 {
     palTLS_t* localTLSCtx = (palTLS_t*)palTLSHandle;
+    uint16_t ticket_len = 0;
+    int32_t ciphersuite = 0;
+    palStatus_t status = PAL_SUCCESS;
+
+    if ((buffer_size < PAL_SSL_SESSION_FIXED_SIZE) || (session_buffer[0] != PAL_SSL_SESSION_BUFFER_VERSION))
+    {
+        PAL_LOG_ERR("pal_plat_SetSslSession - unknown session format");
+        return PAL_ERR_TLS_BAD_INPUT_DATA;
+    }
+
+    memcpy(&ticket_len, session_buffer + 2, sizeof(ticket_len));
+    if ((session_buffer[1] > PAL_SSL_SESSION_ID_SIZE) || (buffer_size != (size_t)PAL_SSL_SESSION_FIXED_SIZE + ticket_len))
+    {
+        PAL_LOG_ERR("pal_plat_SetSslSession - corrupted session");
+        return PAL_ERR_TLS_BAD_INPUT_DATA;
+    }
 
     mbedtls_ssl_session saved_ssl_session = {0};
-    memcpy(&saved_ssl_session.id_len, session_buffer, sizeof(saved_ssl_session.id_len));
-    memcpy(&saved_ssl_session.id, session_buffer + sizeof(saved_ssl_session.id_len), sizeof(saved_ssl_session.id));
-    memcpy(&saved_ssl_session.master, session_buffer + sizeof(saved_ssl_session.id_len) + sizeof(saved_ssl_session.id), sizeof(saved_ssl_session.master));
-    memcpy(&saved_ssl_session.ciphersuite, session_buffer + sizeof(saved_ssl_session.id_len) + sizeof(saved_ssl_session.id) + sizeof(saved_ssl_session.master), sizeof(saved_ssl_session.ciphersuite));
+    memcpy(&ciphersuite, session_buffer + 4, sizeof(ciphersuite));
+    saved_ssl_session.ciphersuite = ciphersuite;
+    saved_ssl_session.id_len = session_buffer[1];
+    memcpy(saved_ssl_session.id, session_buffer + 8, PAL_SSL_SESSION_ID_SIZE);
+    memcpy(saved_ssl_session.master, session_buffer + 8 + PAL_SSL_SESSION_ID_SIZE, PAL_SSL_SESSION_MASTER_SIZE);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
+    // mbedtls_ssl_set_session() takes a copy of the ticket, so it can point to our buffer
+    if (ticket_len)
+    {
+        saved_ssl_session.ticket = (unsigned char*)(session_buffer + PAL_SSL_SESSION_FIXED_SIZE);
+        saved_ssl_session.ticket_len = ticket_len;
+    }
+#endif
 
     int32_t platStatus = mbedtls_ssl_set_session(&localTLSCtx->tlsCtx, &saved_ssl_session);
     if (platStatus != SSL_LIB_SUCCESS) {
         PAL_LOG_ERR("pal_plat_SetSslSession - session set failed %" PRId32, platStatus);
+        status = PAL_ERR_TLS_BAD_INPUT_DATA;
     }
+    return status;
 }
 #endif // PAL_USE_SSL_SESSION_RESUME
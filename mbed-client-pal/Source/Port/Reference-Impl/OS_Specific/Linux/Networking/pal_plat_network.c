@@ -27,6 +27,7 @@
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <sys/ioctl.h>
 #include <net/if.h>
@@ -39,6 +40,10 @@
 #include <fcntl.h>
 #include <time.h>
 #include <assert.h>
+#if PAL_NET_ASYNC_SOCKET_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
 
 #define TRACE_GROUP "PAL"
 
@@ -127,6 +132,35 @@ static palMutexID_t s_mutexSocketCallbacks = 0;
 static palMutexID_t s_mutexSocketEventFilter = 0;
 static palSemaphoreID_t s_socketCallbackSemaphore = 0;
 static palSemaphoreID_t s_socketCallbackSignalSemaphore = 0;
+static volatile bool s_socketThreadTerminateSignaled = false;
+
+#if PAL_NET_ASYNC_SOCKET_EPOLL
+
+typedef struct palAsyncSocket {
+    palAsyncSocketCallback_t callback;
+    void* callbackArgument;
+    // Stored with the fd in the epoll event data, so that events queued for a closed
+    // socket are not delivered to a new socket which got the same fd.
+    uint32_t generation;
+} palAsyncSocket_t;
+
+#define PAL_ASYNC_SOCKET_EVENT_DATA(fd, generation) (((uint64_t)(generation) << 32) | (uint32_t)(fd))
+#define PAL_ASYNC_SOCKET_EVENT_FD(data) ((int)(uint32_t)(data))
+#define PAL_ASYNC_SOCKET_EVENT_GENERATION(data) ((uint32_t)((data) >> 32))
+
+// Indexed by the socket fd and grown on demand.
+// These must be updated only when protected by s_mutexSocketCallbacks
+static palAsyncSocket_t* s_asyncSockets = NULL;
+static int s_asyncSocketsSize = 0;
+// Generation of the latest registration, 0 is used only for the wakeup fd
+static uint32_t s_asyncSocketGeneration = 0;
+
+static int s_epollFd = PAL_LINUX_INVALID_SOCKET;
+// Registered to s_epollFd, written to wake up the asyncSocketManager thread
+static int s_wakeupFd = PAL_LINUX_INVALID_SOCKET;
+static volatile bool s_socketThreadTerminateRequested = false;
+
+#else
 
 // These must be updated only when protected by s_mutexSocketCallbacks
 static palAsyncSocketCallback_t s_callbacks[PAL_NET_TEST_MAX_ASYNC_SOCKETS] = {0};
@@ -134,7 +168,163 @@ static void* s_callbackArgs[PAL_NET_TEST_MAX_ASYNC_SOCKETS] = { 0 };
 static struct pollfd s_fds[PAL_NET_TEST_MAX_ASYNC_SOCKETS] = {{0,0,0}};
 static uint32_t s_callbackFilter[PAL_NET_TEST_MAX_ASYNC_SOCKETS] = {0};
 static nfds_t s_nfds = 0;
-static volatile bool s_socketThreadTerminateSignaled = false;
+
+#endif // PAL_NET_ASYNC_SOCKET_EPOLL
+
+#if PAL_NET_ASYNC_SOCKET_EPOLL
+
+// Edge triggered events are reported only once per change, so there is no event filter to clear.
+PAL_PRIVATE void clearSocketFilter(int socketFD)
+{
+    PAL_UNUSED_ARG(socketFD);
+}
+
+PAL_PRIVATE void destroyEpoll(void)
+{
+    if (s_wakeupFd != PAL_LINUX_INVALID_SOCKET)
+    {
+        close(s_wakeupFd);
+        s_wakeupFd = PAL_LINUX_INVALID_SOCKET;
+    }
+    if (s_epollFd != PAL_LINUX_INVALID_SOCKET)
+    {
+        close(s_epollFd);
+        s_epollFd = PAL_LINUX_INVALID_SOCKET;
+    }
+    free(s_asyncSockets);
+    s_asyncSockets = NULL;
+    s_asyncSocketsSize = 0;
+}
+
+PAL_PRIVATE palStatus_t createEpoll(void)
+{
+    palStatus_t result = PAL_SUCCESS;
+    struct epoll_event event;
+
+    s_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (s_epollFd == -1)
+    {
+        result = translateErrorToPALError(errno);
+        s_epollFd = PAL_LINUX_INVALID_SOCKET;
+        return result;
+    }
+
+    s_wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (s_wakeupFd == -1)
+    {
+        result = translateErrorToPALError(errno);
+        s_wakeupFd = PAL_LINUX_INVALID_SOCKET;
+        destroyEpoll();
+        return result;
+    }
+
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u64 = PAL_ASYNC_SOCKET_EVENT_DATA(s_wakeupFd, 0);
+    if (epoll_ctl(s_epollFd, EPOLL_CTL_ADD, s_wakeupFd, &event) == -1)
+    {
+        result = translateErrorToPALError(errno);
+        destroyEpoll();
+    }
+    return result;
+}
+
+PAL_PRIVATE void wakeupAsyncSocketManager(void)
+{
+    const uint64_t value = 1;
+    if (write(s_wakeupFd, &value, sizeof(value)) != sizeof(value))
+    {
+        PAL_LOG_ERR("Error in waking up async socket manager");
+    }
+}
+
+// Thread function.
+PAL_PRIVATE void asyncSocketManager(void const* arg)
+{
+    PAL_UNUSED_ARG(arg); // unused
+    struct epoll_event events[PAL_NET_ASYNC_SOCKET_EPOLL_MAX_EVENTS];
+    sigset_t blockedSignals;
+    palStatus_t result = PAL_SUCCESS;
+    int res;
+    int i;
+
+    // Block the timer signal from interrupting epoll_pwait(), as it does not have a signal handler.
+    sigemptyset(&blockedSignals);
+    sigaddset(&blockedSignals, PAL_TIMER_SIGNAL);
+
+    s_pollThread = pthread_self();
+    // Tell the calling thread that we have finished initialization
+    result = pal_osSemaphoreRelease(s_socketCallbackSemaphore);
+    if (result != PAL_SUCCESS)
+    {
+        PAL_LOG_ERR("Error in async socket manager on semaphore release");
+    }
+
+    // Sockets are added to and removed from s_epollFd directly by the API calls,
+    // this thread only waits for events and calls the callbacks.
+    while (!s_socketThreadTerminateRequested)
+    {
+        res = epoll_pwait(s_epollFd, events, PAL_NET_ASYNC_SOCKET_EPOLL_MAX_EVENTS, -1, &blockedSignals);
+        if (res < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            PAL_LOG_ERR("Error in async socket manager");
+            break;
+        }
+
+        for (i = 0; i < res; i++)
+        {
+            palAsyncSocketCallback_t callback = NULL;
+            void* callbackArgument = NULL;
+            const int fd = PAL_ASYNC_SOCKET_EVENT_FD(events[i].data.u64);
+            const uint32_t generation = PAL_ASYNC_SOCKET_EVENT_GENERATION(events[i].data.u64);
+
+            if (fd == s_wakeupFd)
+            {
+                uint64_t value;
+                (void)read(s_wakeupFd, &value, sizeof(value));
+                continue;
+            }
+
+            // Reported for sockets which are not connected, this combination shouldn't exist in an active socket.
+            if (events[i].events == (EPOLLOUT | EPOLLHUP))
+            {
+                continue;
+            }
+
+            result = pal_osMutexWait(s_mutexSocketCallbacks, PAL_RTOS_WAIT_FOREVER);
+            if (PAL_SUCCESS != result)
+            {
+                PAL_LOG_ERR("Error in async socket manager on mutex wait");
+                continue;
+            }
+            // The socket may have been closed after epoll_pwait() returned, and its fd
+            // may even have been reused by a new socket registered in the meantime.
+            if ((fd < s_asyncSocketsSize) && (s_asyncSockets[fd].generation == generation))
+            {
+                callback = s_asyncSockets[fd].callback;
+                callbackArgument = s_asyncSockets[fd].callbackArgument;
+            }
+            result = pal_osMutexRelease(s_mutexSocketCallbacks);
+            if (PAL_SUCCESS != result)
+            {
+                PAL_LOG_ERR("Error in async socket manager on mutex release");
+            }
+
+            if (callback)
+            {
+                callback(callbackArgument);
+            }
+        }
+    }
+
+    s_socketThreadTerminateSignaled = true; // mark that the thread has receieved the termination request
+}
+
+#else
 
 // The below function is the signal handler API, doing nothing.
 // The idea is to signal the asyncSocketManager thread with pthread_kill(s_pollThread, SIGUSR1) command
@@ -347,6 +537,9 @@ PAL_PRIVATE void asyncSocketManager(void const* arg)
 }
 
 
+#endif // PAL_NET_ASYNC_SOCKET_EPOLL
+
+
 PAL_PRIVATE palStatus_t pal_plat_SockAddrToSocketAddress(const palSocketAddress_t* palAddr, struct sockaddr* output)
 {
     palStatus_t result = PAL_SUCCESS;
@@ -486,6 +679,15 @@ palStatus_t pal_plat_socketsInit(void* context)
         return result;
     }
 
+#if PAL_NET_ASYNC_SOCKET_EPOLL
+    result = createEpoll();
+    if (result != PAL_SUCCESS)
+    {
+        return result;
+    }
+    s_socketThreadTerminateRequested = false;
+#endif
+
     s_socketThreadTerminateSignaled = false;
     palThreadID_t threadID = NULLPTR;
     result = pal_osThreadCreateWithAlloc(asyncSocketManager, NULL, PAL_osPriorityReservedSockets, PAL_NET_TEST_ASYNC_SOCKET_MANAGER_THREAD_STACK_SIZE, NULL, &threadID);
@@ -520,6 +722,12 @@ end:
     {
         s_pal_network_initialized = 1;
     }
+#if PAL_NET_ASYNC_SOCKET_EPOLL
+    else
+    {
+        destroyEpoll();
+    }
+#endif
 
     return result;
 }
@@ -582,6 +790,10 @@ palStatus_t pal_plat_socketsTerminate(void* context)
         firstError = result;
     }
 
+#if PAL_NET_ASYNC_SOCKET_EPOLL
+    s_socketThreadTerminateRequested = true;
+    wakeupAsyncSocketManager();
+#else
     s_nfds = PAL_SOCKETS_TERMINATE;
     result = pal_osSemaphoreRelease(s_socketCallbackSignalSemaphore);
     if ((PAL_SUCCESS != result) && (PAL_SUCCESS == firstError))
@@ -594,6 +806,7 @@ palStatus_t pal_plat_socketsTerminate(void* context)
     {
         pthread_kill(s_pollThread, SIGUSR1);
     }
+#endif
 
     result = pal_osMutexRelease(s_mutexSocketCallbacks);
     if ((PAL_SUCCESS != result) && (PAL_SUCCESS == firstError))
@@ -607,6 +820,10 @@ palStatus_t pal_plat_socketsTerminate(void* context)
         pal_osDelay(10);
     }
 
+#if PAL_NET_ASYNC_SOCKET_EPOLL
+    destroyEpoll();
+#endif
+
     result = pal_osSemaphoreDelete(&s_socketCallbackSignalSemaphore);
     if ((PAL_SUCCESS != result) && (PAL_SUCCESS == firstError))
     {
@@ -830,11 +1047,50 @@ palStatus_t pal_plat_sendTo(palSocket_t socket, const void* buffer, size_t lengt
     return result;
 }
 
+#if PAL_NET_SCATTER_GATHER_SUPPORT
+palStatus_t pal_plat_sendToBatch(palSocket_t socket, const palSocketBuffer_t* datagrams, uint32_t count, const palSocketAddress_t* to, palSocketLength_t toLength, uint32_t* datagramsSent)
+{
+    palStatus_t result = PAL_SUCCESS;
+    struct mmsghdr messages[PAL_NET_MAX_SEND_BUFFERS];
+    struct iovec vectors[PAL_NET_MAX_SEND_BUFFERS];
+    uint32_t i;
+    int res;
+
+    memset(messages, 0, sizeof(struct mmsghdr) * count);
+    for (i = 0; i < count; i++)
+    {
+        vectors[i].iov_base = (void*)datagrams[i].buffer;
+        vectors[i].iov_len = datagrams[i].length;
+        messages[i].msg_hdr.msg_name = (void*)to;
+        messages[i].msg_hdr.msg_namelen = toLength;
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    clearSocketFilter((intptr_t)socket);
+    res = sendmmsg((intptr_t)socket, messages, count, 0);
+    if(res == -1)
+    {
+        result = translateErrorToPALError(errno);
+    }
+    else
+    {
+        *datagramsSent = res;
+    }
+
+    return result;
+}
+#endif // PAL_NET_SCATTER_GATHER_SUPPORT
+
 palStatus_t pal_plat_close(palSocket_t* socket)
 {
     palStatus_t result = PAL_SUCCESS;
     int res;
+#if PAL_NET_ASYNC_SOCKET_EPOLL
+    const int fd = (intptr_t)*socket;
+#else
     unsigned int i,j;
+#endif
 
     if  (*socket == (void *)PAL_LINUX_INVALID_SOCKET) // socket already closed - return success.
     {
@@ -850,6 +1106,17 @@ palStatus_t pal_plat_close(palSocket_t* socket)
         return result;
     }
 
+#if PAL_NET_ASYNC_SOCKET_EPOLL
+    if ((fd < s_asyncSocketsSize) && s_asyncSockets[fd].callback)
+    {
+        // Remove from async socket list. The socket would also be removed from the
+        // epoll set on close(), but only if it has not been duplicated.
+        (void)epoll_ctl(s_epollFd, EPOLL_CTL_DEL, fd, NULL);
+        s_asyncSockets[fd].callback = NULL;
+        s_asyncSockets[fd].callbackArgument = NULL;
+        s_asyncSockets[fd].generation = 0;
+    }
+#else
     for(i= 0 ; i < s_nfds; i++)
     {
         // check if we have we found the socket being closed
@@ -874,6 +1141,7 @@ palStatus_t pal_plat_close(palSocket_t* socket)
             break;
         }
     }
+#endif
     result = pal_osMutexRelease(s_mutexSocketCallbacks);
     if (result != PAL_SUCCESS)
     {
@@ -959,6 +1227,70 @@ palStatus_t pal_plat_getNetInterfaceInfo(uint32_t interfaceNum, palNetInterfaceI
     return result;
 }
 
+#if PAL_NET_ASYNC_SOCKET_EPOLL
+
+PAL_PRIVATE palStatus_t registerAsyncSocketParams(palSocket_t socket, palAsyncSocketCallback_t callback, void* callbackArgument)
+{
+    palStatus_t result;
+    palStatus_t releaseResult;
+    const int fd = (intptr_t)socket;
+    struct epoll_event event;
+
+    // Critical section to update globals
+    result = pal_osMutexWait(s_mutexSocketCallbacks, PAL_RTOS_WAIT_FOREVER);
+    if (result != PAL_SUCCESS)
+    {
+        return result;
+    }
+
+    if (fd >= s_asyncSocketsSize)
+    {
+        int newSize = (s_asyncSocketsSize * 2 > fd) ? (s_asyncSocketsSize * 2) : (fd + 1);
+        palAsyncSocket_t* newSockets = (palAsyncSocket_t*)realloc(s_asyncSockets, newSize * sizeof(palAsyncSocket_t));
+        if (newSockets)
+        {
+            memset(&newSockets[s_asyncSocketsSize], 0, (newSize - s_asyncSocketsSize) * sizeof(palAsyncSocket_t));
+            s_asyncSockets = newSockets;
+            s_asyncSocketsSize = newSize;
+        }
+        else
+        {
+            result = PAL_ERR_NO_MEMORY;
+        }
+    }
+
+    if (result == PAL_SUCCESS)
+    {
+        if (++s_asyncSocketGeneration == 0)
+        {
+            s_asyncSocketGeneration = 1;
+        }
+        s_asyncSockets[fd].callback = callback;
+        s_asyncSockets[fd].callbackArgument = callbackArgument;
+        s_asyncSockets[fd].generation = s_asyncSocketGeneration;
+
+        // The socket is added once, the asyncSocketManager thread does not need to be woken up
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLERR | EPOLLET;
+        event.data.u64 = PAL_ASYNC_SOCKET_EVENT_DATA(fd, s_asyncSocketGeneration);
+        if (epoll_ctl(s_epollFd, EPOLL_CTL_ADD, fd, &event) == -1)
+        {
+            result = translateErrorToPALError(errno);
+            s_asyncSockets[fd].callback = NULL;
+            s_asyncSockets[fd].callbackArgument = NULL;
+        }
+    }
+
+    releaseResult = pal_osMutexRelease(s_mutexSocketCallbacks);
+    if (result == PAL_SUCCESS)
+    {
+        result = releaseResult;
+    }
+    return result;
+}
+
+#else
+
 PAL_PRIVATE palStatus_t registerAsyncSocketParams(palSocket_t socket, palAsyncSocketCallback_t callback, void* callbackArgument)
 {
     palStatus_t result;
@@ -992,6 +1324,8 @@ PAL_PRIVATE palStatus_t registerAsyncSocketParams(palSocket_t socket, palAsyncSo
     return result;
 }
 
+#endif // PAL_NET_ASYNC_SOCKET_EPOLL
+
 #if PAL_NET_TCP_AND_TLS_SUPPORT // functionality below supported only in case TCP is supported.
 
 #if PAL_NET_SERVER_SOCKET_API
@@ -1110,14 +1444,50 @@ palStatus_t pal_plat_send(palSocket_t socket, const void *buf, size_t len, size_
     return result;
 }
 
+#if PAL_NET_SCATTER_GATHER_SUPPORT
+palStatus_t pal_plat_sendVector(palSocket_t socket, const palSocketBuffer_t* buffers, uint32_t count, size_t* sentDataSize)
+{
+    palStatus_t result = PAL_SUCCESS;
+    struct iovec vectors[PAL_NET_MAX_SEND_BUFFERS];
+    struct msghdr message;
+    uint32_t i;
+    ssize_t res;
+
+    for (i = 0; i < count; i++)
+    {
+        vectors[i].iov_base = (void*)buffers[i].buffer;
+        vectors[i].iov_len = buffers[i].length;
+    }
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = vectors;
+    message.msg_iovlen = count;
+
+    clearSocketFilter((intptr_t)socket);
+
+    res = sendmsg((intptr_t)socket, &message, 0);
+    if(res == -1)
+    {
+        result = translateErrorToPALError(errno);
+    }
+    else
+    {
+        *sentDataSize = res;
+    }
+
+    return result;
+}
+#endif // PAL_NET_SCATTER_GATHER_SUPPORT
+
 #endif //PAL_NET_TCP_AND_TLS_SUPPORT
 
 palStatus_t pal_plat_asynchronousSocket(palSocketDomain_t domain, palSocketType_t type, bool nonBlockingSocket, uint32_t interfaceNum, palAsyncSocketCallback_t callback, void* callbackArgument, palSocket_t* socket)
 {
 
+    palStatus_t result = create_socket(domain,  type,  nonBlockingSocket,  interfaceNum, socket);
+
+#if !PAL_NET_ASYNC_SOCKET_EPOLL
     int err;
     int flags;
-    palStatus_t result = create_socket(domain,  type,  nonBlockingSocket,  interfaceNum, socket);
 
     // initialize the socket to be ASYNC so we get SIGIO's for it
     // XXX: this needs to be conditionalized as the blocking IO might have some use also.
@@ -1135,6 +1505,7 @@ palStatus_t pal_plat_asynchronousSocket(palSocketDomain_t domain, palSocketType_
     {
         result = translateErrorToPALError(errno);
     }
+#endif
 
     if (result == PAL_SUCCESS)
     {
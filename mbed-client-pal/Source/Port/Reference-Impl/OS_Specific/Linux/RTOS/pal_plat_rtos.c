@@ -35,6 +35,10 @@
 #include "pal.h"
 #include "pal_plat_rtos.h"
 
+#if PAL_RTOS_TIMER_TIMERFD
+#include <sys/timerfd.h>
+#endif
+
 #define TRACE_GROUP "PAL"
 
  /*
@@ -67,8 +71,14 @@ typedef struct palThreadData
  */
 struct palTimerInfo
 {
+#if PAL_RTOS_TIMER_TIMERFD
+    uint64_t expiry; // absolute CLOCK_MONOTONIC time in nanoseconds, valid while armed
+    uint32_t period; // milliseconds, used to re-arm periodic timers
+    size_t heapIndex; // position in g_timerHeap or PAL_TIMER_NOT_ARMED
+#else
     struct palTimerInfo *next;
     timer_t handle;
+#endif
     palTimerFuncPtr function;
     void *funcArgs;
     palTimerType_t timerType;
@@ -77,17 +87,35 @@ struct palTimerInfo
 // Mutex to prevent simultaneus modification of the linked list of the timers in g_timerList.
 PAL_PRIVATE palMutexID_t g_timerListMutex = 0;
 
+#if PAL_RTOS_TIMER_TIMERFD
+#define PAL_TIMER_NOT_ARMED SIZE_MAX
+#define PAL_TIMER_HEAP_INITIAL_SIZE 16
+
+// Binary min-heap of the armed timers ordered by expiry, access may be done only if holding
+// the g_timerListMutex. The earliest expiry is programmed to g_timerFd, which the timer thread
+// blocks on, so only one kernel timer is used regardless of the number of PAL timers.
+PAL_PRIVATE struct palTimerInfo **g_timerHeap = NULL;
+PAL_PRIVATE size_t g_timerHeapCount = 0;
+PAL_PRIVATE size_t g_timerHeapSize = 0;
+PAL_PRIVATE int g_timerFd = -1;
+
+// Number of created timers, the heap always has room for all of them.
+PAL_PRIVATE size_t g_timerCount = 0;
+#endif
+
 #if (PAL_SIMULATE_RTOS_REBOOT == 1)
     extern char *program_invocation_name;
 #endif
 
 
+#if !PAL_RTOS_TIMER_TIMERFD
 // A singly linked list of the timers, access may be done only if holding the g_timerListMutex.
 // The list is needed as the timers use async signals and when the signal is finally delivered, the
 // palTimerInfo timer struct may be already deleted. The signals themselves carry pointer to timer,
 // so whenever a signal is received, the thread will look if the palTimerInfo is still on the list,
 // and if it is, uses the struct to find the callback pointer and arguments.
 PAL_PRIVATE volatile struct palTimerInfo *g_timerList = NULL;
+#endif
 
 extern palStatus_t pal_plat_getRandomBufferFromHW(uint8_t *randomBuf, size_t bufSizeBytes, size_t* actualRandomSizeBytes);
 
@@ -138,6 +166,18 @@ palStatus_t pal_plat_RTOSInitialize(void* opaqueContext)
 
     status = pal_osMutexCreate(&g_timerListMutex);
 
+#if PAL_RTOS_TIMER_TIMERFD
+    if (status == PAL_SUCCESS) {
+
+        g_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+
+        if (g_timerFd == -1) {
+
+            PAL_LOG_ERR("pal_plat_RTOSInitialize: timerfd_create failed with %d\n", errno);
+            status = PAL_ERR_SYSCALL_FAILED;
+        }
+    }
+#else
     if (status == PAL_SUCCESS) {
 
         sigset_t blocked;
@@ -155,6 +195,7 @@ palStatus_t pal_plat_RTOSInitialize(void* opaqueContext)
             status = PAL_ERR_SYSCALL_FAILED;
         }
     }
+#endif
 
     if (status == PAL_SUCCESS) {
 
@@ -180,6 +221,20 @@ palStatus_t pal_plat_RTOSDestroy(void)
         ret = stopTimerThread();
     }
 
+#if PAL_RTOS_TIMER_TIMERFD
+    if (ret == PAL_SUCCESS) {
+        close(g_timerFd);
+        g_timerFd = -1;
+
+        // the timers themselves are owned by their creators, only the heap array is ours
+        free(g_timerHeap);
+        g_timerHeap = NULL;
+        g_timerHeapCount = 0;
+        g_timerHeapSize = 0;
+        g_timerCount = 0;
+    }
+#endif
+
     if (ret == PAL_SUCCESS) {
         ret = pal_osMutexDelete(&g_timerListMutex);
     }
@@ -399,6 +454,206 @@ typedef struct palTimerThreadContext
 static palThreadID_t s_palHighResTimerThreadID = NULLPTR;
 static palTimerThreadContext_t s_palTimerThreadContext = {0};
 
+#if PAL_RTOS_TIMER_TIMERFD
+
+PAL_PRIVATE uint64_t getMonotonicTimeNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * PAL_NANO_PER_SECOND) + (uint64_t)ts.tv_nsec;
+}
+
+PAL_PRIVATE void timerHeapSet(size_t index, struct palTimerInfo* timer)
+{
+    g_timerHeap[index] = timer;
+    timer->heapIndex = index;
+}
+
+PAL_PRIVATE void timerHeapSiftUp(size_t index)
+{
+    struct palTimerInfo* timer = g_timerHeap[index];
+
+    while (index > 0) {
+
+        size_t parent = (index - 1) / 2;
+
+        if (g_timerHeap[parent]->expiry <= timer->expiry) {
+            break;
+        }
+        timerHeapSet(index, g_timerHeap[parent]);
+        index = parent;
+    }
+    timerHeapSet(index, timer);
+}
+
+PAL_PRIVATE void timerHeapSiftDown(size_t index)
+{
+    struct palTimerInfo* timer = g_timerHeap[index];
+
+    while (1) {
+
+        size_t child = (2 * index) + 1;
+
+        if (child >= g_timerHeapCount) {
+            break;
+        }
+        if (((child + 1) < g_timerHeapCount) && (g_timerHeap[child + 1]->expiry < g_timerHeap[child]->expiry)) {
+            child++;
+        }
+        if (timer->expiry <= g_timerHeap[child]->expiry) {
+            break;
+        }
+        timerHeapSet(index, g_timerHeap[child]);
+        index = child;
+    }
+    timerHeapSet(index, timer);
+}
+
+// Move a timer whose expiry has changed to its correct place in the heap.
+PAL_PRIVATE void timerHeapUpdate(struct palTimerInfo* timer)
+{
+    timerHeapSiftUp(timer->heapIndex);
+    timerHeapSiftDown(timer->heapIndex);
+}
+
+// The caller must have reserved room in the heap, see pal_plat_osTimerCreate().
+PAL_PRIVATE void timerHeapInsert(struct palTimerInfo* timer)
+{
+    timerHeapSet(g_timerHeapCount, timer);
+    g_timerHeapCount++;
+    timerHeapSiftUp(timer->heapIndex);
+}
+
+PAL_PRIVATE void timerHeapRemove(struct palTimerInfo* timer)
+{
+    size_t index = timer->heapIndex;
+
+    g_timerHeapCount--;
+    timer->heapIndex = PAL_TIMER_NOT_ARMED;
+
+    if (index != g_timerHeapCount) {
+
+        // fill the hole with the last item and let it find its place
+        struct palTimerInfo* last = g_timerHeap[g_timerHeapCount];
+
+        timerHeapSet(index, last);
+        timerHeapUpdate(last);
+    }
+}
+
+// Program g_timerFd to expire at the earliest expiry in the heap, or disarm it if the heap is empty.
+PAL_PRIVATE palStatus_t timerFdRearm(void)
+{
+    palStatus_t status = PAL_SUCCESS;
+    struct itimerspec its;
+
+    memset(&its, 0, sizeof(its));
+
+    if (g_timerHeapCount > 0) {
+
+        uint64_t expiry = g_timerHeap[0]->expiry;
+
+        its.it_value.tv_sec = expiry / PAL_NANO_PER_SECOND;
+        its.it_value.tv_nsec = expiry % PAL_NANO_PER_SECOND;
+    }
+
+    if (-1 == timerfd_settime(g_timerFd, TFD_TIMER_ABSTIME, &its, NULL)) {
+
+        PAL_LOG_ERR("timerFdRearm: timerfd_settime failed with %d\n", errno);
+        status = PAL_ERR_SYSCALL_FAILED;
+    }
+    return status;
+}
+
+/*
+* Thread for handling the expirations of all timers by calling the attached callback
+*/
+
+PAL_PRIVATE void palTimerThread(void const *args)
+{
+    palTimerThreadContext_t* context = (palTimerThreadContext_t*)args;
+
+    // signal the caller that thread has started
+    if (pal_osSemaphoreRelease(context->startStopSemaphore) != PAL_SUCCESS) {
+        PAL_LOG_ERR("pal_osSemaphoreRelease(context->startStopSemaphore) failed!");
+    }
+
+    // loop until signaled with threadStopRequested
+    while (1) {
+
+        uint64_t expirations;
+
+        // Wait for the earliest timer to expire. The expiration count itself is not
+        // needed, the heap tells which timers are due.
+        ssize_t ret = read(g_timerFd, &expirations, sizeof(expirations));
+
+        if (ret != sizeof(expirations)) {
+            if (errno != EINTR) {
+                PAL_LOG_ERR("palTimerThread: read failed with %d\n", errno);
+            }
+            continue;
+        }
+
+        // before using the timer heap or threadStopRequested flag, we need to claim the mutex
+        pal_osMutexWait(g_timerListMutex, PAL_RTOS_WAIT_FOREVER);
+
+        uint64_t now = getMonotonicTimeNs();
+
+        // Run every timer which is due. The heap top is re-read after each callback, as
+        // the timers may have been started, stopped or deleted while the mutex was released.
+        while ((!context->threadStopRequested) && (g_timerHeapCount > 0) && (g_timerHeap[0]->expiry <= now)) {
+
+            struct palTimerInfo* timer = g_timerHeap[0];
+
+            // Backup the callback parameters as the timer may get deleted as soon as
+            // the mutex is released.
+            palTimerFuncPtr function = timer->function;
+            void *funcArgs = timer->funcArgs;
+
+            if (palOsTimerPeriodic == timer->timerType) {
+
+                uint64_t period = (uint64_t)timer->period * PAL_NANO_PER_MILLI;
+
+                // keep the period free of drift, but skip the periods missed
+                // instead of firing them back-to-back
+                timer->expiry += period;
+                if (timer->expiry <= now) {
+                    timer->expiry = now + period;
+                }
+                timerHeapSiftDown(0);
+            } else {
+                timerHeapRemove(timer);
+            }
+
+            // Release the heap mutex before callback to avoid callback deadlocking other threads
+            // if they try to create a timer.
+            (void)pal_osMutexRelease(g_timerListMutex);
+
+            function(funcArgs);
+
+            pal_osMutexWait(g_timerListMutex, PAL_RTOS_WAIT_FOREVER);
+        }
+
+        if (context->threadStopRequested) {
+
+            // release mutex and bail out
+            (void)pal_osMutexRelease(g_timerListMutex);
+            break;
+        }
+
+        (void)timerFdRearm();
+
+        (void)pal_osMutexRelease(g_timerListMutex);
+    }
+
+    // signal the caller that thread is now stopping and it can continue the pal_destroy()
+    (void)pal_osSemaphoreRelease(context->startStopSemaphore);
+}
+
+#else
+
 /*
 * Thread for handling the signals from all timers by calling the attached callback
 */
@@ -495,6 +750,8 @@ PAL_PRIVATE void palTimerThread(void const *args)
     (void)pal_osSemaphoreRelease(context->startStopSemaphore);
 }
 
+#endif
+
 PAL_PRIVATE palStatus_t startTimerThread()
 {
     palStatus_t status;
@@ -522,6 +779,243 @@ PAL_PRIVATE palStatus_t startTimerThread()
     return status;
 }
 
+#if PAL_RTOS_TIMER_TIMERFD
+
+PAL_PRIVATE palStatus_t stopTimerThread()
+{
+    palStatus_t status;
+
+    status = pal_osMutexWait(g_timerListMutex, PAL_RTOS_WAIT_FOREVER);
+
+    if (status == PAL_SUCCESS) {
+
+        // set the flag to end the thread
+        s_palTimerThreadContext.threadStopRequested = true;
+
+        // ping the timer thread that it should start shutdown by expiring the timerfd right away
+        struct itimerspec its;
+        int err;
+
+        memset(&its, 0, sizeof(its));
+        its.it_value.tv_nsec = 1;
+
+        err = timerfd_settime(g_timerFd, TFD_TIMER_ABSTIME, &its, NULL);
+
+        (void)pal_osMutexRelease(g_timerListMutex);
+
+        // if the timerfd could not be armed, the thread never wakes up and a wait
+        // on semaphore would cause a deadlock.
+        if (err == 0) {
+
+            // wait for for acknowledgement that timer thread is going down
+            pal_osSemaphoreWait(s_palTimerThreadContext.startStopSemaphore, PAL_RTOS_WAIT_FOREVER, NULL);
+        }
+
+        pal_osSemaphoreDelete(&s_palTimerThreadContext.startStopSemaphore);
+
+        // and clean up the thread
+        status = pal_osThreadTerminate(&s_palHighResTimerThreadID);
+    }
+    return status;
+}
+
+/*! Create a timer.
+ *
+ * @param[in] function A function pointer to the timer callback function.
+ * @param[in] funcArgument An argument for the timer callback function.
+ * @param[in] timerType The timer type to be created, periodic or oneShot.
+ * @param[out] timerID The ID of the created timer, zero value indicates an error.
+ *
+ * \return PAL_SUCCESS when the timer was created successfully. A specific error in case of failure.
+ */
+palStatus_t pal_plat_osTimerCreate(palTimerFuncPtr function, void* funcArgument,
+        palTimerType_t timerType, palTimerID_t* timerID)
+{
+    palStatus_t status = PAL_SUCCESS;
+    struct palTimerInfo* timerInfo = NULL;
+
+    if ((NULL == timerID) || (NULL == (void*) function))
+    {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+
+    timerInfo = (struct palTimerInfo*) malloc(sizeof(struct palTimerInfo));
+    if (NULL == timerInfo)
+    {
+        return PAL_ERR_NO_MEMORY;
+    }
+
+    timerInfo->expiry = 0;
+    timerInfo->period = 0;
+    timerInfo->heapIndex = PAL_TIMER_NOT_ARMED;
+    timerInfo->function = function;
+    timerInfo->funcArgs = funcArgument;
+    timerInfo->timerType = timerType;
+
+    pal_osMutexWait(g_timerListMutex, PAL_RTOS_WAIT_FOREVER);
+
+    // Reserve a heap slot for every created timer, so starting a timer never needs to allocate.
+    if (g_timerCount >= g_timerHeapSize)
+    {
+        size_t newSize = (g_timerHeapSize == 0) ? PAL_TIMER_HEAP_INITIAL_SIZE : (g_timerHeapSize * 2);
+        struct palTimerInfo **newHeap = (struct palTimerInfo **) realloc(g_timerHeap, newSize * sizeof(struct palTimerInfo *));
+
+        if (NULL == newHeap)
+        {
+            status = PAL_ERR_NO_MEMORY;
+        }
+        else
+        {
+            g_timerHeap = newHeap;
+            g_timerHeapSize = newSize;
+        }
+    }
+
+    if (PAL_SUCCESS == status)
+    {
+        g_timerCount++;
+        *timerID = (palTimerID_t) timerInfo;
+    }
+
+    (void)pal_osMutexRelease(g_timerListMutex);
+
+    if (PAL_SUCCESS != status)
+    {
+        free(timerInfo);
+        *timerID = (palTimerID_t) NULL;
+    }
+    return status;
+}
+
+// Take the timer out of the heap, if it is armed. Must be called while holding g_timerListMutex.
+PAL_PRIVATE palStatus_t timerDisarm(struct palTimerInfo* timerInfo)
+{
+    palStatus_t status = PAL_SUCCESS;
+
+    if (PAL_TIMER_NOT_ARMED != timerInfo->heapIndex)
+    {
+        bool wasFirst = (0 == timerInfo->heapIndex);
+
+        timerHeapRemove(timerInfo);
+
+        // the kernel timer only needs an update if the earliest expiry changed
+        if (wasFirst)
+        {
+            status = timerFdRearm();
+        }
+    }
+    return status;
+}
+
+/*! Start or restart a timer.
+ *
+ * @param[in] timerID The handle for the timer to start.
+ * @param[in] millisec The time in milliseconds to set the timer to.
+ *
+ * \return The status in the form of palStatus_t; PAL_SUCCESS(0) in case of success, a negative value indicating a specific error code in case of failure.
+ */
+palStatus_t pal_plat_osTimerStart(palTimerID_t timerID, uint32_t millisec)
+{
+    palStatus_t status = PAL_SUCCESS;
+    if (NULL == (struct palTimerInfo *) timerID)
+    {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+
+    struct palTimerInfo* timerInfo = (struct palTimerInfo *) timerID;
+
+    pal_osMutexWait(g_timerListMutex, PAL_RTOS_WAIT_FOREVER);
+
+    if (0 == millisec)
+    {
+        // a zero time disarms the timer, as with timer_settime()
+        status = timerDisarm(timerInfo);
+    }
+    else
+    {
+        struct palTimerInfo* oldFirst = (g_timerHeapCount > 0) ? g_timerHeap[0] : NULL;
+
+        timerInfo->period = millisec;
+        timerInfo->expiry = getMonotonicTimeNs() + ((uint64_t)millisec * PAL_NANO_PER_MILLI);
+
+        if (PAL_TIMER_NOT_ARMED == timerInfo->heapIndex)
+        {
+            timerHeapInsert(timerInfo);
+        }
+        else
+        {
+            timerHeapUpdate(timerInfo);
+        }
+
+        if ((g_timerHeap[0] != oldFirst) || (g_timerHeap[0] == timerInfo))
+        {
+            status = timerFdRearm();
+        }
+    }
+
+    (void)pal_osMutexRelease(g_timerListMutex);
+
+    return status;
+}
+
+/*! Stop a timer.
+ *
+ * @param[in] timerID The handle for the timer to stop.
+ *
+ * \return The status in the form of palStatus_t; PAL_SUCCESS(0) in case of success, a negative value indicating a specific error code in case of failure.
+ */
+palStatus_t pal_plat_osTimerStop(palTimerID_t timerID)
+{
+    palStatus_t status = PAL_SUCCESS;
+    if (NULL == (struct palTimerInfo *) timerID)
+    {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+
+    struct palTimerInfo* timerInfo = (struct palTimerInfo *) timerID;
+
+    pal_osMutexWait(g_timerListMutex, PAL_RTOS_WAIT_FOREVER);
+
+    status = timerDisarm(timerInfo);
+
+    (void)pal_osMutexRelease(g_timerListMutex);
+
+    return status;
+}
+
+/*! Delete the timer object
+ *
+ * @param[inout] timerID The handle for the timer to delete. In success, *timerID = NULL.
+ *
+ * \return PAL_SUCCESS when the timer was deleted successfully, PAL_ERR_RTOS_PARAMETER when the timerID is incorrect.
+ */
+palStatus_t pal_plat_osTimerDelete(palTimerID_t* timerID)
+{
+    palStatus_t status = PAL_SUCCESS;
+    if ((NULL == timerID) || ((struct palTimerInfo *)*timerID == NULL)) {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+    struct palTimerInfo* timerInfo = (struct palTimerInfo *) *timerID;
+
+    pal_osMutexWait(g_timerListMutex, PAL_RTOS_WAIT_FOREVER);
+
+    // remove the timer from the heap before freeing it
+    status = timerDisarm(timerInfo);
+
+    if (g_timerCount > 0) {
+        g_timerCount--;
+    }
+
+    (void)pal_osMutexRelease(g_timerListMutex);
+
+    free(timerInfo);
+    *timerID = (palTimerID_t) NULL;
+
+    return status;
+}
+
+#else
+
 PAL_PRIVATE palStatus_t stopTimerThread()
 {
     palStatus_t status;
@@ -785,6 +1279,8 @@ palStatus_t pal_plat_osTimerDelete(palTimerID_t* timerID)
     return status;
 }
 
+#endif
+
 /*! Create and initialize a mutex object.
  *
  * @param[out] mutexID The created mutex ID handle, zero value indicates an error.
@@ -28,6 +28,8 @@
 
 #ifdef __LINUX__
 #include <netdb.h>
+#include <time.h>
+#include <inttypes.h>
 #endif
 
 TEST_GROUP(pal_socket);
@@ -1816,6 +1818,323 @@ TEST(pal_socket, udp_echo)
     echo_test(false);
 }
 
+#ifdef __LINUX__
+
+#if PAL_NET_ASYNC_SOCKET_EPOLL
+#define PAL_NET_TEST_STRESS_SOCKETS 200
+#else
+// One socket is used for sending
+#define PAL_NET_TEST_STRESS_SOCKETS (PAL_NET_TEST_MAX_ASYNC_SOCKETS - 1)
+#endif
+#define PAL_NET_TEST_STRESS_ROUNDS 20
+#define PAL_NET_TEST_STRESS_BASE_PORT 21000
+
+PAL_PRIVATE palSocket_t *g_stressSockets = NULLPTR;
+PAL_PRIVATE volatile int32_t g_stressExpectedSocket = -1;
+PAL_PRIVATE volatile uint64_t g_stressSendTick = 0;
+PAL_PRIVATE uint64_t g_stressLatencyTotal = 0;
+PAL_PRIVATE uint64_t g_stressLatencyMax = 0;
+PAL_PRIVATE uint32_t g_stressEvents = 0;
+
+PAL_PRIVATE void stressSocketCallback(void *arg)
+{
+    const int32_t index = (int32_t)(intptr_t)arg;
+    palSocketAddress_t from = { 0 };
+    palSocketLength_t fromLength = sizeof(from);
+    uint8_t buffer[PAL_TEST_BUFFER_SIZE];
+    size_t read = 0;
+    bool received = false;
+
+    if (index < 0)
+    {
+        return; // sending socket
+    }
+
+    // Read until the socket is empty, edge triggered events are not repeated
+    while (pal_receiveFrom(g_stressSockets[index], buffer, sizeof(buffer), &from, &fromLength, &read) == PAL_SUCCESS)
+    {
+        received = true;
+    }
+
+    if (received && (index == g_stressExpectedSocket))
+    {
+        uint64_t latency = pal_osKernelSysTick() - g_stressSendTick;
+        g_stressLatencyTotal += latency;
+        if (latency > g_stressLatencyMax)
+        {
+            g_stressLatencyMax = latency;
+        }
+        g_stressEvents++;
+        pal_osSemaphoreRelease(s_semaphoreID);
+    }
+}
+#endif // __LINUX__
+
+/*! \brief Stress test for the async socket callbacks using pairs of loopback UDP sockets.
+* Reports the callback latency and the CPU time used, to compare the async socket manager backends.
+** \test
+* | # |    Step                                                                                     |   Expected  |
+* |---|---------------------------------------------------------------------------------------------|-------------|
+* | 1 | Create `PAL_NET_TEST_STRESS_SOCKETS` asynchronous non-blocking UDP sockets and bind them to loopback. | PAL_SUCCESS |
+* | 2 | Create an asynchronous non-blocking UDP socket for sending.                                  | PAL_SUCCESS |
+* | 3 | Send a datagram to each socket in turn and wait for its callback, for all rounds.           | PAL_SUCCESS |
+* | 4 | Check that every datagram was signaled and report latency and CPU time.                     | PAL_SUCCESS |
+* | 5 | Close all sockets.                                                                         | PAL_SUCCESS |
+*/
+TEST(pal_socket, asyncSocketStress)
+{
+#ifdef __LINUX__
+    palStatus_t result = PAL_SUCCESS;
+    palSocket_t sendSocket = 0;
+    palSocketAddress_t address = { 0 };
+    palIpV4Addr_t loopback = { 127, 0, 0, 1 };
+    size_t sent = 0;
+    uint32_t round = 0;
+    int32_t i = 0;
+    clock_t cpuStart;
+    uint64_t cpuTime;
+
+    g_stressLatencyTotal = 0;
+    g_stressLatencyMax = 0;
+    g_stressEvents = 0;
+
+    result = pal_osSemaphoreCreate(0, &s_semaphoreID);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+
+    g_stressSockets = (palSocket_t*)malloc(PAL_NET_TEST_STRESS_SOCKETS * sizeof(palSocket_t));
+    TEST_ASSERT_NOT_NULL(g_stressSockets);
+    memset(g_stressSockets, 0, PAL_NET_TEST_STRESS_SOCKETS * sizeof(palSocket_t));
+
+    /*#1*/
+    result = pal_setSockAddrIPV4Addr(&address, loopback);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    for (i = 0; i < PAL_NET_TEST_STRESS_SOCKETS; i++)
+    {
+        result = pal_asynchronousSocketWithArgument(PAL_AF_INET, PAL_SOCK_DGRAM, true, 0, stressSocketCallback, (void*)(intptr_t)i, &g_stressSockets[i]);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+        result = pal_setSockAddrPort(&address, PAL_NET_TEST_STRESS_BASE_PORT + i);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+        result = pal_bind(g_stressSockets[i], &address, sizeof(address));
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    }
+
+    /*#2*/
+    result = pal_asynchronousSocketWithArgument(PAL_AF_INET, PAL_SOCK_DGRAM, true, 0, stressSocketCallback, (void*)(intptr_t)-1, &sendSocket);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+
+    /*#3*/
+    cpuStart = clock();
+    for (round = 0; round < PAL_NET_TEST_STRESS_ROUNDS; round++)
+    {
+        for (i = 0; i < PAL_NET_TEST_STRESS_SOCKETS; i++)
+        {
+            result = pal_setSockAddrPort(&address, PAL_NET_TEST_STRESS_BASE_PORT + i);
+            TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+            g_stressExpectedSocket = i;
+            g_stressSendTick = pal_osKernelSysTick();
+            result = pal_sendTo(sendSocket, "ping", 4, &address, sizeof(address), &sent);
+            TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+            result = pal_osSemaphoreWait(s_semaphoreID, TEST_SEMAPHORE_WAIT, NULL);
+            TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+        }
+    }
+    cpuTime = (uint64_t)(clock() - cpuStart) * 1000000 / CLOCKS_PER_SEC;
+
+    /*#4*/
+    TEST_ASSERT_EQUAL(PAL_NET_TEST_STRESS_ROUNDS * PAL_NET_TEST_STRESS_SOCKETS, g_stressEvents);
+    PAL_PRINTF("async sockets %d, events %" PRIu32 ", latency avg %" PRIu64 " us max %" PRIu64 " us, cpu %" PRIu64 " us",
+               PAL_NET_TEST_STRESS_SOCKETS, g_stressEvents,
+               (g_stressLatencyTotal * 1000000 / pal_osKernelSysTickFrequency()) / g_stressEvents,
+               g_stressLatencyMax * 1000000 / pal_osKernelSysTickFrequency(),
+               cpuTime);
+    PAL_UNUSED_ARG(cpuTime); // unused if printing is disabled
+
+    /*#5*/
+    result = pal_close(&sendSocket);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    for (i = 0; i < PAL_NET_TEST_STRESS_SOCKETS; i++)
+    {
+        result = pal_close(&g_stressSockets[i]);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    }
+    free(g_stressSockets);
+    g_stressSockets = NULLPTR;
+
+    pal_osSemaphoreDelete(&s_semaphoreID);
+#else
+    TEST_IGNORE_MESSAGE("Ignored, loopback stress test is only supported on Linux");
+#endif
+}
+
+#ifdef __LINUX__
+#define PAL_NET_TEST_SCATTER_GATHER_PORT 21500
+
+PAL_PRIVATE void scatterGatherSocketCallback(void* arg)
+{
+    PAL_UNUSED_ARG(arg); // the sockets are blocking
+}
+#endif // __LINUX__
+
+/*! \brief Send a batch of datagrams with `pal_sendToBatch` over loopback.
+** \test
+* | # |    Step                                                                            |   Expected  |
+* |---|------------------------------------------------------------------------------------|-------------|
+* | 1 | Create a blocking UDP socket, set a receive timeout and bind it to loopback.      | PAL_SUCCESS |
+* | 2 | Create a blocking UDP socket for sending.                                          | PAL_SUCCESS |
+* | 3 | Send three datagrams of different sizes with one `pal_sendToBatch` call.          | PAL_SUCCESS |
+* | 4 | Receive the datagrams and check they arrived whole and in order.                  | PAL_SUCCESS |
+* | 5 | Close the sockets.                                                                 | PAL_SUCCESS |
+*/
+TEST(pal_socket, sendToBatchLoopback)
+{
+#ifdef __LINUX__
+    palStatus_t result = PAL_SUCCESS;
+    palSocketAddress_t address = { 0 };
+    palSocketAddress_t from = { 0 };
+    palSocketLength_t fromLength = 0;
+    palIpV4Addr_t loopback = { 127, 0, 0, 1 };
+    const char* payloads[] = { "first", "the second datagram", "3" };
+    palSocketBuffer_t datagrams[3];
+    uint8_t buffer[PAL_TEST_BUFFER_SIZE];
+    int timeout = PAL_MILLI_PER_SECOND;
+    uint32_t datagramsSent = 0;
+    size_t read = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i < 3; i++)
+    {
+        datagrams[i].buffer = payloads[i];
+        datagrams[i].length = strlen(payloads[i]);
+    }
+
+    /*#1*/
+    result = pal_asynchronousSocket(PAL_AF_INET, PAL_SOCK_DGRAM, false, 0, scatterGatherSocketCallback, &g_testSockets[0]);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    result = pal_setSocketOptions(g_testSockets[0], PAL_SO_RCVTIMEO, &timeout, sizeof(timeout));
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    result = pal_setSockAddrIPV4Addr(&address, loopback);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    result = pal_setSockAddrPort(&address, PAL_NET_TEST_SCATTER_GATHER_PORT);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    result = pal_bind(g_testSockets[0], &address, sizeof(address));
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+
+    /*#2*/
+    result = pal_asynchronousSocket(PAL_AF_INET, PAL_SOCK_DGRAM, false, 0, scatterGatherSocketCallback, &g_testSockets[1]);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+
+    /*#3*/
+    result = pal_sendToBatch(g_testSockets[1], datagrams, 3, &address, sizeof(address), &datagramsSent);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    TEST_ASSERT_EQUAL(3, datagramsSent);
+
+    /*#4*/
+    for (i = 0; i < 3; i++)
+    {
+        fromLength = sizeof(from);
+        result = pal_receiveFrom(g_testSockets[0], buffer, sizeof(buffer), &from, &fromLength, &read);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+        TEST_ASSERT_EQUAL(datagrams[i].length, read);
+        TEST_ASSERT_EQUAL_MEMORY(payloads[i], buffer, read);
+    }
+
+    /*#5*/
+    result = pal_close(&g_testSockets[1]);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    result = pal_close(&g_testSockets[0]);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+#else
+    TEST_IGNORE_MESSAGE("Ignored, loopback scatter/gather test is only supported on Linux");
+#endif
+}
+
+/*! \brief Send a length prefix and a payload as one stream write with `pal_sendVector` over loopback.
+** \test
+* | # |    Step                                                                            |   Expected  |
+* |---|------------------------------------------------------------------------------------|-------------|
+* | 1 | Create a blocking TCP server socket, bind it to loopback and listen.              | PAL_SUCCESS |
+* | 2 | Connect a blocking TCP socket to it and accept the connection.                    | PAL_SUCCESS |
+* | 3 | Send a 4 byte length prefix and the payload with one `pal_sendVector` call.       | PAL_SUCCESS |
+* | 4 | Receive on the accepted socket until the whole frame arrived and check it.        | PAL_SUCCESS |
+* | 5 | Close the sockets.                                                                 | PAL_SUCCESS |
+*/
+TEST(pal_socket, sendVectorLoopback)
+{
+#if defined(__LINUX__) && PAL_NET_TCP_AND_TLS_SUPPORT && PAL_NET_SERVER_SOCKET_API
+    palStatus_t result = PAL_SUCCESS;
+    palSocketAddress_t address = { 0 };
+    palSocketAddress_t acceptedAddress = { 0 };
+    palSocketLength_t acceptedLength = sizeof(acceptedAddress);
+    palIpV4Addr_t loopback = { 127, 0, 0, 1 };
+    const char* payload = "scattered payload";
+    uint8_t header[4] = { 0, 0, 0, 0 };
+    palSocketBuffer_t buffers[2];
+    uint8_t buffer[PAL_TEST_BUFFER_SIZE];
+    int timeout = PAL_MILLI_PER_SECOND;
+    size_t frameLength = sizeof(header) + strlen(payload);
+    size_t sent = 0;
+    size_t received = 0;
+    size_t read = 0;
+
+    header[3] = (uint8_t)strlen(payload);
+    buffers[0].buffer = header;
+    buffers[0].length = sizeof(header);
+    buffers[1].buffer = payload;
+    buffers[1].length = strlen(payload);
+
+    /*#1*/
+    result = pal_asynchronousSocket(PAL_AF_INET, PAL_SOCK_STREAM_SERVER, false, 0, scatterGatherSocketCallback, &g_testSockets[0]);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    result = pal_setSocketOptions(g_testSockets[0], PAL_SO_REUSEADDR, &timeout, sizeof(timeout));
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    result = pal_setSockAddrIPV4Addr(&address, loopback);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    result = pal_setSockAddrPort(&address, PAL_NET_TEST_SCATTER_GATHER_PORT);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    result = pal_bind(g_testSockets[0], &address, sizeof(address));
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    result = pal_listen(g_testSockets[0], 1);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+
+    /*#2*/
+    result = pal_asynchronousSocket(PAL_AF_INET, PAL_SOCK_STREAM, false, 0, scatterGatherSocketCallback, &g_testSockets[1]);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    result = pal_connect(g_testSockets[1], &address, sizeof(address));
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    result = pal_accept(g_testSockets[0], &acceptedAddress, &acceptedLength, &g_testSockets[2], scatterGatherSocketCallback, NULL);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    result = pal_setSocketOptions(g_testSockets[2], PAL_SO_RCVTIMEO, &timeout, sizeof(timeout));
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+
+    /*#3*/
+    result = pal_sendVector(g_testSockets[1], buffers, 2, &sent);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    TEST_ASSERT_EQUAL(frameLength, sent);
+
+    /*#4*/
+    while (received < frameLength)
+    {
+        result = pal_recv(g_testSockets[2], buffer + received, sizeof(buffer) - received, &read);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+        TEST_ASSERT_NOT_EQUAL(0, read);
+        received += read;
+    }
+    TEST_ASSERT_EQUAL(frameLength, received);
+    TEST_ASSERT_EQUAL_MEMORY(header, buffer, sizeof(header));
+    TEST_ASSERT_EQUAL_MEMORY(payload, buffer + sizeof(header), strlen(payload));
+
+    /*#5*/
+    result = pal_close(&g_testSockets[2]);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    result = pal_close(&g_testSockets[1]);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+    result = pal_close(&g_testSockets[0]);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, result);
+#else
+    TEST_IGNORE_MESSAGE("Ignored, loopback TCP scatter/gather test is only supported on Linux with TCP server sockets");
+#endif
+}
+
 #ifdef TARGET_LIKE_MBED
 void network_status_event_cb(palNetworkStatus_t status, void *client_arg)
 {
@@ -39,5 +39,8 @@ TEST_GROUP_RUNNER(pal_socket)
     RUN_TEST_CASE(pal_socket, keepaliveOff);
     RUN_TEST_CASE(pal_socket, tcp_echo);
     RUN_TEST_CASE(pal_socket, udp_echo);
+    RUN_TEST_CASE(pal_socket, asyncSocketStress);
+    RUN_TEST_CASE(pal_socket, sendToBatchLoopback);
+    RUN_TEST_CASE(pal_socket, sendVectorLoopback);
     RUN_TEST_CASE(pal_socket, interfaceStatusListener);
 }
@@ -52,6 +52,7 @@ palRecursiveMutexParam_t* recursiveMutexData = NULL;
 #define PAL_TEST_PERCENTAGE_TIMER_ERROR 10
 #define PAL_TEST_PERCENTAGE_HUNDRED  100
 #define PAL_TEST_TIME_SECOND 1000
+#define PAL_TEST_TIMER_COUNT 64
 
 #define PAL_DELAY_RUN_LOOPS 10
 
@@ -777,6 +778,54 @@ TEST(pal_rtos, TimerStartUnityTest)
     TEST_ASSERT_EQUAL(NULLPTR, timerID2);
 }
 
+/*! \brief Create many one-shot timers with different timeouts, stop half of them
+* and check that exactly the remaining ones fire.
+*
+* | # |    Step                                                                                          |   Expected                     |
+* |---|--------------------------------------------------------------------------------------------------|--------------------------------|
+* | 1 | Create `PAL_TEST_TIMER_COUNT` one-shot timers, which call `palTimerFunc8`, using `pal_osTimerCreate`. | PAL_SUCCESS               |
+* | 2 | Start the timers with increasing timeouts using `pal_osTimerStart`.                              | PAL_SUCCESS                    |
+* | 3 | Stop every second timer using `pal_osTimerStop`.                                                 | PAL_SUCCESS                    |
+* | 4 | Sleep for a period.                                                                              | PAL_SUCCESS                    |
+* | 5 | Check that only the timers left running have fired.                                             | PAL_SUCCESS                    |
+* | 6 | Delete the timers using `pal_osTimerDelete`.                                                     | PAL_SUCCESS                    |
+*/
+TEST(pal_rtos, ManyTimersUnityTest)
+{
+    palStatus_t status = PAL_SUCCESS;
+    palTimerID_t timerIDs[PAL_TEST_TIMER_COUNT] = { NULLPTR };
+    int i;
+
+    g_timerArgs.ticksInFunc1 = 0;
+
+    /*#1*/
+    for (i = 0; i < PAL_TEST_TIMER_COUNT; i++) {
+        status = pal_osTimerCreate(palTimerFunc8, NULL, palOsTimerOnce, &timerIDs[i]);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    }
+    /*#2*/
+    for (i = 0; i < PAL_TEST_TIMER_COUNT; i++) {
+        status = pal_osTimerStart(timerIDs[i], PAL_TIMER_TEST_TIME_TO_WAIT_MS_LONG + (i * 5));
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    }
+    /*#3*/
+    for (i = 0; i < PAL_TEST_TIMER_COUNT; i += 2) {
+        status = pal_osTimerStop(timerIDs[i]);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    }
+    /*#4*/
+    status = pal_osDelay(PAL_TEST_TIME_SECOND);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    /*#5*/
+    TEST_ASSERT_EQUAL_INT(PAL_TEST_TIMER_COUNT / 2, g_timerArgs.ticksInFunc1);
+    /*#6*/
+    for (i = 0; i < PAL_TEST_TIMER_COUNT; i++) {
+        status = pal_osTimerDelete(&timerIDs[i]);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+        TEST_ASSERT_EQUAL(NULLPTR, timerIDs[i]);
+    }
+}
+
 /*! \brief Test high-resolution timers
  *
 * | 1 | Create a periodic timer, which calls `palTimerFunc3` when triggered, using `pal_osTimerCreate`. | PAL_SUCCESS                    |
@@ -36,6 +36,7 @@ TEST_GROUP_RUNNER(pal_rtos)
     RUN_TEST_CASE(pal_rtos, OneShotTimerStopUnityTest);
     RUN_TEST_CASE(pal_rtos, PeriodicTimerStopUnityTest);
     RUN_TEST_CASE(pal_rtos, TimerStartUnityTest);
+    RUN_TEST_CASE(pal_rtos, ManyTimersUnityTest);
     RUN_TEST_CASE(pal_rtos, HighResTimerUnityTest);
     RUN_TEST_CASE(pal_rtos, TimerSleepUnityTest);
     RUN_TEST_CASE(pal_rtos, TimerNegativeUnityTest);
@@ -52,6 +52,7 @@
 #if (PAL_USE_SSL_SESSION_RESUME == 1)
 static bool isSslSessionAvailable();
 static void removeSslSession();
+static uint8_t getSslSessionRecordVersion();
 static const char* ssl_session_item_name = "sslsession";
 #endif
 
@@ -561,7 +562,7 @@ TEST(pal_tls, tlsHandshakeTCP)
         status = pal_handShake(palTLSHandle, palTLSConf);
         pal_osSemaphoreWait(s_semaphoreID, 1000, &temp);
     }
-    while ((PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status) &&
+    while ((PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status || PAL_ERR_TLS_HANDSHAKE_IN_PROGRESS == status) &&
             (timePassedInSec < PAL_SECONDS_PER_MIN)); //2 minutes to wait for handshake
 
     TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
@@ -713,7 +714,7 @@ TEST(pal_tls, tlsHandshakeUDP)
         status = pal_handShake(palTLSHandle, palTLSConf);
         pal_osSemaphoreWait(s_semaphoreID, 1000, &temp);
     }
-    while (PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status);
+    while (PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status || PAL_ERR_TLS_HANDSHAKE_IN_PROGRESS == status);
     TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
 
     /*#10*/
@@ -856,7 +857,7 @@ TEST(pal_tls, tlsHandshakeUDPTimeOut)
         status = pal_handShake(palTLSHandle, palTLSConf);
         pal_osSemaphoreWait(s_semaphoreID, 1000, &temp);
     }
-    while (PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status);
+    while (PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status || PAL_ERR_TLS_HANDSHAKE_IN_PROGRESS == status);
 
     curTimeInSec = pal_osGetTime();
     TEST_ASSERT_EQUAL_HEX(PAL_ERR_TIMEOUT_EXPIRED, status);
@@ -989,7 +990,7 @@ TEST(pal_tls, tlsHandshakeTCP_FutureLWM2M)
         status = pal_handShake(palTLSHandle, palTLSConf);
         pal_osSemaphoreWait(s_semaphoreID, 1000, &temp);
     }
-    while (PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status);
+    while (PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status || PAL_ERR_TLS_HANDSHAKE_IN_PROGRESS == status);
 
     if (PAL_SUCCESS != status)
     {
@@ -1184,7 +1185,7 @@ TEST(pal_tls, tlsHandshakeTCP_FutureLWM2M_NoTimeUpdate)
         status = pal_handShake(palTLSHandle, palTLSConf);
         pal_osSemaphoreWait(s_semaphoreID, 1000, &temp);
     }
-    while (PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status);
+    while (PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status || PAL_ERR_TLS_HANDSHAKE_IN_PROGRESS == status);
 
     TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
 
@@ -1374,7 +1375,7 @@ TEST(pal_tls, tlsHandshakeTCP_ExpiredLWM2MCert)
         status = pal_handShake(palTLSHandle, palTLSConf);
         pal_osSemaphoreWait(s_semaphoreID, 1000, &temp);
     }
-    while (PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status);
+    while (PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status || PAL_ERR_TLS_HANDSHAKE_IN_PROGRESS == status);
 
     if (PAL_ERR_X509_CERT_VERIFY_FAILED != status)
     {
@@ -1589,7 +1590,7 @@ TEST(pal_tls, tlsHandshakeTCP_ExpiredServerCert_Trusted)
         status = pal_handShake(palTLSHandle, palTLSConf);
         pal_osSemaphoreWait(s_semaphoreID, 1000, &temp);
     }
-    while (PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status);
+    while (PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status || PAL_ERR_TLS_HANDSHAKE_IN_PROGRESS == status);
 
     if (PAL_SUCCESS != status)
     {
@@ -1856,7 +1857,7 @@ TEST(pal_tls, tlsHandshakeTCP_FutureTrustedServer_NoTimeUpdate)
         status = pal_handShake(palTLSHandle, palTLSConf);
         pal_osSemaphoreWait(s_semaphoreID, 1000, &temp);
     }
-    while (PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status);
+    while (PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status || PAL_ERR_TLS_HANDSHAKE_IN_PROGRESS == status);
 
     if (PAL_SUCCESS != status)
     {
@@ -2118,7 +2119,7 @@ TEST(pal_tls, tlsHandshakeTCP_NearPastTrustedServer_NoTimeUpdate)
         status = pal_handShake(palTLSHandle, palTLSConf);
         pal_osSemaphoreWait(s_semaphoreID, 1000, &temp);
     }
-    while (PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status);
+    while (PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status || PAL_ERR_TLS_HANDSHAKE_IN_PROGRESS == status);
 
     if (PAL_SUCCESS != status)
     {
@@ -2300,10 +2301,16 @@ static void do_handshake(palTLSTransportMode_t mode, bool enable_session_storing
         status = pal_handShake(palTLSHandle, palTLSConf);
         pal_osSemaphoreWait(s_semaphoreID, 1000, &temp);
     }
-    while ((PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status));
+    while ((PAL_ERR_TLS_WANT_READ == status || PAL_ERR_TLS_WANT_WRITE == status || PAL_ERR_TLS_HANDSHAKE_IN_PROGRESS == status));
 
     TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
 
+    palTLSHandshakeTimes_t handshakeTimes;
+    status = pal_sslGetHandshakeTimes(palTLSHandle, &handshakeTimes);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    PAL_LOG_INFO("handshake phases: hello %" PRIu32 " ms, certificate %" PRIu32 " ms, key exchange %" PRIu32 " ms, finished %" PRIu32 " ms",
+                 handshakeTimes.hello, handshakeTimes.certificate, handshakeTimes.keyExchange, handshakeTimes.finished);
+
     status = pal_freeTLS(&palTLSHandle);
     TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
 
@@ -2410,7 +2417,7 @@ static palStatus_t ThreadHandshakeTCP()
         }
         status = pal_handShake(palTLSHandle, palTLSConf);
     }
-    while ( (PAL_ERR_TLS_WANT_READ == status) || (PAL_ERR_TLS_WANT_WRITE == status));
+    while ( (PAL_ERR_TLS_WANT_READ == status) || (PAL_ERR_TLS_WANT_WRITE == status) || (PAL_ERR_TLS_HANDSHAKE_IN_PROGRESS == status));
 
     PAL_TLS_INT32_CHECK_NOT_EQUAL_GOTO_FINISH(PAL_SUCCESS, status);
 
@@ -2675,6 +2682,7 @@ TEST(pal_tls, tlsHandshake_SessionResume)
     // Handshake again, session should be now stored into file system.
     do_handshake(PAL_DTLS_MODE, true);
     TEST_ASSERT(isSslSessionAvailable());
+    TEST_ASSERT_EQUAL_UINT8(1, getSslSessionRecordVersion());
 
     // This time handshake will use the saved session.
     // Currently can be verified only through mbedtls logs.
@@ -2692,6 +2700,13 @@ TEST(pal_tls, tlsHandshake_SessionResume)
     do_handshake(PAL_TLS_MODE, true);
     TEST_ASSERT(isSslSessionAvailable());
 
+    // Session removed outside of PAL (e.g. factory reset) must not be resumed from
+    // the RAM copy PAL keeps, and the next handshake must store a session again.
+    removeSslSession();
+    TEST_ASSERT(!isSslSessionAvailable());
+    do_handshake(PAL_TLS_MODE, true);
+    TEST_ASSERT(isSslSessionAvailable());
+
 #else
     TEST_IGNORE_MESSAGE("Ignored, PAL_USE_SSL_SESSION_RESUME not set");
 #endif // PAL_USE_SSL_SESSION_RESUME
@@ -2758,5 +2773,41 @@ static void removeSslSession()
                         KCM_CONFIG_ITEM);
     }
 }
+
+static uint8_t getSslSessionRecordVersion()
+{
+    uint8_t version = 0;
+    size_t act_size = 0;
+    kcm_status_e kcm_status = kcm_init();
+    if (kcm_status != KCM_STATUS_SUCCESS)
+    {
+        return 0;
+    }
+
+    kcm_status = kcm_item_get_data_size((uint8_t *)ssl_session_item_name,
+                                        strlen(ssl_session_item_name),
+                                        KCM_CONFIG_ITEM, &act_size);
+    if ((kcm_status != KCM_STATUS_SUCCESS) || (act_size == 0))
+    {
+        return 0;
+    }
+
+    uint8_t *data = (uint8_t*)malloc(act_size);
+    if (!data)
+    {
+        return 0;
+    }
+
+    size_t data_out = 0;
+    kcm_status = kcm_item_get_data((uint8_t *)ssl_session_item_name,
+                                   strlen(ssl_session_item_name),
+                                   KCM_CONFIG_ITEM, data, act_size, &data_out);
+    if (kcm_status == KCM_STATUS_SUCCESS)
+    {
+        version = data[0];
+    }
+    free(data);
+    return version;
+}
 #endif //PAL_USE_SSL_SESSION_RESUME
 
@@ -53,6 +53,14 @@ int mbed_cloud_application_entrypoint(void)
     status = palSanityTestMain();
 #elif defined(PAL_UNIT_TEST_REFORMAT)
     status = palReformatTestMain();
+#elif defined(PAL_UNIT_TEST_MBED_CLIENT)
+    status = mbedClientTestMain();
+#elif defined(PAL_UNIT_TEST_UPDATE_CLIENT_HTTP)
+    status = updateClientHttpTestMain();
+#elif defined(PAL_UNIT_TEST_UPDATE_CLIENT_LWM2M)
+    status = updateClientLwm2mTestMain();
+#elif defined(PAL_UNIT_TEST_UPDATE_CLIENT_DELTA)
+    status = updateClientDeltaTestMain();
 #else 
     // No need for defined(PAL_UNIT_TEST_ALL), this is likely the most needed one
     status = palAllTestMain(); // this will execute tests for all the other modules above
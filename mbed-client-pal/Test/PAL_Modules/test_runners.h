@@ -191,6 +191,25 @@ int palSOTPTestMain(void);
 int palSanityTestMain(void);
 int palReformatTestMain(void);
 
+// Entry point for the mbed-client object model tests (mbed-client/Test/M2M), which
+// are built into their own runner as they need the mbedclient library.
+int mbedClientTestMain(void);
+
+// Entry point for the update client's HTTP socket source tests (update-client-hub/Test/HTTP),
+// which are built with the source's pipelining or streaming options set.
+int updateClientHttpTestMain(void);
+
+// Entry point for the update client's LwM2M source tests (update-client-hub/Test/LWM2M),
+// which are built with a CoAP block window and link the mbedclient library.
+int updateClientLwm2mTestMain(void);
+
+// Entry point for the update client's delta patch pipeline tests (update-client-hub/Test/Delta),
+// which are built with the pipeline enabled.
+int updateClientDeltaTestMain(void);
+
+// Common runner used by the entry points above, defined in test_main.c.
+int palTestMain(void (*runAllTests)(void), int init_flags);
+
 typedef enum _palTestSOTPTests_t
 {
     PAL_TEST_SOTP_TEST_START,
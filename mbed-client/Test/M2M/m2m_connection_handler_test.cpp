@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2019 ARM Limited. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Note: this macro is needed on armcc to get the the PRI*32 macros
+// from inttypes.h in a C++ code.
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+extern "C" {
+#include "unity.h"
+#include "unity_fixture.h"
+}
+
+#include "mbed-client/m2mconnectionhandler.h"
+#include "mbed-client/m2mconnectionobserver.h"
+#include "mbed-client/m2mconnectionsecurity.h"
+#include "mbed-client/m2msecurity.h"
+#include "ns_hal_init.h"
+#include "eventOS_scheduler.h"
+#include "pal.h"
+#include "test_runners.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// More messages than PAL_NET_MAX_SEND_BUFFERS, so UDP drains in several batches
+#define M2M_TEST_SEND_QUEUE_MESSAGES    40
+#define M2M_TEST_SEND_QUEUE_PORT        21600
+#define M2M_TEST_SEND_QUEUE_TIMEOUT_MS  5000
+#define M2M_TEST_EVENT_LOOP_SIZE        40000
+
+class TestConnectionObserver : public M2MConnectionObserver {
+public:
+    TestConnectionObserver() : ready(false), sent(0), errors(0) {}
+    void data_available(uint8_t *, uint16_t, const M2MConnectionObserver::SocketAddress &) {}
+    void socket_error(int, bool) { errors++; }
+    void address_ready(const M2MConnectionObserver::SocketAddress &, M2MConnectionObserver::ServerType, const uint16_t) { ready = true; }
+    void data_sent() { sent++; }
+    void network_interface_status_change(NetworkInterfaceStatus) {}
+
+    volatile bool ready;
+    volatile int sent;
+    volatile int errors;
+};
+
+static TestConnectionObserver *observer = NULL;
+static M2MConnectionHandler *handler = NULL;
+static palSocket_t server_socket = 0;
+static palSocket_t accepted_socket = 0;
+
+static void m2m_test_socket_callback(void *)
+{
+    // the test sockets are blocking
+}
+
+// Wait for the event loop thread to set a flag or count
+static bool m2m_test_wait(volatile bool *flag, volatile int *count, int expected)
+{
+    for (int waited = 0; waited < M2M_TEST_SEND_QUEUE_TIMEOUT_MS; waited += 10) {
+        if ((flag && *flag) || (count && *count >= expected)) {
+            return true;
+        }
+        pal_osDelay(10);
+    }
+    return false;
+}
+
+// Message index in the first two bytes, then a pattern of index dependent length
+static uint16_t m2m_test_fill_message(uint8_t *message, int index)
+{
+    uint16_t length = (uint16_t)(8 + (index * 7) % 60);
+    message[0] = (uint8_t)(index >> 8);
+    message[1] = (uint8_t)index;
+    for (uint16_t pos = 2; pos < length; pos++) {
+        message[pos] = (uint8_t)(index + pos);
+    }
+    return length;
+}
+
+static void m2m_test_connect(M2MInterface::BindingMode mode)
+{
+    observer = new TestConnectionObserver();
+    handler = new M2MConnectionHandler(*observer,
+                                       new M2MConnectionSecurity(M2MConnectionSecurity::NO_SECURITY),
+                                       mode,
+                                       M2MInterface::LwIP_IPv4);
+    TEST_ASSERT_TRUE(handler->resolve_server_address("127.0.0.1", M2M_TEST_SEND_QUEUE_PORT,
+                                                     M2MConnectionObserver::LWM2MServer,
+                                                     M2MSecurity::get_instance()));
+    TEST_ASSERT_TRUE(m2m_test_wait(&observer->ready, NULL, 0));
+}
+
+// Queue every message while the event loop is held, half copied and half taken
+static void m2m_test_queue_messages(void)
+{
+    uint8_t message[80];
+    sn_nsdl_addr_s address;
+    memset(&address, 0, sizeof(address));
+
+    eventOS_scheduler_mutex_wait();
+    for (int index = 0; index < M2M_TEST_SEND_QUEUE_MESSAGES; index++) {
+        uint16_t length = m2m_test_fill_message(message, index);
+        if (index % 2) {
+            uint8_t *taken = (uint8_t*)malloc(length);
+            TEST_ASSERT_NOT_NULL(taken);
+            memcpy(taken, message, length);
+            TEST_ASSERT_TRUE(handler->send_data_take(taken, length, &address));
+        } else {
+            TEST_ASSERT_TRUE(handler->send_data(message, length, &address));
+        }
+    }
+    eventOS_scheduler_mutex_release();
+}
+
+TEST_GROUP(m2m_connection_handler);
+
+TEST_SETUP(m2m_connection_handler)
+{
+    palStatus_t status = pal_init();
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    ns_hal_init(NULL, M2M_TEST_EVENT_LOOP_SIZE, NULL, NULL);
+}
+
+TEST_TEAR_DOWN(m2m_connection_handler)
+{
+    if (handler) {
+        // Close while the event loop is held, then let it run the events left for the socket
+        eventOS_scheduler_mutex_wait();
+        handler->stop_listening();
+        handler->force_close();
+        eventOS_scheduler_mutex_release();
+        pal_osDelay(100);
+    }
+    delete handler;
+    handler = NULL;
+    delete observer;
+    observer = NULL;
+    M2MSecurity::delete_instance();
+    if (accepted_socket) {
+        pal_close(&accepted_socket);
+    }
+    if (server_socket) {
+        pal_close(&server_socket);
+    }
+    pal_destroy();
+}
+
+/**
+ * Queued UDP messages arrive whole and in order, copied or taken, and each
+ * one is reported sent.
+ */
+TEST(m2m_connection_handler, udpSendQueue)
+{
+    palSocketAddress_t address = { 0 };
+    palSocketAddress_t from = { 0 };
+    palSocketLength_t from_length = 0;
+    palIpV4Addr_t loopback = { 127, 0, 0, 1 };
+    uint8_t expected[80];
+    uint8_t buffer[80];
+    int timeout = M2M_TEST_SEND_QUEUE_TIMEOUT_MS;
+    size_t read = 0;
+
+    palStatus_t status = pal_asynchronousSocket(PAL_AF_INET, PAL_SOCK_DGRAM, false, 0, m2m_test_socket_callback, &server_socket);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    status = pal_setSocketOptions(server_socket, PAL_SO_RCVTIMEO, &timeout, sizeof(timeout));
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    pal_setSockAddrIPV4Addr(&address, loopback);
+    pal_setSockAddrPort(&address, M2M_TEST_SEND_QUEUE_PORT);
+    status = pal_bind(server_socket, &address, sizeof(address));
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    m2m_test_connect(M2MInterface::UDP);
+    m2m_test_queue_messages();
+
+    for (int index = 0; index < M2M_TEST_SEND_QUEUE_MESSAGES; index++) {
+        uint16_t length = m2m_test_fill_message(expected, index);
+        from_length = sizeof(from);
+        status = pal_receiveFrom(server_socket, buffer, sizeof(buffer), &from, &from_length, &read);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+        TEST_ASSERT_EQUAL(length, read);
+        TEST_ASSERT_EQUAL_MEMORY(expected, buffer, length);
+    }
+
+    TEST_ASSERT_TRUE(m2m_test_wait(NULL, &observer->sent, M2M_TEST_SEND_QUEUE_MESSAGES));
+    TEST_ASSERT_EQUAL(M2M_TEST_SEND_QUEUE_MESSAGES, observer->sent);
+    TEST_ASSERT_EQUAL(0, observer->errors);
+}
+
+/**
+ * Queued non-secure TCP messages arrive as length prefixed frames in order,
+ * copied or taken, and each one is reported sent.
+ */
+TEST(m2m_connection_handler, tcpSendQueue)
+{
+#if PAL_NET_TCP_AND_TLS_SUPPORT && PAL_NET_SERVER_SOCKET_API
+    palSocketAddress_t address = { 0 };
+    palSocketAddress_t accepted_address = { 0 };
+    palSocketLength_t accepted_length = sizeof(accepted_address);
+    palIpV4Addr_t loopback = { 127, 0, 0, 1 };
+    uint8_t expected[80];
+    uint8_t buffer[4 + 80];
+    int timeout = M2M_TEST_SEND_QUEUE_TIMEOUT_MS;
+    size_t read = 0;
+
+    palStatus_t status = pal_asynchronousSocket(PAL_AF_INET, PAL_SOCK_STREAM_SERVER, false, 0, m2m_test_socket_callback, &server_socket);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    status = pal_setSocketOptions(server_socket, PAL_SO_REUSEADDR, &timeout, sizeof(timeout));
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    pal_setSockAddrIPV4Addr(&address, loopback);
+    pal_setSockAddrPort(&address, M2M_TEST_SEND_QUEUE_PORT);
+    status = pal_bind(server_socket, &address, sizeof(address));
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    status = pal_listen(server_socket, 1);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    m2m_test_connect(M2MInterface::TCP);
+    status = pal_accept(server_socket, &accepted_address, &accepted_length, &accepted_socket, m2m_test_socket_callback, NULL);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    status = pal_setSocketOptions(accepted_socket, PAL_SO_RCVTIMEO, &timeout, sizeof(timeout));
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    m2m_test_queue_messages();
+
+    for (int index = 0; index < M2M_TEST_SEND_QUEUE_MESSAGES; index++) {
+        uint16_t length = m2m_test_fill_message(expected, index);
+        size_t received = 0;
+        while (received < 4u + length) {
+            status = pal_recv(accepted_socket, buffer + received, 4 + length - received, &read);
+            TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+            TEST_ASSERT_NOT_EQUAL(0, read);
+            received += read;
+        }
+        TEST_ASSERT_EQUAL(0, buffer[0]);
+        TEST_ASSERT_EQUAL(0, buffer[1]);
+        TEST_ASSERT_EQUAL(length, (buffer[2] << 8) | buffer[3]);
+        TEST_ASSERT_EQUAL_MEMORY(expected, buffer + 4, length);
+    }
+
+    TEST_ASSERT_TRUE(m2m_test_wait(NULL, &observer->sent, M2M_TEST_SEND_QUEUE_MESSAGES));
+    TEST_ASSERT_EQUAL(M2M_TEST_SEND_QUEUE_MESSAGES, observer->sent);
+    TEST_ASSERT_EQUAL(0, observer->errors);
+#else
+    TEST_IGNORE_MESSAGE("Ignored, TCP server sockets are not supported");
+#endif
+}
@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2019 ARM Limited. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Note: this macro is needed on armcc to get the the PRI*32 macros
+// from inttypes.h in a C++ code.
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+extern "C" {
+#include "unity.h"
+#include "unity_fixture.h"
+}
+
+#include "mbed-client/m2minterfacefactory.h"
+#include "mbed-client/m2mobject.h"
+#include "mbed-client/m2mobjectinstance.h"
+#include "mbed-client/m2mresource.h"
+#include "mbed-client/m2mconnectionhandler.h"
+#include "include/m2mnsdlinterface.h"
+#include "include/m2mnsdlobserver.h"
+#include "include/m2mtlvdeserializer.h"
+#include "test_runners.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Largest registration size measured by the lookup benchmark
+#ifndef M2M_TEST_LOOKUP_BENCHMARK_MAX_RESOURCES
+#ifdef __LINUX__
+#define M2M_TEST_LOOKUP_BENCHMARK_MAX_RESOURCES 100000
+#else
+#define M2M_TEST_LOOKUP_BENCHMARK_MAX_RESOURCES 100
+#endif
+#endif
+
+#define M2M_TEST_LOOKUP_BENCHMARK_RESOURCES_PER_OBJECT  100
+#define M2M_TEST_LOOKUP_BENCHMARK_INDEX_LOOKUPS         10000
+#define M2M_TEST_LOOKUP_BENCHMARK_WALK_LOOKUPS          100
+
+class TestNsdlObserver : public M2MNsdlObserver, public M2MConnectionObserver {
+public:
+    void coap_message_ready(uint8_t *, uint16_t, sn_nsdl_addr_s *) {}
+    void coap_message_take(uint8_t *data_ptr, uint16_t, sn_nsdl_addr_s *) { free(data_ptr); }
+    void client_registered(M2MServer *) {}
+    void registration_updated(const M2MServer &) {}
+    void registration_error(uint8_t, bool, bool) {}
+    void client_unregistered() {}
+#ifndef MBED_CLIENT_DISABLE_BOOTSTRAP_FEATURE
+    void bootstrap_done() {}
+    void bootstrap_finish() {}
+    void bootstrap_wait() {}
+    void bootstrap_error_wait(const char *) {}
+    void bootstrap_error(const char *) {}
+#endif
+    void coap_data_processed() {}
+    void value_updated(M2MBase *) {}
+    void data_available(uint8_t *, uint16_t, const M2MConnectionObserver::SocketAddress &) {}
+    void socket_error(int, bool) {}
+    void address_ready(const M2MConnectionObserver::SocketAddress &, M2MConnectionObserver::ServerType, const uint16_t) {}
+    void data_sent() {}
+    void network_interface_status_change(NetworkInterfaceStatus) {}
+};
+
+// Accesses the protected and private parts of M2MNsdlInterface
+class Test_M2MNsdlInterface {
+public:
+    static void value_updated(M2MNsdlInterface &nsdl, M2MBase *base) { nsdl.value_updated(base); }
+    static M2MBase* find_resource(const M2MNsdlInterface &nsdl, const char *path) { return nsdl.find_resource(path); }
+    static void force_tree_walk(M2MNsdlInterface &nsdl) { nsdl._path_index.clear(); nsdl._path_index_partial = true; }
+    // Adds the object to the lookup structures only. Registering it to sn_nsdl as well would make the
+    // setup quadratic in the resource count when SN_GRS_RESOURCE_HASH_SIZE is 0.
+    static void index_object(M2MNsdlInterface &nsdl, M2MObject *object)
+    {
+        nsdl._base_list.push_back(object);
+        TEST_ASSERT_TRUE(nsdl._path_index.insert(object));
+        const M2MObjectInstanceList &instances = object->instances();
+        for (M2MObjectInstanceList::const_iterator i = instances.begin(); i != instances.end(); i++) {
+            TEST_ASSERT_TRUE(nsdl._path_index.insert(*i));
+            const M2MResourceList &resources = (*i)->resources();
+            for (M2MResourceList::const_iterator r = resources.begin(); r != resources.end(); r++) {
+                TEST_ASSERT_TRUE(nsdl._path_index.insert(*r));
+            }
+        }
+    }
+};
+
+static TestNsdlObserver *observer = NULL;
+static M2MConnectionHandler *connection_handler = NULL;
+static M2MNsdlInterface *nsdl = NULL;
+static M2MObject *object = NULL;
+static M2MObjectInstance *object_instance = NULL;
+static M2MResource *resource = NULL;
+
+TEST_GROUP(m2m_nsdl_interface);
+
+TEST_SETUP(m2m_nsdl_interface)
+{
+    observer = new TestNsdlObserver();
+    connection_handler = new M2MConnectionHandler(*observer, NULL, M2MInterface::UDP, M2MInterface::LwIP_IPv4);
+    nsdl = new M2MNsdlInterface(*observer, *connection_handler);
+
+    object = M2MInterfaceFactory::create_object("3303");
+    TEST_ASSERT_NOT_NULL(object);
+    object_instance = object->create_object_instance();
+    TEST_ASSERT_NOT_NULL(object_instance);
+    resource = object_instance->create_dynamic_resource("5700", "", M2MResourceInstance::INTEGER, true, true);
+    TEST_ASSERT_NOT_NULL(resource);
+    TEST_ASSERT_NOT_NULL(object_instance->create_dynamic_resource_instance("5700", "",
+                                                                          M2MResourceInstance::INTEGER,
+                                                                          true, 0));
+
+    M2MBaseList list;
+    list.push_back(object);
+    TEST_ASSERT_TRUE(nsdl->create_nsdl_list_structure(list));
+}
+
+TEST_TEAR_DOWN(m2m_nsdl_interface)
+{
+    delete object;
+    delete nsdl;
+    delete connection_handler;
+    delete observer;
+    object = NULL;
+    object_instance = NULL;
+    resource = NULL;
+    nsdl = NULL;
+    connection_handler = NULL;
+    observer = NULL;
+}
+
+/*! \brief Check that a resource instance created after registration, like M2MDevice does, can be found.
+*/
+TEST(m2m_nsdl_interface, findCreatedResourceInstance)
+{
+    M2MResourceInstance *instance = object_instance->create_dynamic_resource_instance("5700", "",
+                                                                                     M2MResourceInstance::INTEGER,
+                                                                                     true, 3);
+    TEST_ASSERT_NOT_NULL(instance);
+    Test_M2MNsdlInterface::value_updated(*nsdl, instance);
+
+    TEST_ASSERT_EQUAL_PTR(instance, Test_M2MNsdlInterface::find_resource(*nsdl, "3303/0/5700/3"));
+}
+
+/*! \brief Check that a resource instance created from a TLV POST can be found.
+*/
+TEST(m2m_nsdl_interface, findTlvCreatedResourceInstance)
+{
+    // Multiple resource 5700 holding resource instance 1 with value 7
+    const uint8_t tlv[] = { 0xA3, 0x16, 0x44, 0x41, 0x01, 0x07 };
+    TEST_ASSERT_EQUAL_INT(M2MTLVDeserializer::None,
+                          M2MTLVDeserializer::deserialize_resources(tlv, sizeof(tlv), *object_instance,
+                                                                    M2MTLVDeserializer::Post));
+    M2MResourceInstance *instance = resource->resource_instance(1);
+    TEST_ASSERT_NOT_NULL(instance);
+    Test_M2MNsdlInterface::value_updated(*nsdl, object_instance);
+
+    TEST_ASSERT_EQUAL_PTR(instance, Test_M2MNsdlInterface::find_resource(*nsdl, "3303/0/5700/1"));
+}
+
+/*! \brief Check that objects not published to the server get no observation handler but can still be found.
+*/
+TEST(m2m_nsdl_interface, findNotPublishedObject)
+{
+    M2MObject *hidden = M2MInterfaceFactory::create_object("3304");
+    TEST_ASSERT_NOT_NULL(hidden);
+    hidden->set_operation(M2MBase::NOT_ALLOWED);
+    M2MObjectInstance *hidden_instance = hidden->create_object_instance();
+    TEST_ASSERT_NOT_NULL(hidden_instance);
+    hidden_instance->set_operation(M2MBase::NOT_ALLOWED);
+
+    M2MBaseList list;
+    list.push_back(hidden);
+    TEST_ASSERT_TRUE(nsdl->create_nsdl_list_structure(list));
+
+    TEST_ASSERT_NULL(hidden->observation_handler());
+    TEST_ASSERT_NULL(hidden_instance->observation_handler());
+    TEST_ASSERT_EQUAL_PTR(hidden, Test_M2MNsdlInterface::find_resource(*nsdl, "3304"));
+    TEST_ASSERT_EQUAL_PTR(hidden_instance, Test_M2MNsdlInterface::find_resource(*nsdl, "3304/0"));
+    TEST_ASSERT_EQUAL_PTR(resource, Test_M2MNsdlInterface::find_resource(*nsdl, "3303/0/5700"));
+
+    // Its deletion is not reported to the interface, so it must not be left in the index
+    TEST_ASSERT_TRUE(hidden->remove_object_instance(0));
+    TEST_ASSERT_NULL(Test_M2MNsdlInterface::find_resource(*nsdl, "3304/0"));
+
+    nsdl->remove_object_from_list(hidden);
+    delete hidden;
+}
+
+// Returns the average time of one find_resource() call in nanoseconds
+static uint64_t lookup_time_ns(char (*paths)[20], M2MBase **expected, uint32_t path_count, uint32_t lookups)
+{
+    uint64_t start = pal_osKernelSysTick();
+    for (uint32_t i = 0; i < lookups; i++) {
+        // step through the paths with a stride so that consecutive lookups hit different objects
+        uint32_t n = (uint32_t)(((uint64_t)i * 7919) % path_count);
+        TEST_ASSERT_EQUAL_PTR(expected[n], Test_M2MNsdlInterface::find_resource(*nsdl, paths[n]));
+    }
+    uint64_t ticks = pal_osKernelSysTick() - start;
+    return (ticks * 1000000000ULL) / pal_osKernelSysTickFrequency() / lookups;
+}
+
+static void measure_lookups(uint32_t resource_count)
+{
+    const uint32_t per_object = M2M_TEST_LOOKUP_BENCHMARK_RESOURCES_PER_OBJECT;
+    const uint32_t object_count = (resource_count + per_object - 1) / per_object;
+    M2MObject **objects = new M2MObject*[object_count];
+    char (*paths)[20] = new char[resource_count][20];
+    M2MBase **expected = new M2MBase*[resource_count];
+    char name[8];
+
+    for (uint32_t o = 0; o < object_count; o++) {
+        snprintf(name, sizeof(name), "%" PRIu32, 10000 + o);
+        objects[o] = M2MInterfaceFactory::create_object(name);
+        TEST_ASSERT_NOT_NULL(objects[o]);
+        M2MObjectInstance *inst = objects[o]->create_object_instance();
+        TEST_ASSERT_NOT_NULL(inst);
+        for (uint32_t r = 0; r < per_object && o * per_object + r < resource_count; r++) {
+            uint32_t n = o * per_object + r;
+            snprintf(name, sizeof(name), "%" PRIu32, r);
+            expected[n] = inst->create_dynamic_resource(name, "", M2MResourceInstance::INTEGER, true);
+            TEST_ASSERT_NOT_NULL(expected[n]);
+            snprintf(paths[n], sizeof(paths[n]), "%" PRIu32 "/0/%" PRIu32, 10000 + o, r);
+        }
+        Test_M2MNsdlInterface::index_object(*nsdl, objects[o]);
+    }
+
+    uint64_t index_ns = lookup_time_ns(paths, expected, resource_count, M2M_TEST_LOOKUP_BENCHMARK_INDEX_LOOKUPS);
+    Test_M2MNsdlInterface::force_tree_walk(*nsdl);
+    uint64_t walk_ns = lookup_time_ns(paths, expected, resource_count, M2M_TEST_LOOKUP_BENCHMARK_WALK_LOOKUPS);
+
+    TEST_PRINTF("find_resource() with %" PRIu32 " resources: index %" PRIu32 " ns, tree walk %" PRIu32 " ns per lookup\r\n",
+                resource_count, (uint32_t)index_ns, (uint32_t)walk_ns);
+
+    for (uint32_t o = 0; o < object_count; o++) {
+        nsdl->remove_object_from_list(objects[o]);
+        delete objects[o];
+    }
+    delete[] expected;
+    delete[] paths;
+    delete[] objects;
+}
+
+/*! \brief Measure find_resource() through the path index against the tree walk it replaced,
+ * with 100, 10k and 100k registered resources.
+*/
+TEST(m2m_nsdl_interface, lookupBenchmark)
+{
+    const uint32_t counts[] = { 100, 10000, 100000 };
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        if (counts[i] <= M2M_TEST_LOOKUP_BENCHMARK_MAX_RESOURCES) {
+            measure_lookups(counts[i]);
+        }
+    }
+}
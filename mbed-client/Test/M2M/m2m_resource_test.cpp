@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2019 ARM Limited. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+extern "C" {
+#include "unity.h"
+#include "unity_fixture.h"
+}
+
+#include "mbed-client/m2minterfacefactory.h"
+#include "mbed-client/m2mobject.h"
+#include "mbed-client/m2mobjectinstance.h"
+#include "mbed-client/m2mresource.h"
+#include "include/m2mtlvdeserializer.h"
+
+static M2MObject *object = NULL;
+static M2MObjectInstance *object_instance = NULL;
+
+TEST_GROUP(m2m_resource);
+
+TEST_SETUP(m2m_resource)
+{
+    object = M2MInterfaceFactory::create_object("3303");
+    TEST_ASSERT_NOT_NULL(object);
+    object_instance = object->create_object_instance();
+    TEST_ASSERT_NOT_NULL(object_instance);
+}
+
+TEST_TEAR_DOWN(m2m_resource)
+{
+    delete object;
+    object = NULL;
+    object_instance = NULL;
+}
+
+/*! \brief Check that set_value(int64_t) on a natively stored FLOAT resource keeps the value.
+*/
+TEST(m2m_resource, nativeFloatSetInteger)
+{
+    M2MResource *res = object_instance->create_dynamic_resource("5700", "Temperature",
+                                                                M2MResourceInstance::FLOAT, true);
+    TEST_ASSERT_NOT_NULL(res);
+    TEST_ASSERT_TRUE(res->set_native_value_storage(true));
+
+    TEST_ASSERT_TRUE(res->set_value(5));
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, res->get_value_float());
+    TEST_ASSERT_EQUAL_INT32(5, (int32_t)res->get_value_int());
+
+    TEST_ASSERT_TRUE(res->set_value(-42));
+    TEST_ASSERT_EQUAL_FLOAT(-42.0f, res->get_value_float());
+}
+
+/*! \brief Check that set_value_float() on natively stored INTEGER, BOOLEAN and TIME resources keeps the value.
+*/
+TEST(m2m_resource, nativeIntegerSetFloat)
+{
+    M2MResource *integer = object_instance->create_dynamic_resource("5601", "Min", M2MResourceInstance::INTEGER, true);
+    M2MResource *boolean = object_instance->create_dynamic_resource("5850", "OnOff", M2MResourceInstance::BOOLEAN, true);
+    M2MResource *time = object_instance->create_dynamic_resource("5518", "Timestamp", M2MResourceInstance::TIME, true);
+    TEST_ASSERT_NOT_NULL(integer);
+    TEST_ASSERT_NOT_NULL(boolean);
+    TEST_ASSERT_NOT_NULL(time);
+    TEST_ASSERT_TRUE(integer->set_native_value_storage(true));
+    TEST_ASSERT_TRUE(boolean->set_native_value_storage(true));
+    TEST_ASSERT_TRUE(time->set_native_value_storage(true));
+
+    TEST_ASSERT_TRUE(integer->set_value_float(2.5f));
+    TEST_ASSERT_EQUAL_INT32(2, (int32_t)integer->get_value_int());
+    TEST_ASSERT_TRUE(integer->set_value_float(-7.0f));
+    TEST_ASSERT_EQUAL_INT32(-7, (int32_t)integer->get_value_int());
+
+    TEST_ASSERT_TRUE(boolean->set_value_float(1.0f));
+    TEST_ASSERT_EQUAL_INT32(1, (int32_t)boolean->get_value_int());
+
+    TEST_ASSERT_TRUE(time->set_value_float(1554000000.0f));
+    TEST_ASSERT_EQUAL_INT32((int32_t)1554000000.0f, (int32_t)time->get_value_int());
+}
+
+/*! \brief Check that TLV float values are read only when they are 4 or 8 bytes long.
+*/
+TEST(m2m_resource, tlvFloatLength)
+{
+    M2MResource *res = object_instance->create_dynamic_resource("5700", "Temperature",
+                                                                M2MResourceInstance::FLOAT, true);
+    TEST_ASSERT_NOT_NULL(res);
+    res->set_operation(M2MBase::GET_PUT_ALLOWED);
+
+    const uint8_t float32[] = {0xE4, 0x16, 0x44, 0x41, 0x20, 0x00, 0x00};
+    TEST_ASSERT_EQUAL_INT(M2MTLVDeserializer::None,
+                          M2MTLVDeserializer::deserialize_resources(float32, sizeof(float32),
+                                                                    *object_instance, M2MTLVDeserializer::Put));
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, res->get_value_float());
+
+    const uint8_t float64[] = {0xE8, 0x16, 0x44, 0x08, 0x40, 0x34, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    TEST_ASSERT_EQUAL_INT(M2MTLVDeserializer::None,
+                          M2MTLVDeserializer::deserialize_resources(float64, sizeof(float64),
+                                                                    *object_instance, M2MTLVDeserializer::Put));
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, res->get_value_float());
+
+    // Only the 2 value bytes are in the buffer, reading 4 would run past it
+    const uint8_t truncated[] = {0xE2, 0x16, 0x44, 0x41, 0x20};
+    TEST_ASSERT_EQUAL_INT(M2MTLVDeserializer::NotValid,
+                          M2MTLVDeserializer::deserialize_resources(truncated, sizeof(truncated),
+                                                                    *object_instance, M2MTLVDeserializer::Put));
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, res->get_value_float());
+}
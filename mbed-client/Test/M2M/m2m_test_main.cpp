@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2019 ARM Limited. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "test_runners.h"
+
+extern "C" {
+#include "unity.h"
+#include "unity_fixture.h"
+}
+
+// The group runners are defined with C++ linkage in the *_test_runner.cpp files,
+// so they are collected here instead of in the PAL's test_main.c.
+static void TEST_m2m_all_GROUPS_RUNNER(void)
+{
+    RUN_TEST_GROUP(m2m_resource);
+    RUN_TEST_GROUP(m2m_nsdl_interface);
+    RUN_TEST_GROUP(m2m_tlv_serializer);
+    RUN_TEST_GROUP(m2m_connection_handler);
+}
+
+int mbedClientTestMain(void)
+{
+    // The tests only use the client's object model and loopback sockets, so no connection or storage is needed.
+    int init_flags = PAL_TEST_PLATFORM_INIT_BASE;
+    return palTestMain(TEST_m2m_all_GROUPS_RUNNER, init_flags);
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2019 ARM Limited. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Note: this macro is needed on armcc to get the the PRI*32 macros
+// from inttypes.h in a C++ code.
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+extern "C" {
+#include "unity.h"
+#include "unity_fixture.h"
+}
+
+#include "mbed-client/m2minterfacefactory.h"
+#include "mbed-client/m2mobject.h"
+#include "mbed-client/m2mobjectinstance.h"
+#include "mbed-client/m2mresource.h"
+#include "include/m2mtlvserializer.h"
+#include "include/m2mtlvdeserializer.h"
+#include "test_runners.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define M2M_TEST_SERIALIZER_BENCHMARK_ROUNDS    20
+
+static M2MObject *object = NULL;
+static M2MObjectInstance *object_instance = NULL;
+
+TEST_GROUP(m2m_tlv_serializer);
+
+TEST_SETUP(m2m_tlv_serializer)
+{
+    object = M2MInterfaceFactory::create_object("10");
+    TEST_ASSERT_NOT_NULL(object);
+    object_instance = object->create_object_instance();
+    TEST_ASSERT_NOT_NULL(object_instance);
+}
+
+TEST_TEAR_DOWN(m2m_tlv_serializer)
+{
+    delete object;
+    object = NULL;
+    object_instance = NULL;
+}
+
+// Adds count resources to the instance, every fourth one a string and every
+// tenth one a multiple resource with two integer instances. The values are
+// derived from the resource id, or left empty if set_values is false.
+static void create_mixed_resources(M2MObjectInstance &instance, uint16_t count, bool set_values = true)
+{
+    char name[8];
+    for (uint16_t i = 0; i < count; i++) {
+        snprintf(name, sizeof(name), "%u", i);
+        if (i % 10 == 9) {
+            for (uint16_t j = 0; j < 2; j++) {
+                M2MResourceInstance *res = instance.create_dynamic_resource_instance(name, "",
+                                                                                    M2MResourceInstance::INTEGER,
+                                                                                    true, j);
+                TEST_ASSERT_NOT_NULL(res);
+                res->set_operation(M2MBase::GET_PUT_ALLOWED);
+                TEST_ASSERT_TRUE(!set_values || res->set_value((int64_t)i * 1000 + j));
+            }
+        } else if (i % 4 == 3) {
+            M2MResource *res = instance.create_dynamic_resource(name, "", M2MResourceInstance::STRING, true);
+            TEST_ASSERT_NOT_NULL(res);
+            res->set_operation(M2MBase::GET_PUT_ALLOWED);
+            char value[24];
+            int len = snprintf(value, sizeof(value), "value-%u", i);
+            TEST_ASSERT_TRUE(!set_values || res->set_value((const uint8_t*)value, len));
+        } else {
+            M2MResource *res = instance.create_dynamic_resource(name, "", M2MResourceInstance::INTEGER, true);
+            TEST_ASSERT_NOT_NULL(res);
+            res->set_operation(M2MBase::GET_PUT_ALLOWED);
+            TEST_ASSERT_TRUE(!set_values || res->set_value((int64_t)i * 100000));
+        }
+    }
+}
+
+/*! \brief Check that serialized resources are read back with the same values.
+*/
+TEST(m2m_tlv_serializer, resourcesRoundTrip)
+{
+    const uint16_t count = 40;
+    create_mixed_resources(*object_instance, count);
+
+    uint32_t size = 0;
+    uint8_t *tlv = M2MTLVSerializer::serialize(object_instance->resources(), size);
+    TEST_ASSERT_NOT_NULL(tlv);
+    TEST_ASSERT_TRUE(M2MTLVDeserializer::is_resource(tlv));
+
+    M2MObject *copy = M2MInterfaceFactory::create_object("10");
+    TEST_ASSERT_NOT_NULL(copy);
+    M2MObjectInstance *copy_instance = copy->create_object_instance();
+    TEST_ASSERT_NOT_NULL(copy_instance);
+    create_mixed_resources(*copy_instance, count, false);
+    TEST_ASSERT_EQUAL_INT(M2MTLVDeserializer::None,
+                          M2MTLVDeserializer::deserialize_resources(tlv, size, *copy_instance,
+                                                                    M2MTLVDeserializer::Put));
+    free(tlv);
+
+    const M2MResourceList &original = object_instance->resources();
+    TEST_ASSERT_EQUAL_INT(original.size(), copy_instance->resources().size());
+    for (M2MResourceList::const_iterator it = original.begin(); it != original.end(); it++) {
+        M2MResource *res = copy_instance->resource((*it)->name());
+        TEST_ASSERT_NOT_NULL(res);
+        if ((*it)->supports_multiple_instances()) {
+            TEST_ASSERT_EQUAL_INT((*it)->resource_instance_count(), res->resource_instance_count());
+            for (uint16_t j = 0; j < (*it)->resource_instance_count(); j++) {
+                TEST_ASSERT_EQUAL_INT32((int32_t)(*it)->resource_instance(j)->get_value_int(),
+                                        (int32_t)res->resource_instance(j)->get_value_int());
+            }
+        } else {
+            TEST_ASSERT_NOT_EQUAL(0, res->value_length());
+            TEST_ASSERT_EQUAL_INT((*it)->value_length(), res->value_length());
+            TEST_ASSERT_EQUAL_MEMORY((*it)->value(), res->value(), res->value_length());
+        }
+    }
+    delete copy;
+}
+
+static void measure_serialize(uint16_t count)
+{
+    create_mixed_resources(*object_instance, count);
+
+    uint32_t size = 0;
+    uint64_t start = pal_osKernelSysTick();
+    for (int i = 0; i < M2M_TEST_SERIALIZER_BENCHMARK_ROUNDS; i++) {
+        uint8_t *tlv = M2MTLVSerializer::serialize(object_instance->resources(), size);
+        TEST_ASSERT_NOT_NULL(tlv);
+        free(tlv);
+    }
+    uint64_t ticks = pal_osKernelSysTick() - start;
+    uint64_t us = (ticks * 1000000ULL) / pal_osKernelSysTickFrequency() / M2M_TEST_SERIALIZER_BENCHMARK_ROUNDS;
+
+    TEST_PRINTF("serialize() of %u resources: %" PRIu32 " bytes in %" PRIu32 " us\r\n",
+                count, size, (uint32_t)us);
+}
+
+/*! \brief Measure serializing one object instance of 500 and 2000 mixed resources.
+*/
+TEST(m2m_tlv_serializer, serializeBenchmark500)
+{
+    measure_serialize(500);
+}
+
+TEST(m2m_tlv_serializer, serializeBenchmark2000)
+{
+    measure_serialize(2000);
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2019 ARM Limited. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+extern "C" {
+#include "unity.h"
+#include "unity_fixture.h"
+}
+
+TEST_GROUP_RUNNER(m2m_tlv_serializer)
+{
+    RUN_TEST_CASE(m2m_tlv_serializer, resourcesRoundTrip);
+    RUN_TEST_CASE(m2m_tlv_serializer, serializeBenchmark500);
+    RUN_TEST_CASE(m2m_tlv_serializer, serializeBenchmark2000);
+}
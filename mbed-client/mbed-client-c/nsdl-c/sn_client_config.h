@@ -46,6 +46,24 @@
  * \brief If enabled this will print out the CoAP package payload.
  */
 #define MBED_CLIENT_PRINT_COAP_PAYLOAD
+
+/**
+ * \def SN_GRS_RESOURCE_HASH_SIZE
+ * \brief Number of buckets in the GRS resource path hash index.
+ * When non-zero, exact path lookups in sn_grs_search_resource() are
+ * done through a hash table instead of a linear list scan.
+ * Default is 0 (disabled).
+ */
+#define SN_GRS_RESOURCE_HASH_SIZE 0
+
+/**
+ * \def SN_NSDL_CACHE_REGISTRATION_ATTRIBUTES
+ * \brief Cache the link-format attributes (;rt, ;if..) of each resource
+ * for registration messages. Attributes are then formatted once per
+ * resource instead of twice per registration, at the cost of keeping a
+ * copy of them in memory. Default is 0 (disabled).
+ */
+#define SN_NSDL_CACHE_REGISTRATION_ATTRIBUTES 0
 #endif
 
 #ifdef MBED_CLIENT_USER_CONFIG_FILE
@@ -46,6 +46,22 @@ extern "C" {
 #define DISABLE_RESOURCE_TYPE MBED_CONF_MBED_CLIENT_DISABLE_RESOURCE_TYPE
 #endif
 
+#if defined MBED_CONF_MBED_CLIENT_SN_GRS_RESOURCE_HASH_SIZE
+#define SN_GRS_RESOURCE_HASH_SIZE MBED_CONF_MBED_CLIENT_SN_GRS_RESOURCE_HASH_SIZE
+#endif
+
+#ifndef SN_GRS_RESOURCE_HASH_SIZE
+#define SN_GRS_RESOURCE_HASH_SIZE 0
+#endif
+
+#if defined MBED_CONF_MBED_CLIENT_SN_NSDL_CACHE_REGISTRATION_ATTRIBUTES
+#define SN_NSDL_CACHE_REGISTRATION_ATTRIBUTES MBED_CONF_MBED_CLIENT_SN_NSDL_CACHE_REGISTRATION_ATTRIBUTES
+#endif
+
+#ifndef SN_NSDL_CACHE_REGISTRATION_ATTRIBUTES
+#define SN_NSDL_CACHE_REGISTRATION_ATTRIBUTES 0
+#endif
+
 /* Handle structure */
 struct nsdl_s;
 
@@ -219,6 +235,15 @@ typedef struct sn_nsdl_resource_parameters_ {
     bool                                        always_publish:1;    /**< 1 if resource should always be published in registration or registration update **/
     unsigned                                    publish_value:2;     /**< 0 for non-publishing,1 if resource value to be published in registration message,
                                                                          2 if resource value to be published in Base64 encoded format */
+    uint16_t                                    path_len;            /**< Cached length of static_resource_parameters->path, set by GRS */
+#if SN_GRS_RESOURCE_HASH_SIZE
+    struct sn_nsdl_resource_parameters_         *hash_next;          /**< Next resource in the same GRS hash bucket, owned by GRS */
+#endif
+#if SN_NSDL_CACHE_REGISTRATION_ATTRIBUTES
+    uint8_t                                     *registration_attributes_ptr; /**< Cached link-format attributes for registration, owned by NSDL */
+    uint16_t                                    registration_attributes_len;
+    bool                                        registration_attributes_valid:1; /**< Cleared by sn_nsdl_resource_attributes_changed() */
+#endif
 } sn_nsdl_dynamic_resource_parameters_s;
 
 
@@ -642,6 +667,23 @@ extern int8_t sn_nsdl_set_duplicate_buffer_size(struct nsdl_s *handle, uint8_t m
  */
 extern int8_t sn_nsdl_set_context(struct nsdl_s * const handle, void * const context);
 
+/**
+ * \fn int8_t sn_nsdl_set_tx_take_callback(struct nsdl_s *handle, uint8_t (*sn_nsdl_tx_take_cb)(struct nsdl_s *, sn_nsdl_capab_e , uint8_t *, uint16_t, sn_nsdl_addr_s *))
+ *
+ * \brief Set a callback for sending new messages without copying them.
+ *        When set, it is called instead of the tx callback for each message the
+ *        library builds, and the message buffer becomes its own. It must release
+ *        the buffer with the free function given to sn_nsdl_init(), whether the
+ *        message is sent or not. Retransmissions and other buffers the library
+ *        keeps still go through the tx callback.
+ *
+ * \param *handle Pointer to library handle
+ * \param *sn_nsdl_tx_take_cb Callback taking the message, NULL to use the tx callback only
+ * \return 0 = success, -1 = failure
+ */
+extern int8_t sn_nsdl_set_tx_take_callback(struct nsdl_s *handle,
+                                           uint8_t (*sn_nsdl_tx_take_cb)(struct nsdl_s *, sn_nsdl_capab_e , uint8_t *, uint16_t, sn_nsdl_addr_s *));
+
 /**
  * \fn void *sn_nsdl_get_context(const struct nsdl_s *handle)
  *
@@ -754,6 +796,16 @@ extern const char* sn_nsdl_get_resource_attribute(const sn_nsdl_static_resource_
 extern bool sn_nsdl_remove_resource_attribute(sn_nsdl_static_resource_parameters_s *params, sn_nsdl_resource_attribute_t attribute);
 #endif
 
+/**
+ * \fn void sn_nsdl_resource_attributes_changed(sn_nsdl_dynamic_resource_parameters_s *res)
+ *
+ * \brief Must be called after link-format attributes (resource type, interface description or
+ * attributes list) of a resource have been modified, so that next registration uses the new values.
+ *
+ * \param *res Pointer to resource dynamic parameters
+ */
+extern void sn_nsdl_resource_attributes_changed(sn_nsdl_dynamic_resource_parameters_s *res);
+
 /**
  * \fn bool sn_nsdl_print_coap_data(sn_coap_hdr_s *coap_header_ptr, bool outgoing)
  *
@@ -59,6 +59,9 @@ struct grs_s {
 
     uint16_t resource_root_count;
     resource_list_t resource_root_list;
+#if SN_GRS_RESOURCE_HASH_SIZE
+    sn_nsdl_dynamic_resource_parameters_s **resource_hash_table; /* NULL if allocation failed, list is then scanned */
+#endif
 };
 
 
@@ -88,6 +91,7 @@ struct nsdl_s {
     void *(*sn_nsdl_alloc)(uint16_t);
     void (*sn_nsdl_free)(void *);
     uint8_t (*sn_nsdl_tx_callback)(struct nsdl_s *, sn_nsdl_capab_e , uint8_t *, uint16_t, sn_nsdl_addr_s *);
+    uint8_t (*sn_nsdl_tx_take_callback)(struct nsdl_s *, sn_nsdl_capab_e , uint8_t *, uint16_t, sn_nsdl_addr_s *); // NULL unless set
     uint8_t (*sn_nsdl_rx_callback)(struct nsdl_s *, sn_coap_hdr_s *, sn_nsdl_addr_s *);
     uint8_t (*sn_nsdl_auto_obs_token_callback)(struct nsdl_s *, const char*, uint8_t*);
 };
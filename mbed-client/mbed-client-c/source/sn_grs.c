@@ -42,6 +42,10 @@ static char *sn_grs_convert_uri(uint16_t *uri_len, const char *uri_ptr);
 static int8_t                       sn_grs_core_request(struct nsdl_s *handle, sn_nsdl_addr_s *src_addr_ptr, sn_coap_hdr_s *coap_packet_ptr);
 static uint8_t                      coap_tx_callback(uint8_t *, uint16_t, sn_nsdl_addr_s *, void *);
 static int8_t                       coap_rx_callback(sn_coap_hdr_s *coap_ptr, sn_nsdl_addr_s *address_ptr, void *param);
+static void                         sn_grs_remove_resource(struct grs_s *handle, sn_nsdl_dynamic_resource_parameters_s *res);
+#if SN_GRS_RESOURCE_HASH_SIZE
+static uint16_t                     sn_grs_hash_path(const char *path, uint16_t path_len);
+#endif
 
 /* Extern function prototypes */
 extern int8_t                       sn_nsdl_build_registration_body(struct nsdl_s *handle, sn_coap_hdr_s *message_ptr, uint8_t updating_registeration);
@@ -57,10 +61,12 @@ extern int8_t sn_grs_destroy(struct grs_s *handle)
         return 0;
     }
     ns_list_foreach_safe(sn_nsdl_dynamic_resource_parameters_s, tmp, &handle->resource_root_list) {
-        ns_list_remove(&handle->resource_root_list, tmp);
-        --handle->resource_root_count;
+        sn_grs_remove_resource(handle, tmp);
         sn_grs_resource_info_free(handle, tmp);
     }
+#if SN_GRS_RESOURCE_HASH_SIZE
+    handle->sn_grs_free(handle->resource_hash_table);
+#endif
     handle->sn_grs_free(handle);
 
     return 0;
@@ -133,6 +139,14 @@ extern struct grs_s *sn_grs_init(uint8_t (*sn_grs_tx_callback_ptr)(struct nsdl_s
     handle_ptr->sn_grs_tx_callback = sn_grs_tx_callback_ptr;
     handle_ptr->sn_grs_rx_callback = sn_grs_rx_callback_ptr;
 
+#if SN_GRS_RESOURCE_HASH_SIZE
+    /* Path index, lookups fall back to list scan if this fails */
+    handle_ptr->resource_hash_table = sn_grs_alloc(SN_GRS_RESOURCE_HASH_SIZE * sizeof(sn_nsdl_dynamic_resource_parameters_s *));
+    if (handle_ptr->resource_hash_table) {
+        memset(handle_ptr->resource_hash_table, 0, SN_GRS_RESOURCE_HASH_SIZE * sizeof(sn_nsdl_dynamic_resource_parameters_s *));
+    }
+#endif
+
     /* Initialize CoAP protocol library */
     handle_ptr->coap = sn_coap_protocol_init(sn_grs_alloc, sn_grs_free, coap_tx_callback, coap_rx_callback);
 
@@ -172,8 +186,7 @@ extern int8_t sn_grs_delete_resource(struct grs_s *handle, const char *path)
     /* If found, delete it and delete also subresources, if there is any */
     do {
         /* Remove from list */
-        ns_list_remove(&handle->resource_root_list, resource_temp);
-        --handle->resource_root_count;
+        sn_grs_remove_resource(handle, resource_temp);
 
         /* Free */
         sn_grs_resource_info_free(handle, resource_temp);
@@ -203,10 +216,19 @@ int8_t sn_grs_put_resource(struct grs_s *handle, sn_nsdl_dynamic_resource_parame
     }
 
     res->registered = SN_NDSL_RESOURCE_NOT_REGISTERED;
+    res->path_len = strlen(res->static_resource_parameters->path);
 
     ns_list_add_to_start(&handle->resource_root_list, res);
     ++handle->resource_root_count;
 
+#if SN_GRS_RESOURCE_HASH_SIZE
+    if (handle->resource_hash_table) {
+        uint16_t bucket = sn_grs_hash_path(res->static_resource_parameters->path, res->path_len);
+        res->hash_next = handle->resource_hash_table[bucket];
+        handle->resource_hash_table[bucket] = res;
+    }
+#endif
+
     return SN_NSDL_SUCCESS;
 }
 
@@ -227,11 +249,67 @@ int8_t sn_grs_pop_resource(struct grs_s *handle, sn_nsdl_dynamic_resource_parame
         return SN_NSDL_FAILURE;
     }
 
+    sn_grs_remove_resource(handle, res);
+
+    return SN_NSDL_SUCCESS;
+}
+
+/**
+ * \fn  static void sn_grs_remove_resource(struct grs_s *handle, sn_nsdl_dynamic_resource_parameters_s *res)
+ *
+ * \brief Unlinks resource from the resource list and from the path index,
+ *        and frees its cached registration attributes
+ *
+ *  \param  *res    Pointer to the resource, must be on the list
+ *
+*/
+static void sn_grs_remove_resource(struct grs_s *handle, sn_nsdl_dynamic_resource_parameters_s *res)
+{
+#if SN_GRS_RESOURCE_HASH_SIZE
+    if (handle->resource_hash_table) {
+        sn_nsdl_dynamic_resource_parameters_s **link_ptr =
+                &handle->resource_hash_table[sn_grs_hash_path(res->static_resource_parameters->path, res->path_len)];
+        while (*link_ptr) {
+            if (*link_ptr == res) {
+                *link_ptr = res->hash_next;
+                break;
+            }
+            link_ptr = &(*link_ptr)->hash_next;
+        }
+        res->hash_next = NULL;
+    }
+#endif
+
+#if SN_NSDL_CACHE_REGISTRATION_ATTRIBUTES
+    handle->sn_grs_free(res->registration_attributes_ptr);
+    res->registration_attributes_ptr = NULL;
+    res->registration_attributes_len = 0;
+    res->registration_attributes_valid = false;
+#endif
+
     ns_list_remove(&handle->resource_root_list, res);
     --handle->resource_root_count;
+}
 
-    return SN_NSDL_SUCCESS;
+#if SN_GRS_RESOURCE_HASH_SIZE
+/**
+ * \fn  static uint16_t sn_grs_hash_path(const char *path, uint16_t path_len)
+ *
+ * \brief Calculates path index bucket for the path (FNV-1a)
+ *
+ *  \return bucket index, 0 .. SN_GRS_RESOURCE_HASH_SIZE - 1
+ *
+*/
+static uint16_t sn_grs_hash_path(const char *path, uint16_t path_len)
+{
+    uint32_t hash = 2166136261u;
+    for (uint16_t i = 0; i < path_len; i++) {
+        hash ^= (uint8_t)path[i];
+        hash *= 16777619u;
+    }
+    return (uint16_t)(hash % SN_GRS_RESOURCE_HASH_SIZE);
 }
+#endif
 
 /**
  * \fn  extern int8_t sn_grs_process_coap(uint8_t *packet, uint16_t *packet_len, sn_nsdl_addr_s *src)
@@ -497,11 +575,16 @@ extern int8_t sn_grs_send_coap_message(struct nsdl_s *handle, sn_nsdl_addr_s *ad
         }
     }
 
-    /* Call tx callback function to send message */
-    ret_val = handle->grs->sn_grs_tx_callback(handle, SN_NSDL_PROTOCOL_COAP, message_ptr, message_len, address_ptr);
+    if (handle->sn_nsdl_tx_take_callback) {
+        /* Call the taking tx callback, it frees the message */
+        ret_val = handle->sn_nsdl_tx_take_callback(handle, SN_NSDL_PROTOCOL_COAP, message_ptr, message_len, address_ptr);
+    } else {
+        /* Call tx callback function to send message */
+        ret_val = handle->grs->sn_grs_tx_callback(handle, SN_NSDL_PROTOCOL_COAP, message_ptr, message_len, address_ptr);
 
-    /* Free allocated memory */
-    handle->grs->sn_grs_free(message_ptr);
+        /* Free allocated memory */
+        handle->grs->sn_grs_free(message_ptr);
+    }
     message_ptr = 0;
 
     if (ret_val == 0) {
@@ -585,17 +668,26 @@ sn_nsdl_dynamic_resource_parameters_s *sn_grs_search_resource(struct grs_s *hand
 
     /* Searchs exact path */
     if (search_method == SN_GRS_SEARCH_METHOD) {
+#if SN_GRS_RESOURCE_HASH_SIZE
+        if (handle->resource_hash_table) {
+            sn_nsdl_dynamic_resource_parameters_s *resource_search_temp =
+                    handle->resource_hash_table[sn_grs_hash_path(path_temp_ptr, pathlen)];
+            while (resource_search_temp) {
+                if (resource_search_temp->path_len == pathlen &&
+                        0 == memcmp(resource_search_temp->static_resource_parameters->path,
+                                    path_temp_ptr,
+                                    pathlen)) {
+                    return resource_search_temp;
+                }
+                resource_search_temp = resource_search_temp->hash_next;
+            }
+            return NULL;
+        }
+#endif
         /* Scan all nodes on list */
         ns_list_foreach(sn_nsdl_dynamic_resource_parameters_s, resource_search_temp, &handle->resource_root_list) {
             /* If length equals.. */
-            size_t len = 0;
-            if(resource_search_temp &&
-                    resource_search_temp->static_resource_parameters &&
-                    resource_search_temp->static_resource_parameters->path) {
-                len = strlen(resource_search_temp->static_resource_parameters->path);
-            }
-
-            if (len == pathlen) {
+            if (resource_search_temp->path_len == pathlen) {
                 /* Compare paths, If same return node pointer*/
                 if (0 == memcmp(resource_search_temp->static_resource_parameters->path,
                                 path_temp_ptr,
@@ -610,9 +702,9 @@ sn_nsdl_dynamic_resource_parameters_s *sn_grs_search_resource(struct grs_s *hand
         /* Scan all nodes on list */
         ns_list_foreach(sn_nsdl_dynamic_resource_parameters_s, resource_search_temp, &handle->resource_root_list) {
             char *temp_path = resource_search_temp->static_resource_parameters->path;
-            if (strlen(resource_search_temp->static_resource_parameters->path) > pathlen &&
-                    (*(temp_path + (uint8_t)pathlen) == '/') &&
-                    0 == memcmp(resource_search_temp->static_resource_parameters->path,
+            if (resource_search_temp->path_len > pathlen &&
+                    (*(temp_path + pathlen) == '/') &&
+                    0 == memcmp(temp_path,
                                 path_temp_ptr,
                                 pathlen)) {
                 return resource_search_temp;
@@ -120,6 +120,11 @@ static int32_t          sn_nsdl_internal_coap_send(struct nsdl_s *handle, sn_coa
 static void             sn_nsdl_resolve_nsp_address(struct nsdl_s *handle);
 int8_t                  sn_nsdl_build_registration_body(struct nsdl_s *handle, sn_coap_hdr_s *message_ptr, uint8_t updating_registeration);
 static uint16_t         sn_nsdl_calculate_registration_body_size(struct nsdl_s *handle, uint8_t updating_registeration, int8_t *error);
+static uint16_t         sn_nsdl_calculate_resource_attributes_len(const sn_nsdl_dynamic_resource_parameters_s *resource_ptr, int8_t *error);
+static uint8_t          *sn_nsdl_build_resource_attributes(uint8_t *dst, const sn_nsdl_dynamic_resource_parameters_s *resource_ptr);
+#if SN_NSDL_CACHE_REGISTRATION_ATTRIBUTES
+static bool             sn_nsdl_cache_resource_attributes(struct nsdl_s *handle, sn_nsdl_dynamic_resource_parameters_s *resource_ptr);
+#endif
 static uint8_t          sn_nsdl_calculate_uri_query_option_len(sn_nsdl_ep_parameters_s *endpoint_info_ptr, uint8_t msg_type, const char *uri_query);
 static int8_t           sn_nsdl_fill_uri_query_options(struct nsdl_s *handle, sn_nsdl_ep_parameters_s *parameter_ptr, sn_coap_hdr_s *source_msg_ptr, uint8_t msg_type, const char *uri_query);
 static int8_t           sn_nsdl_local_rx_function(struct nsdl_s *handle, sn_coap_hdr_s *coap_packet_ptr, sn_nsdl_addr_s *address_ptr);
@@ -962,8 +967,13 @@ static int32_t sn_nsdl_internal_coap_send(struct nsdl_s *handle, sn_coap_hdr_s *
         return ret;
     }
 
-    handle->sn_nsdl_tx_callback(handle, SN_NSDL_PROTOCOL_COAP, coap_message_ptr, coap_message_len, dst_addr_ptr);
-    handle->sn_nsdl_free(coap_message_ptr);
+    if (handle->sn_nsdl_tx_take_callback) {
+        /* The callback frees the message */
+        handle->sn_nsdl_tx_take_callback(handle, SN_NSDL_PROTOCOL_COAP, coap_message_ptr, coap_message_len, dst_addr_ptr);
+    } else {
+        handle->sn_nsdl_tx_callback(handle, SN_NSDL_PROTOCOL_COAP, coap_message_ptr, coap_message_len, dst_addr_ptr);
+        handle->sn_nsdl_free(coap_message_ptr);
+    }
 
     return coap_header_ptr->msg_id;
 }
@@ -1058,14 +1068,10 @@ int8_t sn_nsdl_build_registration_body(struct nsdl_s *handle, sn_coap_hdr_s *mes
 
             *temp_ptr++ = '<';
             *temp_ptr++ = '/';
-            size_t path_len = 0;
-            if (resource_temp_ptr->static_resource_parameters->path) {
-                path_len = strlen(resource_temp_ptr->static_resource_parameters->path);
-            }
             memcpy(temp_ptr,
                    resource_temp_ptr->static_resource_parameters->path,
-                   path_len);
-            temp_ptr += path_len;
+                   resource_temp_ptr->path_len);
+            temp_ptr += resource_temp_ptr->path_len;
             *temp_ptr++ = '>';
 
             /* Resource attributes */
@@ -1073,64 +1079,17 @@ int8_t sn_nsdl_build_registration_body(struct nsdl_s *handle, sn_coap_hdr_s *mes
                 *temp_ptr++ = ';';
                 *temp_ptr++ = 'd';
             }
-#ifndef RESOURCE_ATTRIBUTES_LIST
-#ifndef DISABLE_RESOURCE_TYPE
-            size_t resource_type_len = 0;
-            if (resource_temp_ptr->static_resource_parameters->resource_type_ptr) {
-                resource_type_len = strlen(resource_temp_ptr->static_resource_parameters->resource_type_ptr);
-            }
-            if (resource_type_len) {
-                *temp_ptr++ = ';';
-                memcpy(temp_ptr, resource_type_parameter, RT_PARAMETER_LEN);
-                temp_ptr += RT_PARAMETER_LEN;
-                *temp_ptr++ = '"';
-                memcpy(temp_ptr,
-                       resource_temp_ptr->static_resource_parameters->resource_type_ptr,
-                       resource_type_len);
-                temp_ptr += resource_type_len;
-                *temp_ptr++ = '"';
-            }
-#endif
-#ifndef DISABLE_INTERFACE_DESCRIPTION
-            size_t interface_description_len = 0;
-            if (resource_temp_ptr->static_resource_parameters->interface_description_ptr) {
-                interface_description_len = strlen(resource_temp_ptr->static_resource_parameters->interface_description_ptr);
-            }
-
-            if (interface_description_len) {
-                *temp_ptr++ = ';';
-                memcpy(temp_ptr, if_description_parameter, IF_PARAMETER_LEN);
-                temp_ptr += IF_PARAMETER_LEN;
-                *temp_ptr++ = '"';
+#if SN_NSDL_CACHE_REGISTRATION_ATTRIBUTES
+            if (resource_temp_ptr->registration_attributes_valid) {
                 memcpy(temp_ptr,
-                       resource_temp_ptr->static_resource_parameters->interface_description_ptr,
-                       interface_description_len);
-                temp_ptr += interface_description_len;
-                *temp_ptr++ = '"';
-            }
+                       resource_temp_ptr->registration_attributes_ptr,
+                       resource_temp_ptr->registration_attributes_len);
+                temp_ptr += resource_temp_ptr->registration_attributes_len;
+            } else
 #endif
-#else
-            size_t attribute_len = 0;
-            if (resource_temp_ptr->static_resource_parameters->attributes_ptr) {
-                sn_nsdl_attribute_item_s *attribute = resource_temp_ptr->static_resource_parameters->attributes_ptr;
-                while (attribute->attribute_name != ATTR_END) {
-                    switch (attribute->attribute_name) {
-                    case ATTR_RESOURCE_TYPE:
-                        temp_ptr = sn_nsdl_build_resource_attribute_str(temp_ptr, attribute, resource_type_parameter, RT_PARAMETER_LEN);
-                        break;
-                    case ATTR_INTERFACE_DESCRIPTION:
-                        temp_ptr = sn_nsdl_build_resource_attribute_str(temp_ptr, attribute, if_description_parameter, IF_PARAMETER_LEN);
-                        break;
-                    case ATTR_ENDPOINT_NAME:
-                        temp_ptr = sn_nsdl_build_resource_attribute_str(temp_ptr, attribute, name_parameter, NAME_PARAMETER_LEN);
-                        break;
-                    default:
-                        break;
-                    }
-                    attribute++;
-                }
+            {
+                temp_ptr = sn_nsdl_build_resource_attributes(temp_ptr, resource_temp_ptr);
             }
-#endif
             if (resource_temp_ptr->coap_content_type != 0) {
                 *temp_ptr++ = ';';
                 memcpy(temp_ptr, coap_con_type_parameter, COAP_CON_PARAMETER_LEN);
@@ -1221,8 +1180,9 @@ static uint16_t sn_nsdl_calculate_registration_body_size(struct nsdl_s *handle,
     tr_debug("sn_nsdl_calculate_registration_body_size");
     /* Local variables */
     uint16_t return_value = 0;
+    uint16_t attributes_len;
     *error = SN_NSDL_SUCCESS;
-    const sn_nsdl_dynamic_resource_parameters_s *resource_temp_ptr;
+    sn_nsdl_dynamic_resource_parameters_s *resource_temp_ptr;
 
     /* check pointer */
     resource_temp_ptr = sn_grs_get_first_resource(handle->grs);
@@ -1244,13 +1204,8 @@ static uint16_t sn_nsdl_calculate_registration_body_size(struct nsdl_s *handle,
             }
 
             /* Count length for the resource path </path> */
-            size_t path_len = 0;
-            if (resource_temp_ptr->static_resource_parameters->path) {
-                path_len = strlen(resource_temp_ptr->static_resource_parameters->path);
-            }
-
-            if (sn_nsdl_check_uint_overflow(return_value, 3, path_len)) {
-                return_value += (3 + path_len);
+            if (sn_nsdl_check_uint_overflow(return_value, 3, resource_temp_ptr->path_len)) {
+                return_value += (3 + resource_temp_ptr->path_len);
             } else {
                 *error = SN_NSDL_FAILURE;
                 break;
@@ -1260,88 +1215,25 @@ static uint16_t sn_nsdl_calculate_registration_body_size(struct nsdl_s *handle,
             if (resource_temp_ptr->registered == SN_NDSL_RESOURCE_DELETE) {
                 return_value += 2;
             }
-#ifndef RESOURCE_ATTRIBUTES_LIST
-#ifndef DISABLE_RESOURCE_TYPE
-            /* Resource type parameter */
-            size_t resource_type_len = 0;
-            if (resource_temp_ptr->static_resource_parameters->resource_type_ptr) {
-                resource_type_len = strlen(resource_temp_ptr->static_resource_parameters->resource_type_ptr);
-            }
-
-            if (resource_type_len) {
-                /* ;rt="restype" */
-                if (sn_nsdl_check_uint_overflow(return_value,
-                                                6,
-                                                resource_type_len)) {
-                    return_value += (6 + resource_type_len);
-                } else {
-                    *error = SN_NSDL_FAILURE;
-                    break;
-                }
-            }
+#if SN_NSDL_CACHE_REGISTRATION_ATTRIBUTES
+            if (sn_nsdl_cache_resource_attributes(handle, resource_temp_ptr)) {
+                attributes_len = resource_temp_ptr->registration_attributes_len;
+            } else
 #endif
-
-#ifndef DISABLE_INTERFACE_DESCRIPTION
-            /* Interface description parameter */
-            size_t interface_description_len = 0;
-            if (resource_temp_ptr->static_resource_parameters->interface_description_ptr) {
-                interface_description_len = strlen(resource_temp_ptr->static_resource_parameters->interface_description_ptr);
-            }
-            if (interface_description_len) {
-                /* ;if="iftype" */
-                if (sn_nsdl_check_uint_overflow(return_value,
-                                                6,
-                                                interface_description_len)) {
-                    return_value += (6 + interface_description_len);
-                } else {
-                    *error = SN_NSDL_FAILURE;
+            {
+                attributes_len = sn_nsdl_calculate_resource_attributes_len(resource_temp_ptr, error);
+                if (SN_NSDL_FAILURE == *error) {
                     break;
                 }
             }
-#endif
-#else
-            /* All attributes */
-            if (resource_temp_ptr->static_resource_parameters->attributes_ptr) {
-                size_t attribute_len = 0;
-                size_t attribute_desc_len = 0;
-                uint8_t success = 1;
-                sn_nsdl_attribute_item_s *item = resource_temp_ptr->static_resource_parameters->attributes_ptr;
-                while (item->attribute_name != ATTR_END) {
-                    switch(item->attribute_name) {
-                    case ATTR_RESOURCE_TYPE:
-                        /* ;rt="restype" */
-                        attribute_desc_len = 6;
-                        attribute_len = strlen(item->value);
-                        break;
-                    case ATTR_INTERFACE_DESCRIPTION:
-                        /* ;if="iftype" */
-                        attribute_desc_len = 6;
-                        attribute_len = strlen(item->value);
-                        break;
-                    case ATTR_ENDPOINT_NAME:
-                        /* ;name="name" */
-                        attribute_desc_len = 8;
-                        attribute_len = strlen(item->value);
-                        break;
-                    default:
-                        break;
-                    }
-                    if (sn_nsdl_check_uint_overflow(return_value,
-                                                    attribute_desc_len,
-                                                    attribute_len)) {
-                        return_value += (attribute_desc_len + attribute_len);
-                    } else {
-                        success = 0;
-                        break;
-                    }
-                    item++;
-                }
-                if (!success) {
-                    *error = SN_NSDL_FAILURE;
-                    break;
-                }
+
+            if (sn_nsdl_check_uint_overflow(return_value, attributes_len, 0)) {
+                return_value += attributes_len;
+            } else {
+                *error = SN_NSDL_FAILURE;
+                break;
             }
-#endif
+
             if (resource_temp_ptr->coap_content_type != 0) {
                 /* ;if="content" */
                 uint8_t len = sn_nsdl_itoa_len(resource_temp_ptr->coap_content_type);
@@ -1407,6 +1299,196 @@ static uint16_t sn_nsdl_calculate_registration_body_size(struct nsdl_s *handle,
     return return_value;
 }
 
+/**
+ * \fn static uint16_t sn_nsdl_calculate_resource_attributes_len(const sn_nsdl_dynamic_resource_parameters_s *resource_ptr, int8_t *error)
+ *
+ * \brief   Calculates length of the resource type and interface description attributes of a resource
+ * \param   *resource_ptr   Pointer to resource
+ * \param   *error          Error code, SN_NSDL_SUCCESS or SN_NSDL_FAILURE
+ *
+ * \return  Length of the attributes
+ */
+static uint16_t sn_nsdl_calculate_resource_attributes_len(const sn_nsdl_dynamic_resource_parameters_s *resource_ptr, int8_t *error)
+{
+    size_t return_value = 0;
+    *error = SN_NSDL_SUCCESS;
+
+#ifndef RESOURCE_ATTRIBUTES_LIST
+#ifndef DISABLE_RESOURCE_TYPE
+    /* ;rt="restype" */
+    if (resource_ptr->static_resource_parameters->resource_type_ptr) {
+        size_t resource_type_len = strlen(resource_ptr->static_resource_parameters->resource_type_ptr);
+        if (resource_type_len) {
+            return_value += (6 + resource_type_len);
+        }
+    }
+#endif
+#ifndef DISABLE_INTERFACE_DESCRIPTION
+    /* ;if="iftype" */
+    if (resource_ptr->static_resource_parameters->interface_description_ptr) {
+        size_t interface_description_len = strlen(resource_ptr->static_resource_parameters->interface_description_ptr);
+        if (interface_description_len) {
+            return_value += (6 + interface_description_len);
+        }
+    }
+#endif
+#else
+    /* All attributes */
+    if (resource_ptr->static_resource_parameters->attributes_ptr) {
+        const sn_nsdl_attribute_item_s *item = resource_ptr->static_resource_parameters->attributes_ptr;
+        while (item->attribute_name != ATTR_END) {
+            if (item->value) {
+                switch (item->attribute_name) {
+                case ATTR_RESOURCE_TYPE:
+                    /* ;rt="restype" */
+                case ATTR_INTERFACE_DESCRIPTION:
+                    /* ;if="iftype" */
+                    return_value += (6 + strlen(item->value));
+                    break;
+                case ATTR_ENDPOINT_NAME:
+                    /* ;name="name" */
+                    return_value += (8 + strlen(item->value));
+                    break;
+                default:
+                    break;
+                }
+            }
+            item++;
+        }
+    }
+#endif
+
+    if (return_value > UINT16_MAX) {
+        *error = SN_NSDL_FAILURE;
+        return 0;
+    }
+    return return_value;
+}
+
+/**
+ * \fn static uint8_t *sn_nsdl_build_resource_attributes(uint8_t *dst, const sn_nsdl_dynamic_resource_parameters_s *resource_ptr)
+ *
+ * \brief   Writes resource type and interface description attributes of a resource
+ * \param   *dst            Destination, sn_nsdl_calculate_resource_attributes_len() bytes are written
+ * \param   *resource_ptr   Pointer to resource
+ *
+ * \return  Pointer to the end of written attributes
+ */
+static uint8_t *sn_nsdl_build_resource_attributes(uint8_t *dst, const sn_nsdl_dynamic_resource_parameters_s *resource_ptr)
+{
+#ifndef RESOURCE_ATTRIBUTES_LIST
+#ifndef DISABLE_RESOURCE_TYPE
+    size_t resource_type_len = 0;
+    if (resource_ptr->static_resource_parameters->resource_type_ptr) {
+        resource_type_len = strlen(resource_ptr->static_resource_parameters->resource_type_ptr);
+    }
+    if (resource_type_len) {
+        *dst++ = ';';
+        memcpy(dst, resource_type_parameter, RT_PARAMETER_LEN);
+        dst += RT_PARAMETER_LEN;
+        *dst++ = '"';
+        memcpy(dst,
+               resource_ptr->static_resource_parameters->resource_type_ptr,
+               resource_type_len);
+        dst += resource_type_len;
+        *dst++ = '"';
+    }
+#endif
+#ifndef DISABLE_INTERFACE_DESCRIPTION
+    size_t interface_description_len = 0;
+    if (resource_ptr->static_resource_parameters->interface_description_ptr) {
+        interface_description_len = strlen(resource_ptr->static_resource_parameters->interface_description_ptr);
+    }
+
+    if (interface_description_len) {
+        *dst++ = ';';
+        memcpy(dst, if_description_parameter, IF_PARAMETER_LEN);
+        dst += IF_PARAMETER_LEN;
+        *dst++ = '"';
+        memcpy(dst,
+               resource_ptr->static_resource_parameters->interface_description_ptr,
+               interface_description_len);
+        dst += interface_description_len;
+        *dst++ = '"';
+    }
+#endif
+#else
+    if (resource_ptr->static_resource_parameters->attributes_ptr) {
+        const sn_nsdl_attribute_item_s *attribute = resource_ptr->static_resource_parameters->attributes_ptr;
+        while (attribute->attribute_name != ATTR_END) {
+            switch (attribute->attribute_name) {
+            case ATTR_RESOURCE_TYPE:
+                dst = (uint8_t*)sn_nsdl_build_resource_attribute_str((char*)dst, attribute, (const char*)resource_type_parameter, RT_PARAMETER_LEN);
+                break;
+            case ATTR_INTERFACE_DESCRIPTION:
+                dst = (uint8_t*)sn_nsdl_build_resource_attribute_str((char*)dst, attribute, (const char*)if_description_parameter, IF_PARAMETER_LEN);
+                break;
+            case ATTR_ENDPOINT_NAME:
+                dst = (uint8_t*)sn_nsdl_build_resource_attribute_str((char*)dst, attribute, (const char*)name_parameter, NAME_PARAMETER_LEN);
+                break;
+            default:
+                break;
+            }
+            attribute++;
+        }
+    }
+#endif
+    return dst;
+}
+
+#if SN_NSDL_CACHE_REGISTRATION_ATTRIBUTES
+/**
+ * \fn static bool sn_nsdl_cache_resource_attributes(struct nsdl_s *handle, sn_nsdl_dynamic_resource_parameters_s *resource_ptr)
+ *
+ * \brief   Formats attributes of a resource to its attribute cache, unless the cache is up to date
+ * \param   *handle         Pointer to nsdl-library handle
+ * \param   *resource_ptr   Pointer to resource
+ *
+ * \return  true if cache is valid, false if attributes must be formatted directly
+ */
+static bool sn_nsdl_cache_resource_attributes(struct nsdl_s *handle, sn_nsdl_dynamic_resource_parameters_s *resource_ptr)
+{
+    int8_t error;
+    uint16_t attributes_len;
+
+    if (resource_ptr->registration_attributes_valid) {
+        return true;
+    }
+
+    attributes_len = sn_nsdl_calculate_resource_attributes_len(resource_ptr, &error);
+    if (SN_NSDL_FAILURE == error) {
+        return false;
+    }
+
+    handle->grs->sn_grs_free(resource_ptr->registration_attributes_ptr);
+    resource_ptr->registration_attributes_ptr = NULL;
+    resource_ptr->registration_attributes_len = 0;
+
+    if (attributes_len) {
+        resource_ptr->registration_attributes_ptr = handle->grs->sn_grs_alloc(attributes_len);
+        if (!resource_ptr->registration_attributes_ptr) {
+            return false;
+        }
+        sn_nsdl_build_resource_attributes(resource_ptr->registration_attributes_ptr, resource_ptr);
+        resource_ptr->registration_attributes_len = attributes_len;
+    }
+
+    resource_ptr->registration_attributes_valid = true;
+    return true;
+}
+#endif
+
+void sn_nsdl_resource_attributes_changed(sn_nsdl_dynamic_resource_parameters_s *res)
+{
+#if SN_NSDL_CACHE_REGISTRATION_ATTRIBUTES
+    if (res) {
+        res->registration_attributes_valid = false;
+    }
+#else
+    (void)res;
+#endif
+}
+
 /**
  * \fn static uint8_t sn_nsdl_calculate_uri_query_option_len(sn_nsdl_ep_parameters_s *endpoint_info_ptr, uint8_t msg_type)
  *
@@ -2191,6 +2273,16 @@ extern int8_t sn_nsdl_set_context(struct nsdl_s * const handle, void * const con
     return SN_NSDL_SUCCESS;
 }
 
+extern int8_t sn_nsdl_set_tx_take_callback(struct nsdl_s *handle,
+                                           uint8_t (*sn_nsdl_tx_take_cb)(struct nsdl_s *, sn_nsdl_capab_e , uint8_t *, uint16_t, sn_nsdl_addr_s *))
+{
+    if (handle == NULL) {
+        return SN_NSDL_FAILURE;
+    }
+    handle->sn_nsdl_tx_take_callback = sn_nsdl_tx_take_cb;
+    return SN_NSDL_SUCCESS;
+}
+
 extern void *sn_nsdl_get_context(const struct nsdl_s * const handle)
 {
     if (handle == NULL) {
@@ -2574,13 +2666,13 @@ void remove_previous_block_data(struct nsdl_s *handle, sn_nsdl_addr_s *src_ptr,
 {
 #if SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
     ns_list_foreach(coap_blockwise_payload_s, stored_payload_info_ptr, &handle->grs->coap->linked_list_blockwise_received_payloads) {
-        uint32_t stored_number = stored_payload_info_ptr->block_number;
-        // Remove the previous block data
-        if (block_number - 1 == stored_number) {
-            sn_coap_protocol_block_remove(handle->grs->coap,
-                    src_ptr,
-                    stored_payload_info_ptr->payload_len,
-                    stored_payload_info_ptr->payload_ptr);
+        // Remove the data stored before the current block
+        if (block_number == stored_payload_info_ptr->block_number &&
+            stored_payload_info_ptr->block_offset > stored_payload_info_ptr->payload_offset &&
+            stored_payload_info_ptr->port == src_ptr->port &&
+            !memcmp(stored_payload_info_ptr->addr_ptr, src_ptr->addr_ptr, src_ptr->addr_len)) {
+            sn_coap_protocol_linked_list_blockwise_payload_release(stored_payload_info_ptr,
+                    stored_payload_info_ptr->block_offset - stored_payload_info_ptr->payload_offset);
             break;
         }
     }
@@ -2618,12 +2710,19 @@ bool update_last_block_data(struct nsdl_s *handle, sn_coap_hdr_s *coap_packet_pt
 
 static void sn_nsdl_add_token(struct nsdl_s *handle, uint32_t *token, sn_coap_hdr_s *message_ptr)
 {
-    handle->token_seed++;
-    if (handle->token_seed == 0) {
-        handle->token_seed++;
-    }
+    uint32_t token_seed;
+    uint32_t next_token_seed;
+
+    /* Token counter is per handle, advance it atomically so that concurrent requests get unique tokens */
+    do {
+        token_seed = handle->token_seed;
+        next_token_seed = token_seed + 1;
+        if (next_token_seed == 0) {
+            next_token_seed++;
+        }
+    } while (!SN_COAP_ATOMIC_CAS_32(&handle->token_seed, token_seed, next_token_seed));
 
-    *token = handle->token_seed;
+    *token = next_token_seed;
 
     message_ptr->token_ptr = (uint8_t*)token;
     message_ptr->token_len = sizeof(*token);
@@ -101,6 +101,16 @@ public:
                    uint16_t data_len,
                    sn_nsdl_addr_s *address_ptr);
 
+    /**
+    * @brief Sends data to the connected server without copying it.
+    * The buffer is released with free() once it is sent or dropped,
+    * also when false is returned.
+    * @param data, Data to be sent, allocated with malloc().
+    */
+    bool send_data_take(uint8_t *data_ptr,
+                        uint16_t data_len,
+                        sn_nsdl_addr_s *address_ptr);
+
     /**
     * @brief Listens for incoming data from remote server
     * @return true if successful else false.
@@ -150,7 +160,7 @@ public:
     bool is_handshake_ongoing() const;
 
     /**
-    * @brief Sends data to socket through event loop.
+    * @brief Sends all queued data to socket through event loop.
     */
     void send_socket_data();
 
@@ -200,6 +210,18 @@ private:
     */
     void receive_handshake_handler();
 
+    /**
+    * @brief Continues a stepwise handshake from a low priority event, so that
+    * other events are handled between the handshake steps.
+    */
+    void send_handshake_step_event();
+
+    /**
+    * @brief Returns the time since the previous connection phase ended and
+    * starts timing the next phase.
+    */
+    uint32_t connection_phase_time_ms();
+
     /**
     * @brief Callback handler for socket events.
     */
@@ -227,6 +249,44 @@ private:
     */
     void close_socket();
 
+    /**
+    * @brief Sends the first queued message, or for non-secure UDP a batch
+    * of queued messages with one call.
+    * @return true if everything taken from the queue was sent and the
+    * next message can be tried.
+    */
+    bool send_queued_data();
+
+    /**
+    * @brief Sends up to PAL_NET_MAX_SEND_BUFFERS queued datagrams with one
+    * pal_sendToBatch() and puts back the ones that were not sent.
+    * @return true if all the datagrams taken from the queue were sent.
+    */
+    bool send_queued_datagrams();
+
+    /**
+    * @brief Queues a message and posts a send event if none is pending.
+    * @param take, true if the queue takes over the data buffer instead of copying it.
+    */
+    bool queue_data(uint8_t *data_ptr,
+                    uint16_t data_len,
+                    sn_nsdl_addr_s *address_ptr,
+                    bool take);
+
+#ifdef PAL_NET_TCP_AND_TLS_SUPPORT
+    /**
+    * @brief Callback handler for receiving data over non-secure TCP.
+    */
+    void receive_tcp_handler();
+
+    /**
+    * @brief Passes every complete length-prefixed frame in the TCP receive
+    * buffer to the observer and keeps the trailing partial frame.
+    * @return false if the connection was closed while dispatching.
+    */
+    bool dispatch_tcp_frames();
+#endif //PAL_NET_TCP_AND_TLS_SUPPORT
+
 public:
 
     /**
@@ -237,10 +297,16 @@ public:
     void interface_event(palNetworkStatus_t status);
 
 private:
+    // Copied data follows the struct in the same allocation, taken data
+    // is the sender's own buffer. Non-secure TCP messages are sent after
+    // the length header, offset counts the header and data bytes sent.
     typedef struct send_data_queue {
         uint8_t *data;
-        uint16_t offset;
+        uint32_t offset;
         uint16_t data_len;
+        uint8_t header_len;
+        uint8_t header[4];
+        bool data_taken;
         ns_list_link_t link;
     } send_data_queue_s;
 
@@ -254,6 +320,11 @@ private:
      */
     void add_item_to_list(send_data_queue_s* data);
 
+    /**
+     * @brief Free a queue item and its data.
+     */
+    static void free_item(send_data_queue_s* data);
+
 private:
     enum SocketState {
 
@@ -323,6 +394,11 @@ private:
     SocketState                                 _socket_state;
     uint8_t                                     _handshake_retry;
 
+    // Connection setup timing, traced when the connection is ready
+    uint64_t                                    _phase_start_tick;
+    uint32_t                                    _dns_time_ms;
+    uint32_t                                    _connect_time_ms;
+
     /**
      * This is a flag which is set before sending a socket callback event
      * and cleared when the event handler side is started. It is meant to get rid of
@@ -333,8 +409,18 @@ private:
 
     send_data_list_t                            _linked_list_send_data;
 
+    // Set while an ESocketSend event is queued. Protected by the mutex.
+    bool                                        _send_event_pending;
+
     bool                                        _secure_connection;
 
+#ifdef PAL_NET_TCP_AND_TLS_SUPPORT
+    // Reassembly buffer for non-secure TCP. A frame may be split over several
+    // reads and a single read may contain several frames.
+    uint8_t                                     *_tcp_recv_buffer;
+    uint16_t                                    _tcp_recv_buffer_used;
+#endif //PAL_NET_TCP_AND_TLS_SUPPORT
+
 friend class Test_M2MConnectionHandlerPimpl;
 friend class Test_M2MConnectionHandlerPimpl_mbed;
 friend class Test_M2MConnectionHandlerPimpl_classic;
@@ -64,6 +64,13 @@ bool M2MConnectionHandler::send_data(uint8_t *data,
     return _private_impl->send_data(data, data_len, address);
 }
 
+bool M2MConnectionHandler::send_data_take(uint8_t *data,
+                                          uint16_t data_len,
+                                          sn_nsdl_addr_s *address)
+{
+    return _private_impl->send_data_take(data, data_len, address);
+}
+
 void M2MConnectionHandler::handle_connection_error(int error)
 {
     _private_impl->handle_connection_error(error);
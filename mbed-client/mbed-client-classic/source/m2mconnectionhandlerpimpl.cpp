@@ -31,6 +31,7 @@
 #include "eventOS_event_timer.h"
 
 #include "mbed-trace/mbed_trace.h"
+#include "common_functions.h"
 
 #include <stdlib.h> // free() and malloc()
 
@@ -40,6 +41,12 @@
 #define MBED_CONF_MBED_CLIENT_TLS_MAX_RETRY 30
 #endif
 
+#ifdef PAL_NET_TCP_AND_TLS_SUPPORT
+// Non-secure TCP frames are prefixed with a 32-bit length in network byte order
+#define TCP_FRAME_HEADER_LENGTH 4
+#define TCP_RECV_BUFFER_LENGTH  (BUFFER_LENGTH + TCP_FRAME_HEADER_LENGTH)
+#endif
+
 #if (PAL_DNS_API_VERSION == 1) && defined(TARGET_LIKE_MBED)
 #error "For async PAL DNS only API v2 or greater is supported on Mbed."
 #endif
@@ -107,6 +114,10 @@ void M2MConnectionHandlerPimpl::event_handler(arm_event_s *event)
 
         // Data send request from client side
         case M2MConnectionHandlerPimpl::ESocketSend:
+            // Data queued from now on needs a new event
+            claim_mutex();
+            _send_event_pending = false;
+            release_mutex();
             send_socket_data();
             break;
 
@@ -192,8 +203,16 @@ M2MConnectionHandlerPimpl::M2MConnectionHandlerPimpl(M2MConnectionHandler* base,
 #endif
  _socket_state(ESocketStateDisconnected),
  _handshake_retry(0),
+ _phase_start_tick(0),
+ _dns_time_ms(0),
+ _connect_time_ms(0),
  _suppressable_event_in_flight(false),
+ _send_event_pending(false),
  _secure_connection(false)
+#ifdef PAL_NET_TCP_AND_TLS_SUPPORT
+ ,_tcp_recv_buffer(NULL),
+ _tcp_recv_buffer_used(0)
+#endif
 {
 #ifndef PAL_NET_TCP_AND_TLS_SUPPORT
     if (is_tcp_connection()) {
@@ -231,6 +250,10 @@ M2MConnectionHandlerPimpl::~M2MConnectionHandlerPimpl()
     close_socket();
     delete _security_impl;
     _security_impl = NULL;
+#ifdef PAL_NET_TCP_AND_TLS_SUPPORT
+    free(_tcp_recv_buffer);
+    _tcp_recv_buffer = NULL;
+#endif
     pal_destroy();
     tr_debug("~M2MConnectionHandlerPimpl() - OUT");
 }
@@ -322,6 +345,7 @@ void M2MConnectionHandlerPimpl::handle_dns_result(bool success)
     }
 
     if (success) {
+        _dns_time_ms = connection_phase_time_ms();
         _socket_state = EsocketStateInitializeConnection;
         socket_connect_handler();
 
@@ -344,6 +368,7 @@ bool M2MConnectionHandlerPimpl::resolve_server_address(const String& server_addr
 #endif
     _socket_state = ESocketStateDNSResolving;
     _security = security;
+    connection_phase_time_ms();
 
     int32_t security_instance_id = _security->get_security_instance_id(M2MSecurity::M2MServer);
     if (server_type == M2MConnectionObserver::Bootstrap) {
@@ -480,6 +505,7 @@ void M2MConnectionHandlerPimpl::socket_connect_handler()
 
         // fall through is a normal flow in case the UDP was used or pal_connect() happened to return immediately with PAL_SUCCESS
         case ESocketStateConnected:
+            _connect_time_ms = connection_phase_time_ms();
             if (_security && security_instance_id >= 0) {
                 if (_secure_connection) {
                     if ( _security_impl != NULL ) {
@@ -510,6 +536,8 @@ void M2MConnectionHandlerPimpl::socket_connect_handler()
                 }
             }
             if (_socket_state != ESocketStateHandshaking) {
+                tr_info("M2MConnectionHandlerPimpl::socket_connect_handler - DNS %" PRIu32 " ms, connect %" PRIu32 " ms",
+                        _dns_time_ms, _connect_time_ms);
                 _socket_state = ESocketStateUnsecureConnection;
                 _observer.address_ready(_address,
                                         _server_type,
@@ -523,57 +551,76 @@ void M2MConnectionHandlerPimpl::socket_connect_handler()
 bool M2MConnectionHandlerPimpl::send_data(uint8_t *data,
                                           uint16_t data_len,
                                           sn_nsdl_addr_s *address)
+{
+    return queue_data(data, data_len, address, false);
+}
+
+bool M2MConnectionHandlerPimpl::send_data_take(uint8_t *data,
+                                               uint16_t data_len,
+                                               sn_nsdl_addr_s *address)
+{
+    return queue_data(data, data_len, address, true);
+}
+
+bool M2MConnectionHandlerPimpl::queue_data(uint8_t *data,
+                                           uint16_t data_len,
+                                           sn_nsdl_addr_s *address,
+                                           bool take)
 {
     if (address == NULL || data == NULL || !data_len || _socket_state < ESocketStateUnsecureConnection) {
         tr_warn("M2MConnectionHandlerPimpl::send_data() - too early");
+        if (take) {
+            free(data);
+        }
         return false;
     }
 
-    send_data_queue_s* out_data = (send_data_queue_s*)malloc(sizeof(send_data_queue_s));
+    // Copied data shares the allocation of the queue node
+    send_data_queue_s* out_data = (send_data_queue_s*)malloc(sizeof(send_data_queue_s) + (take ? 0 : data_len));
     if (!out_data) {
+        if (take) {
+            free(data);
+        }
         return false;
     }
 
     memset(out_data, 0, sizeof(send_data_queue_s));
-
-    uint8_t offset = 0;
-#ifdef PAL_NET_TCP_AND_TLS_SUPPORT
-    if (is_tcp_connection() && !_secure_connection ) {
-        offset = 4;
-    }
-#endif
-
-    out_data->data = (uint8_t*)malloc(data_len + offset);
-    if (!out_data->data) {
-        free(out_data);
-        return false;
+    if (take) {
+        out_data->data = data;
+        out_data->data_taken = true;
+    } else {
+        out_data->data = (uint8_t*)(out_data + 1);
+        memcpy(out_data->data, data, data_len);
     }
+    out_data->data_len = data_len;
 
     // TCP non-secure
-    // We need to "shim" the length in front
+    // We need to "shim" the length in front, it is sent with the data in one pal_sendVector()
 #ifdef PAL_NET_TCP_AND_TLS_SUPPORT
     if (is_tcp_connection() && !_secure_connection ) {
-        out_data->data[0] = 0;
-        out_data->data[1] = 0;
-        out_data->data[2] = (data_len >> 8 ) & 0xff;
-        out_data->data[3] = data_len & 0xff;
+        out_data->header[0] = 0;
+        out_data->header[1] = 0;
+        out_data->header[2] = (data_len >> 8 ) & 0xff;
+        out_data->header[3] = data_len & 0xff;
+        out_data->header_len = TCP_FRAME_HEADER_LENGTH;
     }
 #endif //PAL_NET_TCP_AND_TLS_SUPPORT
 
-    memcpy(out_data->data + offset, data, data_len);
-    out_data->data_len = data_len + offset;
-
+    // One ESocketSend event drains the whole queue, so only post a new one
+    // if none is pending already.
     claim_mutex();
     ns_list_add_to_end(&_linked_list_send_data, out_data);
+    bool post_event = !_send_event_pending;
+    _send_event_pending = true;
     release_mutex();
 
-    if (!send_event(ESocketSend)) {
+    if (post_event && !send_event(ESocketSend)) {
         // Event push failed, free the buffer
         claim_mutex();
         ns_list_remove(&_linked_list_send_data, out_data);
+        _send_event_pending = false;
         release_mutex();
-        free(out_data->data);
-        free(out_data);
+        free_item(out_data);
         return false;
     }
 
@@ -583,22 +630,35 @@ bool M2MConnectionHandlerPimpl::send_data(uint8_t *data,
 void M2MConnectionHandlerPimpl::send_socket_data()
 {
     tr_debug("M2MConnectionHandlerPimpl::send_socket_data()");
+
+    // Drain the queue until it is empty, the socket would block or sending fails.
+    while (send_queued_data()) {
+    }
+}
+
+bool M2MConnectionHandlerPimpl::send_queued_data()
+{
     int bytes_sent = 0;
     bool success = true;
 
-    send_data_queue_s* out_data = get_item_from_list();
-    if (!out_data) {
-        return;
+    if (_socket_state < ESocketStateUnsecureConnection) {
+        tr_warn("M2MConnectionHandlerPimpl::send_socket_data() - too early");
+        return false;
     }
 
-    if (!out_data->data || !out_data->data_len || _socket_state < ESocketStateUnsecureConnection) {
-        tr_warn("M2MConnectionHandlerPimpl::send_socket_data() - too early");
-        add_item_to_list(out_data);
-        return;
+    // Non-secure datagrams go out in batches
+    if (_socket_state == ESocketStateUnsecureConnection && !is_tcp_connection()) {
+        return send_queued_datagrams();
+    }
+
+    send_data_queue_s* out_data = get_item_from_list();
+    if (!out_data) {
+        return false;
     }
 
     // Loop until all the data is sent
-    for (; out_data->offset < out_data->data_len; out_data->offset += bytes_sent) {
+    const uint32_t total_len = out_data->header_len + out_data->data_len;
+    for (; out_data->offset < total_len; out_data->offset += bytes_sent) {
         // Secure send
         if (_socket_state == ESocketStateSecureConnection) {
             // TODO! Change the send_message API to take bytes_sent as a out param like the pal send API's.
@@ -607,7 +667,7 @@ void M2MConnectionHandlerPimpl::send_socket_data()
                 if (bytes_sent == M2MConnectionHandler::CONNECTION_ERROR_WANTS_WRITE) {
                     // Return and wait the next event
                     add_item_to_list(out_data);
-                    return;
+                    return false;
                 }
 
                 if (bytes_sent != M2MConnectionHandler::CONNECTION_ERROR_WANTS_READ) {
@@ -620,40 +680,42 @@ void M2MConnectionHandlerPimpl::send_socket_data()
                 break;
             }
         }
-        // Unsecure send
+        // Unsecure TCP send, the rest of the length header and the data in one call
         else {
-            bytes_sent = 0;
-            palStatus_t ret;
-            if (is_tcp_connection()) {
 #ifdef PAL_NET_TCP_AND_TLS_SUPPORT
-                ret = pal_send(_socket,
-                               out_data->data + out_data->offset,
-                               out_data->data_len - out_data->offset,
-                               (size_t*)&bytes_sent);
-#endif
+            palSocketBuffer_t buffers[2];
+            uint32_t count = 0;
+            if (out_data->offset < out_data->header_len) {
+                buffers[count].buffer = out_data->header + out_data->offset;
+                buffers[count].length = out_data->header_len - out_data->offset;
+                count++;
+                buffers[count].buffer = out_data->data;
+                buffers[count].length = out_data->data_len;
+                count++;
             } else {
-                ret = pal_sendTo(_socket,
-                                 out_data->data + out_data->offset,
-                                 out_data->data_len - out_data->offset,
-                                 (palSocketAddress_t*)&_socket_address,
-                                 sizeof(_socket_address),
-                                 (size_t*)&bytes_sent);
+                buffers[count].buffer = out_data->data + (out_data->offset - out_data->header_len);
+                buffers[count].length = total_len - out_data->offset;
+                count++;
             }
+
+            size_t sent = 0;
+            palStatus_t ret = pal_sendVector(_socket, buffers, count, &sent);
+            bytes_sent = (int)sent;
             if (ret == PAL_ERR_SOCKET_WOULD_BLOCK) {
                 // Return and wait next event
                 add_item_to_list(out_data);
-                return;
+                return false;
             }
             if (ret < 0) {
                 tr_error("M2MConnectionHandlerPimpl::send_socket_data() - unsecure failed %" PRIx32, ret);
                 success = false;
                 break;
             }
+#endif //PAL_NET_TCP_AND_TLS_SUPPORT
         }
     }
 
-    free(out_data->data);
-    free(out_data);
+    free_item(out_data);
 
     if (!success) {
         if (bytes_sent == M2MConnectionHandler::SSL_PEER_CLOSE_NOTIFY) {
@@ -670,6 +732,66 @@ void M2MConnectionHandlerPimpl::send_socket_data()
     } else {
         _observer.data_sent();
     }
+
+    return success;
+}
+
+bool M2MConnectionHandlerPimpl::send_queued_datagrams()
+{
+    send_data_queue_s* batch[PAL_NET_MAX_SEND_BUFFERS];
+    palSocketBuffer_t datagrams[PAL_NET_MAX_SEND_BUFFERS];
+    uint32_t count = 0;
+    uint32_t sent = 0;
+
+    claim_mutex();
+    while (count < PAL_NET_MAX_SEND_BUFFERS) {
+        send_data_queue_s* out_data = (send_data_queue_s*)ns_list_get_first(&_linked_list_send_data);
+        if (!out_data) {
+            break;
+        }
+        ns_list_remove(&_linked_list_send_data, out_data);
+        batch[count] = out_data;
+        datagrams[count].buffer = out_data->data;
+        datagrams[count].length = out_data->data_len;
+        count++;
+    }
+    release_mutex();
+
+    if (count == 0) {
+        return false;
+    }
+
+    palStatus_t ret = pal_sendToBatch(_socket,
+                                      datagrams,
+                                      count,
+                                      (palSocketAddress_t*)&_socket_address,
+                                      sizeof(_socket_address),
+                                      &sent);
+
+    // A failed datagram is dropped like any failed send, the rest wait in order for the next event
+    const bool failed = (ret < 0 && ret != PAL_ERR_SOCKET_WOULD_BLOCK);
+    const uint32_t done = failed ? 1 : sent;
+    claim_mutex();
+    for (uint32_t index = count; index > done; index--) {
+        ns_list_add_to_start(&_linked_list_send_data, batch[index - 1]);
+    }
+    release_mutex();
+
+    for (uint32_t index = 0; index < done; index++) {
+        free_item(batch[index]);
+        if (!failed) {
+            _observer.data_sent();
+        }
+    }
+
+    if (failed) {
+        tr_error("M2MConnectionHandlerPimpl::send_socket_data() - unsecure failed %" PRIx32, ret);
+        _observer.socket_error(M2MConnectionHandler::SOCKET_SEND_ERROR, true);
+        close_socket();
+        return false;
+    }
+
+    return (ret == PAL_SUCCESS) && (sent == count);
 }
 
 bool M2MConnectionHandlerPimpl::start_listening_for_data()
@@ -716,6 +838,8 @@ void M2MConnectionHandlerPimpl::receive_handshake_handler()
 
     if (return_value == M2MConnectionHandler::ERROR_NONE) {
 
+        tr_info("M2MConnectionHandlerPimpl::receive_handshake_handler() - DNS %" PRIu32 " ms, connect %" PRIu32 " ms, handshake %" PRIu32 " ms",
+                _dns_time_ms, _connect_time_ms, connection_phase_time_ms());
         _handshake_retry = 0;
         _socket_state = ESocketStateSecureConnection;
         _observer.address_ready(_address,
@@ -727,6 +851,10 @@ void M2MConnectionHandlerPimpl::receive_handshake_handler()
         _observer.socket_error(M2MConnectionHandler::SSL_PEER_CLOSE_NOTIFY, true);
         close_socket();
 
+    } else if (return_value == M2MConnectionHandler::CONNECTION_ERROR_HANDSHAKE_IN_PROGRESS) {
+
+        send_handshake_step_event();
+
     } else if (return_value == M2MConnectionHandler::MEMORY_ALLOCATION_FAILED) {
 
         tr_error("M2MConnectionHandlerPimpl::receive_handshake_handler() - memory allocation failed");
@@ -766,6 +894,36 @@ void M2MConnectionHandlerPimpl::receive_handshake_handler()
     }
 }
 
+void M2MConnectionHandlerPimpl::send_handshake_step_event()
+{
+    // A queued socket event continues the handshake as well
+    if (_suppressable_event_in_flight) {
+        return;
+    }
+    _suppressable_event_in_flight = true;
+
+    arm_event_s event = {0};
+    event.receiver = M2MConnectionHandlerPimpl::_tasklet_id;
+    event.event_type = ESocketCallback;
+    event.data_ptr = this;
+    event.priority = ARM_LIB_LOW_PRIORITY_EVENT;
+    if (eventOS_event_send(&event) != 0) {
+        tr_error("M2MConnectionHandlerPimpl::send_handshake_step_event() - event send failed");
+        _suppressable_event_in_flight = false;
+        _handshake_retry = 0;
+        _observer.socket_error(M2MConnectionHandler::SSL_HANDSHAKE_ERROR, true);
+        close_socket();
+    }
+}
+
+uint32_t M2MConnectionHandlerPimpl::connection_phase_time_ms()
+{
+    uint64_t now = pal_osKernelSysTick();
+    uint32_t elapsed = (uint32_t)pal_osKernelSysMilliSecTick(now - _phase_start_tick);
+    _phase_start_tick = now;
+    return elapsed;
+}
+
 bool M2MConnectionHandlerPimpl::is_handshake_ongoing() const
 {
     return (_socket_state == ESocketStateHandshaking);
@@ -808,18 +966,16 @@ void M2MConnectionHandlerPimpl::receive_handler()
             }
         } while (rcv_size > 0 && _socket_state == ESocketStateSecureConnection);
 
+#ifdef PAL_NET_TCP_AND_TLS_SUPPORT
+    } else if (is_tcp_connection()) {
+        receive_tcp_handler();
+#endif //PAL_NET_TCP_AND_TLS_SUPPORT
     } else {
         size_t recv;
         palStatus_t status;
         unsigned char recv_buffer[BUFFER_LENGTH];
         do {
-            if (is_tcp_connection()) {
-#ifdef PAL_NET_TCP_AND_TLS_SUPPORT
-                status = pal_recv(_socket, recv_buffer, sizeof(recv_buffer), &recv);
-#endif //PAL_NET_TCP_AND_TLS_SUPPORT
-            } else {
-                status = pal_receiveFrom(_socket, recv_buffer, sizeof(recv_buffer), NULL, NULL, &recv);
-            }
+            status = pal_receiveFrom(_socket, recv_buffer, sizeof(recv_buffer), NULL, NULL, &recv);
 
             if (status == PAL_ERR_SOCKET_WOULD_BLOCK) {
                 return;
@@ -832,29 +988,97 @@ void M2MConnectionHandlerPimpl::receive_handler()
 
             tr_debug("M2MConnectionHandlerPimpl::receive_handler() - data received, len: %zu", recv);
 
-            if (!is_tcp_connection()) { // Observer for UDP plain mode
-                _observer.data_available((uint8_t*)recv_buffer, recv, _address);
-            } else {
+            // Observer for UDP plain mode
+            _observer.data_available((uint8_t*)recv_buffer, recv, _address);
+        } while (recv > 0 && _socket_state == ESocketStateUnsecureConnection);
+    }
+}
+
 #ifdef PAL_NET_TCP_AND_TLS_SUPPORT
-                if ( recv < 4 ) {
-                    tr_error("M2MConnectionHandlerPimpl::receive_handler() - TCP SOCKET_READ_ERROR");
-                    _observer.socket_error(M2MConnectionHandler::SOCKET_READ_ERROR, true);
-                    close_socket();
-                    return;
-                }
+void M2MConnectionHandlerPimpl::receive_tcp_handler()
+{
+    size_t recv;
+    palStatus_t status;
 
-                //We need to "shim" out the length from the front
-                uint32_t len = (recv_buffer[0] << 24 & 0xFF000000) + (recv_buffer[1] << 16 & 0xFF0000);
-                len += (recv_buffer[2] << 8 & 0xFF00) + (recv_buffer[3] & 0xFF);
-                if (len > 0 && len <= recv - 4) {
-                    // Observer for TCP plain mode
-                    _observer.data_available(recv_buffer + 4, len, _address);
-                }
-#endif //PAL_NET_TCP_AND_TLS_SUPPORT
+    if (!_tcp_recv_buffer) {
+        _tcp_recv_buffer = (uint8_t*)malloc(TCP_RECV_BUFFER_LENGTH);
+        if (!_tcp_recv_buffer) {
+            tr_error("M2MConnectionHandlerPimpl::receive_tcp_handler() - memory allocation failed!");
+            _observer.socket_error(M2MConnectionHandler::MEMORY_ALLOCATION_FAILED, false);
+            close_socket();
+            return;
+        }
+    }
+
+    // we need to read as much as there is data available as the events may or may not be suppressed
+    do {
+        status = pal_recv(_socket,
+                          _tcp_recv_buffer + _tcp_recv_buffer_used,
+                          TCP_RECV_BUFFER_LENGTH - _tcp_recv_buffer_used,
+                          &recv);
+
+        if (status == PAL_ERR_SOCKET_WOULD_BLOCK) {
+            return;
+        } else if (status != PAL_SUCCESS || recv == 0) {
+            tr_error("M2MConnectionHandlerPimpl::receive_tcp_handler() - SOCKET_READ_ERROR %" PRIx32, status);
+            _observer.socket_error(M2MConnectionHandler::SOCKET_READ_ERROR, true);
+            close_socket();
+            return;
+        }
+
+        tr_debug("M2MConnectionHandlerPimpl::receive_tcp_handler() - data received, len: %zu", recv);
+
+        _tcp_recv_buffer_used += recv;
+        if (!dispatch_tcp_frames()) {
+            return;
+        }
+    } while (_socket_state == ESocketStateUnsecureConnection);
+}
+
+bool M2MConnectionHandlerPimpl::dispatch_tcp_frames()
+{
+    uint16_t offset = 0;
+
+    while (_tcp_recv_buffer_used - offset >= TCP_FRAME_HEADER_LENGTH) {
+        uint8_t *frame = _tcp_recv_buffer + offset;
+        uint32_t available = _tcp_recv_buffer_used - offset;
+        uint32_t len = common_read_32_bit(frame);
+
+        // The whole frame must fit in the buffer, otherwise it could never be completed
+        if (len > TCP_RECV_BUFFER_LENGTH - TCP_FRAME_HEADER_LENGTH) {
+            tr_error("M2MConnectionHandlerPimpl::dispatch_tcp_frames() - frame too long: %" PRIu32, len);
+            _observer.socket_error(M2MConnectionHandler::SOCKET_READ_ERROR, true);
+            close_socket();
+            return false;
+        }
+
+        if (available < TCP_FRAME_HEADER_LENGTH + len) {
+            // Rest of the frame is still on its way
+            break;
+        }
+
+        offset += TCP_FRAME_HEADER_LENGTH + len;
+
+        if (len > 0) {
+            // Observer for TCP plain mode
+            _observer.data_available(frame + TCP_FRAME_HEADER_LENGTH, len, _address);
+
+            // The observer may have closed the connection, which also resets the buffer
+            if (_socket_state != ESocketStateUnsecureConnection) {
+                return false;
             }
-        } while (recv > 0 && _socket_state == ESocketStateUnsecureConnection);
+        }
     }
+
+    // Move the partial frame, if any, to the start of the buffer for the next read
+    if (offset) {
+        _tcp_recv_buffer_used -= offset;
+        memmove(_tcp_recv_buffer, _tcp_recv_buffer + offset, _tcp_recv_buffer_used);
+    }
+
+    return true;
 }
+#endif //PAL_NET_TCP_AND_TLS_SUPPORT
 
 void M2MConnectionHandlerPimpl::claim_mutex()
 {
@@ -943,6 +1167,11 @@ void M2MConnectionHandlerPimpl::close_socket()
     // make sure the socket connection statemachine is reset too.
     _socket_state = ESocketStateDisconnected;
 
+#ifdef PAL_NET_TCP_AND_TLS_SUPPORT
+    // A new connection starts a new stream, drop any partial frame
+    _tcp_recv_buffer_used = 0;
+#endif
+
     if (_security_impl) {
         _security_impl->reset();
     }
@@ -958,8 +1187,7 @@ void M2MConnectionHandlerPimpl::close_socket()
     while (!ns_list_is_empty(&_linked_list_send_data)) {
         send_data_queue_s* data = (send_data_queue_s*)ns_list_get_first(&_linked_list_send_data);
         ns_list_remove(&_linked_list_send_data, data);
-        free(data->data);
-        free(data);
+        free_item(data);
     }
     release_mutex();
 }
@@ -982,6 +1210,14 @@ void M2MConnectionHandlerPimpl::add_item_to_list(M2MConnectionHandlerPimpl::send
     release_mutex();
 }
 
+void M2MConnectionHandlerPimpl::free_item(M2MConnectionHandlerPimpl::send_data_queue_s *data)
+{
+    if (data->data_taken) {
+        free(data->data);
+    }
+    free(data);
+}
+
 void M2MConnectionHandlerPimpl::force_close()
 {
     close_socket();
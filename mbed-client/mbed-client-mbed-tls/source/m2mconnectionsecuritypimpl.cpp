@@ -254,6 +254,9 @@ int M2MConnectionSecurityPimpl::start_handshake()
     if (ret == PAL_ERR_TLS_WANT_READ || ret == PAL_ERR_TLS_WANT_WRITE || ret == PAL_ERR_TIMEOUT_EXPIRED){
         return M2MConnectionHandler::CONNECTION_ERROR_WANTS_READ;
     }
+    else if (ret == PAL_ERR_TLS_HANDSHAKE_IN_PROGRESS) {
+        return M2MConnectionHandler::CONNECTION_ERROR_HANDSHAKE_IN_PROGRESS;
+    }
     else if (ret == PAL_ERR_TLS_PEER_CLOSE_NOTIFY) {
         return M2MConnectionHandler::SSL_PEER_CLOSE_NOTIFY;
     }
@@ -272,6 +275,12 @@ int M2MConnectionSecurityPimpl::start_handshake()
         return M2MConnectionHandler::ERROR_GENERIC;
     }
 
+    palTLSHandshakeTimes_t times;
+    if (pal_sslGetHandshakeTimes(_ssl, &times) == PAL_SUCCESS) {
+        tr_info("M2MConnectionSecurityPimpl::start_handshake - hello %" PRIu32 " ms, certificate %" PRIu32 " ms, key exchange %" PRIu32 " ms, finished %" PRIu32 " ms",
+                times.hello, times.certificate, times.keyExchange, times.finished);
+    }
+
     return ret;
 }
 
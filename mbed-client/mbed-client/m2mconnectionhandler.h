@@ -51,6 +51,7 @@ public:
         DNS_RESOLVING_ERROR = -10,
         SSL_HANDSHAKE_ERROR = -11,
         FAILED_TO_READ_CREDENTIALS = -12,
+        CONNECTION_ERROR_HANDSHAKE_IN_PROGRESS = -13,
     } ConnectionError;
 
 public:
@@ -101,6 +102,18 @@ public:
                            uint16_t data_len,
                            sn_nsdl_addr_s *address_ptr);
 
+    /**
+    * \brief Sends data to the connected server without copying it.
+    * \param data_ptr The data to be sent, allocated with malloc(). The connection
+    * handler releases it with free() once it is sent or dropped, also when false is returned.
+    * \param data_len The length of data to be sent.
+    * \param address_ptr The address structure to which the data needs to be sent.
+    * \return True if data is queued for sending successfully, else false.
+    */
+    bool send_data_take(uint8_t *data_ptr,
+                        uint16_t data_len,
+                        sn_nsdl_addr_s *address_ptr);
+
     /**
     * \brief Listens to the incoming data from a remote server.
     * \return True if successful, else false.
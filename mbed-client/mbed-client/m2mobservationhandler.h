@@ -21,6 +21,7 @@
 #include "mbed-client/coap_response.h"
 //FORWARD DECLARATION
 class M2MResourceInstance;
+class M2MReportHandler;
 
 /*! \file m2mobservationhandler.h
  * \brief M2MObservationHandler.
@@ -67,6 +68,13 @@ class M2MObservationHandler
      */
     virtual void remove_object(M2MBase *object) = 0;
 
+    /**
+     * \brief A callback indicating that a report handler has queued a notification,
+     * started sending one, or has none pending anymore.
+     * \param handler The report handler whose notification state changed.
+     */
+    virtual void update_pending_notification(M2MReportHandler &handler) { (void)handler; }
+
 #ifndef DISABLE_DELAYED_RESPONSE
     /**
      * \brief Sends a delayed post response to the server with 'COAP_MSG_CODE_RESPONSE_CHANGED' response code.
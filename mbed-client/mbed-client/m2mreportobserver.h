@@ -17,8 +17,12 @@
 #define M2MREPORTOBSERVER_H
 
 #include <inttypes.h>
+#include <stddef.h>
 #include <mbed-client/m2mvector.h>
 
+//FORWARD DECLARATION
+class M2MObservationHandler;
+
 /*! \file m2mreportobserver.h
  * \brief M2MReportObserver.
  * An interface for inviting the base class
@@ -42,6 +46,12 @@ class M2MReportObserver
                                         uint16_t obs_number,
                                         bool send_object = false) = 0;
 
+    /**
+     * \brief Returns the handler which sends the notifications.
+     * \return The observation handler, NULL if not set.
+     */
+    virtual M2MObservationHandler* observation_handler() const { return NULL; }
+
 };
 
 #endif // M2MREPORTOBSERVER_H
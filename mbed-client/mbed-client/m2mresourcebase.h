@@ -306,6 +306,28 @@ public:
      */
     bool set_value_float(float value);
 
+    /**
+     * \brief Enables or disables native value storage for a numeric resource.
+     * When enabled, set_value(int64_t) and set_value_float() keep the value
+     * in binary form instead of converting it to a heap allocated string.
+     * The text payload is generated only when the value is read through
+     * value(), value_length(), get_value() or serialized to a response or
+     * notification, and get_value_int()/get_value_float() return the stored
+     * number without parsing.
+     * \param enable True to enable, false to go back to text storage.
+     * \return True if the mode was set, false if the resource is not a
+     * dynamic INTEGER, FLOAT, BOOLEAN or TIME resource.
+     * \note Values are always stored as text if a value set callback or
+     * resource write callback is set.
+     */
+    bool set_native_value_storage(bool enable);
+
+    /**
+     * \brief Returns whether native value storage is enabled.
+     * \return True if enabled, else false.
+     */
+    bool native_value_storage() const;
+
     /**
      * \brief Clears the value of a given resource.
      */
@@ -508,6 +530,26 @@ private:
 
     M2MResourceBase::ResourceType convert_data_type(M2MBase::DataType type) const;
 
+    /**
+     * \brief Stores a numeric value in native form, if native value storage is in use.
+     * Callers pass the same value converted to both types, as the resource type
+     * decides which one is kept.
+     * \param int_value Value to store for non-FLOAT resources.
+     * \param float_value Value to store for FLOAT resources.
+     * \return True if the value was stored, false if it must be stored as text.
+     */
+    bool set_native_value(int64_t int_value, float float_value);
+
+    /**
+     * \brief Formats the native value into the resource text buffer if it is out of date.
+     */
+    void update_native_value_text() const;
+
+    /**
+     * \brief Marks the text value as the current one after it has been replaced.
+     */
+    void clear_native_value();
+
 private:
 
 #ifndef DISABLE_BLOCK_MESSAGE
@@ -516,6 +558,16 @@ private:
 
     NotificationStatus    _notification_status : 2;
 
+    bool                  _native_value_storage : 1;
+    bool                  _native_value_set : 1;         // _native_value is the current value
+    mutable bool          _native_value_text_stale : 1;  // resource text does not match _native_value
+    mutable bool          _native_value_buffer : 1;      // resource text buffer is NATIVE_VALUE_BUFFER_SIZE long
+
+    union {
+        int64_t           int_value;
+        float             float_value;
+    } _native_value;
+
     friend class Test_M2MResourceInstance;
     friend class Test_M2MResource;
     friend class Test_M2MObjectInstance;
@@ -314,6 +314,10 @@ protected: // From M2MNsdlObserver
                                     uint16_t data_len,
                                     sn_nsdl_addr_s *address_ptr);
 
+    virtual void coap_message_take(uint8_t *data_ptr,
+                                   uint16_t data_len,
+                                   sn_nsdl_addr_s *address_ptr);
+
     virtual void client_registered(M2MServer *server_object);
 
     virtual void registration_updated(const M2MServer &server_object);
@@ -532,6 +536,11 @@ private: // state machine state functions
     */
     bool queue_mode() const;
 
+    /**
+    * Handles a CoAP message the connection handler could not queue for sending.
+    */
+    void coap_message_send_failed();
+
     enum
     {
         EVENT_IGNORED = 0xFE,
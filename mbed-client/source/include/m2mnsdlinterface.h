@@ -26,6 +26,7 @@
 #include "mbed-client/m2mbase.h"
 #include "mbed-client/m2mserver.h"
 #include "include/nsdllinker.h"
+#include "include/m2mpathindex.h"
 #include "eventOS_event.h"
 
 //FORWARD DECLARARTION
@@ -240,6 +241,22 @@ public:
                                     uint16_t data_len,
                                     sn_nsdl_addr_s *address);
 
+    /**
+    * @brief Callback from nsdl library to hand over a new message
+    * to be sent to server, the buffer is freed once it is sent.
+    * @param nsdl_handle, Handler for the nsdl structure for this endpoint
+    * @param protocol, Protocol format of the data
+    * @param data, Data to be sent, allocated with malloc().
+    * @param data_len, Size of the data to be sent
+    * @param address, server address where data has to be sent.
+    * @return 1 if successful else 0.
+    */
+    uint8_t send_to_server_take_callback(struct nsdl_s * nsdl_handle,
+                                         sn_nsdl_capab_e protocol,
+                                         uint8_t *data,
+                                         uint16_t data_len,
+                                         sn_nsdl_addr_s *address);
+
     /**
     * @brief Callback from nsdl library to inform the data which is
     * received from server for the client has been converted to coap message.
@@ -455,6 +472,8 @@ protected: // from M2MObservationHandler
     virtual void value_updated(M2MBase *base);
 
     virtual void remove_object(M2MBase *object);
+
+    virtual void update_pending_notification(M2MReportHandler &handler);
 #ifndef DISABLE_DELAYED_RESPONSE
     virtual void send_delayed_response(M2MBase *base);
 #endif //DISABLE_DELAYED_RESPONSE
@@ -526,6 +545,25 @@ private:
                            const String &object_name,
                            const String &resource_instance) const;
 
+    /**
+     * @brief Adds the object to the path index used by find_resource().
+     * Only objects having this interface as their observation handler are
+     * added, as only their deletion is reported to this interface.
+     * @param base Object to be added.
+     */
+    void add_to_path_index(M2MBase *base);
+
+    /**
+     * @brief Removes the object and all its children from the path index.
+     * @param base Object to be removed.
+     */
+    void remove_from_path_index(M2MBase *base);
+
+    /**
+     * @brief Unlinks all report handlers from the pending notification queue.
+     */
+    void clear_pending_notifications();
+
     bool object_present(M2MBase *base) const;
 
     int object_index(M2MBase *base) const;
@@ -721,6 +759,7 @@ private:
 private:
     M2MNsdlObserver                         &_observer;
     M2MBaseList                             _base_list;
+    M2MPathIndex                            _path_index;
     sn_nsdl_ep_parameters_s                 *_endpoint;
     nsdl_s                                  *_nsdl_handle;
     M2MSecurity                             *_security; // Not owned
@@ -737,6 +776,9 @@ private:
     response_list_t                         _response_list;
     char                                    *_custom_uri_query_params;
     M2MNotificationHandler                  *_notification_handler;
+    // Report handlers having a notification queued or in progress, protected by the mutex
+    M2MReportHandler                        *_pending_notification_head;
+    M2MReportHandler                        *_pending_notification_tail;
     arm_event_storage_t                     _event;
     uint16_t                                _auto_obs_token;
     uint16_t                                _bootstrap_id;
@@ -747,6 +789,8 @@ private:
     bool                                    _notification_send_ongoing;
     bool                                    _registered;
     bool                                    _bootstrap_finish_ack_received;
+    // Set once an object was left out of _path_index, see add_to_path_index()
+    bool                                    _path_index_partial;
     M2MTimer                                _download_retry_timer;
     uint64_t                                _download_retry_time;
 
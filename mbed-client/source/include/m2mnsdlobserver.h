@@ -41,6 +41,17 @@ public :
                                     uint16_t data_len,
                                     sn_nsdl_addr_s *address_ptr) = 0;
 
+    /**
+    * @brief Informs that coap message is ready and hands its buffer over.
+    * @param data_ptr, Data object of coap message, released with free()
+    * once it is sent or dropped.
+    * @param data_len, Length of the data object.
+    * @param address_ptr, Address structure of the server.
+    */
+    virtual void coap_message_take(uint8_t *data_ptr,
+                                   uint16_t data_len,
+                                   sn_nsdl_addr_s *address_ptr) = 0;
+
     /**
     * @brief Informs that client is registered successfully.
     * @param server_object, Server object associated with
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2018 ARM Limited. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef M2M_PATH_INDEX_H
+#define M2M_PATH_INDEX_H
+
+#include <stdint.h>
+
+class M2MBase;
+
+/**
+ *  @brief M2MPathIndex.
+ *  Open addressing hash table mapping URI paths to M2MBase objects.
+ *  The index does not own the objects, the caller must remove an object
+ *  before it is deleted.
+ */
+class M2MPathIndex
+{
+private:
+    // Prevents the use of assignment operator and copy constructor by accident.
+    M2MPathIndex& operator=(const M2MPathIndex& /*other*/);
+    M2MPathIndex(const M2MPathIndex& /*other*/);
+
+public:
+
+    M2MPathIndex();
+
+    ~M2MPathIndex();
+
+    /**
+     * \brief Adds the object to the index, using its uri_path() as key.
+     * Adding an object which is already indexed has no effect.
+     * \param base The object to add.
+     * \return True if the object is indexed, false if the memory allocation
+     * failed. The index is then invalid until clear() is called.
+     */
+    bool insert(M2MBase *base);
+
+    /**
+     * \brief Removes the object from the index.
+     * \param base The object to remove.
+     */
+    void remove(const M2MBase *base);
+
+    /**
+     * \brief Finds the object with the given URI path.
+     * \param path The URI path, without leading '/'.
+     * \return The object if found, else NULL.
+     */
+    M2MBase *find(const char *path) const;
+
+    /**
+     * \brief Returns whether the index holds all the inserted objects,
+     * this is false after a failed memory allocation.
+     */
+    bool is_valid() const;
+
+    /**
+     * \brief Removes all the objects and releases the table.
+     */
+    void clear();
+
+private:
+
+    static uint32_t hash(const char *path);
+
+    uint32_t slot(const char *path) const;
+
+    bool grow();
+
+private:
+
+    M2MBase         **_table;
+    uint32_t        _capacity;
+    uint32_t        _count;
+    bool            _valid;
+};
+
+#endif // M2M_PATH_INDEX_H
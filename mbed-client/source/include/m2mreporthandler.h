@@ -227,6 +227,14 @@ public:
      */
     bool blockwise_notify() const;
 
+    /**
+     * @brief Returns the next report handler which has a notification
+     * queued or in progress.
+     *
+     * @return Next pending report handler, NULL if this is the last one.
+     */
+    M2MReportHandler* next_pending_notification() const;
+
 protected : // from M2MTimerObserver
 
     virtual void timer_expired(M2MTimerObserver::Type type =
@@ -285,6 +293,12 @@ private:
     */
     void send_value();
 
+    /**
+     * \brief Adds to or removes from the pending notification
+     * queue of the observation handler according to the notification flags.
+     */
+    void update_pending_notification();
+
 private:
     M2MReportObserver           &_observer;
     bool                        _is_under_observation : 1;
@@ -313,8 +327,15 @@ private:
     bool                        _notification_in_queue : 1;
     bool                        _blockwise_notify : 1;
     bool                        _pmin_quiet_period : 1;
+    // Membership in the pending notification queue of _pending_owner, protected by its
+    // mutex. Not a bitfield, as the flags above are written without holding that mutex.
+    bool                        _notification_pending;
+    M2MObservationHandler       *_pending_owner;
+    M2MReportHandler            *_pending_prev;
+    M2MReportHandler            *_pending_next;
 
 friend class Test_M2MReportHandler;
+friend class M2MNsdlInterface;
 
 };
 
@@ -114,23 +114,26 @@ public :
 
 private:
 
+    /*
+     * The private methods get the value span of one TLV level and walk it
+     * with M2MTLVIterator, so the payload is parsed once per pass and
+     * values are passed to the resources straight from the CoAP payload.
+     */
+
     static M2MTLVDeserializer::Error deserialize_object_instances(const uint8_t *tlv,
                                                            uint32_t tlv_size,
-                                                           uint32_t offset,
                                                            M2MObject &object,
                                                            M2MTLVDeserializer::Operation operation,
                                                            bool update_value);
 
     static M2MTLVDeserializer::Error deserialize_resources(const uint8_t *tlv,
                                                     uint32_t tlv_size,
-                                                    uint32_t offset,
                                                     M2MObjectInstance &object_instance,
                                                     M2MTLVDeserializer::Operation operation,
                                                     bool update_value);
 
     static M2MTLVDeserializer::Error deserialize_resource_instances(const uint8_t *tlv,
                                                              uint32_t tlv_size,
-                                                             uint32_t offset,
                                                              M2MResource &resource,
                                                              M2MObjectInstance &object_instance,
                                                              M2MTLVDeserializer::Operation operation,
@@ -138,7 +141,6 @@ private:
 
     static M2MTLVDeserializer::Error deserialize_resource_instances(const uint8_t *tlv,
                                                              uint32_t tlv_size,
-                                                             uint32_t offset,
                                                              M2MResource &resource,
                                                              M2MTLVDeserializer::Operation operation,
                                                              bool update_value);
@@ -153,15 +155,26 @@ private:
 
     static bool set_resource_instance_value(M2MResourceBase *res, const uint8_t *tlv, const uint32_t size);
 
+    static M2MTLVDeserializer::Error update_resource_instance_value(M2MResourceBase *res,
+                                                             const uint8_t *tlv,
+                                                             uint32_t size,
+                                                             bool update_value);
+
+    /*
+     * Find functions start from the position after the previous match, so
+     * a payload in the same order as the list is matched in linear time.
+     */
+    static M2MResource* find_resource(const M2MResourceList &list, uint16_t id, bool multiple, int &hint);
+
+    static M2MResourceInstance* find_resource_instance(const M2MResourceInstanceList &list, uint16_t id, int &hint);
+
     static void remove_resources(const uint8_t *tlv,
                                  uint32_t tlv_size,
-                                 M2MObjectInstance &object_instance,
-                                 uint32_t offset_size);
+                                 M2MObjectInstance &object_instance);
 
     static void remove_resource_instances(const uint8_t *tlv,
                                  uint32_t tlv_size,
-                                 M2MResource &resource,
-                                 uint32_t offset_size);
+                                 M2MResource &resource);
 };
 
 class TypeIdLength {
@@ -183,3 +196,58 @@ public:
 
     friend class Test_M2MTLVDeserializer;
 };
+
+/**
+ * @brief M2MTLVIterator
+ * Walks the TLVs of one level of an OMA-TLV payload without copying them.
+ * The value of a nested TLV (object instance or multiple resource) can be
+ * walked with another iterator over value() and length().
+ */
+class M2MTLVIterator {
+
+public:
+    M2MTLVIterator(const uint8_t *tlv, uint32_t tlv_size);
+
+    /**
+     * Moves to the next TLV.
+     * @return True if there is a TLV, false at the end of the payload or if
+     * the next TLV does not fit in the payload.
+     */
+    bool next();
+
+    /**
+     * Moves back to the start of the payload.
+     */
+    void rewind();
+
+    /**
+     * @return False if a TLV header or value did not fit in the payload.
+     */
+    bool is_valid() const;
+
+    /**
+     * @return Offset of the current TLV from the start of the payload.
+     */
+    uint32_t offset() const;
+
+    uint8_t type() const;
+
+    uint16_t id() const;
+
+    const uint8_t *value() const;
+
+    uint32_t length() const;
+
+private:
+    const uint8_t   *_tlv;
+    uint32_t        _tlv_size;
+    uint32_t        _offset;
+    uint32_t        _next_offset;
+    uint32_t        _value_offset;
+    uint32_t        _length;
+    uint16_t        _id;
+    uint8_t         _type;
+    bool            _valid;
+
+    friend class Test_M2MTLVDeserializer;
+};
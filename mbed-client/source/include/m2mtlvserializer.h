@@ -78,27 +78,55 @@ public:
 
 private :
 
-    static uint8_t* serialize_object_instances(const M2MObjectInstanceList &object_instance_list, uint32_t &size);
+    /*
+     * Serialization is done in two passes over the same functions. In the
+     * first pass data is NULL, the content is validated and only the encoded
+     * length is accumulated into size. The value lengths of nested TLVs
+     * (object instances and multiple resources) are recorded so that the
+     * second pass can write their headers without measuring them again.
+     * The second pass writes into a single, exactly sized buffer.
+     */
+    struct tlv_buffer_s {
+        tlv_buffer_s() : data(NULL), capacity(0), size(0), nested_index(0) {}
+
+        uint8_t                 *data;
+        uint32_t                capacity;
+        uint32_t                size;
+        m2m::Vector<uint32_t>   nested_sizes;
+        int                     nested_index;
+    };
+
+    static bool begin_write(tlv_buffer_s &buffer);
+
+    static bool end_write(tlv_buffer_s &buffer);
+
+    static bool serialize_object_instances(const M2MObjectInstanceList &object_instance_list, tlv_buffer_s &buffer);
+
+    static bool serialize_resources(const M2MResourceList &resource_list, tlv_buffer_s &buffer);
+
+    static bool serialize(uint16_t id, const M2MObjectInstance *object_instance, tlv_buffer_s &buffer);
+
+    static bool serialize(const M2MResource *resource, tlv_buffer_s &buffer);
+
+    static bool serialize_resource(uint16_t id, const M2MResource *resource, tlv_buffer_s &buffer);
+
+    static bool serialize_multiple_resource(uint16_t id, const M2MResource *resource, tlv_buffer_s &buffer);
 
-    static uint8_t* serialize_resources(const M2MResourceList &resource_list, uint32_t &size, bool &valid);
+    static bool serialize_resource_instance(uint16_t id, const M2MResourceInstance *resource, tlv_buffer_s &buffer);
 
-    static bool serialize(uint16_t id, const M2MObjectInstance *object_instance, uint8_t *&data, uint32_t &size);
-    
-    static bool serialize(const M2MResource *resource, uint8_t *&data, uint32_t &size);
+    static bool begin_nested_TLV(uint8_t type, uint16_t id, uint32_t &start, int &index, tlv_buffer_s &buffer);
 
-    static bool serialize_resource(const M2MResource *resource, uint8_t *&data, uint32_t &size);
+    static bool end_nested_TLV(uint8_t type, uint16_t id, bool success, uint32_t start, int index, tlv_buffer_s &buffer);
 
-    static bool serialize_multiple_resource(const M2MResource *resource, uint8_t *&data, uint32_t &size);
+    static bool serialize_TILV (uint8_t type, uint16_t id, const uint8_t *value, uint32_t value_length, tlv_buffer_s &buffer);
 
-    static bool serialize_resource_instance(uint16_t id, const M2MResourceInstance *resource, uint8_t *&data, uint32_t &size);
-    
-    static bool serialize_TILV (uint8_t type, uint16_t id, uint8_t *value, uint32_t value_length, uint8_t *&data, uint32_t &size);
+    static bool serialize_TIL(uint8_t type, uint16_t id, uint32_t value_length, tlv_buffer_s &buffer);
 
     static void serialize_id(uint16_t id, uint32_t &size, uint8_t *id_ptr);
 
     static void serialize_length(uint32_t length, uint32_t &size, uint8_t *length_ptr);
 
-    static bool serialize_TLV_binary_int(const M2MResourceBase *resource, uint8_t type, uint16_t id, uint8_t *&data, uint32_t &size);
+    static bool serialize_TLV_binary_int(const M2MResourceBase *resource, uint8_t type, uint16_t id, tlv_buffer_s &buffer);
 
-    static bool serialize_TLV_binary_float(const M2MResourceBase *resource, uint8_t type, uint16_t id, uint8_t *&data, uint32_t &size);
+    static bool serialize_TLV_binary_float(const M2MResourceBase *resource, uint8_t type, uint16_t id, tlv_buffer_s &buffer);
 };
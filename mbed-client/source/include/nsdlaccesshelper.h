@@ -39,6 +39,12 @@ uint8_t __nsdl_c_send_to_server(struct nsdl_s * nsdl_handle,
                                 uint16_t data_len,
                                 sn_nsdl_addr_s *address_ptr);
 
+uint8_t __nsdl_c_send_to_server_take(struct nsdl_s * nsdl_handle,
+                                     sn_nsdl_capab_e protocol,
+                                     uint8_t *data_ptr,
+                                     uint16_t data_len,
+                                     sn_nsdl_addr_s *address_ptr);
+
 uint8_t __nsdl_c_received_from_server(struct nsdl_s * nsdl_handle,
                                       sn_coap_hdr_s *coap_header,
                                       sn_nsdl_addr_s *address_ptr);
@@ -211,6 +211,7 @@ void M2MBase::set_interface_description(const char *desc)
         _sn_resource->dynamic_resource_params->static_resource_parameters->interface_description_ptr =
                 (char*)alloc_string_copy((uint8_t*) desc, len);
     }
+    sn_nsdl_resource_attributes_changed(_sn_resource->dynamic_resource_params);
     set_changed();
 }
 
@@ -238,6 +239,7 @@ void M2MBase::set_resource_type(const char *res_type)
         _sn_resource->dynamic_resource_params->static_resource_parameters->resource_type_ptr = (char*)
                 alloc_string_copy((uint8_t*) res_type, len);
     }
+    sn_nsdl_resource_attributes_changed(_sn_resource->dynamic_resource_params);
     set_changed();
 }
 #endif // DISABLE_RESOURCE_TYPE
@@ -252,6 +254,7 @@ void M2MBase::set_interface_description(const char *desc)
         item.attribute_name = ATTR_INTERFACE_DESCRIPTION;
         item.value = (char*)alloc_string_copy((uint8_t*) desc, len);
         sn_nsdl_set_resource_attribute(_sn_resource->dynamic_resource_params->static_resource_parameters, &item);
+        sn_nsdl_resource_attributes_changed(_sn_resource->dynamic_resource_params);
         set_changed();
     }
 }
@@ -277,6 +280,7 @@ void M2MBase::set_resource_type(const char *res_type)
         item.attribute_name = ATTR_RESOURCE_TYPE;
         item.value = (char*)alloc_string_copy((uint8_t*) res_type, len);
         sn_nsdl_set_resource_attribute(_sn_resource->dynamic_resource_params->static_resource_parameters, &item);
+        sn_nsdl_resource_attributes_changed(_sn_resource->dynamic_resource_params);
         set_changed();
     }
 }
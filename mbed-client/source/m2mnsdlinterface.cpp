@@ -168,6 +168,8 @@ M2MNsdlInterface::M2MNsdlInterface(M2MNsdlObserver &observer, M2MConnectionHandl
   _server_address(NULL),
   _custom_uri_query_params(NULL),
   _notification_handler(new M2MNotificationHandler()),
+  _pending_notification_head(NULL),
+  _pending_notification_tail(NULL),
   _bootstrap_id(0),
   _binding_mode(M2MInterface::NOT_SET),
   _identity_accepted(false),
@@ -175,6 +177,7 @@ M2MNsdlInterface::M2MNsdlInterface(M2MNsdlObserver &observer, M2MConnectionHandl
   _notification_send_ongoing(false),
   _registered(false),
   _bootstrap_finish_ack_received(false),
+  _path_index_partial(false),
   _download_retry_timer(*this),
   _download_retry_time(0)
 {
@@ -197,6 +200,8 @@ M2MNsdlInterface::M2MNsdlInterface(M2MNsdlObserver &observer, M2MConnectionHandl
                  &(__nsdl_c_memory_alloc), &(__nsdl_c_memory_free), &(__nsdl_c_auto_obs_token));
 
     sn_nsdl_set_context(_nsdl_handle, this);
+    // New messages are queued for sending without a copy
+    sn_nsdl_set_tx_take_callback(_nsdl_handle, &(__nsdl_c_send_to_server_take));
 
     ns_hal_init(NULL, MBED_CLIENT_EVENT_LOOP_SIZE, NULL, NULL);
     eventOS_scheduler_mutex_wait();
@@ -229,6 +234,8 @@ M2MNsdlInterface::~M2MNsdlInterface()
     _base_list.clear();
     _security = NULL;
     delete _server;
+    _path_index.clear();
+    clear_pending_notifications();
     sn_nsdl_destroy(_nsdl_handle);
     _nsdl_handle = NULL;
     memory_free(_server_address);
@@ -688,6 +695,17 @@ uint8_t M2MNsdlInterface::send_to_server_callback(struct nsdl_s * /*nsdl_handle*
     return 1;
 }
 
+uint8_t M2MNsdlInterface::send_to_server_take_callback(struct nsdl_s * /*nsdl_handle*/,
+                                                       sn_nsdl_capab_e /*protocol*/,
+                                                       uint8_t *data_ptr,
+                                                       uint16_t data_len,
+                                                       sn_nsdl_addr_s *address)
+{
+    tr_debug("M2MNsdlInterface::send_to_server_take_callback(data size %d)", data_len);
+    _observer.coap_message_take(data_ptr,data_len,address);
+    return 1;
+}
+
 uint8_t M2MNsdlInterface::received_from_server_callback(struct nsdl_s *nsdl_handle,
                                                         sn_coap_hdr_s *coap_header,
                                                         sn_nsdl_addr_s *address)
@@ -1348,6 +1366,7 @@ void M2MNsdlInterface::resource_to_be_deleted(M2MBase *base)
     tr_debug("M2MNsdlInterface::resource_to_be_deleted() %p", base);
     claim_mutex();
     remove_nsdl_resource(base);
+    _path_index.remove(base);
 #if !defined(DISABLE_DELAYED_RESPONSE) || defined(ENABLE_ASYNC_REST_RESPONSE)
     remove_items_from_response_list_for_uri(base->uri_path());
 #endif
@@ -1412,6 +1431,7 @@ void M2MNsdlInterface::remove_object(M2MBase *object)
         int index = 0;
         for ( ; it != _base_list.end(); it++, index++ ) {
             if((*it)->base_type() == M2MBase::Object && (*it) == rem_object) {
+                remove_from_path_index(rem_object);
                 _base_list.erase(index);
                 break;
             }
@@ -1493,6 +1513,9 @@ bool M2MNsdlInterface::create_nsdl_object_structure(M2MObject *object)
     if (object && object->operation() != M2MBase::NOT_ALLOWED) {
         success = create_nsdl_resource(object);
     } else {
+        if (object) {
+            add_to_path_index(object);
+        }
         success = true;
     }
 
@@ -1523,6 +1546,7 @@ bool M2MNsdlInterface::create_nsdl_object_instance_structure(M2MObjectInstance *
         if (object_instance->operation() != M2MBase::NOT_ALLOWED) {
             success = create_nsdl_resource(object_instance);
         } else {
+            add_to_path_index(object_instance);
             success = true;
         }
     }
@@ -1550,6 +1574,8 @@ bool M2MNsdlInterface::create_nsdl_resource_structure(M2MResource *res,
                 }
                 // Register the main Resource as well along with ResourceInstances
                 success = create_nsdl_resource(res);
+            } else {
+                add_to_path_index(res);
             }
         } else {
             success = create_nsdl_resource(res);
@@ -1571,6 +1597,7 @@ bool M2MNsdlInterface::create_nsdl_resource(M2MBase *base)
         if (base->observation_handler() == NULL) {
             base->set_observation_handler(this);
         }
+        add_to_path_index(base);
 
         result = sn_nsdl_put_resource(_nsdl_handle, nsdl_resource);
 
@@ -1667,7 +1694,13 @@ M2MBase* M2MNsdlInterface::find_resource(const String &object_name) const
     tr_debug("M2MNsdlInterface::find_resource(object level) - from %p name (%s) ", this, object_name.c_str());
     M2MObject *current = NULL;
     M2MBase *found = NULL;
-    if(!_base_list.empty()) {
+    // The index holds the objects created through create_nsdl_*_structure(),
+    // walk the tree only if the index could not be maintained or if some
+    // objects were left out of it.
+    if (_path_index.is_valid()) {
+        found = _path_index.find(object_name.c_str());
+    }
+    if (!found && (!_path_index.is_valid() || _path_index_partial) && !_base_list.empty()) {
         M2MBaseList::const_iterator it;
         it = _base_list.begin();
         for ( ; it != _base_list.end(); it++ ) {
@@ -1812,6 +1845,119 @@ M2MBase* M2MNsdlInterface::find_resource(const M2MResource *resource,
     return res;
 }
 
+void M2MNsdlInterface::add_to_path_index(M2MBase *base)
+{
+    // Deleted objects are removed from the index in resource_to_be_deleted(),
+    // which is not called for objects without this interface as their handler.
+    // Objects not published to the server do not get a handler, so leave them
+    // out and let find_resource() walk the tree when the index has no match.
+    if (base->observation_handler() != this) {
+        _path_index_partial = true;
+        return;
+    }
+    _path_index.insert(base);
+
+    // Pick up a notification queued before the object was added to this interface
+    if (base->report_handler()) {
+        base->report_handler()->update_pending_notification();
+    }
+}
+
+void M2MNsdlInterface::update_pending_notification(M2MReportHandler &handler)
+{
+    claim_mutex();
+    bool pending = handler._notification_in_queue || handler._notification_send_in_progress;
+    if (pending != handler._notification_pending) {
+        if (pending) {
+            handler._pending_owner = this;
+            handler._pending_prev = _pending_notification_tail;
+            handler._pending_next = NULL;
+            if (_pending_notification_tail) {
+                _pending_notification_tail->_pending_next = &handler;
+            } else {
+                _pending_notification_head = &handler;
+            }
+            _pending_notification_tail = &handler;
+        } else {
+            if (handler._pending_prev) {
+                handler._pending_prev->_pending_next = handler._pending_next;
+            } else {
+                _pending_notification_head = handler._pending_next;
+            }
+            if (handler._pending_next) {
+                handler._pending_next->_pending_prev = handler._pending_prev;
+            } else {
+                _pending_notification_tail = handler._pending_prev;
+            }
+            handler._pending_owner = NULL;
+            handler._pending_prev = NULL;
+            handler._pending_next = NULL;
+        }
+        handler._notification_pending = pending;
+    }
+    release_mutex();
+}
+
+void M2MNsdlInterface::clear_pending_notifications()
+{
+    claim_mutex();
+    M2MReportHandler *handler = _pending_notification_head;
+    while (handler) {
+        M2MReportHandler *next = handler->_pending_next;
+        handler->_notification_pending = false;
+        handler->_pending_owner = NULL;
+        handler->_pending_prev = NULL;
+        handler->_pending_next = NULL;
+        handler = next;
+    }
+    _pending_notification_head = NULL;
+    _pending_notification_tail = NULL;
+    release_mutex();
+}
+
+void M2MNsdlInterface::remove_from_path_index(M2MBase *base)
+{
+    switch (base->base_type()) {
+#ifdef MBED_CLOUD_CLIENT_EDGE_EXTENSION
+        case M2MBase::ObjectDirectory: {
+            const M2MObjectList &list = static_cast<M2MEndpoint*> (base)->objects();
+            M2MObjectList::const_iterator it = list.begin();
+            for ( ; it != list.end(); it++ ) {
+                remove_from_path_index(*it);
+            }
+            break;
+        }
+#endif
+        case M2MBase::Object: {
+            const M2MObjectInstanceList &list = static_cast<M2MObject*> (base)->instances();
+            M2MObjectInstanceList::const_iterator it = list.begin();
+            for ( ; it != list.end(); it++ ) {
+                remove_from_path_index(*it);
+            }
+            break;
+        }
+        case M2MBase::ObjectInstance: {
+            const M2MResourceList &list = static_cast<M2MObjectInstance*> (base)->resources();
+            M2MResourceList::const_iterator it = list.begin();
+            for ( ; it != list.end(); it++ ) {
+                remove_from_path_index(*it);
+            }
+            break;
+        }
+        case M2MBase::Resource: {
+            const M2MResourceInstanceList &list = static_cast<M2MResource*> (base)->resource_instances();
+            M2MResourceInstanceList::const_iterator it = list.begin();
+            for ( ; it != list.end(); it++ ) {
+                _path_index.remove(*it);
+            }
+            break;
+        }
+        case M2MBase::ResourceInstance:
+            break;
+    }
+    _path_index.remove(base);
+}
+
 bool M2MNsdlInterface::object_present(M2MBase* base) const
 {
     bool success = false;
@@ -1864,6 +2010,7 @@ bool M2MNsdlInterface::remove_object_from_list(M2MBase* object)
     int index;
     if(object && (-1 != (index = object_index(object)))) {
         tr_debug("  object found at index %d", index);
+        remove_from_path_index(object);
         _base_list.erase(index);
         success = true;
     }
@@ -2822,7 +2969,20 @@ void M2MNsdlInterface::send_next_notification(bool clear_token)
 {
     tr_debug("M2MNsdlInterface::send_next_notification");
     claim_mutex();
-    if (!_base_list.empty()) {
+    if (!clear_token) {
+        // Report handlers queue themselves when a notification is queued or in progress,
+        // so there is no need to go through the whole object tree.
+        M2MReportHandler *reporter = _pending_notification_head;
+        while (reporter) {
+            if (reporter->is_under_observation()) {
+                reporter->schedule_report(true);
+                release_mutex();
+                return;
+            }
+            reporter = reporter->next_pending_notification();
+        }
+    } else if (!_base_list.empty()) {
+        // Tokens need to be cleared from every object
         M2MBaseList::const_iterator base_iterator;
         base_iterator = _base_list.begin();
         for ( ; base_iterator != _base_list.end(); base_iterator++ ) {
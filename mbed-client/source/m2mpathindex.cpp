@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2018 ARM Limited. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "include/m2mpathindex.h"
+#include "mbed-client/m2mbase.h"
+#include "mbed-trace/mbed_trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_GROUP "mClt"
+
+// Initial slot count, must be a power of two
+#define PATH_INDEX_INITIAL_CAPACITY 32
+
+M2MPathIndex::M2MPathIndex()
+: _table(NULL),
+  _capacity(0),
+  _count(0),
+  _valid(true)
+{
+}
+
+M2MPathIndex::~M2MPathIndex()
+{
+    free(_table);
+}
+
+bool M2MPathIndex::insert(M2MBase *base)
+{
+    if (!base || !_valid) {
+        return false;
+    }
+
+    // Keep the load factor at or below 1/2 so that probe sequences stay short
+    if ((_count + 1) * 2 > _capacity && !grow()) {
+        tr_error("M2MPathIndex::insert - out of memory, index disabled");
+        clear();
+        _valid = false;
+        return false;
+    }
+
+    const char *path = base->uri_path();
+    uint32_t i = slot(path);
+    while (_table[i]) {
+        if (_table[i] == base) {
+            return true;
+        }
+        i = (i + 1) & (_capacity - 1);
+    }
+    _table[i] = base;
+    _count++;
+    return true;
+}
+
+void M2MPathIndex::remove(const M2MBase *base)
+{
+    if (!base || !_table) {
+        return;
+    }
+
+    uint32_t i = slot(base->uri_path());
+    while (_table[i] && _table[i] != base) {
+        i = (i + 1) & (_capacity - 1);
+    }
+    if (!_table[i]) {
+        return;
+    }
+
+    // Backward shift deletion, move up entries whose probe sequence
+    // passes the freed slot so that no tombstones are needed.
+    uint32_t hole = i;
+    uint32_t j = i;
+    for (;;) {
+        j = (j + 1) & (_capacity - 1);
+        if (!_table[j]) {
+            break;
+        }
+        uint32_t home = slot(_table[j]->uri_path());
+        if (((j - home) & (_capacity - 1)) >= ((j - hole) & (_capacity - 1))) {
+            _table[hole] = _table[j];
+            hole = j;
+        }
+    }
+    _table[hole] = NULL;
+    _count--;
+}
+
+M2MBase *M2MPathIndex::find(const char *path) const
+{
+    if (!path || !_table) {
+        return NULL;
+    }
+
+    uint32_t i = slot(path);
+    while (_table[i]) {
+        if (strcmp(_table[i]->uri_path(), path) == 0) {
+            return _table[i];
+        }
+        i = (i + 1) & (_capacity - 1);
+    }
+    return NULL;
+}
+
+bool M2MPathIndex::is_valid() const
+{
+    return _valid;
+}
+
+void M2MPathIndex::clear()
+{
+    free(_table);
+    _table = NULL;
+    _capacity = 0;
+    _count = 0;
+    _valid = true;
+}
+
+uint32_t M2MPathIndex::hash(const char *path)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    while (*path) {
+        hash ^= (uint8_t)*path++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint32_t M2MPathIndex::slot(const char *path) const
+{
+    return hash(path) & (_capacity - 1);
+}
+
+bool M2MPathIndex::grow()
+{
+    uint32_t new_capacity = _capacity ? _capacity * 2 : PATH_INDEX_INITIAL_CAPACITY;
+    M2MBase **new_table = (M2MBase**)calloc(new_capacity, sizeof(M2MBase*));
+    if (!new_table) {
+        return false;
+    }
+
+    M2MBase **old_table = _table;
+    uint32_t old_capacity = _capacity;
+    _table = new_table;
+    _capacity = new_capacity;
+
+    for (uint32_t i = 0; i < old_capacity; i++) {
+        if (old_table[i]) {
+            uint32_t j = slot(old_table[i]->uri_path());
+            while (_table[j]) {
+                j = (j + 1) & (_capacity - 1);
+            }
+            _table[j] = old_table[i];
+        }
+    }
+    free(old_table);
+    return true;
+}
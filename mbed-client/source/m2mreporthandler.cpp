@@ -29,6 +29,7 @@
 #include "mbed-client/m2mreportobserver.h"
 #include "mbed-client/m2mconstants.h"
 #include "mbed-client/m2mtimer.h"
+#include "mbed-client/m2mobservationhandler.h"
 #include "include/m2mreporthandler.h"
 #include "mbed-trace/mbed_trace.h"
 #include <string.h>
@@ -58,7 +59,11 @@ M2MReportHandler::M2MReportHandler(M2MReportObserver &observer, M2MBase::DataTyp
   _notification_send_in_progress(false),
   _notification_in_queue(false),
   _blockwise_notify(false),
-  _pmin_quiet_period(false)
+  _pmin_quiet_period(false),
+  _notification_pending(false),
+  _pending_owner(NULL),
+  _pending_prev(NULL),
+  _pending_next(NULL)
 {
     tr_debug("M2MReportHandler::M2MReportHandler()");
     if (_resource_type == M2MBase::FLOAT) {
@@ -77,6 +82,9 @@ M2MReportHandler::M2MReportHandler(M2MReportObserver &observer, M2MBase::DataTyp
 M2MReportHandler::~M2MReportHandler()
 {
     tr_debug("M2MReportHandler::~M2MReportHandler()");
+    _notification_in_queue = false;
+    _notification_send_in_progress = false;
+    update_pending_notification();
     free(_token);
 }
 
@@ -503,6 +511,7 @@ void M2MReportHandler::set_default_values()
     _changed_instance_ids.clear();
     _notification_in_queue = false;
     _notification_send_in_progress = false;
+    update_pending_notification();
     _pmin_quiet_period = false;
     if (_resource_type == M2MBase::FLOAT) {
         _high_step.float_value = 0.0f;
@@ -674,6 +683,7 @@ uint8_t* M2MReportHandler::alloc_copy(const uint8_t* source, uint32_t size)
 void M2MReportHandler::set_notification_in_queue(bool to_queue)
 {
     _notification_in_queue = to_queue;
+    update_pending_notification();
 }
 
 bool M2MReportHandler::notification_in_queue() const
@@ -684,6 +694,24 @@ bool M2MReportHandler::notification_in_queue() const
 void M2MReportHandler::set_notification_send_in_progress(bool progress)
 {
     _notification_send_in_progress = progress;
+    update_pending_notification();
+}
+
+M2MReportHandler* M2MReportHandler::next_pending_notification() const
+{
+    return _pending_next;
+}
+
+void M2MReportHandler::update_pending_notification()
+{
+    // Once queued, the handler stays with the same owner until it is unlinked
+    M2MObservationHandler *owner = _pending_owner;
+    if (!owner && (_notification_in_queue || _notification_send_in_progress)) {
+        owner = _observer.observation_handler();
+    }
+    if (owner) {
+        owner->update_pending_notification(*this);
+    }
 }
 
 bool M2MReportHandler::notification_send_in_progress() const
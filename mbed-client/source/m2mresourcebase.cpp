@@ -47,6 +47,8 @@
 #define REGISTRY_INT64_STRING_MAX_LEN 21
 // (space needed for -3.402823 × 10^38) + (magic decimal 6 digits added as no precision is added to "%f") + trailing zero
 #define REGISTRY_FLOAT_STRING_MAX_LEN 48
+// Native values are formatted into a buffer of this size, which is reused for every update
+#define NATIVE_VALUE_BUFFER_SIZE REGISTRY_FLOAT_STRING_MAX_LEN
 
 
 
@@ -70,8 +72,13 @@ M2MResourceBase::M2MResourceBase(
 #ifndef DISABLE_BLOCK_MESSAGE
  ,_block_message_data(NULL),
 #endif
-  _notification_status(M2MResourceBase::INIT)
+  _notification_status(M2MResourceBase::INIT),
+  _native_value_storage(false),
+  _native_value_set(false),
+  _native_value_text_stale(false),
+  _native_value_buffer(false)
 {
+    _native_value.int_value = 0;
 }
 
 M2MResourceBase::M2MResourceBase(
@@ -96,8 +103,13 @@ M2MResourceBase::M2MResourceBase(
 #ifndef DISABLE_BLOCK_MESSAGE
  ,_block_message_data(NULL),
 #endif
- _notification_status(M2MResourceBase::INIT)
+ _notification_status(M2MResourceBase::INIT),
+ _native_value_storage(false),
+ _native_value_set(false),
+ _native_value_text_stale(false),
+ _native_value_buffer(false)
 {
+    _native_value.int_value = 0;
     M2MBase::set_base_type(M2MBase::ResourceInstance);
     if( value != NULL && value_length > 0 ) {
         sn_nsdl_dynamic_resource_parameters_s* res = get_nsdl_resource();
@@ -113,8 +125,13 @@ M2MResourceBase::M2MResourceBase(
 #ifndef DISABLE_BLOCK_MESSAGE
   ,_block_message_data(NULL),
 #endif
-  _notification_status(M2MResourceBase::INIT)
+  _notification_status(M2MResourceBase::INIT),
+  _native_value_storage(false),
+  _native_value_set(false),
+  _native_value_text_stale(false),
+  _native_value_buffer(false)
 {
+    _native_value.int_value = 0;
     // we are not there yet for this check as this is called from M2MResource(): assert(base_type() == M2MBase::ResourceInstance);
 }
 
@@ -224,12 +241,17 @@ void M2MResourceBase::clear_value()
     free(res->resource);
     res->resource = NULL;
     res->resource_len = 0;
+    clear_native_value();
 
     report();
 }
 
 bool M2MResourceBase::set_value_float(float value)
 {
+    if (set_native_value((int64_t)value, value)) {
+        return true;
+    }
+
     bool success;
     char buffer[REGISTRY_FLOAT_STRING_MAX_LEN];
 
@@ -244,6 +266,10 @@ bool M2MResourceBase::set_value_float(float value)
 
 bool M2MResourceBase::set_value(int64_t value)
 {
+    if (set_native_value(value, (float)value)) {
+        return true;
+    }
+
     bool success;
     char buffer[REGISTRY_INT64_STRING_MAX_LEN];
     uint32_t size = m2m::itoa_c(value, buffer);
@@ -305,6 +331,7 @@ void M2MResourceBase::update_value(uint8_t *value, const uint32_t value_length)
     free(res->resource);
     res->resource = value;
     res->resource_len = value_length;
+    clear_native_value();
     if (changed) {
         report_value_change();
     }
@@ -372,9 +399,96 @@ void M2MResourceBase::report()
     }
 }
 
+bool M2MResourceBase::set_native_value_storage(bool enable)
+{
+    if (enable) {
+        const M2MResourceBase::ResourceType type = resource_instance_type();
+        if (M2MBase::Dynamic != mode() ||
+            (type != M2MResourceBase::INTEGER &&
+             type != M2MResourceBase::FLOAT &&
+             type != M2MResourceBase::BOOLEAN &&
+             type != M2MResourceBase::TIME)) {
+            return false;
+        }
+    } else {
+        update_native_value_text();
+        clear_native_value();
+    }
+    _native_value_storage = enable;
+    return true;
+}
+
+bool M2MResourceBase::native_value_storage() const
+{
+    return _native_value_storage;
+}
+
+bool M2MResourceBase::set_native_value(int64_t int_value, float float_value)
+{
+    if (!_native_value_storage ||
+        M2MBase::get_lwm2m_parameters()->read_write_callback_set ||
+        M2MCallbackStorage::get_callback(*this, M2MCallbackAssociation::M2MResourceBaseValueSetCallback)) {
+        return false;
+    }
+
+    bool changed;
+    if (resource_instance_type() == M2MResourceBase::FLOAT) {
+        changed = !_native_value_set || _native_value.float_value != float_value;
+        _native_value.float_value = float_value;
+    } else {
+        changed = !_native_value_set || _native_value.int_value != int_value;
+        _native_value.int_value = int_value;
+    }
+
+    _native_value_set = true;
+    if (changed) {
+        _native_value_text_stale = true;
+        // The C library reads the text directly when publishing the value in registration
+        if (get_nsdl_resource()->publish_value) {
+            update_native_value_text();
+        }
+        report_value_change();
+    }
+    return true;
+}
+
+void M2MResourceBase::update_native_value_text() const
+{
+    if (!_native_value_text_stale) {
+        return;
+    }
+
+    sn_nsdl_dynamic_resource_parameters_s* res = get_nsdl_resource();
+    if (!_native_value_buffer) {
+        uint8_t *buffer = (uint8_t*)malloc(NATIVE_VALUE_BUFFER_SIZE);
+        if (!buffer) {
+            tr_error("M2MResourceBase::update_native_value_text - failed to allocate buffer");
+            return;
+        }
+        free(res->resource);
+        res->resource = buffer;
+        _native_value_buffer = true;
+    }
+
+    if (resource_instance_type() == M2MResourceBase::FLOAT) {
+        res->resource_len = snprintf((char*)res->resource, NATIVE_VALUE_BUFFER_SIZE, "%f", _native_value.float_value);
+    } else {
+        res->resource_len = m2m::itoa_c(_native_value.int_value, (char*)res->resource);
+    }
+    _native_value_text_stale = false;
+}
+
+void M2MResourceBase::clear_native_value()
+{
+    _native_value_set = false;
+    _native_value_text_stale = false;
+    _native_value_buffer = false;
+}
+
 bool M2MResourceBase::has_value_changed(const uint8_t* value, const uint32_t value_len)
 {
     bool changed = false;
+    update_native_value_text();
     sn_nsdl_dynamic_resource_parameters_s* res = get_nsdl_resource();
 
     if(value_len != res->resource_len) {
@@ -485,6 +599,8 @@ void M2MResourceBase::get_value(uint8_t *&value, uint32_t &value_length)
         value = NULL;
     }
 
+    update_native_value_text();
+
     sn_nsdl_dynamic_resource_parameters_s* res = get_nsdl_resource();
     if(res->resource && res->resource_len > 0) {
         value = alloc_string_copy(res->resource, res->resource_len);
@@ -496,6 +612,13 @@ void M2MResourceBase::get_value(uint8_t *&value, uint32_t &value_length)
 
 int64_t M2MResourceBase::get_value_int() const
 {
+    if (_native_value_set) {
+        if (resource_instance_type() == M2MResourceBase::FLOAT) {
+            return (int64_t)_native_value.float_value;
+        }
+        return _native_value.int_value;
+    }
+
     int64_t value_int = 0;
 
     const char *value_string = (char *)value();
@@ -524,6 +647,7 @@ String M2MResourceBase::get_value_string() const
 {
     // XXX: do a better constructor to avoid pointless malloc
     String value;
+    update_native_value_text();
     if (get_nsdl_resource()->resource) {
         value.append_raw((char*)get_nsdl_resource()->resource, get_nsdl_resource()->resource_len);
     }
@@ -532,6 +656,13 @@ String M2MResourceBase::get_value_string() const
 
 float M2MResourceBase::get_value_float() const
 {
+    if (_native_value_set) {
+        if (resource_instance_type() == M2MResourceBase::FLOAT) {
+            return _native_value.float_value;
+        }
+        return (float)_native_value.int_value;
+    }
+
     float value_float = 0;
 
     const char *value_string = (char *)value();
@@ -554,11 +685,13 @@ float M2MResourceBase::get_value_float() const
 
 uint8_t* M2MResourceBase::value() const
 {
+    update_native_value_text();
     return get_nsdl_resource()->resource;
 }
 
 uint32_t M2MResourceBase::value_length() const
 {
+    update_native_value_text();
     return get_nsdl_resource()->resource_len;
 }
 
@@ -931,4 +1064,7 @@ void M2MResourceBase::publish_value_in_registration_msg(bool publish_value)
         pub_value = (uint8_t)publish_value;
     }
     param->dynamic_resource_params->publish_value = pub_value;
+    if (pub_value) {
+        update_native_value_text();
+    }
 }
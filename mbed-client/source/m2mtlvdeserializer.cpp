@@ -15,6 +15,7 @@
  */
 // Needed for PRIu64 on FreeRTOS
 #include <stdio.h>
+#include <string.h>
 // Note: this macro is needed on armcc to get the the limit macros like UINT16_MAX
 #ifndef __STDC_LIMIT_MACROS
 #define __STDC_LIMIT_MACROS
@@ -62,9 +63,9 @@ M2MTLVDeserializer::Error M2MTLVDeserializer::deserialise_object_instances(const
     M2MTLVDeserializer::Error error = M2MTLVDeserializer::None;
     if (is_object_instance(tlv) ) {
         tr_debug("M2MTLVDeserializer::deserialise_object_instances");
-        error = deserialize_object_instances(tlv, tlv_size, 0, object,operation,false);
+        error = deserialize_object_instances(tlv, tlv_size, object,operation,false);
         if(M2MTLVDeserializer::None == error) {
-            error = deserialize_object_instances(tlv, tlv_size, 0, object,operation,true);
+            error = deserialize_object_instances(tlv, tlv_size, object,operation,true);
         }
     } else {
         tr_debug("M2MTLVDeserializer::deserialise_object_instances ::NotValid");
@@ -82,12 +83,12 @@ M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_resources(const uint8_
     if (!is_resource(tlv) && !is_multiple_resource(tlv)) {
         error = M2MTLVDeserializer::NotValid;
     } else {
-        error = deserialize_resources(tlv, tlv_size, 0, object_instance, operation,false);
+        error = deserialize_resources(tlv, tlv_size, object_instance, operation,false);
         if(M2MTLVDeserializer::None == error) {
             if (M2MTLVDeserializer::Put == operation) {
-                remove_resources(tlv, tlv_size, object_instance, 0);
+                remove_resources(tlv, tlv_size, object_instance);
             }
-            error = deserialize_resources(tlv, tlv_size, 0, object_instance, operation,true);
+            error = deserialize_resources(tlv, tlv_size, object_instance, operation,true);
         }
     }
     return error;
@@ -99,30 +100,17 @@ M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_resource_instances(con
                                                                              M2MTLVDeserializer::Operation operation)
 {
     M2MTLVDeserializer::Error error = M2MTLVDeserializer::None;
-    if (!is_multiple_resource(tlv)) {
+    M2MTLVIterator til(tlv, tlv_size);
+    if (!is_multiple_resource(tlv) || !til.next()) {
         error = M2MTLVDeserializer::NotValid;
     } else {
         tr_debug("M2MTLVDeserializer::deserialize_resource_instances()");
-        uint8_t offset = 2;
-
-        ((tlv[0] & 0x20) == 0) ? offset : offset++;
-
-        uint8_t length = tlv[0] & 0x18;
-        if(length == 0x08) {
-            offset += 1;
-        } else if(length == 0x10) {
-            offset += 2;
-        } else if(length == 0x18) {
-            offset += 3;
-        }
-
-        tr_debug("M2MTLVDeserializer::deserialize_resource_instances() Offset %d", offset);
-        error = deserialize_resource_instances(tlv, tlv_size, offset, resource, operation,false);
+        error = deserialize_resource_instances(til.value(), til.length(), resource, operation,false);
         if(M2MTLVDeserializer::None == error) {
             if (M2MTLVDeserializer::Put == operation) {
-                remove_resource_instances(tlv, tlv_size, resource, offset);
+                remove_resource_instances(til.value(), til.length(), resource);
             }
-            error = deserialize_resource_instances(tlv, tlv_size, offset, resource, operation,true);
+            error = deserialize_resource_instances(til.value(), til.length(), resource, operation,true);
         }
     }
     return error;
@@ -130,104 +118,69 @@ M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_resource_instances(con
 
 M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_object_instances(const uint8_t *tlv,
                                                                            uint32_t tlv_size,
-                                                                           uint32_t offset,
                                                                            M2MObject &object,
                                                                            M2MTLVDeserializer::Operation operation,
                                                                            bool update_value)
 {
     tr_debug("M2MTLVDeserializer::deserialize_object_instances()");
     M2MTLVDeserializer::Error error = M2MTLVDeserializer::None;
-    TypeIdLength til(tlv, offset);
-    til.deserialize();
-    offset = til._offset;
+    M2MTLVIterator til(tlv, tlv_size);
 
-    const M2MObjectInstanceList &list = object.instances();
-    M2MObjectInstanceList::const_iterator it;
-    it = list.begin();
-
-    if (TYPE_OBJECT_INSTANCE == til._type) {
-        for (; it!=list.end(); it++) {
-            if((*it)->instance_id() == til._id) {
-                error = deserialize_resources(tlv, tlv_size, offset, (**it),operation, update_value);
-            }
+    while (M2MTLVDeserializer::None == error && til.next()) {
+        if (TYPE_OBJECT_INSTANCE != til.type()) {
+            break;
         }
-        offset += til._length;
-
-        if(offset < tlv_size) {
-            error = deserialize_object_instances(tlv, tlv_size, offset, object, operation, update_value);
+        M2MObjectInstance *object_instance = object.object_instance(til.id());
+        if (object_instance) {
+            error = deserialize_resources(til.value(), til.length(), *object_instance, operation, update_value);
         }
     }
+
+    if (!til.is_valid()) {
+        error = M2MTLVDeserializer::NotValid;
+    }
     return error;
 }
 
 M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_resources(const uint8_t *tlv,
                                                                     uint32_t tlv_size,
-                                                                    uint32_t offset,
                                                                     M2MObjectInstance &object_instance,
                                                                     M2MTLVDeserializer::Operation operation,
                                                                     bool update_value)
 {
     tr_debug("M2MTLVDeserializer::deserialize_resources()");
     M2MTLVDeserializer::Error error = M2MTLVDeserializer::None;
-    TypeIdLength til(tlv, offset);
-    til.deserialize();
-    offset = til._offset;
-
+    M2MTLVIterator til(tlv, tlv_size);
     const M2MResourceList &list = object_instance.resources();
-    M2MResourceList::const_iterator it;
-    it = list.begin();
-
-    bool found = false;
-    bool multi = false;
-    if (TYPE_RESOURCE == til._type || TYPE_RESOURCE_INSTANCE == til._type) {
-        multi = false;
-        for (; it!=list.end(); it++) {
-            if((*it)->name_id() == til._id){
-                tr_debug("M2MTLVDeserializer::deserialize_resources() - Resource ID %d ", til._id);
-                found = true;
-                if(update_value) {
-                    if(til._length > 0) {
-                        tr_debug("M2MTLVDeserializer::deserialize_resources() - Update value");
-                        if (!set_resource_instance_value((*it), tlv+offset, til._length)) {
-                            error = M2MTLVDeserializer::OutOfMemory;
-                            break;
-                        }
-                    } else {
-                        tr_debug("M2MTLVDeserializer::deserialize_resources() - Clear Value");
-                        (*it)->clear_value();
-                    }
-                    break;
-                } else if(0 == ((*it)->operation() & M2MBase::PUT_ALLOWED)) {
-                    tr_debug("M2MTLVDeserializer::deserialize_resources() - NOT_ALLOWED");
-                    error = M2MTLVDeserializer::NotAllowed;
-                    break;
-                }
-            }
-        }
-    } else if (TYPE_MULTIPLE_RESOURCE == til._type) {
-        multi = true;
-        for (; it!=list.end(); it++) {
-            if((*it)->supports_multiple_instances() &&
-                    (*it)->name_id() == til._id) {
-                found = true;
-                error = deserialize_resource_instances(tlv, tlv_size, offset, (**it), object_instance, operation, update_value);
-            }
+    int hint = 0;
+
+    while (M2MTLVDeserializer::None == error && til.next()) {
+        bool multi;
+        if (TYPE_RESOURCE == til.type() || TYPE_RESOURCE_INSTANCE == til.type()) {
+            multi = false;
+        } else if (TYPE_MULTIPLE_RESOURCE == til.type()) {
+            multi = true;
+        } else {
+            return M2MTLVDeserializer::NotValid;
         }
-    } else {
-        error = M2MTLVDeserializer::NotValid;
-        return error;
-    }
 
-    if (!found) {
-        if (M2MTLVDeserializer::Post == operation) {
+        M2MResource *resource = find_resource(list, til.id(), multi, hint);
+        if (resource) {
+            tr_debug("M2MTLVDeserializer::deserialize_resources() - Resource ID %d ", til.id());
+            if (multi) {
+                error = deserialize_resource_instances(til.value(), til.length(), *resource, object_instance, operation, update_value);
+            } else {
+                error = update_resource_instance_value(resource, til.value(), til.length(), update_value);
+            }
+        } else if (M2MTLVDeserializer::Post == operation) {
             //Create a new Resource
             String id;
-            id.append_int(til._id);
-            M2MResource *resource = object_instance.create_dynamic_resource(id, "", M2MResourceInstance::OPAQUE, true, multi);
+            id.append_int(til.id());
+            resource = object_instance.create_dynamic_resource(id, "", M2MResourceInstance::OPAQUE, true, multi);
             if (resource) {
                 resource->set_operation(M2MBase::GET_PUT_POST_DELETE_ALLOWED);
-                if  (TYPE_MULTIPLE_RESOURCE == til._type) {
-                    error = deserialize_resource_instances(tlv, tlv_size, offset, (*resource), object_instance, operation, update_value);
+                if (multi) {
+                    error = deserialize_resource_instances(til.value(), til.length(), *resource, object_instance, operation, update_value);
                 }
             }
         } else if (M2MTLVDeserializer::Put == operation) {
@@ -235,132 +188,84 @@ M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_resources(const uint8_
         }
     }
 
-    offset += til._length;
-
-    if (offset < tlv_size) {
-        error = deserialize_resources(tlv, tlv_size, offset, object_instance, operation, update_value);
+    if (!til.is_valid()) {
+        error = M2MTLVDeserializer::NotValid;
     }
-
     return error;
 }
 
 M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_resource_instances(const uint8_t *tlv,
                                                                              uint32_t tlv_size,
-                                                                             uint32_t offset,
                                                                              M2MResource &resource,
                                                                              M2MObjectInstance &object_instance,
                                                                              M2MTLVDeserializer::Operation operation,
                                                                              bool update_value)
 {
     M2MTLVDeserializer::Error error = M2MTLVDeserializer::None;
-    TypeIdLength til(tlv, offset);
-    til.deserialize();
-    offset = til._offset;
+    M2MTLVIterator til(tlv, tlv_size);
+    const M2MResourceInstanceList &list = resource.resource_instances();
+    int hint = 0;
 
-    if (TYPE_MULTIPLE_RESOURCE == til._type || TYPE_RESOURCE_INSTANCE == til._type) {
-        const M2MResourceInstanceList &list = resource.resource_instances();
-        M2MResourceInstanceList::const_iterator it;
-        it = list.begin();
-        bool found = false;
-        for (; it!=list.end(); it++) {
-            if((*it)->instance_id() == til._id && TYPE_RESOURCE_INSTANCE == til._type) {
-                found = true;
-                if(update_value) {
-                    if(til._length > 0) {
-                        if (!set_resource_instance_value((*it), tlv+offset, til._length)) {
-                            error = M2MTLVDeserializer::OutOfMemory;
-                            break;
-                        }
-                    } else {
-                        (*it)->clear_value();
-                    }
-                    break;
-                } else if(0 == ((*it)->operation() & M2MBase::PUT_ALLOWED)) {
-                    error = M2MTLVDeserializer::NotAllowed;
-                    break;
-                }
-            }
+    while (M2MTLVDeserializer::None == error && til.next()) {
+        if (TYPE_MULTIPLE_RESOURCE != til.type() && TYPE_RESOURCE_INSTANCE != til.type()) {
+            return M2MTLVDeserializer::NotValid;
         }
 
-        if(!found) {
-            if(M2MTLVDeserializer::Post == operation) {
-                // Create a new Resource Instance
-                M2MResourceInstance *res_instance = object_instance.create_dynamic_resource_instance(resource.name(),"",
-                                                                                                 resource.resource_instance_type(),
-                                                                                                 true,
-                                                                                                 til._id);
-                if(res_instance) {
-                    res_instance->set_operation(M2MBase::GET_PUT_POST_DELETE_ALLOWED);
-                }
-            } else if(M2MTLVDeserializer::Put == operation) {
-                error = M2MTLVDeserializer::NotFound;
+        M2MResourceInstance *res_instance = NULL;
+        if (TYPE_RESOURCE_INSTANCE == til.type()) {
+            res_instance = find_resource_instance(list, til.id(), hint);
+        }
+
+        if (res_instance) {
+            error = update_resource_instance_value(res_instance, til.value(), til.length(), update_value);
+        } else if (M2MTLVDeserializer::Post == operation) {
+            // Create a new Resource Instance
+            res_instance = object_instance.create_dynamic_resource_instance(resource.name(),"",
+                                                                            resource.resource_instance_type(),
+                                                                            true,
+                                                                            til.id());
+            if(res_instance) {
+                res_instance->set_operation(M2MBase::GET_PUT_POST_DELETE_ALLOWED);
             }
+        } else if (M2MTLVDeserializer::Put == operation) {
+            error = M2MTLVDeserializer::NotFound;
         }
-    } else {
-        error = M2MTLVDeserializer::NotValid;
-        return error;
     }
 
-    offset += til._length;
-
-    if(offset < tlv_size) {
-      error = deserialize_resource_instances(tlv, tlv_size, offset, resource, object_instance, operation, update_value);
+    if (!til.is_valid()) {
+        error = M2MTLVDeserializer::NotValid;
     }
     return error;
 }
 
 M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_resource_instances(const uint8_t *tlv,
                                                                              uint32_t tlv_size,
-                                                                             uint32_t offset,
                                                                              M2MResource &resource,
                                                                              M2MTLVDeserializer::Operation operation,
                                                                              bool update_value)
 {
     M2MTLVDeserializer::Error error = M2MTLVDeserializer::None;
-    TypeIdLength til(tlv, offset);
-    til.deserialize();
-    offset = til._offset;
+    M2MTLVIterator til(tlv, tlv_size);
+    const M2MResourceInstanceList &list = resource.resource_instances();
+    int hint = 0;
 
-    if (TYPE_RESOURCE_INSTANCE == til._type) {
-        const M2MResourceInstanceList &list = resource.resource_instances();
-        M2MResourceInstanceList::const_iterator it;
-        it = list.begin();
-        bool found = false;
-        for (; it!=list.end(); it++) {
-            if((*it)->instance_id() == til._id) {
-                found = true;
-                if(update_value) {
-                    if(til._length > 0) {
-                        if (!set_resource_instance_value((*it),tlv+offset, til._length)) {
-                            error = M2MTLVDeserializer::OutOfMemory;
-                            break;
-                        }
-                    } else {
-                        (*it)->clear_value();
-                    }
-                    break;
-                } else if(0 == ((*it)->operation() & M2MBase::PUT_ALLOWED)) {
-                    error = M2MTLVDeserializer::NotAllowed;
-                    break;
-                }
-            }
+    while (M2MTLVDeserializer::None == error && til.next()) {
+        if (TYPE_RESOURCE_INSTANCE != til.type()) {
+            return M2MTLVDeserializer::NotValid;
         }
-        if(!found) {
-            if(M2MTLVDeserializer::Post == operation) {
-                error = M2MTLVDeserializer::NotAllowed;
-            } else if(M2MTLVDeserializer::Put == operation) {
-                error = M2MTLVDeserializer::NotFound;
-            }
+
+        M2MResourceInstance *res_instance = find_resource_instance(list, til.id(), hint);
+        if (res_instance) {
+            error = update_resource_instance_value(res_instance, til.value(), til.length(), update_value);
+        } else if (M2MTLVDeserializer::Post == operation) {
+            error = M2MTLVDeserializer::NotAllowed;
+        } else if (M2MTLVDeserializer::Put == operation) {
+            error = M2MTLVDeserializer::NotFound;
         }
-    } else {
-        error = M2MTLVDeserializer::NotValid;
-        return error;
     }
 
-    offset += til._length;
-
-    if(offset < tlv_size) {
-         error = deserialize_resource_instances(tlv, tlv_size, offset, resource, operation, update_value);
+    if (!til.is_valid()) {
+        error = M2MTLVDeserializer::NotValid;
     }
     return error;
 }
@@ -434,8 +339,18 @@ bool M2MTLVDeserializer::set_resource_instance_value(M2MResourceBase *res, const
             break;
         case M2MResourceBase::FLOAT:
         {
-            uint32_t value = common_read_32_bit(tlv);
-            if (!res->set_value_float(*(float*)&value)) {
+            // LwM2M floats are 4 or 8 bytes, anything else is rejected by the caller
+            float value;
+            if (size == 8) {
+                uint64_t raw = common_read_64_bit(tlv);
+                double dvalue;
+                memcpy(&dvalue, &raw, sizeof(dvalue));
+                value = (float)dvalue;
+            } else {
+                uint32_t raw = common_read_32_bit(tlv);
+                memcpy(&value, &raw, sizeof(value));
+            }
+            if (!res->set_value_float(value)) {
                 success = false;
             }
             break;
@@ -448,35 +363,94 @@ bool M2MTLVDeserializer::set_resource_instance_value(M2MResourceBase *res, const
     return success;
 }
 
+M2MTLVDeserializer::Error M2MTLVDeserializer::update_resource_instance_value(M2MResourceBase *res,
+                                                                             const uint8_t *tlv,
+                                                                             uint32_t size,
+                                                                             bool update_value)
+{
+    M2MTLVDeserializer::Error error = M2MTLVDeserializer::None;
+    if (update_value) {
+        if (size > 0 && res->resource_instance_type() == M2MResourceBase::FLOAT &&
+            size != 4 && size != 8) {
+            tr_error("M2MTLVDeserializer::update_resource_instance_value() - invalid float length %" PRIu32, size);
+            error = M2MTLVDeserializer::NotValid;
+        } else if (size > 0) {
+            if (!set_resource_instance_value(res, tlv, size)) {
+                error = M2MTLVDeserializer::OutOfMemory;
+            }
+        } else {
+            res->clear_value();
+        }
+    } else if (0 == (res->operation() & M2MBase::PUT_ALLOWED)) {
+        tr_debug("M2MTLVDeserializer::update_resource_instance_value() - NOT_ALLOWED");
+        error = M2MTLVDeserializer::NotAllowed;
+    }
+    return error;
+}
+
+M2MResource* M2MTLVDeserializer::find_resource(const M2MResourceList &list, uint16_t id, bool multiple, int &hint)
+{
+    const int count = list.size();
+    for (int i = 0; i < count; i++) {
+        const int index = (hint + i) % count;
+        M2MResource *resource = list[index];
+        if ((!multiple || resource->supports_multiple_instances()) &&
+            resource->name_id() == id) {
+            hint = index + 1;
+            return resource;
+        }
+    }
+    return NULL;
+}
+
+M2MResourceInstance* M2MTLVDeserializer::find_resource_instance(const M2MResourceInstanceList &list, uint16_t id, int &hint)
+{
+    const int count = list.size();
+    for (int i = 0; i < count; i++) {
+        const int index = (hint + i) % count;
+        if (list[index]->instance_id() == id) {
+            hint = index + 1;
+            return list[index];
+        }
+    }
+    return NULL;
+}
+
 void M2MTLVDeserializer::remove_resources(const uint8_t *tlv,
                                           uint32_t tlv_size,
-                                          M2MObjectInstance &object_instance,
-                                          uint32_t offset_size)
+                                          M2MObjectInstance &object_instance)
 {
     tr_debug("M2MTLVDeserializer::remove_resources");
-    uint32_t offset = offset_size;
+    M2MTLVIterator til(tlv, tlv_size);
     const M2MResourceList &list = object_instance.resources();
     M2MResourceList::const_iterator it;
 
     it = list.begin();
     for (; it!=list.end();) {
+        const int32_t name_id = (*it)->name_id();
         bool found = false;
-        while(offset < tlv_size) {
-            TypeIdLength til(tlv, offset);
-            til.deserialize();
-            offset = til._offset;
-            offset += til._length;
-            if((*it)->name_id() == til._id){
-                offset = offset_size;
+        bool wrapped = false;
+        // Continue from the previous match and wrap around once
+        const uint32_t start = til.offset();
+        while (!found) {
+            if (!til.next()) {
+                if (wrapped) {
+                    break;
+                }
+                wrapped = true;
+                til.rewind();
+                continue;
+            }
+            if (til.id() == name_id) {
                 found = true;
+            } else if (wrapped && til.offset() >= start) {
                 break;
             }
         }
-        offset = offset_size;
 
         // Remove resource if not part of the TLV message
         if (!found) {
-            tr_debug("M2MTLVDeserializer::remove_resources - remove resource %" PRId32, (*it)->name_id());
+            tr_debug("M2MTLVDeserializer::remove_resources - remove resource %" PRId32, name_id);
             object_instance.remove_resource((*it)->name());
         } else {
             ++it;
@@ -486,34 +460,40 @@ void M2MTLVDeserializer::remove_resources(const uint8_t *tlv,
 
 void M2MTLVDeserializer::remove_resource_instances(const uint8_t *tlv,
                                           uint32_t tlv_size,
-                                          M2MResource &resource,
-                                          uint32_t offset_size)
+                                          M2MResource &resource)
 {
     tr_debug("M2MTLVDeserializer::remove_resource_instances");
-    uint32_t offset = offset_size;
+    M2MTLVIterator til(tlv, tlv_size);
     const M2MResourceInstanceList &list = resource.resource_instances();
     M2MResourceInstanceList::const_iterator it;
     it = list.begin();
 
     for (; it!=list.end();) {
+        const uint16_t instance_id = (*it)->instance_id();
         bool found = false;
-        while (offset < tlv_size) {
-            TypeIdLength til(tlv, offset);
-            til.deserialize();
-            offset = til._offset;
-            offset += til._length;
-            if ((*it)->instance_id() == til._id){
-                offset = offset_size;
+        bool wrapped = false;
+        // Continue from the previous match and wrap around once
+        const uint32_t start = til.offset();
+        while (!found) {
+            if (!til.next()) {
+                if (wrapped) {
+                    break;
+                }
+                wrapped = true;
+                til.rewind();
+                continue;
+            }
+            if (til.id() == instance_id) {
                 found = true;
+            } else if (wrapped && til.offset() >= start) {
                 break;
             }
         }
-        offset = offset_size;
 
         // Remove resource instance if not part of the TLV message
         if (!found) {
-            tr_debug("M2MTLVDeserializer::remove_resource_instances - remove resource instance %d", (*it)->instance_id());
-            resource.remove_resource_instance((*it)->instance_id());
+            tr_debug("M2MTLVDeserializer::remove_resource_instances - remove resource instance %d", instance_id);
+            resource.remove_resource_instance(instance_id);
         } else {
             ++it;
         }
@@ -558,3 +538,96 @@ void TypeIdLength::deserialiseLength(uint32_t lengthType)
         _length = (_length << 8) + (_tlv[_offset++] & 0xFF);
     }
 }
+
+M2MTLVIterator::M2MTLVIterator(const uint8_t *tlv, uint32_t tlv_size)
+: _tlv(tlv),
+  _tlv_size(tlv ? tlv_size : 0),
+  _offset(0),
+  _next_offset(0),
+  _value_offset(0),
+  _length(0),
+  _id(0),
+  _type(0),
+  _valid(true)
+{
+}
+
+bool M2MTLVIterator::next()
+{
+    if (!_valid || _next_offset >= _tlv_size) {
+        return false;
+    }
+
+    uint32_t offset = _next_offset;
+    const uint8_t header = _tlv[offset++];
+    const uint32_t id_size = (header & ID16) ? 2 : 1;
+    const uint32_t length_type = header & LENGTH24;
+    const uint32_t length_size = length_type >> 3;
+
+    if (_tlv_size - offset < id_size + length_size) {
+        _valid = false;
+        return false;
+    }
+
+    uint16_t id = _tlv[offset++];
+    if (id_size == 2) {
+        id = (id << 8) + _tlv[offset++];
+    }
+
+    uint32_t length = 0;
+    if (0 == length_type) {
+        length = header & 0x07;
+    }
+    for (uint32_t i = 0; i < length_size; i++) {
+        length = (length << 8) + _tlv[offset++];
+    }
+
+    if (_tlv_size - offset < length) {
+        _valid = false;
+        return false;
+    }
+
+    _offset = _next_offset;
+    _type = header & 0xC0;
+    _id = id;
+    _value_offset = offset;
+    _length = length;
+    _next_offset = offset + length;
+    return true;
+}
+
+void M2MTLVIterator::rewind()
+{
+    _offset = 0;
+    _next_offset = 0;
+}
+
+bool M2MTLVIterator::is_valid() const
+{
+    return _valid;
+}
+
+uint32_t M2MTLVIterator::offset() const
+{
+    return _offset;
+}
+
+uint8_t M2MTLVIterator::type() const
+{
+    return _type;
+}
+
+uint16_t M2MTLVIterator::id() const
+{
+    return _id;
+}
+
+const uint8_t* M2MTLVIterator::value() const
+{
+    return _tlv + _value_offset;
+}
+
+uint32_t M2MTLVIterator::length() const
+{
+    return _length;
+}
@@ -18,223 +18,308 @@
 
 #include <stdlib.h>
 #include "common_functions.h"
+#include "mbed-trace/mbed_trace.h"
 
 #define TRACE_GROUP "mClt"
 
 #define MAX_TLV_LENGTH_SIZE 3
 #define MAX_TLV_ID_SIZE 2
 #define TLV_TYPE_SIZE 1
+// Marks a nested TLV which is left out of the payload
+#define NESTED_TLV_SKIPPED 0xFFFFFFFF
 
 uint8_t* M2MTLVSerializer::serialize(const M2MObjectInstanceList &object_instance_list, uint32_t &size)
 {
-    return serialize_object_instances(object_instance_list, size);
+    tlv_buffer_s buffer;
+
+    if (!serialize_object_instances(object_instance_list, buffer) || !begin_write(buffer)) {
+        return NULL;
+    }
+    serialize_object_instances(object_instance_list, buffer);
+    if (!end_write(buffer)) {
+        return NULL;
+    }
+    size = buffer.size;
+    return buffer.data;
 }
 
 uint8_t* M2MTLVSerializer::serialize(const M2MResourceList &resource_list, uint32_t &size)
 {
-    bool valid = true;
-    return serialize_resources(resource_list, size,valid);
+    tlv_buffer_s buffer;
+
+    if (!serialize_resources(resource_list, buffer) || !begin_write(buffer)) {
+        return NULL;
+    }
+    serialize_resources(resource_list, buffer);
+    if (!end_write(buffer)) {
+        return NULL;
+    }
+    size = buffer.size;
+    return buffer.data;
 }
 
 uint8_t* M2MTLVSerializer::serialize(const M2MResource *resource, uint32_t &size)
 {
-    uint8_t* data = NULL;
-    serialize(resource, data, size);
-    return data;
+    tlv_buffer_s buffer;
+
+    if (!serialize(resource, buffer) || !begin_write(buffer)) {
+        return NULL;
+    }
+    serialize(resource, buffer);
+    if (!end_write(buffer)) {
+        return NULL;
+    }
+    size = buffer.size;
+    return buffer.data;
 }
 
-uint8_t* M2MTLVSerializer::serialize_object_instances(const M2MObjectInstanceList &object_instance_list, uint32_t &size)
+bool M2MTLVSerializer::begin_write(tlv_buffer_s &buffer)
 {
-    uint8_t *data = NULL;
-
-    if(!object_instance_list.empty()) {
-        M2MObjectInstanceList::const_iterator it;
-        it = object_instance_list.begin();
-        for (; it!=object_instance_list.end(); it++) {            
-            uint16_t id = (*it)->instance_id();
-            serialize(id, *it, data, size);            
-        }
+    if (!buffer.size) {
+        return false;
     }
-    return data;
+    buffer.data = (uint8_t*)malloc(buffer.size);
+    if (!buffer.data) {
+        /* memory allocation has failed */
+        return false;
+    }
+    buffer.capacity = buffer.size;
+    buffer.size = 0;
+    buffer.nested_index = 0;
+    return true;
 }
 
-uint8_t* M2MTLVSerializer::serialize_resources(const M2MResourceList &resource_list, uint32_t &size, bool &valid)
+bool M2MTLVSerializer::end_write(tlv_buffer_s &buffer)
 {
-    uint8_t *data = NULL;
+    if (buffer.size != buffer.capacity || buffer.nested_index != buffer.nested_sizes.size()) {
+        /* content has changed between the passes */
+        tr_error("M2MTLVSerializer::end_write - size mismatch");
+        free(buffer.data);
+        buffer.data = NULL;
+        return false;
+    }
+    return true;
+}
 
-    if(!resource_list.empty()) {
-        M2MResourceList::const_iterator it;
+bool M2MTLVSerializer::serialize_object_instances(const M2MObjectInstanceList &object_instance_list, tlv_buffer_s &buffer)
+{
+    M2MObjectInstanceList::const_iterator it;
+    it = object_instance_list.begin();
+    for (; it!=object_instance_list.end(); it++) {
+        uint16_t id = (*it)->instance_id();
+        // Instances with invalid resources are left out of the payload
+        serialize(id, *it, buffer);
+    }
+    return true;
+}
+
+bool M2MTLVSerializer::serialize_resources(const M2MResourceList &resource_list, tlv_buffer_s &buffer)
+{
+    M2MResourceList::const_iterator it;
+    if (!buffer.data) {
         it = resource_list.begin();
         for (; it!=resource_list.end(); it++) {
             if((*it)->name_id() == -1) {
-                valid = false;
-                break;
+                return false;
             }
         }
-        if(valid) {
-            it = resource_list.begin();
-            for (; it!=resource_list.end(); it++) {
-                if (((*it)->operation() & M2MBase::GET_ALLOWED) == M2MBase::GET_ALLOWED) {
-                    if(!serialize(*it, data, size)) {
-                        /* serializing has failed */
-                        /* free data so far */
-                        free(data);
-                        /* invalidate */
-                        valid = false;
-                        /* return NULL immediately */
-                        return NULL;
-                    }
-                }
+    }
+
+    it = resource_list.begin();
+    for (; it!=resource_list.end(); it++) {
+        if (((*it)->operation() & M2MBase::GET_ALLOWED) == M2MBase::GET_ALLOWED) {
+            if(!serialize(*it, buffer)) {
+                /* serializing has failed */
+                return false;
             }
         }
     }
-    return data;
+    return true;
 }
 
-bool M2MTLVSerializer::serialize(uint16_t id, const M2MObjectInstance *object_instance, uint8_t *&data, uint32_t &size)
+bool M2MTLVSerializer::serialize(uint16_t id, const M2MObjectInstance *object_instance, tlv_buffer_s &buffer)
 {
-    uint8_t *resource_data = NULL;
-    uint32_t resource_size = 0;
-    bool success;
+    uint32_t start;
+    int index;
 
-    bool valid = true;
-    resource_data = serialize_resources(object_instance->resources(),resource_size,valid);
-    if(valid) {
-        if(serialize_TILV(TYPE_OBJECT_INSTANCE, id, resource_data, resource_size, data, size)) {
-            success = true;
-        } else {
-            /* serializing object instance failed */
-            success = false;
-        }
-        free(resource_data);
-    } else {
-        /* serializing resources failed */
-        success = false;
+    if (!begin_nested_TLV(TYPE_OBJECT_INSTANCE, id, start, index, buffer)) {
+        return false;
     }
-    return success;
+    bool success = serialize_resources(object_instance->resources(), buffer);
+    return end_nested_TLV(TYPE_OBJECT_INSTANCE, id, success, start, index, buffer);
 }
 
-bool M2MTLVSerializer::serialize(const M2MResource *resource, uint8_t *&data, uint32_t &size)
+bool M2MTLVSerializer::serialize(const M2MResource *resource, tlv_buffer_s &buffer)
 {
     bool success = false;
-    if(resource->name_id() != -1) {
+    int32_t id = resource->name_id();
+    if(id != -1) {
         success = resource->supports_multiple_instances() ?
-                serialize_multiple_resource(resource, data, size) :
-                serialize_resource(resource, data, size);
+                serialize_multiple_resource(id, resource, buffer) :
+                serialize_resource(id, resource, buffer);
     }
     return success;
 }
 
-bool M2MTLVSerializer::serialize_resource(const M2MResource *resource, uint8_t *&data, uint32_t &size)
+bool M2MTLVSerializer::serialize_resource(uint16_t id, const M2MResource *resource, tlv_buffer_s &buffer)
 {
-    bool success = false;
-    if(resource->name_id() != -1) {
-        if ( (resource->resource_instance_type() == M2MResourceBase::INTEGER) ||
-             (resource->resource_instance_type() == M2MResourceBase::BOOLEAN) ||
-             (resource->resource_instance_type() == M2MResourceBase::TIME) ) {
-            success = serialize_TLV_binary_int(resource, TYPE_RESOURCE, resource->name_id(), data, size);
-        }
-        else if (resource->resource_instance_type() == M2MResourceBase::FLOAT) {
-            success = serialize_TLV_binary_float(resource, TYPE_RESOURCE, resource->name_id(), data, size);
-        }
-        else {
-             success = serialize_TILV(TYPE_RESOURCE, resource->name_id(),
-                      resource->value(), resource->value_length(), data, size);
-        }
+    bool success;
+    if ( (resource->resource_instance_type() == M2MResourceBase::INTEGER) ||
+         (resource->resource_instance_type() == M2MResourceBase::BOOLEAN) ||
+         (resource->resource_instance_type() == M2MResourceBase::TIME) ) {
+        success = serialize_TLV_binary_int(resource, TYPE_RESOURCE, id, buffer);
+    }
+    else if (resource->resource_instance_type() == M2MResourceBase::FLOAT) {
+        success = serialize_TLV_binary_float(resource, TYPE_RESOURCE, id, buffer);
+    }
+    else {
+        success = serialize_TILV(TYPE_RESOURCE, id, resource->value(), resource->value_length(), buffer);
     }
     return success;
 }
 
-bool M2MTLVSerializer::serialize_multiple_resource(const M2MResource *resource, uint8_t *&data, uint32_t &size)
+bool M2MTLVSerializer::serialize_multiple_resource(uint16_t id, const M2MResource *resource, tlv_buffer_s &buffer)
 {
-    bool success = false;
-    uint8_t *nested_data = NULL;
-    uint32_t nested_data_size = 0;
+    uint32_t start;
+    int index;
+
+    if ((resource->operation() & M2MBase::GET_ALLOWED) != M2MBase::GET_ALLOWED) {
+        return false;
+    }
+
+    if (!begin_nested_TLV(TYPE_MULTIPLE_RESOURCE, id, start, index, buffer)) {
+        return false;
+    }
 
+    bool success = true;
     const M2MResourceInstanceList &instance_list = resource->resource_instances();
-    if(!instance_list.empty()) {
-        M2MResourceInstanceList::const_iterator it;
-        it = instance_list.begin();
-        for (; it!=instance_list.end(); it++) {
-            uint16_t id = (*it)->instance_id();
-            if (((*it)->operation() & M2MBase::GET_ALLOWED) == M2MBase::GET_ALLOWED) {
-                if(!serialize_resource_instance(id, (*it), nested_data, nested_data_size)) {
-                    /* serializing instance has failed */
-                    /* free data so far allocated */
-                    free(nested_data);
-                    /* return fail immediately*/
-                    success = false;
-                    return success;
-                }
-            }
+    M2MResourceInstanceList::const_iterator it;
+    it = instance_list.begin();
+    for (; it!=instance_list.end() && success; it++) {
+        if (((*it)->operation() & M2MBase::GET_ALLOWED) == M2MBase::GET_ALLOWED) {
+            success = serialize_resource_instance((*it)->instance_id(), (*it), buffer);
         }
     }
-    if(resource->name_id() != -1 &&
-            (resource->operation() & M2MBase::GET_ALLOWED) == M2MBase::GET_ALLOWED) {
-        success = serialize_TILV(TYPE_MULTIPLE_RESOURCE, resource->name_id(),
-                                    nested_data, nested_data_size, data, size);
-    }
 
-    free(nested_data);
-    return success;
+    return end_nested_TLV(TYPE_MULTIPLE_RESOURCE, id, success, start, index, buffer);
 }
 
-bool M2MTLVSerializer::serialize_resource_instance(uint16_t id, const M2MResourceInstance *resource, uint8_t *&data, uint32_t &size)
+bool M2MTLVSerializer::serialize_resource_instance(uint16_t id, const M2MResourceInstance *resource, tlv_buffer_s &buffer)
 {
     bool success;
 
     if ( (resource->resource_instance_type() == M2MResourceBase::INTEGER) ||
          (resource->resource_instance_type() == M2MResourceBase::BOOLEAN) ||
          (resource->resource_instance_type() == M2MResourceBase::TIME) ) {
-        success=serialize_TLV_binary_int(resource, TYPE_RESOURCE_INSTANCE, id, data, size);
+        success=serialize_TLV_binary_int(resource, TYPE_RESOURCE_INSTANCE, id, buffer);
     }
     else if (resource->resource_instance_type() == M2MResourceBase::FLOAT) {
-        success=serialize_TLV_binary_float(resource, TYPE_RESOURCE_INSTANCE, id, data, size);
+        success=serialize_TLV_binary_float(resource, TYPE_RESOURCE_INSTANCE, id, buffer);
     }
     else {
-        success=serialize_TILV(TYPE_RESOURCE_INSTANCE, id, resource->value(), resource->value_length(), data, size);
+        success=serialize_TILV(TYPE_RESOURCE_INSTANCE, id, resource->value(), resource->value_length(), buffer);
     }
 
     return success;
 }
 
+bool M2MTLVSerializer::begin_nested_TLV(uint8_t type, uint16_t id, uint32_t &start, int &index, tlv_buffer_s &buffer)
+{
+    if (!buffer.data) {
+        // Value length is known only after the content has been measured
+        start = buffer.size;
+        index = buffer.nested_sizes.size();
+        buffer.nested_sizes.push_back(0);
+        return true;
+    }
+
+    if (buffer.nested_index >= buffer.nested_sizes.size()) {
+        return false;
+    }
+    uint32_t value_length = buffer.nested_sizes[buffer.nested_index++];
+    if (value_length == NESTED_TLV_SKIPPED) {
+        return false;
+    }
+    return serialize_TIL(type, id, value_length, buffer);
+}
+
+bool M2MTLVSerializer::end_nested_TLV(uint8_t type, uint16_t id, bool success, uint32_t start, int index, tlv_buffer_s &buffer)
+{
+    if (buffer.data) {
+        return success;
+    }
+
+    if (success) {
+        uint32_t value_length = buffer.size - start;
+        buffer.nested_sizes[index] = value_length;
+        buffer.size = start;
+        serialize_TIL(type, id, value_length, buffer);
+        buffer.size += value_length;
+    } else {
+        // Drop the sizes recorded for the content and skip this TLV in the second pass
+        buffer.nested_sizes.resize(index + 1);
+        buffer.nested_sizes[index] = NESTED_TLV_SKIPPED;
+        buffer.size = start;
+    }
+    return success;
+}
+
 /* See, OMA-TS-LightweightM2M-V1_0-20170208-A, Appendix C,
  * Data Types, Integer, Boolean and Time TLV Format */
-bool M2MTLVSerializer::serialize_TLV_binary_int(const M2MResourceBase *resource, uint8_t type, uint16_t id, uint8_t *&data, uint32_t &size)
+bool M2MTLVSerializer::serialize_TLV_binary_int(const M2MResourceBase *resource, uint8_t type, uint16_t id, tlv_buffer_s &buffer)
 {
-    int64_t valueInt = resource->get_value_int();
-    uint32_t buffer_size;
+    const uint32_t buffer_size = resource->resource_instance_type() == M2MResourceBase::BOOLEAN ? 1 : 8;
     /* max len 8 bytes */
-    uint8_t buffer[8];
+    uint8_t value[8];
 
-    if (resource->resource_instance_type() == M2MResourceBase::BOOLEAN) {
-        buffer_size = 1;
-        buffer[0] = valueInt;
-    } else {
-        buffer_size = 8;
-        common_write_64_bit(valueInt, buffer);
+    // Length is fixed, value is needed only when writing
+    if (buffer.data) {
+        int64_t valueInt = resource->get_value_int();
+        if (buffer_size == 1) {
+            value[0] = valueInt;
+        } else {
+            common_write_64_bit(valueInt, value);
+        }
     }
 
-    return serialize_TILV(type, id, buffer, buffer_size, data, size);
+    return serialize_TILV(type, id, value, buffer_size, buffer);
 }
 
 /* See, OMA-TS-LightweightM2M-V1_0-20170208-A, Appendix C,
  * Data Type Float (32 bit only) TLV Format */
-bool M2MTLVSerializer::serialize_TLV_binary_float(const M2MResourceBase *resource, uint8_t type, uint16_t id, uint8_t *&data, uint32_t &size)
+bool M2MTLVSerializer::serialize_TLV_binary_float(const M2MResourceBase *resource, uint8_t type, uint16_t id, tlv_buffer_s &buffer)
 {
-    float valueFloat = resource->get_value_float();
     /* max len 8 bytes */
-    uint8_t buffer[4];
+    uint8_t value[4];
 
-    common_write_32_bit(*(uint32_t*)&valueFloat, buffer);
+    if (buffer.data) {
+        float valueFloat = resource->get_value_float();
+        common_write_32_bit(*(uint32_t*)&valueFloat, value);
+    }
 
-    return serialize_TILV(type, id, buffer, 4, data, size);
+    return serialize_TILV(type, id, value, 4, buffer);
 }
 
+bool M2MTLVSerializer::serialize_TILV(uint8_t type, uint16_t id, const uint8_t *value, uint32_t value_length, tlv_buffer_s &buffer)
+{
+    if (!serialize_TIL(type, id, value_length, buffer)) {
+        return false;
+    }
+
+    if (buffer.data) {
+        if (buffer.capacity - buffer.size < value_length) {
+            return false;
+        }
+        if (value_length) {
+            memcpy(buffer.data + buffer.size, value, value_length);
+        }
+    }
+    buffer.size += value_length;
+    return true;
+}
 
-bool M2MTLVSerializer::serialize_TILV(uint8_t type, uint16_t id, uint8_t *value, uint32_t value_length, uint8_t *&data, uint32_t &size)
+bool M2MTLVSerializer::serialize_TIL(uint8_t type, uint16_t id, uint32_t value_length, tlv_buffer_s &buffer)
 {
-    uint8_t *tlv = 0;
     const uint32_t type_length = TLV_TYPE_SIZE;
     type += id < 256 ? 0 : ID16;
     type += value_length < 8 ? value_length :
@@ -251,24 +336,18 @@ bool M2MTLVSerializer::serialize_TILV(uint8_t type, uint16_t id, uint8_t *value,
     uint8_t length_array[MAX_TLV_LENGTH_SIZE];
     serialize_length(value_length, length_size, length_array);
 
-    tlv = (uint8_t*)malloc(size + type_length + id_size + length_size + value_length);
-    if (!tlv) {
-        /* memory allocation has failed */
-        /* return failure immediately */
-        return false;
-        /* eventually NULL will be returned to serializer public method caller */
-    }
-    if(data) {
-        memcpy(tlv, data, size);
-        free(data);
+    const uint32_t header_size = type_length + id_size + length_size;
+    if (buffer.data) {
+        if (buffer.size > buffer.capacity || buffer.capacity - buffer.size < header_size) {
+            return false;
+        }
+        uint8_t *tlv = buffer.data + buffer.size;
+        memcpy(tlv, &tlv_type, type_length);
+        memcpy(tlv+type_length, id_array, id_size);
+        memcpy(tlv+type_length+id_size, length_array, length_size);
     }
-    memcpy(tlv+size, &tlv_type, type_length);
-    memcpy(tlv+size+type_length, id_array, id_size);
-    memcpy(tlv+size+type_length+id_size, length_array, length_size);
-    memcpy(tlv+size+type_length+id_size+length_size, value, value_length);
 
-    data = tlv;
-    size += type_length + id_size + length_size + value_length;
+    buffer.size += header_size;
     return true;
 }
 
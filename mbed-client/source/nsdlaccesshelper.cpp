@@ -71,6 +71,30 @@ uint8_t __nsdl_c_send_to_server(struct nsdl_s * nsdl_handle,
     return status;
 }
 
+uint8_t __nsdl_c_send_to_server_take(struct nsdl_s * nsdl_handle,
+                                     sn_nsdl_capab_e protocol,
+                                     uint8_t *data_ptr,
+                                     uint16_t data_len,
+                                     sn_nsdl_addr_s *address_ptr)
+{
+    uint8_t status = 0;
+    M2MNsdlInterface *interface = (M2MNsdlInterface*)sn_nsdl_get_context(nsdl_handle);
+#if MBED_CONF_MBED_TRACE_ENABLE
+    coap_version_e version = COAP_VERSION_UNKNOWN;
+    sn_coap_hdr_s *header = sn_coap_parser(nsdl_handle->grs->coap, data_len, data_ptr, &version);
+    sn_nsdl_print_coap_data(header, true);
+    sn_coap_parser_release_allocated_coap_msg_mem(nsdl_handle->grs->coap, header);
+#endif
+    if(interface) {
+        status = interface->send_to_server_take_callback(nsdl_handle,
+                                                         protocol, data_ptr,
+                                                         data_len, address_ptr);
+    } else {
+        __nsdl_c_memory_free(data_ptr);
+    }
+    return status;
+}
+
 uint8_t __nsdl_c_received_from_server(struct nsdl_s * nsdl_handle,
                                       sn_coap_hdr_s *coap_header,
                                       sn_nsdl_addr_s *address_ptr)
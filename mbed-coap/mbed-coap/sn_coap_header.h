@@ -226,6 +226,7 @@ typedef struct sn_coap_hdr_ {
     uint16_t                msg_id;             /**< Message ID. Parser sets parsed message ID, builder sets message ID of built coap message */
     uint16_t                uri_path_len;       /**< 0-255 bytes. Repeatable. */
     uint16_t                payload_len;        /**< Must be set to zero if not used */
+    uint16_t                parsed_mem_len;     /**< Set by parser when message and its option data are one allocation. Must be set to zero otherwise */
 
     uint8_t                *token_ptr;          /**< Must be set to NULL if not used */
     uint8_t                *uri_path_ptr;       /**< Must be set to NULL if not used. E.g: temp1/temp2 */
@@ -297,6 +298,8 @@ typedef struct sn_nsdl_addr_ {
  *
  * \brief Parses CoAP message from given Packet data
  *
+ * Parsed message, its options and option data are allocated as one block. Payload points to the given Packet data.
+ *
  * \param *handle Pointer to CoAP library handle
  *
  * \param packet_data_len is length of given Packet data to be parsed to CoAP message
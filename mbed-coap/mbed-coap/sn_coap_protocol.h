@@ -18,6 +18,16 @@
  * \file sn_coap_protocol.h
  *
  * \brief CoAP C-library User protocol interface header file
+ *
+ * Thread safety: library has no global state besides sn_coap_protocol_init() seeding randLIB.
+ * All other sn_coap_protocol_*, sn_coap_parser* and sn_coap_builder* functions only touch the
+ * given handle, so separate handles can be used concurrently from separate threads as long as the
+ * malloc and free functions given to sn_coap_protocol_init() are thread safe. Calls on the same
+ * handle must be serialized by the caller. Message ID generation of a handle is atomic when the
+ * compiler provides lock-free 16 and 32 bit atomics (__GCC_ATOMIC_*_LOCK_FREE); otherwise it is a
+ * plain update, and a handle must not be used from more than one thread at a time even for that.
+ * sn_coap_protocol_init() takes the random message ID and resend jitter seed of the handle from
+ * randLIB, so it must not run concurrently with other users of randLIB.
  */
 
 #ifdef __cplusplus
@@ -194,6 +204,9 @@ extern void sn_coap_protocol_clear_retransmission_buffer(struct coap_s *handle);
  *
  * \brief Remove saved block data. Can be used to remove the data from RAM to enable storing it to other place.
  *
+ * Received blocks of a transfer are stored contiguously, so a block can be removed once
+ * the blocks before it have been removed.
+ *
  * \param handle Pointer to CoAP library handle
  * \param source_address Addres from where the block has been received.
  * \param payload_length Length of the coap payload of the block.
@@ -34,6 +34,7 @@
  * \brief For Message duplication detection
  * Init value for the maximum count of messages to be stored for duplication detection
  * Setting of this value to 0 will disable duplication check, also reduce use of ROM memory
+ * Stored messages are hash indexed, so values in the hundreds are feasible.
  * Default is set to 0.
  */
 #ifdef MBED_CONF_MBED_CLIENT_SN_COAP_DUPLICATION_MAX_MSGS_COUNT
@@ -34,6 +34,27 @@ extern "C" {
 
 struct sn_coap_hdr_;
 
+/* Compare-and-swap for the per-handle message ID and token counters, so that handles driven from
+ * different threads do not need a common lock. Without lock-free atomics the fallback is a plain
+ * store, which is not atomic: the counters of a handle are then correct only when that handle is
+ * used from one thread, see the thread safety note in sn_coap_protocol.h. Toolchains with
+ * atomics of their own can define these macros before including this header. */
+#ifndef SN_COAP_ATOMIC_CAS_16
+#if defined(__GCC_ATOMIC_SHORT_LOCK_FREE) && (__GCC_ATOMIC_SHORT_LOCK_FREE == 2)
+#define SN_COAP_ATOMIC_CAS_16(ptr, old_value, new_value) __sync_bool_compare_and_swap((ptr), (old_value), (new_value))
+#else
+#define SN_COAP_ATOMIC_CAS_16(ptr, old_value, new_value) (*(ptr) = (new_value), true)
+#endif
+#endif
+
+#ifndef SN_COAP_ATOMIC_CAS_32
+#if defined(__GCC_ATOMIC_INT_LOCK_FREE) && (__GCC_ATOMIC_INT_LOCK_FREE == 2)
+#define SN_COAP_ATOMIC_CAS_32(ptr, old_value, new_value) __sync_bool_compare_and_swap((ptr), (old_value), (new_value))
+#else
+#define SN_COAP_ATOMIC_CAS_32(ptr, old_value, new_value) (*(ptr) = (new_value), true)
+#endif
+#endif
+
 #define RESPONSE_RANDOM_FACTOR                      1.5   /**< Resending random factor, value is specified in IETF CoAP specification */
 
 /* * For Option handling * */
@@ -41,12 +62,31 @@ struct sn_coap_hdr_;
 #define COAP_OPTION_URI_PORT_NONE                   (-1) /**< Internal value to represent no Uri-Port option */
 #define COAP_OPTION_BLOCK_NONE                      (-1) /**< Internal value to represent no Block1/2 option */
 
+/* * For Blockwise reassembly * */
+#define SN_COAP_BLOCKWISE_UNIT_SIZE                 16 /**< Smallest CoAP block size, granularity of received blocks bitmap */
+
 int8_t prepare_blockwise_message(struct coap_s *handle, struct sn_coap_hdr_ *coap_hdr_ptr);
 
+/* Slot of an open addressing index over stored messages, keyed by address, port and Message ID */
+typedef struct coap_msg_index_slot_ {
+    void                    *entry;     /* Indexed message, NULL when the slot is free */
+    const sn_nsdl_addr_s    *address;   /* Address of the indexed message, owned by the entry */
+    uint16_t                msg_id;
+    uint16_t                hash;       /* Hash of the key, the home slot is hash & (size - 1) */
+} coap_msg_index_slot_s;
+
+/* Hash index kept next to a Linked list, so that messages can be found without a list scan */
+typedef struct coap_msg_index_ {
+    coap_msg_index_slot_s   *slots;
+    uint16_t                size;       /* Slot count, power of two or 0 when nothing is allocated */
+    uint16_t                count;
+} coap_msg_index_s;
+
 /* Structure which is stored to Linked list for message sending purposes */
 typedef struct coap_send_msg_ {
     uint8_t             resending_counter;  /* Tells how many times message is still tried to resend */
     uint32_t            resending_time;     /* Tells next resending time */
+    uint16_t            msg_id;             /* Message ID of the stored packet */
 
     sn_nsdl_transmit_s *send_msg_ptr;
 
@@ -65,9 +105,10 @@ typedef struct coap_duplication_info_ {
     uint16_t            packet_len;
     uint8_t             *packet_ptr;
     struct coap_s       *coap;  /* CoAP library handle */
-    sn_nsdl_addr_s      *address;
+    sn_nsdl_addr_s      address; /* addr_ptr points to addr_data */
     void                *param;
     ns_list_link_t      link;
+    uint8_t             addr_data[]; /* Address bytes, allocated together with the struct */
 } coap_duplication_info_s;
 
 typedef NS_LIST_HEAD(coap_duplication_info_s, link) coap_duplication_info_list_t;
@@ -87,26 +128,37 @@ typedef struct coap_blockwise_msg_ {
 
 typedef NS_LIST_HEAD(coap_blockwise_msg_s, link) coap_blockwise_msg_list_t;
 
-/* Structure which is stored to Linked list for blockwise messages receiving purposes */
+/* Structure which is stored to Linked list for blockwise messages receiving purposes.
+ * All blocks of one transfer (address and token as key) are reassembled into a single buffer. */
 typedef struct coap_blockwise_payload_ {
-    uint32_t            timestamp; /* Tells when Payload is stored to Linked list */
+    uint32_t            timestamp; /* Tells when last block is stored to Linked list */
 
     uint8_t             addr_len;
     uint8_t             *addr_ptr;
     uint16_t            port;
-    uint32_t            block_number;
+    uint32_t            block_number;   /* Number of the last stored block */
+    uint32_t            block_offset;   /* Offset of the last stored block in the transfer */
+    uint16_t            block_size;     /* Size of the last stored block */
     uint8_t             *token_ptr;
     uint8_t             token_len;
 
-    uint16_t            payload_len;
+    uint32_t            payload_offset; /* Offset of payload_ptr[0] in the transfer, data before it is released */
+    uint16_t            payload_len;    /* Reassembled length from payload_offset */
+    uint16_t            payload_size;   /* Allocated length of payload_ptr */
     uint8_t             *payload_ptr;
+    uint8_t             *block_bitmap;  /* Received units of payload_ptr, one bit per SN_COAP_BLOCKWISE_UNIT_SIZE bytes */
     struct coap_s       *coap;  /* CoAP library handle */
 
     ns_list_link_t     link;
+    uint8_t             data[]; /* Address and token, allocated together with the struct */
 } coap_blockwise_payload_s;
 
 typedef NS_LIST_HEAD(coap_blockwise_payload_s, link) coap_blockwise_payload_list_t;
 
+/* Releases released_len bytes from the beginning of the reassembled data of a transfer,
+ * used when the application has already stored the data to other place */
+void sn_coap_protocol_linked_list_blockwise_payload_release(coap_blockwise_payload_s *payload_info_ptr, uint16_t released_len);
+
 struct coap_s {
     void *(*sn_coap_protocol_malloc)(uint16_t);
     void (*sn_coap_protocol_free)(void *);
@@ -116,11 +168,15 @@ struct coap_s {
 
     #if ENABLE_RESENDINGS /* If Message resending is not used at all, this part of code will not be compiled */
         coap_send_msg_list_t linked_list_resent_msgs; /* Active resending messages are stored to this Linked list */
+        coap_msg_index_s index_resent_msgs; /* Index of linked_list_resent_msgs for searching replies */
         uint16_t count_resent_msgs;
+        uint32_t size_resent_msgs; /* Total packet length of the active resending messages */
+        uint32_t resend_random_state; /* State of the resend time jitter generator of this handle */
     #endif
 
     #if SN_COAP_DUPLICATION_MAX_MSGS_COUNT /* If Message duplication detection is not used at all, this part of code will not be compiled */
         coap_duplication_info_list_t  linked_list_duplication_msgs; /* Messages for duplicated messages detection is stored to this Linked list */
+        coap_msg_index_s              index_duplication_msgs; /* Index of linked_list_duplication_msgs for detecting duplicates */
         uint16_t                      count_duplication_msgs;
     #endif
 
@@ -130,12 +186,13 @@ struct coap_s {
     #endif
 
     uint32_t system_time;    /* System time seconds */
+    uint16_t message_id;     /* Next Message ID of this handle, updated with SN_COAP_ATOMIC_CAS_16 */
     uint16_t sn_coap_block_data_size;
-    uint8_t sn_coap_resending_queue_msgs;
+    uint16_t sn_coap_resending_queue_msgs;
     uint32_t sn_coap_resending_queue_bytes;
     uint8_t sn_coap_resending_count;
     uint8_t sn_coap_resending_intervall;
-    uint8_t sn_coap_duplication_buffer_size;
+    uint16_t sn_coap_duplication_buffer_size;
     uint8_t sn_coap_internal_block2_resp_handling; /* If this is set then coap itself sends a next GET request automatically */
 };
 
@@ -38,13 +38,25 @@
 #include "mbed-trace/mbed_trace.h"
 
 #define TRACE_GROUP "coap"
+
+/* Unused part of the single allocation holding a parsed message */
+typedef struct sn_coap_parser_mem_ {
+    uint8_t *ptr;
+    uint8_t *end_ptr;
+} sn_coap_parser_mem_s;
+
 /* * * * * * * * * * * * * * * * * * * * */
 /* * * * LOCAL FUNCTION PROTOTYPES * * * */
 /* * * * * * * * * * * * * * * * * * * * */
 
+static sn_coap_hdr_s *sn_coap_parser_alloc_parsed_message(struct coap_s *handle, uint16_t packet_data_len, uint8_t *packet_data_ptr, sn_coap_parser_mem_s *mem_ptr);
+static uint16_t sn_coap_parser_count_needed_memory(uint16_t packet_data_len, uint8_t *packet_data_ptr, bool *options_needed_ptr);
+static void    *sn_coap_parser_mem_alloc(struct coap_s *handle, sn_coap_parser_mem_s *mem_ptr, uint16_t len);
+static void     sn_coap_parser_mem_free(struct coap_s *handle, sn_coap_hdr_s *coap_msg_ptr, void *ptr);
+static void     sn_coap_parser_init_options(sn_coap_options_list_s *options_list_ptr);
 static void     sn_coap_parser_header_parse(uint8_t **packet_data_pptr, sn_coap_hdr_s *dst_coap_msg_ptr, coap_version_e *coap_version_ptr);
-static int8_t   sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **packet_data_pptr, sn_coap_hdr_s *dst_coap_msg_ptr, uint8_t *packet_data_start_ptr, uint16_t packet_len);
-static int8_t   sn_coap_parser_options_parse_multiple_options(struct coap_s *handle, uint8_t **packet_data_pptr, uint16_t packet_left_len,  uint8_t **dst_pptr, uint16_t *dst_len_ptr, sn_coap_option_numbers_e option, uint16_t option_number_len);
+static int8_t   sn_coap_parser_options_parse(struct coap_s *handle, sn_coap_parser_mem_s *mem_ptr, uint8_t **packet_data_pptr, sn_coap_hdr_s *dst_coap_msg_ptr, uint8_t *packet_data_start_ptr, uint16_t packet_len);
+static int8_t   sn_coap_parser_options_parse_multiple_options(struct coap_s *handle, sn_coap_parser_mem_s *mem_ptr, uint8_t **packet_data_pptr, uint16_t packet_left_len,  uint8_t **dst_pptr, uint16_t *dst_len_ptr, sn_coap_option_numbers_e option, uint16_t option_number_len);
 static int16_t  sn_coap_parser_options_count_needed_memory_multiple_option(uint8_t *packet_data_ptr, uint16_t packet_left_len, sn_coap_option_numbers_e option, uint16_t option_number_len);
 static int8_t   sn_coap_parser_payload_parse(uint16_t packet_data_len, uint8_t *packet_data_start_ptr, uint8_t **packet_data_pptr, sn_coap_hdr_s *dst_coap_msg_ptr);
 
@@ -99,15 +111,7 @@ sn_coap_options_list_s *sn_coap_parser_alloc_options(struct coap_s *handle, sn_c
         return NULL;
     }
 
-    /* XXX not technically legal to memset pointers to 0 */
-    memset(coap_msg_ptr->options_list_ptr, 0x00, sizeof(sn_coap_options_list_s));
-
-    coap_msg_ptr->options_list_ptr->max_age = 0;
-    coap_msg_ptr->options_list_ptr->uri_port = COAP_OPTION_URI_PORT_NONE;
-    coap_msg_ptr->options_list_ptr->observe = COAP_OBSERVE_NONE;
-    coap_msg_ptr->options_list_ptr->accept = COAP_CT_NONE;
-    coap_msg_ptr->options_list_ptr->block2 = COAP_OPTION_BLOCK_NONE;
-    coap_msg_ptr->options_list_ptr->block1 = COAP_OPTION_BLOCK_NONE;
+    sn_coap_parser_init_options(coap_msg_ptr->options_list_ptr);
 
     return coap_msg_ptr->options_list_ptr;
 }
@@ -116,14 +120,15 @@ sn_coap_hdr_s *sn_coap_parser(struct coap_s *handle, uint16_t packet_data_len, u
 {
     uint8_t       *data_temp_ptr                    = packet_data_ptr;
     sn_coap_hdr_s *parsed_and_returned_coap_msg_ptr = NULL;
+    sn_coap_parser_mem_s mem;
 
     /* * * * Check given pointer * * * */
     if (packet_data_ptr == NULL || packet_data_len < 4 || handle == NULL) {
         return NULL;
     }
 
-    /* * * * Allocate and initialize CoAP message  * * * */
-    parsed_and_returned_coap_msg_ptr = sn_coap_parser_alloc_message(handle);
+    /* * * * Allocate and initialize CoAP message, options and option data in one go * * * */
+    parsed_and_returned_coap_msg_ptr = sn_coap_parser_alloc_parsed_message(handle, packet_data_len, packet_data_ptr, &mem);
 
     if (parsed_and_returned_coap_msg_ptr == NULL) {
         tr_error("sn_coap_parser - failed to allocate message!");
@@ -134,7 +139,7 @@ sn_coap_hdr_s *sn_coap_parser(struct coap_s *handle, uint16_t packet_data_len, u
     sn_coap_parser_header_parse(&data_temp_ptr, parsed_and_returned_coap_msg_ptr, coap_version_ptr);
 
     /* * * * Options parsing, move pointer over the options... * * * */
-    if (sn_coap_parser_options_parse(handle, &data_temp_ptr, parsed_and_returned_coap_msg_ptr, packet_data_ptr, packet_data_len) != 0) {
+    if (sn_coap_parser_options_parse(handle, &mem, &data_temp_ptr, parsed_and_returned_coap_msg_ptr, packet_data_ptr, packet_data_len) != 0) {
         parsed_and_returned_coap_msg_ptr->coap_status = COAP_STATUS_PARSER_ERROR_IN_HEADER;
         return parsed_and_returned_coap_msg_ptr;
     }
@@ -156,44 +161,199 @@ void sn_coap_parser_release_allocated_coap_msg_mem(struct coap_s *handle, sn_coa
     }
 
     if (freed_coap_msg_ptr != NULL) {
-        if (freed_coap_msg_ptr->uri_path_ptr != NULL) {
-            handle->sn_coap_protocol_free(freed_coap_msg_ptr->uri_path_ptr);
-        }
+        sn_coap_parser_mem_free(handle, freed_coap_msg_ptr, freed_coap_msg_ptr->uri_path_ptr);
+        sn_coap_parser_mem_free(handle, freed_coap_msg_ptr, freed_coap_msg_ptr->token_ptr);
 
-        if (freed_coap_msg_ptr->token_ptr != NULL) {
-            handle->sn_coap_protocol_free(freed_coap_msg_ptr->token_ptr);
+        if (freed_coap_msg_ptr->options_list_ptr != NULL) {
+            sn_coap_parser_mem_free(handle, freed_coap_msg_ptr, freed_coap_msg_ptr->options_list_ptr->proxy_uri_ptr);
+            sn_coap_parser_mem_free(handle, freed_coap_msg_ptr, freed_coap_msg_ptr->options_list_ptr->etag_ptr);
+            sn_coap_parser_mem_free(handle, freed_coap_msg_ptr, freed_coap_msg_ptr->options_list_ptr->uri_host_ptr);
+            sn_coap_parser_mem_free(handle, freed_coap_msg_ptr, freed_coap_msg_ptr->options_list_ptr->location_path_ptr);
+            sn_coap_parser_mem_free(handle, freed_coap_msg_ptr, freed_coap_msg_ptr->options_list_ptr->location_query_ptr);
+            sn_coap_parser_mem_free(handle, freed_coap_msg_ptr, freed_coap_msg_ptr->options_list_ptr->uri_query_ptr);
+            sn_coap_parser_mem_free(handle, freed_coap_msg_ptr, freed_coap_msg_ptr->options_list_ptr);
         }
 
-        if (freed_coap_msg_ptr->options_list_ptr != NULL) {
-            if (freed_coap_msg_ptr->options_list_ptr->proxy_uri_ptr != NULL) {
-                handle->sn_coap_protocol_free(freed_coap_msg_ptr->options_list_ptr->proxy_uri_ptr);
-            }
+        handle->sn_coap_protocol_free(freed_coap_msg_ptr);
+    }
+}
 
-            if (freed_coap_msg_ptr->options_list_ptr->etag_ptr != NULL) {
-                handle->sn_coap_protocol_free(freed_coap_msg_ptr->options_list_ptr->etag_ptr);
-            }
+/**
+ * \fn static sn_coap_hdr_s *sn_coap_parser_alloc_parsed_message(struct coap_s *handle, uint16_t packet_data_len, uint8_t *packet_data_ptr, sn_coap_parser_mem_s *mem_ptr)
+ *
+ * \brief Allocates CoAP message for parsing given Packet data
+ *
+ * Message, options list and room for token and option data are allocated as one block, so parsing
+ * a packet takes a single allocation. Payload is not copied, it keeps pointing to the Packet data.
+ *
+ * \param *handle Pointer to CoAP library handle
+ *
+ * \param packet_data_len is length of given Packet data
+ *
+ * \param *packet_data_ptr is source for Packet data to be parsed
+ *
+ * \param *mem_ptr is destination for the unused part of the allocated block
+ *
+ * \return Return value is pointer to initialized CoAP message. NULL in failure case.
+ */
+static sn_coap_hdr_s *sn_coap_parser_alloc_parsed_message(struct coap_s *handle, uint16_t packet_data_len, uint8_t *packet_data_ptr, sn_coap_parser_mem_s *mem_ptr)
+{
+    sn_coap_hdr_s *coap_msg_ptr;
+    bool           options_needed = false;
+    uint32_t       needed_mem     = sizeof(sn_coap_hdr_s);
 
-            if (freed_coap_msg_ptr->options_list_ptr->uri_host_ptr != NULL) {
-                handle->sn_coap_protocol_free(freed_coap_msg_ptr->options_list_ptr->uri_host_ptr);
-            }
+    needed_mem += sn_coap_parser_count_needed_memory(packet_data_len, packet_data_ptr, &options_needed);
+    if (options_needed) {
+        needed_mem += sizeof(sn_coap_options_list_s);
+    }
 
-            if (freed_coap_msg_ptr->options_list_ptr->location_path_ptr != NULL) {
-                handle->sn_coap_protocol_free(freed_coap_msg_ptr->options_list_ptr->location_path_ptr);
-            }
+    mem_ptr->ptr = NULL;
+    mem_ptr->end_ptr = NULL;
 
-            if (freed_coap_msg_ptr->options_list_ptr->location_query_ptr != NULL) {
-                handle->sn_coap_protocol_free(freed_coap_msg_ptr->options_list_ptr->location_query_ptr);
-            }
+    /* Block size must fit to parsed_mem_len, huge option parts are allocated separately */
+    if (needed_mem > UINT16_MAX) {
+        return sn_coap_parser_alloc_message(handle);
+    }
 
-            if (freed_coap_msg_ptr->options_list_ptr->uri_query_ptr != NULL) {
-                handle->sn_coap_protocol_free(freed_coap_msg_ptr->options_list_ptr->uri_query_ptr);
-            }
+    coap_msg_ptr = sn_coap_parser_init_message(handle->sn_coap_protocol_malloc(needed_mem));
+    if (coap_msg_ptr == NULL) {
+        return NULL;
+    }
+
+    coap_msg_ptr->parsed_mem_len = needed_mem;
+    mem_ptr->ptr = (uint8_t *)(coap_msg_ptr + 1);
+    mem_ptr->end_ptr = (uint8_t *)coap_msg_ptr + needed_mem;
+
+    if (options_needed) {
+        coap_msg_ptr->options_list_ptr = (sn_coap_options_list_s *)mem_ptr->ptr;
+        sn_coap_parser_init_options(coap_msg_ptr->options_list_ptr);
+        mem_ptr->ptr += sizeof(sn_coap_options_list_s);
+    }
+
+    return coap_msg_ptr;
+}
+
+/**
+ * \fn static uint16_t sn_coap_parser_count_needed_memory(uint16_t packet_data_len, uint8_t *packet_data_ptr, bool *options_needed_ptr)
+ *
+ * \brief Counts memory needed for token and option data of given Packet data
+ *
+ * Options are only walked through here, validating them is left to the actual parsing. Parsed
+ * option data never exceeds the encoded options, separators of multi-part options replace
+ * option headers.
+ *
+ * \param packet_data_len is length of given Packet data
+ *
+ * \param *packet_data_ptr is source for Packet data to be parsed
+ *
+ * \param *options_needed_ptr is set if Packet data has options stored in options list
+ *
+ * \return Return value is length of token and options part of Packet data
+ */
+static uint16_t sn_coap_parser_count_needed_memory(uint16_t packet_data_len, uint8_t *packet_data_ptr, bool *options_needed_ptr)
+{
+    uint8_t  *data_ptr      = packet_data_ptr + 4 + (*packet_data_ptr & COAP_HEADER_TOKEN_LENGTH_MASK);
+    uint8_t  *end_ptr       = packet_data_ptr + packet_data_len;
+    uint16_t  option_number = 0;
 
-            handle->sn_coap_protocol_free(freed_coap_msg_ptr->options_list_ptr);
+    while (data_ptr < end_ptr && *data_ptr != 0xff) {
+        uint16_t option_delta = *data_ptr >> COAP_OPTIONS_OPTION_NUMBER_SHIFT;
+        uint16_t option_len   = *data_ptr & 0x0F;
+
+        data_ptr++;
+
+        if (option_delta == 13 && data_ptr < end_ptr) {
+            option_delta = *data_ptr++ + 13;
+        } else if (option_delta == 14 && (end_ptr - data_ptr) >= 2) {
+            option_delta = (data_ptr[0] << 8) + data_ptr[1] + 269;
+            data_ptr += 2;
         }
 
-        handle->sn_coap_protocol_free(freed_coap_msg_ptr);
+        if (option_len == 13 && data_ptr < end_ptr) {
+            option_len = *data_ptr++ + 13;
+        } else if (option_len == 14 && (end_ptr - data_ptr) >= 2) {
+            option_len = (data_ptr[0] << 8) + data_ptr[1] + 269;
+            data_ptr += 2;
+        }
+
+        option_number += option_delta;
+        if (option_number != COAP_OPTION_URI_PATH && option_number != COAP_OPTION_CONTENT_FORMAT) {
+            *options_needed_ptr = true;
+        }
+
+        if ((end_ptr - data_ptr) <= option_len) {
+            data_ptr = end_ptr;
+        } else {
+            data_ptr += option_len;
+        }
+    }
+
+    if (data_ptr > end_ptr) {
+        data_ptr = end_ptr;
+    }
+
+    return data_ptr - (packet_data_ptr + 4);
+}
+
+/**
+ * \brief Takes memory for token or option data from the parsed message block
+ *
+ * \param *handle Pointer to CoAP library handle
+ * \param *mem_ptr is the unused part of the parsed message block
+ * \param len is length of needed memory
+ *
+ * \return Return value is pointer to memory. If the block is used up, memory is allocated separately.
+ */
+static void *sn_coap_parser_mem_alloc(struct coap_s *handle, sn_coap_parser_mem_s *mem_ptr, uint16_t len)
+{
+    uint8_t *ptr = mem_ptr->ptr;
+
+    if ((mem_ptr->end_ptr - ptr) < len) {
+        return handle->sn_coap_protocol_malloc(len);
+    }
+
+    mem_ptr->ptr += len;
+    return ptr;
+}
+
+/**
+ * \brief Frees token or option data of a message, unless it is part of the parsed message block
+ *
+ * \param *handle Pointer to CoAP library handle
+ * \param *coap_msg_ptr is the message owning the memory
+ * \param *ptr is memory to be freed, may be NULL
+ */
+static void sn_coap_parser_mem_free(struct coap_s *handle, sn_coap_hdr_s *coap_msg_ptr, void *ptr)
+{
+    uint8_t *msg_ptr = (uint8_t *)coap_msg_ptr;
+
+    if (ptr == NULL) {
+        return;
     }
+
+    if ((uint8_t *)ptr >= msg_ptr && (uint8_t *)ptr < msg_ptr + coap_msg_ptr->parsed_mem_len) {
+        return;
+    }
+
+    handle->sn_coap_protocol_free(ptr);
+}
+
+/**
+ * \brief Initializes options list with default values
+ *
+ * \param *options_list_ptr is options list to be initialized
+ */
+static void sn_coap_parser_init_options(sn_coap_options_list_s *options_list_ptr)
+{
+    /* XXX not technically legal to memset pointers to 0 */
+    memset(options_list_ptr, 0x00, sizeof(sn_coap_options_list_s));
+
+    options_list_ptr->max_age = 0;
+    options_list_ptr->uri_port = COAP_OPTION_URI_PORT_NONE;
+    options_list_ptr->observe = COAP_OBSERVE_NONE;
+    options_list_ptr->accept = COAP_CT_NONE;
+    options_list_ptr->block2 = COAP_OPTION_BLOCK_NONE;
+    options_list_ptr->block1 = COAP_OPTION_BLOCK_NONE;
 }
 
 /**
@@ -253,7 +413,7 @@ static uint32_t sn_coap_parser_options_parse_uint(uint8_t **packet_data_pptr, ui
  *
  * \return Return value is 0 in ok case and -1 in failure case
  */
-static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **packet_data_pptr, sn_coap_hdr_s *dst_coap_msg_ptr, uint8_t *packet_data_start_ptr, uint16_t packet_len)
+static int8_t sn_coap_parser_options_parse(struct coap_s *handle, sn_coap_parser_mem_s *mem_ptr, uint8_t **packet_data_pptr, sn_coap_hdr_s *dst_coap_msg_ptr, uint8_t *packet_data_start_ptr, uint16_t packet_len)
 {
     uint8_t previous_option_number = 0;
     uint8_t i                      = 0;
@@ -269,7 +429,7 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
             return -1;
         }
 
-        dst_coap_msg_ptr->token_ptr = handle->sn_coap_protocol_malloc(dst_coap_msg_ptr->token_len);
+        dst_coap_msg_ptr->token_ptr = sn_coap_parser_mem_alloc(handle, mem_ptr, dst_coap_msg_ptr->token_len);
 
         if (dst_coap_msg_ptr->token_ptr == NULL) {
             tr_error("sn_coap_parser_options_parse - failed to allocate token!");
@@ -379,7 +539,7 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
                 dst_coap_msg_ptr->options_list_ptr->proxy_uri_len = option_len;
                 (*packet_data_pptr)++;
 
-                dst_coap_msg_ptr->options_list_ptr->proxy_uri_ptr = handle->sn_coap_protocol_malloc(option_len);
+                dst_coap_msg_ptr->options_list_ptr->proxy_uri_ptr = sn_coap_parser_mem_alloc(handle, mem_ptr, option_len);
 
                 if (dst_coap_msg_ptr->options_list_ptr->proxy_uri_ptr == NULL) {
                     tr_error("sn_coap_parser_options_parse - COAP_OPTION_PROXY_URI allocation failed!");
@@ -394,7 +554,7 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
             case COAP_OPTION_ETAG:
                 /* This is managed independently because User gives this option in one character table */
 
-                ret_status = sn_coap_parser_options_parse_multiple_options(handle, packet_data_pptr,
+                ret_status = sn_coap_parser_options_parse_multiple_options(handle, mem_ptr, packet_data_pptr,
                              message_left,
                              &dst_coap_msg_ptr->options_list_ptr->etag_ptr,
                              (uint16_t *)&dst_coap_msg_ptr->options_list_ptr->etag_len,
@@ -415,7 +575,7 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
                 dst_coap_msg_ptr->options_list_ptr->uri_host_len = option_len;
                 (*packet_data_pptr)++;
 
-                dst_coap_msg_ptr->options_list_ptr->uri_host_ptr = handle->sn_coap_protocol_malloc(option_len);
+                dst_coap_msg_ptr->options_list_ptr->uri_host_ptr = sn_coap_parser_mem_alloc(handle, mem_ptr, option_len);
 
                 if (dst_coap_msg_ptr->options_list_ptr->uri_host_ptr == NULL) {
                     tr_error("sn_coap_parser_options_parse - COAP_OPTION_URI_HOST allocation failed!");
@@ -432,7 +592,7 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
                     return -1;
                 }
                 /* This is managed independently because User gives this option in one character table */
-                ret_status = sn_coap_parser_options_parse_multiple_options(handle, packet_data_pptr, message_left,
+                ret_status = sn_coap_parser_options_parse_multiple_options(handle, mem_ptr, packet_data_pptr, message_left,
                              &dst_coap_msg_ptr->options_list_ptr->location_path_ptr, &dst_coap_msg_ptr->options_list_ptr->location_path_len,
                              COAP_OPTION_LOCATION_PATH, option_len);
                 if (ret_status >= 0) {
@@ -456,7 +616,7 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
                 break;
 
             case COAP_OPTION_LOCATION_QUERY:
-                ret_status = sn_coap_parser_options_parse_multiple_options(handle, packet_data_pptr, message_left,
+                ret_status = sn_coap_parser_options_parse_multiple_options(handle, mem_ptr, packet_data_pptr, message_left,
                              &dst_coap_msg_ptr->options_list_ptr->location_query_ptr, &dst_coap_msg_ptr->options_list_ptr->location_query_len,
                              COAP_OPTION_LOCATION_QUERY, option_len);
                 if (ret_status >= 0) {
@@ -469,7 +629,7 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
                 break;
 
             case COAP_OPTION_URI_PATH:
-                ret_status = sn_coap_parser_options_parse_multiple_options(handle, packet_data_pptr, message_left,
+                ret_status = sn_coap_parser_options_parse_multiple_options(handle, mem_ptr, packet_data_pptr, message_left,
                              &dst_coap_msg_ptr->uri_path_ptr, &dst_coap_msg_ptr->uri_path_len,
                              COAP_OPTION_URI_PATH, option_len);
                 if (ret_status >= 0) {
@@ -494,7 +654,7 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
                 break;
 
             case COAP_OPTION_URI_QUERY:
-                ret_status = sn_coap_parser_options_parse_multiple_options(handle, packet_data_pptr, message_left,
+                ret_status = sn_coap_parser_options_parse_multiple_options(handle, mem_ptr, packet_data_pptr, message_left,
                              &dst_coap_msg_ptr->options_list_ptr->uri_query_ptr, &dst_coap_msg_ptr->options_list_ptr->uri_query_len,
                              COAP_OPTION_URI_QUERY, option_len);
                 if (ret_status >= 0) {
@@ -593,7 +753,7 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
  *
  * \return Return value is count of Uri-query optios parsed. In failure case -1 is returned.
 */
-static int8_t sn_coap_parser_options_parse_multiple_options(struct coap_s *handle, uint8_t **packet_data_pptr, uint16_t packet_left_len,  uint8_t **dst_pptr, uint16_t *dst_len_ptr, sn_coap_option_numbers_e option, uint16_t option_number_len)
+static int8_t sn_coap_parser_options_parse_multiple_options(struct coap_s *handle, sn_coap_parser_mem_s *mem_ptr, uint8_t **packet_data_pptr, uint16_t packet_left_len,  uint8_t **dst_pptr, uint16_t *dst_len_ptr, sn_coap_option_numbers_e option, uint16_t option_number_len)
 {
     int16_t     uri_query_needed_heap       = sn_coap_parser_options_count_needed_memory_multiple_option(*packet_data_pptr, packet_left_len, option, option_number_len);
     uint8_t    *temp_parsed_uri_query_ptr   = NULL;
@@ -604,7 +764,7 @@ static int8_t sn_coap_parser_options_parse_multiple_options(struct coap_s *handl
     }
 
     if (uri_query_needed_heap) {
-        *dst_pptr = (uint8_t *) handle->sn_coap_protocol_malloc(uri_query_needed_heap);
+        *dst_pptr = (uint8_t *) sn_coap_parser_mem_alloc(handle, mem_ptr, uri_query_needed_heap);
 
         if (*dst_pptr == NULL) {
             tr_error("sn_coap_parser_options_parse_multiple_options - failed to allocate options!");
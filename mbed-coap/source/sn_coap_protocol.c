@@ -50,21 +50,22 @@
 #if SN_COAP_DUPLICATION_MAX_MSGS_COUNT/* If Message duplication detection is not used at all, this part of code will not be compiled */
 static void                  sn_coap_protocol_linked_list_duplication_info_store(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id, void *param);
 static coap_duplication_info_s *sn_coap_protocol_linked_list_duplication_info_search(const struct coap_s *handle, const sn_nsdl_addr_s *scr_addr_ptr, const uint16_t msg_id);
-static void                  sn_coap_protocol_linked_list_duplication_info_remove(struct coap_s *handle, uint8_t *scr_addr_ptr, uint16_t port, uint16_t msg_id);
+static void                  sn_coap_protocol_linked_list_duplication_info_remove(struct coap_s *handle, coap_duplication_info_s *removed_duplication_info_ptr);
 static void                  sn_coap_protocol_linked_list_duplication_info_remove_old_ones(struct coap_s *handle);
 static bool                  sn_coap_protocol_update_duplicate_package_data(const struct coap_s *handle, const sn_nsdl_addr_s *dst_addr_ptr, const sn_coap_hdr_s *coap_msg_ptr, const int16_t data_size, const uint8_t *dst_packet_data_ptr);
 #endif
 
 #if SN_COAP_BLOCKWISE_ENABLED || SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE /* If Message blockwising is not enabled, this part of code will not be compiled */
 static void                  sn_coap_protocol_linked_list_blockwise_msg_remove(struct coap_s *handle, coap_blockwise_msg_s *removed_msg_ptr);
-static void                  sn_coap_protocol_linked_list_blockwise_payload_store(struct coap_s *handle, sn_nsdl_addr_s *addr_ptr, uint16_t stored_payload_len, uint8_t *stored_payload_ptr, uint8_t *token_ptr, uint8_t token_len, uint32_t block_number);
-static uint8_t              *sn_coap_protocol_linked_list_blockwise_payload_search(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint16_t *payload_length, uint8_t *token_ptr, uint8_t token_len);
+static bool                  sn_coap_protocol_linked_list_blockwise_payload_alloc(struct coap_s *handle, coap_blockwise_payload_s *payload_info_ptr, uint32_t needed_size, uint32_t total_size);
+static bool                  sn_coap_protocol_linked_list_blockwise_payload_store(struct coap_s *handle, sn_nsdl_addr_s *addr_ptr, uint16_t stored_payload_len, uint8_t *stored_payload_ptr, uint8_t *token_ptr, uint8_t token_len, uint32_t block_number, uint16_t block_size, uint32_t total_size);
+static coap_blockwise_payload_s *sn_coap_protocol_linked_list_blockwise_payload_search(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint8_t *token_ptr, uint8_t token_len);
 static bool                  sn_coap_protocol_linked_list_blockwise_payload_compare_block_number(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint8_t *token_ptr, uint8_t token_len, uint32_t block_number);
+static uint8_t              *sn_coap_protocol_linked_list_blockwise_payload_take(struct coap_s *handle, coap_blockwise_payload_s *payload_info_ptr, uint16_t *payload_length);
 static void                  sn_coap_protocol_linked_list_blockwise_payload_remove(struct coap_s *handle, coap_blockwise_payload_s *removed_payload_ptr);
-static void                  sn_coap_protocol_linked_list_blockwise_payload_remove_oldest(struct coap_s *handle, uint8_t *token_ptr, uint8_t token_len);
-static uint32_t              sn_coap_protocol_linked_list_blockwise_payloads_get_len(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint8_t *token_ptr, uint8_t token_len);
 static void                  sn_coap_protocol_handle_blockwise_timout(struct coap_s *handle);
 static sn_coap_hdr_s        *sn_coap_handle_blockwise_message(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, sn_coap_hdr_s *received_coap_msg_ptr, void *param);
+static void                  sn_coap_protocol_send_block1_error(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, const sn_coap_hdr_s *received_coap_msg_ptr, sn_coap_msg_code_e msg_code, void *param);
 static sn_coap_hdr_s        *sn_coap_protocol_copy_header(struct coap_s *handle, sn_coap_hdr_s *source_header_ptr);
 #endif
 
@@ -72,16 +73,19 @@ static sn_coap_hdr_s        *sn_coap_protocol_copy_header(struct coap_s *handle,
 static uint8_t               sn_coap_protocol_linked_list_send_msg_store(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_ptr, uint16_t send_packet_data_len, uint8_t *send_packet_data_ptr, uint32_t sending_time, void *param);
 static sn_nsdl_transmit_s   *sn_coap_protocol_linked_list_send_msg_search(struct coap_s *handle,sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id);
 static void                  sn_coap_protocol_linked_list_send_msg_remove(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id);
+static void                  sn_coap_protocol_linked_list_send_msg_unlink(struct coap_s *handle, coap_send_msg_s *removed_msg_ptr);
 static coap_send_msg_s      *sn_coap_protocol_allocate_mem_for_msg(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_ptr, uint16_t packet_data_len);
 static void                  sn_coap_protocol_release_allocated_send_msg_mem(struct coap_s *handle, coap_send_msg_s *freed_send_msg_ptr);
-static uint16_t              sn_coap_count_linked_list_size(const coap_send_msg_list_t *linked_list_ptr);
-static uint32_t              sn_coap_calculate_new_resend_time(const uint32_t current_time, const uint8_t interval, const uint8_t counter);
+static uint32_t              sn_coap_calculate_new_resend_time(struct coap_s *handle, const uint32_t current_time, const uint8_t interval, const uint8_t counter);
 #endif
 
-/* * * * * * * * * * * * * * * * * */
-/* * * * GLOBAL DECLARATIONS * * * */
-/* * * * * * * * * * * * * * * * * */
-static uint16_t message_id;
+#if ENABLE_RESENDINGS || SN_COAP_DUPLICATION_MAX_MSGS_COUNT
+static void                 *sn_coap_protocol_msg_index_search(const coap_msg_index_s *index, const sn_nsdl_addr_s *addr_ptr, uint16_t msg_id);
+static bool                  sn_coap_protocol_msg_index_insert(struct coap_s *handle, coap_msg_index_s *index, void *entry, const sn_nsdl_addr_s *addr_ptr, uint16_t msg_id);
+static void                  sn_coap_protocol_msg_index_remove(coap_msg_index_s *index, const void *entry, const sn_nsdl_addr_s *addr_ptr, uint16_t msg_id);
+static void                  sn_coap_protocol_msg_index_free(struct coap_s *handle, coap_msg_index_s *index);
+#endif
+static uint16_t              sn_coap_protocol_next_message_id(struct coap_s *handle);
 
 int8_t sn_coap_protocol_destroy(struct coap_s *handle)
 {
@@ -91,30 +95,17 @@ int8_t sn_coap_protocol_destroy(struct coap_s *handle)
 #if ENABLE_RESENDINGS /* If Message resending is not used at all, this part of code will not be compiled */
 
     sn_coap_protocol_clear_retransmission_buffer(handle);
+    sn_coap_protocol_msg_index_free(handle, &handle->index_resent_msgs);
 
 #endif
 
 #if SN_COAP_DUPLICATION_MAX_MSGS_COUNT /* If Message duplication detection is not used at all, this part of code will not be compiled */
     ns_list_foreach_safe(coap_duplication_info_s, tmp, &handle->linked_list_duplication_msgs) {
         if (tmp->coap == handle) {
-            if (tmp->address) {
-                if (tmp->address->addr_ptr) {
-                    handle->sn_coap_protocol_free(tmp->address->addr_ptr);
-                    tmp->address->addr_ptr = 0;
-                }
-                handle->sn_coap_protocol_free(tmp->address);
-                tmp->address = 0;
-            }
-            if (tmp->packet_ptr) {
-                handle->sn_coap_protocol_free(tmp->packet_ptr);
-                tmp->packet_ptr = 0;
-            }
-            ns_list_remove(&handle->linked_list_duplication_msgs, tmp);
-            handle->count_duplication_msgs--;
-            handle->sn_coap_protocol_free(tmp);
-            tmp = 0;
+            sn_coap_protocol_linked_list_duplication_info_remove(handle, tmp);
         }
     }
+    sn_coap_protocol_msg_index_free(handle, &handle->index_duplication_msgs);
 
 #endif
 
@@ -198,13 +189,21 @@ struct coap_s *sn_coap_protocol_init(void *(*used_malloc_func_ptr)(uint16_t), vo
 
 #endif /* ENABLE_RESENDINGS */
 
-    /* Randomize global message ID */
+    /* Randomize message ID of the handle */
     randLIB_seed_random();
-    message_id = randLIB_get_16bit();
-    if (message_id == 0) {
-        message_id = 1;
+    handle->message_id = randLIB_get_16bit();
+    if (handle->message_id == 0) {
+        handle->message_id = 1;
     }
 
+#if ENABLE_RESENDINGS
+    /* Seed the resend jitter of the handle, xorshift32 must not start from zero */
+    handle->resend_random_state = randLIB_get_32bit();
+    if (handle->resend_random_state == 0) {
+        handle->resend_random_state = 1;
+    }
+#endif
+
     return handle;
 }
 
@@ -339,9 +338,8 @@ void sn_coap_protocol_clear_retransmission_buffer(struct coap_s *handle)
         return;
     }
     ns_list_foreach_safe(coap_send_msg_s, tmp, &handle->linked_list_resent_msgs) {
-        ns_list_remove(&handle->linked_list_resent_msgs, tmp);
+        sn_coap_protocol_linked_list_send_msg_unlink(handle, tmp);
         sn_coap_protocol_release_allocated_send_msg_mem(handle, tmp);
-        --handle->count_resent_msgs;
     }
 #endif
 }
@@ -354,11 +352,8 @@ int8_t sn_coap_protocol_delete_retransmission(struct coap_s *handle, uint16_t ms
     }
     ns_list_foreach_safe(coap_send_msg_s, tmp, &handle->linked_list_resent_msgs) {
         if (tmp->send_msg_ptr && tmp->send_msg_ptr->packet_ptr ) {
-            uint16_t temp_msg_id = (tmp->send_msg_ptr->packet_ptr[2] << 8);
-            temp_msg_id += (uint16_t)tmp->send_msg_ptr->packet_ptr[3];
-            if(temp_msg_id == msg_id){
-                ns_list_remove(&handle->linked_list_resent_msgs, tmp);
-                --handle->count_resent_msgs;
+            if(tmp->msg_id == msg_id){
+                sn_coap_protocol_linked_list_send_msg_unlink(handle, tmp);
                 sn_coap_protocol_release_allocated_send_msg_mem(handle, tmp);
                 return 0;
             }
@@ -382,11 +377,8 @@ int8_t sn_coap_protocol_delete_retransmission_by_token(struct coap_s *handle, ui
             uint8_t stored_token[8];
             memcpy(stored_token, &stored_msg->send_msg_ptr->packet_ptr[4], stored_token_len);
             if (memcmp(stored_token, token, stored_token_len) == 0) {
-                uint16_t temp_msg_id = (stored_msg->send_msg_ptr->packet_ptr[2] << 8);
-                temp_msg_id += (uint16_t)stored_msg->send_msg_ptr->packet_ptr[3];
-                tr_debug("sn_coap_protocol_delete_retransmission_by_token - removed msg_id: %d", temp_msg_id);
-                ns_list_remove(&handle->linked_list_resent_msgs, stored_msg);
-                --handle->count_resent_msgs;
+                tr_debug("sn_coap_protocol_delete_retransmission_by_token - removed msg_id: %d", stored_msg->msg_id);
+                sn_coap_protocol_linked_list_send_msg_unlink(handle, stored_msg);
 
                 /* Free memory of stored message */
                 sn_coap_protocol_release_allocated_send_msg_mem(handle, stored_msg);
@@ -464,11 +456,7 @@ int16_t sn_coap_protocol_build(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_p
             src_coap_msg_ptr->msg_type != COAP_MSG_TYPE_RESET &&
             src_coap_msg_ptr->msg_id == 0) {
         /* * * * Generate new Message ID and increase it by one  * * * */
-        src_coap_msg_ptr->msg_id = message_id;
-        message_id++;
-        if (message_id == 0) {
-            message_id = 1;
-        }
+        src_coap_msg_ptr->msg_id = sn_coap_protocol_next_message_id(handle);
     }
 
 #if SN_COAP_BLOCKWISE_ENABLED || SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE /* If Message blockwising is not enabled, this part of code will not be compiled */
@@ -498,7 +486,7 @@ int16_t sn_coap_protocol_build(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_p
     /* Check if built Message type was confirmable, only these messages are resent */
     if (src_coap_msg_ptr->msg_type == COAP_MSG_TYPE_CONFIRMABLE) {
         /* Store message to Linked list for resending purposes */
-        uint32_t resend_time = sn_coap_calculate_new_resend_time(handle->system_time, handle->sn_coap_resending_intervall, 0);
+        uint32_t resend_time = sn_coap_calculate_new_resend_time(handle, handle->system_time, handle->sn_coap_resending_intervall, 0);
         if (sn_coap_protocol_linked_list_send_msg_store(handle, dst_addr_ptr, byte_count_built, dst_packet_data_ptr,
                 resend_time,
                 param) == 0) {
@@ -686,7 +674,10 @@ sn_coap_hdr_s *sn_coap_protocol_parse(struct coap_s *handle, sn_nsdl_addr_s *src
     if ((returned_dst_coap_msg_ptr->msg_type == COAP_MSG_TYPE_CONFIRMABLE ||
             returned_dst_coap_msg_ptr->msg_type == COAP_MSG_TYPE_NON_CONFIRMABLE) &&
             handle->sn_coap_duplication_buffer_size != 0) {
-        if (sn_coap_protocol_linked_list_duplication_info_search(handle, src_addr_ptr, returned_dst_coap_msg_ptr->msg_id) == NULL) {
+        coap_duplication_info_s* response = sn_coap_protocol_linked_list_duplication_info_search(handle,
+                                                                                                 src_addr_ptr,
+                                                                                                 returned_dst_coap_msg_ptr->msg_id);
+        if (response == NULL) {
             /* * * No Message duplication: Store received message for detecting later duplication * * */
 
             /* Get count of stored duplication messages */
@@ -700,10 +691,7 @@ sn_coap_hdr_s *sn_coap_protocol_parse(struct coap_s *handle, sn_nsdl_addr_s *src
                 coap_duplication_info_s *stored_duplication_info_ptr = ns_list_get_first(&handle->linked_list_duplication_msgs);
 
                 /* Remove oldest stored duplication message for getting room for new duplication message */
-                sn_coap_protocol_linked_list_duplication_info_remove(handle,
-                                                                     stored_duplication_info_ptr->address->addr_ptr,
-                                                                     stored_duplication_info_ptr->address->port,
-                                                                     stored_duplication_info_ptr->msg_id);
+                sn_coap_protocol_linked_list_duplication_info_remove(handle, stored_duplication_info_ptr);
             }
 
             /* Store Duplication info to Linked list */
@@ -711,17 +699,12 @@ sn_coap_hdr_s *sn_coap_protocol_parse(struct coap_s *handle, sn_nsdl_addr_s *src
         } else { /* * * Message duplication detected * * */
             /* Set returned status to User */
             returned_dst_coap_msg_ptr->coap_status = COAP_STATUS_PARSER_DUPLICATED_MSG;
-            coap_duplication_info_s* response = sn_coap_protocol_linked_list_duplication_info_search(handle,
-                                                                                                     src_addr_ptr,
-                                                                                                     returned_dst_coap_msg_ptr->msg_id);
-            /* Send ACK response */
-            if (response) {
-                /* Check that response has been created */
-                if (response->packet_ptr) {
-                    tr_debug("sn_coap_protocol_parse - send ack for duplicate message");
-                    response->coap->sn_coap_tx_callback(response->packet_ptr,
-                            response->packet_len, response->address, response->param);
-                }
+
+            /* Send ACK response, check that response has been created */
+            if (response->packet_ptr) {
+                tr_debug("sn_coap_protocol_parse - send ack for duplicate message");
+                response->coap->sn_coap_tx_callback(response->packet_ptr,
+                        response->packet_len, &response->address, response->param);
             }
 
             return returned_dst_coap_msg_ptr;
@@ -856,8 +839,7 @@ rescan:
                     temp_msg_id += (uint16_t)stored_msg_ptr->send_msg_ptr->packet_ptr[3];
 
                     /* Remove message from Linked list */
-                    ns_list_remove(&handle->linked_list_resent_msgs, stored_msg_ptr);
-                    --handle->count_resent_msgs;
+                    sn_coap_protocol_linked_list_send_msg_unlink(handle, stored_msg_ptr);
 
                     /* If RX callback have been defined.. */
                     if (stored_msg_ptr->coap->sn_coap_rx_callback != 0) {
@@ -881,7 +863,7 @@ rescan:
                             stored_msg_ptr->send_msg_ptr->packet_len, stored_msg_ptr->send_msg_ptr->dst_addr_ptr, stored_msg_ptr->param);
 
                     /* * * Count new Resending time  * * */
-                    stored_msg_ptr->resending_time = sn_coap_calculate_new_resend_time(current_time,
+                    stored_msg_ptr->resending_time = sn_coap_calculate_new_resend_time(handle, current_time,
                                                                                        handle->sn_coap_resending_intervall,
                                                                                        stored_msg_ptr->resending_counter);
                 }
@@ -937,7 +919,7 @@ static uint8_t sn_coap_protocol_linked_list_send_msg_store(struct coap_s *handle
 
     /* Count resending queue size, if buffer size is defined */
     if (handle->sn_coap_resending_queue_bytes > 0) {
-        if ((sn_coap_count_linked_list_size(&handle->linked_list_resent_msgs) + send_packet_data_len) > handle->sn_coap_resending_queue_bytes) {
+        if ((handle->size_resent_msgs + send_packet_data_len) > handle->sn_coap_resending_queue_bytes) {
             tr_error("sn_coap_protocol_linked_list_send_msg_store - resend buffer size reached!");
             return 0;
         }
@@ -954,6 +936,8 @@ static uint8_t sn_coap_protocol_linked_list_send_msg_store(struct coap_s *handle
     /* Filling of coap_send_msg_s with initialization values */
     stored_msg_ptr->resending_counter = 0;
     stored_msg_ptr->resending_time = sending_time;
+    stored_msg_ptr->msg_id = (send_packet_data_ptr[2] << 8);
+    stored_msg_ptr->msg_id += (uint16_t)send_packet_data_ptr[3];
 
     /* Filling of sn_nsdl_transmit_s */
     stored_msg_ptr->send_msg_ptr->protocol = SN_NSDL_PROTOCOL_COAP;
@@ -969,9 +953,18 @@ static uint8_t sn_coap_protocol_linked_list_send_msg_store(struct coap_s *handle
     stored_msg_ptr->coap = handle;
     stored_msg_ptr->param = param;
 
+    /* Index the message so that replies are matched without a list scan */
+    if (!sn_coap_protocol_msg_index_insert(handle, &handle->index_resent_msgs, stored_msg_ptr,
+                                           stored_msg_ptr->send_msg_ptr->dst_addr_ptr, stored_msg_ptr->msg_id)) {
+        tr_error("sn_coap_protocol_linked_list_send_msg_store - failed to allocate index!");
+        sn_coap_protocol_release_allocated_send_msg_mem(handle, stored_msg_ptr);
+        return 0;
+    }
+
     /* Storing Resending message to Linked list */
     ns_list_add_to_end(&handle->linked_list_resent_msgs, stored_msg_ptr);
     ++handle->count_resent_msgs;
+    handle->size_resent_msgs += send_packet_data_len;
     return 1;
 }
 
@@ -991,27 +984,14 @@ static uint8_t sn_coap_protocol_linked_list_send_msg_store(struct coap_s *handle
 static sn_nsdl_transmit_s *sn_coap_protocol_linked_list_send_msg_search(struct coap_s *handle,
         sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id)
 {
-    /* Loop all stored resending messages Linked list */
-    ns_list_foreach(coap_send_msg_s, stored_msg_ptr, &handle->linked_list_resent_msgs) {
-        /* Get message ID from stored resending message */
-        uint16_t temp_msg_id = (stored_msg_ptr->send_msg_ptr->packet_ptr[2] << 8);
-        temp_msg_id += (uint16_t)stored_msg_ptr->send_msg_ptr->packet_ptr[3];
-
-        /* If message's Message ID is same than is searched */
-        if (temp_msg_id == msg_id) {
-            /* If message's Source address is same than is searched */
-            if (0 == memcmp(src_addr_ptr->addr_ptr, stored_msg_ptr->send_msg_ptr->dst_addr_ptr->addr_ptr, src_addr_ptr->addr_len)) {
-                /* If message's Source address port is same than is searched */
-                if (stored_msg_ptr->send_msg_ptr->dst_addr_ptr->port == src_addr_ptr->port) {
-                    /* * * Message found, return pointer to that stored resending message * * * */
-                    return stored_msg_ptr->send_msg_ptr;
-                }
-            }
-        }
+    coap_send_msg_s *stored_msg_ptr = sn_coap_protocol_msg_index_search(&handle->index_resent_msgs, src_addr_ptr, msg_id);
+
+    if (stored_msg_ptr == NULL) {
+        /* Message not found */
+        return NULL;
     }
 
-    /* Message not found */
-    return NULL;
+    return stored_msg_ptr->send_msg_ptr;
 }
 /**************************************************************************//**
  * \fn static void sn_coap_protocol_linked_list_send_msg_remove(sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id)
@@ -1024,38 +1004,45 @@ static sn_nsdl_transmit_s *sn_coap_protocol_linked_list_send_msg_search(struct c
 
 static void sn_coap_protocol_linked_list_send_msg_remove(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id)
 {
-    /* Loop all stored resending messages in Linked list */
-    ns_list_foreach(coap_send_msg_s, stored_msg_ptr, &handle->linked_list_resent_msgs) {
-        /* Get message ID from stored resending message */
-        uint16_t temp_msg_id = (stored_msg_ptr->send_msg_ptr->packet_ptr[2] << 8);
-        temp_msg_id += (uint16_t)stored_msg_ptr->send_msg_ptr->packet_ptr[3];
-
-        /* If message's Message ID is same than is searched */
-        if (temp_msg_id == msg_id) {
-            /* If message's Source address is same than is searched */
-            if (0 == memcmp(src_addr_ptr->addr_ptr, stored_msg_ptr->send_msg_ptr->dst_addr_ptr->addr_ptr, src_addr_ptr->addr_len)) {
-                /* If message's Source address port is same than is searched */
-                if (stored_msg_ptr->send_msg_ptr->dst_addr_ptr->port == src_addr_ptr->port) {
-                    /* * * Message found * * */
-
-                    /* Remove message from Linked list */
-                    ns_list_remove(&handle->linked_list_resent_msgs, stored_msg_ptr);
-                    --handle->count_resent_msgs;
+    coap_send_msg_s *stored_msg_ptr = sn_coap_protocol_msg_index_search(&handle->index_resent_msgs, src_addr_ptr, msg_id);
 
-                    /* Free memory of stored message */
-                    sn_coap_protocol_release_allocated_send_msg_mem(handle, stored_msg_ptr);
+    if (stored_msg_ptr != NULL) {
+        /* Remove message from Linked list */
+        sn_coap_protocol_linked_list_send_msg_unlink(handle, stored_msg_ptr);
 
-                    return;
-                }
-            }
-        }
+        /* Free memory of stored message */
+        sn_coap_protocol_release_allocated_send_msg_mem(handle, stored_msg_ptr);
     }
 }
 
-uint32_t sn_coap_calculate_new_resend_time(const uint32_t current_time, const uint8_t interval, const uint8_t counter)
+/**************************************************************************//**
+ * \fn static void sn_coap_protocol_linked_list_send_msg_unlink(struct coap_s *handle, coap_send_msg_s *removed_msg_ptr)
+ *
+ * \brief Removes stored resending message from Linked list and its index, memory is not freed
+ *
+ * \param *removed_msg_ptr is pointer to removed message
+ *****************************************************************************/
+
+static void sn_coap_protocol_linked_list_send_msg_unlink(struct coap_s *handle, coap_send_msg_s *removed_msg_ptr)
+{
+    ns_list_remove(&handle->linked_list_resent_msgs, removed_msg_ptr);
+    sn_coap_protocol_msg_index_remove(&handle->index_resent_msgs, removed_msg_ptr,
+                                      removed_msg_ptr->send_msg_ptr->dst_addr_ptr, removed_msg_ptr->msg_id);
+    --handle->count_resent_msgs;
+    handle->size_resent_msgs -= removed_msg_ptr->send_msg_ptr->packet_len;
+}
+
+static uint32_t sn_coap_calculate_new_resend_time(struct coap_s *handle, const uint32_t current_time, const uint8_t interval, const uint8_t counter)
 {
     uint32_t resend_time = interval << counter;
-    uint16_t random_factor = randLIB_get_random_in_range(100, RESPONSE_RANDOM_FACTOR * 100);
+    /* The jitter comes from the handle, as randLIB state is shared and not thread safe.
+     * xorshift32 is good enough for spreading retransmissions. */
+    uint32_t state = handle->resend_random_state;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    handle->resend_random_state = state;
+    uint16_t random_factor = 100 + (state % ((uint16_t)(RESPONSE_RANDOM_FACTOR * 100) - 100 + 1));
     return current_time + ((resend_time * random_factor) / 100);
 }
 
@@ -1102,10 +1089,8 @@ static void sn_coap_protocol_linked_list_duplication_info_store(struct coap_s *h
 {
     coap_duplication_info_s *stored_duplication_info_ptr = NULL;
 
-    /* * * * Allocating memory for stored Duplication info * * * */
-
-    /* Allocate memory for stored Duplication info's structure */
-    stored_duplication_info_ptr = handle->sn_coap_protocol_malloc(sizeof(coap_duplication_info_s));
+    /* * * * Allocating memory for stored Duplication info, address is stored after the structure * * * */
+    stored_duplication_info_ptr = handle->sn_coap_protocol_malloc(sizeof(coap_duplication_info_s) + addr_ptr->addr_len);
 
     if (stored_duplication_info_ptr == NULL) {
         tr_error("sn_coap_protocol_linked_list_duplication_info_store - failed to allocate duplication info!");
@@ -1113,39 +1098,28 @@ static void sn_coap_protocol_linked_list_duplication_info_store(struct coap_s *h
     }
     memset(stored_duplication_info_ptr, 0, sizeof(coap_duplication_info_s));
 
-    /* Allocate memory for stored Duplication info's address */
-    stored_duplication_info_ptr->address = handle->sn_coap_protocol_malloc(sizeof(sn_nsdl_addr_s));
-    if (stored_duplication_info_ptr->address == NULL) {
-        tr_error("sn_coap_protocol_linked_list_duplication_info_store - failed to allocate address!");
-        handle->sn_coap_protocol_free(stored_duplication_info_ptr);
-        stored_duplication_info_ptr = 0;
-        return;
-    }
-    memset(stored_duplication_info_ptr->address, 0, sizeof(sn_nsdl_addr_s));
-
-    stored_duplication_info_ptr->address->addr_ptr = handle->sn_coap_protocol_malloc(addr_ptr->addr_len);
-
-    if (stored_duplication_info_ptr->address->addr_ptr == NULL) {
-        tr_error("sn_coap_protocol_linked_list_duplication_info_store - failed to allocate address pointer!");
-        handle->sn_coap_protocol_free(stored_duplication_info_ptr->address);
-        stored_duplication_info_ptr->address = 0;
-        handle->sn_coap_protocol_free(stored_duplication_info_ptr);
-        stored_duplication_info_ptr = 0;
-        return;
-    }
-
     /* * * * Filling fields of stored Duplication info * * * */
     stored_duplication_info_ptr->timestamp = handle->system_time;
-    stored_duplication_info_ptr->address->addr_len = addr_ptr->addr_len;
-    memcpy(stored_duplication_info_ptr->address->addr_ptr, addr_ptr->addr_ptr, addr_ptr->addr_len);
-    stored_duplication_info_ptr->address->port = addr_ptr->port;
+    stored_duplication_info_ptr->address.type = addr_ptr->type;
+    stored_duplication_info_ptr->address.addr_len = addr_ptr->addr_len;
+    stored_duplication_info_ptr->address.addr_ptr = stored_duplication_info_ptr->addr_data;
+    memcpy(stored_duplication_info_ptr->addr_data, addr_ptr->addr_ptr, addr_ptr->addr_len);
+    stored_duplication_info_ptr->address.port = addr_ptr->port;
     stored_duplication_info_ptr->msg_id = msg_id;
 
     stored_duplication_info_ptr->coap = handle;
 
     stored_duplication_info_ptr->param = param;
-    /* * * * Storing Duplication info to Linked list * * * */
 
+    /* * * * Indexing Duplication info * * * */
+    if (!sn_coap_protocol_msg_index_insert(handle, &handle->index_duplication_msgs, stored_duplication_info_ptr,
+                                           &stored_duplication_info_ptr->address, msg_id)) {
+        tr_error("sn_coap_protocol_linked_list_duplication_info_store - failed to allocate index!");
+        handle->sn_coap_protocol_free(stored_duplication_info_ptr);
+        return;
+    }
+
+    /* * * * Storing Duplication info to Linked list * * * */
     ns_list_add_to_end(&handle->linked_list_duplication_msgs, stored_duplication_info_ptr);
     ++handle->count_duplication_msgs;
 }
@@ -1158,102 +1132,241 @@ static void sn_coap_protocol_linked_list_duplication_info_store(struct coap_s *h
  * \param *addr_ptr is pointer to Address key to be searched
  * \param msg_id is Message ID key to be searched
  *
- * \return Return value is 0 when message found and -1 if not found
+ * \return Return value is pointer to found Duplication info or NULL if not found
  *****************************************************************************/
 
 static coap_duplication_info_s* sn_coap_protocol_linked_list_duplication_info_search(const struct coap_s *handle,
         const sn_nsdl_addr_s *addr_ptr, const uint16_t msg_id)
 {
-    /* Loop all nodes in Linked list for searching Message ID */
-    ns_list_foreach(coap_duplication_info_s, stored_duplication_info_ptr, &handle->linked_list_duplication_msgs) {
-        /* If message's Message ID is same than is searched */
-        if (stored_duplication_info_ptr->msg_id == msg_id) {
-            /* If message's Source address is same than is searched */
-            if (0 == memcmp(addr_ptr->addr_ptr, stored_duplication_info_ptr->address->addr_ptr, addr_ptr->addr_len)) {
-                /* If message's Source address port is same than is searched */
-                if (stored_duplication_info_ptr->address->port == addr_ptr->port) {
-                    /* * * Correct Duplication info found * * * */
-                    return stored_duplication_info_ptr;
-                }
-            }
+    return sn_coap_protocol_msg_index_search(&handle->index_duplication_msgs, addr_ptr, msg_id);
+}
+
+/**************************************************************************//**
+ * \fn static void sn_coap_protocol_linked_list_duplication_info_remove(struct coap_s *handle, coap_duplication_info_s *removed_duplication_info_ptr)
+ *
+ * \brief Removes stored Duplication info from Linked list and frees it
+ *
+ * \param *removed_duplication_info_ptr is pointer to removed Duplication info
+ *****************************************************************************/
+
+static void sn_coap_protocol_linked_list_duplication_info_remove(struct coap_s *handle, coap_duplication_info_s *removed_duplication_info_ptr)
+{
+    ns_list_remove(&handle->linked_list_duplication_msgs, removed_duplication_info_ptr);
+    sn_coap_protocol_msg_index_remove(&handle->index_duplication_msgs, removed_duplication_info_ptr,
+                                      &removed_duplication_info_ptr->address, removed_duplication_info_ptr->msg_id);
+    --handle->count_duplication_msgs;
+
+    /* Free memory of stored Duplication info */
+    handle->sn_coap_protocol_free(removed_duplication_info_ptr->packet_ptr);
+    removed_duplication_info_ptr->packet_ptr = 0;
+    handle->sn_coap_protocol_free(removed_duplication_info_ptr);
+}
+
+/**************************************************************************//**
+ * \fn static void sn_coap_protocol_linked_list_duplication_info_remove_old_ones(struct coap_s *handle)
+ *
+ * \brief Removes old stored Duplication detection infos from Linked list
+ *****************************************************************************/
+
+static void sn_coap_protocol_linked_list_duplication_info_remove_old_ones(struct coap_s *handle)
+{
+    /* Linked list is in storing order, so the loop can stop at the first info which is not old */
+    ns_list_foreach_safe(coap_duplication_info_s, removed_duplication_info_ptr, &handle->linked_list_duplication_msgs) {
+        if ((handle->system_time - removed_duplication_info_ptr->timestamp)  <= SN_COAP_DUPLICATION_MAX_TIME_MSGS_STORED) {
+            break;
+        }
+        /* * * * Old Duplication info found, remove it from Linked list * * * */
+        sn_coap_protocol_linked_list_duplication_info_remove(handle, removed_duplication_info_ptr);
+    }
+}
+
+#endif /* SN_COAP_DUPLICATION_MAX_MSGS_COUNT */
+
+#if ENABLE_RESENDINGS || SN_COAP_DUPLICATION_MAX_MSGS_COUNT
+
+/* Slot count of a newly allocated message index */
+#define SN_COAP_MSG_INDEX_INITIAL_SIZE  8
+
+/**************************************************************************//**
+ * \fn static uint16_t sn_coap_protocol_msg_index_hash(const sn_nsdl_addr_s *addr_ptr, uint16_t msg_id)
+ *
+ * \brief Calculates FNV-1a hash of address, port and Message ID
+ *****************************************************************************/
+
+static uint16_t sn_coap_protocol_msg_index_hash(const sn_nsdl_addr_s *addr_ptr, uint16_t msg_id)
+{
+    uint32_t hash = 2166136261u;
+
+    for (uint16_t i = 0; i < addr_ptr->addr_len; i++) {
+        hash = (hash ^ addr_ptr->addr_ptr[i]) * 16777619u;
+    }
+    hash = (hash ^ (uint8_t)addr_ptr->port) * 16777619u;
+    hash = (hash ^ (uint8_t)(addr_ptr->port >> 8)) * 16777619u;
+    hash = (hash ^ (uint8_t)msg_id) * 16777619u;
+    hash = (hash ^ (uint8_t)(msg_id >> 8)) * 16777619u;
+
+    return (uint16_t)(hash ^ (hash >> 16));
+}
+
+/**************************************************************************//**
+ * \fn static void *sn_coap_protocol_msg_index_search(const coap_msg_index_s *index, const sn_nsdl_addr_s *addr_ptr, uint16_t msg_id)
+ *
+ * \brief Searches indexed message (Address, port and Message ID as key)
+ *
+ * \return Return value is pointer to found message or NULL if not found
+ *****************************************************************************/
+
+static void *sn_coap_protocol_msg_index_search(const coap_msg_index_s *index, const sn_nsdl_addr_s *addr_ptr, uint16_t msg_id)
+{
+    if (index->count == 0) {
+        return NULL;
+    }
+
+    const uint16_t hash = sn_coap_protocol_msg_index_hash(addr_ptr, msg_id);
+    const uint16_t mask = index->size - 1;
+
+    /* Index is never more than half full, so the probe always ends to a free slot */
+    for (uint16_t i = hash & mask; index->slots[i].entry != NULL; i = (i + 1) & mask) {
+        const coap_msg_index_slot_s *slot = &index->slots[i];
+        if (slot->hash == hash &&
+                slot->msg_id == msg_id &&
+                slot->address->port == addr_ptr->port &&
+                slot->address->addr_len == addr_ptr->addr_len &&
+                0 == memcmp(slot->address->addr_ptr, addr_ptr->addr_ptr, addr_ptr->addr_len)) {
+            return slot->entry;
         }
     }
+
     return NULL;
 }
 
 /**************************************************************************//**
- * \fn static void sn_coap_protocol_linked_list_duplication_info_remove(struct coap_s *handle, uint8_t *addr_ptr, uint16_t port, uint16_t msg_id)
+ * \fn static void sn_coap_protocol_msg_index_place(coap_msg_index_s *index, const coap_msg_index_slot_s *slot)
  *
- * \brief Removes stored Duplication info from Linked list
+ * \brief Places slot to the first free slot of its probe sequence
+ *****************************************************************************/
+
+static void sn_coap_protocol_msg_index_place(coap_msg_index_s *index, const coap_msg_index_slot_s *slot)
+{
+    const uint16_t mask = index->size - 1;
+    uint16_t i = slot->hash & mask;
+
+    while (index->slots[i].entry != NULL) {
+        i = (i + 1) & mask;
+    }
+    index->slots[i] = *slot;
+    index->count++;
+}
+
+/**************************************************************************//**
+ * \fn static bool sn_coap_protocol_msg_index_insert(struct coap_s *handle, coap_msg_index_s *index, void *entry, const sn_nsdl_addr_s *addr_ptr, uint16_t msg_id)
  *
- * \param *addr_ptr is pointer to Address key to be removed
+ * \brief Adds message to index, index is doubled when it would get more than half full
  *
- * \param port is Port key to be removed
+ * \param *entry is indexed message
+ * \param *addr_ptr is address of the message, it must stay valid while the message is indexed
+ * \param msg_id is Message ID of the message
  *
- * \param msg_id is Message ID key to be removed
+ * \return true if message was indexed, false if memory allocation failed
  *****************************************************************************/
 
-static void sn_coap_protocol_linked_list_duplication_info_remove(struct coap_s *handle, uint8_t *addr_ptr, uint16_t port, uint16_t msg_id)
+static bool sn_coap_protocol_msg_index_insert(struct coap_s *handle, coap_msg_index_s *index, void *entry,
+        const sn_nsdl_addr_s *addr_ptr, uint16_t msg_id)
 {
-    /* Loop all stored duplication messages in Linked list */
-    ns_list_foreach(coap_duplication_info_s, removed_duplication_info_ptr, &handle->linked_list_duplication_msgs) {
-        /* If message's Address is same than is searched */
-        if (handle == removed_duplication_info_ptr->coap && 0 == memcmp(addr_ptr,
-                                                                        removed_duplication_info_ptr->address->addr_ptr,
-                                                                        removed_duplication_info_ptr->address->addr_len)) {
-            /* If message's Address prt is same than is searched */
-            if (removed_duplication_info_ptr->address->port == port) {
-                /* If Message ID is same than is searched */
-                if (removed_duplication_info_ptr->msg_id == msg_id) {
-                    /* * * * Correct Duplication info found, remove it from Linked list * * * */
-                    ns_list_remove(&handle->linked_list_duplication_msgs, removed_duplication_info_ptr);
-                    --handle->count_duplication_msgs;
-
-                    /* Free memory of stored Duplication info */
-                    handle->sn_coap_protocol_free(removed_duplication_info_ptr->address->addr_ptr);
-                    removed_duplication_info_ptr->address->addr_ptr = 0;
-                    handle->sn_coap_protocol_free(removed_duplication_info_ptr->address);
-                    removed_duplication_info_ptr->address = 0;
-                    handle->sn_coap_protocol_free(removed_duplication_info_ptr->packet_ptr);
-                    removed_duplication_info_ptr->packet_ptr = 0;
-                    handle->sn_coap_protocol_free(removed_duplication_info_ptr);
-                    removed_duplication_info_ptr = 0;
-                    return;
-                }
+    coap_msg_index_slot_s slot;
+
+    if ((uint32_t)(index->count + 1) * 2 > index->size) {
+        const uint32_t new_size = index->size ? (uint32_t)index->size * 2 : SN_COAP_MSG_INDEX_INITIAL_SIZE;
+        const uint32_t alloc_size = new_size * sizeof(coap_msg_index_slot_s);
+
+        /* Memory allocator takes 16-bit sizes */
+        if (new_size > UINT16_MAX || alloc_size > UINT16_MAX) {
+            return false;
+        }
+
+        coap_msg_index_s new_index;
+        new_index.slots = handle->sn_coap_protocol_malloc(alloc_size);
+        if (new_index.slots == NULL) {
+            return false;
+        }
+        memset(new_index.slots, 0, alloc_size);
+        new_index.size = new_size;
+        new_index.count = 0;
+
+        for (uint16_t i = 0; i < index->size; i++) {
+            if (index->slots[i].entry != NULL) {
+                sn_coap_protocol_msg_index_place(&new_index, &index->slots[i]);
             }
         }
+
+        handle->sn_coap_protocol_free(index->slots);
+        *index = new_index;
     }
+
+    slot.entry = entry;
+    slot.address = addr_ptr;
+    slot.msg_id = msg_id;
+    slot.hash = sn_coap_protocol_msg_index_hash(addr_ptr, msg_id);
+    sn_coap_protocol_msg_index_place(index, &slot);
+
+    return true;
 }
 
 /**************************************************************************//**
- * \fn static void sn_coap_protocol_linked_list_duplication_info_remove_old_ones(struct coap_s *handle)
+ * \fn static void sn_coap_protocol_msg_index_remove(coap_msg_index_s *index, const void *entry, const sn_nsdl_addr_s *addr_ptr, uint16_t msg_id)
  *
- * \brief Removes old stored Duplication detection infos from Linked list
+ * \brief Removes message from index
+ *
+ * \param *entry is removed message
+ * \param *addr_ptr is address of the message
+ * \param msg_id is Message ID of the message
  *****************************************************************************/
 
-static void sn_coap_protocol_linked_list_duplication_info_remove_old_ones(struct coap_s *handle)
+static void sn_coap_protocol_msg_index_remove(coap_msg_index_s *index, const void *entry,
+        const sn_nsdl_addr_s *addr_ptr, uint16_t msg_id)
 {
-    /* Loop all stored duplication messages in Linked list */
-    ns_list_foreach_safe(coap_duplication_info_s, removed_duplication_info_ptr, &handle->linked_list_duplication_msgs) {
-        if ((handle->system_time - removed_duplication_info_ptr->timestamp)  > SN_COAP_DUPLICATION_MAX_TIME_MSGS_STORED) {
-            /* * * * Old Duplication info found, remove it from Linked list * * * */
-            ns_list_remove(&handle->linked_list_duplication_msgs, removed_duplication_info_ptr);
-            --handle->count_duplication_msgs;
-
-            /* Free memory of stored Duplication info */
-            handle->sn_coap_protocol_free(removed_duplication_info_ptr->address->addr_ptr);
-            removed_duplication_info_ptr->address->addr_ptr = 0;
-            handle->sn_coap_protocol_free(removed_duplication_info_ptr->address);
-            removed_duplication_info_ptr->address = 0;
-            handle->sn_coap_protocol_free(removed_duplication_info_ptr->packet_ptr);
-            removed_duplication_info_ptr->packet_ptr = 0;
-            handle->sn_coap_protocol_free(removed_duplication_info_ptr);
-            removed_duplication_info_ptr = 0;
+    if (index->count == 0) {
+        return;
+    }
+
+    const uint16_t mask = index->size - 1;
+    uint16_t i = sn_coap_protocol_msg_index_hash(addr_ptr, msg_id) & mask;
+
+    while (index->slots[i].entry != entry) {
+        if (index->slots[i].entry == NULL) {
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+
+    /* Move following slots of the probe sequence back, so that no deleted markers are needed */
+    for (uint16_t j = (i + 1) & mask; index->slots[j].entry != NULL; j = (j + 1) & mask) {
+        const uint16_t home = index->slots[j].hash & mask;
+        /* Slot can be moved only if its home slot is not between the freed slot and itself */
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            index->slots[i] = index->slots[j];
+            i = j;
         }
     }
+    index->slots[i].entry = NULL;
+    index->count--;
 }
 
-#endif /* SN_COAP_DUPLICATION_MAX_MSGS_COUNT */
+/**************************************************************************//**
+ * \fn static void sn_coap_protocol_msg_index_free(struct coap_s *handle, coap_msg_index_s *index)
+ *
+ * \brief Releases memory of index
+ *****************************************************************************/
+
+static void sn_coap_protocol_msg_index_free(struct coap_s *handle, coap_msg_index_s *index)
+{
+    handle->sn_coap_protocol_free(index->slots);
+    index->slots = NULL;
+    index->size = 0;
+    index->count = 0;
+}
+
+#endif /* ENABLE_RESENDINGS || SN_COAP_DUPLICATION_MAX_MSGS_COUNT */
 
 #if SN_COAP_BLOCKWISE_ENABLED || SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
 /**************************************************************************//**
@@ -1283,130 +1396,176 @@ static void sn_coap_protocol_linked_list_blockwise_msg_remove(struct coap_s *han
     }
 }
 
+/**************************************************************************//**
+ * \fn static bool sn_coap_protocol_linked_list_blockwise_payload_alloc(struct coap_s *handle, coap_blockwise_payload_s *payload_info_ptr, uint32_t needed_size, uint32_t total_size)
+ *
+ * \brief Grows reassembly buffer of blockwise payload
+ *
+ * \param needed_size is length which must fit to the buffer
+ * \param total_size is expected length of whole payload or 0 if unknown
+ *
+ * \return true if buffer is large enough, false if allocation failed or limit was reached
+ *****************************************************************************/
+
+static bool sn_coap_protocol_linked_list_blockwise_payload_alloc(struct coap_s *handle, coap_blockwise_payload_s *payload_info_ptr,
+        uint32_t needed_size, uint32_t total_size)
+{
+    const uint32_t max_size = (SN_COAP_MAX_INCOMING_BLOCK_MESSAGE_SIZE < UINT16_MAX) ? SN_COAP_MAX_INCOMING_BLOCK_MESSAGE_SIZE : UINT16_MAX;
+    uint32_t new_size;
+
+    if (needed_size <= payload_info_ptr->payload_size) {
+        return true;
+    }
+    if (needed_size > max_size) {
+        return false;
+    }
+
+    /* Allocate whole payload at once if its size is known, otherwise grow geometrically.
+     * Streamed transfers release each block after the next one is stored, so the whole payload
+     * is allocated only if nothing was released once two blocks have been stored. */
+    if (payload_info_ptr->payload_offset == 0 && payload_info_ptr->block_number > 0 &&
+        total_size >= needed_size && total_size <= max_size) {
+        new_size = total_size;
+    } else {
+        new_size = (uint32_t)payload_info_ptr->payload_size * 2;
+        if (new_size < needed_size) {
+            new_size = needed_size;
+        }
+        if (new_size > max_size) {
+            new_size = max_size;
+        }
+    }
+
+    const uint16_t bitmap_len = (new_size + (SN_COAP_BLOCKWISE_UNIT_SIZE * 8) - 1) / (SN_COAP_BLOCKWISE_UNIT_SIZE * 8);
+    const uint16_t old_bitmap_len = (payload_info_ptr->payload_size + (SN_COAP_BLOCKWISE_UNIT_SIZE * 8) - 1) / (SN_COAP_BLOCKWISE_UNIT_SIZE * 8);
+    uint8_t *new_payload_ptr = handle->sn_coap_protocol_malloc(new_size);
+    uint8_t *new_bitmap_ptr = handle->sn_coap_protocol_malloc(bitmap_len);
+
+    if (!new_payload_ptr || !new_bitmap_ptr) {
+        handle->sn_coap_protocol_free(new_payload_ptr);
+        handle->sn_coap_protocol_free(new_bitmap_ptr);
+        return false;
+    }
+
+    memset(new_bitmap_ptr, 0, bitmap_len);
+    if (payload_info_ptr->payload_ptr) {
+        memcpy(new_payload_ptr, payload_info_ptr->payload_ptr, payload_info_ptr->payload_len);
+        memcpy(new_bitmap_ptr, payload_info_ptr->block_bitmap, old_bitmap_len);
+        handle->sn_coap_protocol_free(payload_info_ptr->payload_ptr);
+        handle->sn_coap_protocol_free(payload_info_ptr->block_bitmap);
+    }
+
+    payload_info_ptr->payload_ptr = new_payload_ptr;
+    payload_info_ptr->block_bitmap = new_bitmap_ptr;
+    payload_info_ptr->payload_size = new_size;
+    return true;
+}
+
 /**************************************************************************//**
  * \fn static void sn_coap_protocol_linked_list_blockwise_payload_store(sn_nsdl_addr_s *addr_ptr, uint16_t stored_payload_len, uint8_t *stored_payload_ptr)
  *
- * \brief Stores blockwise payload to Linked list
+ * \brief Stores blockwise payload to the reassembly buffer of its transfer
  *
  * \param *addr_ptr is pointer to Address information to be stored
  * \param stored_payload_len is length of stored Payload
  * \param *stored_payload_ptr is pointer to stored Payload
+ * \param block_number is number of the stored block
+ * \param block_size is size of the stored block, block is stored to offset block_number * block_size
+ * \param total_size is length of whole payload from Size1/Size2 option or 0 if unknown
+ *
+ * \return false if memory for the transfer could not be allocated, the transfer is then removed
  *****************************************************************************/
 
-static void sn_coap_protocol_linked_list_blockwise_payload_store(struct coap_s *handle, sn_nsdl_addr_s *addr_ptr,
+static bool sn_coap_protocol_linked_list_blockwise_payload_store(struct coap_s *handle, sn_nsdl_addr_s *addr_ptr,
         uint16_t stored_payload_len,
         uint8_t *stored_payload_ptr,
         uint8_t *token_ptr,
         uint8_t token_len,
-        uint32_t block_number)
+        uint32_t block_number,
+        uint16_t block_size,
+        uint32_t total_size)
 {
     if (!addr_ptr || !stored_payload_len || !stored_payload_ptr) {
-        return;
-    }
-
-    // Do not add duplicates to list, this could happen if server needs to retransmit block message again
-    ns_list_foreach(coap_blockwise_payload_s, payload_info_ptr, &handle->linked_list_blockwise_received_payloads) {
-        if ((0 == memcmp(addr_ptr->addr_ptr, payload_info_ptr->addr_ptr, addr_ptr->addr_len)) && (payload_info_ptr->port == addr_ptr->port)) {
-            if (token_ptr) {
-                if (!payload_info_ptr->token_ptr || (payload_info_ptr->token_len != token_len) || (memcmp(payload_info_ptr->token_ptr, token_ptr, token_len))) {
-                    continue;
-                }
-            } else if (payload_info_ptr->token_ptr) {
-                continue;
-            }
-            if (payload_info_ptr->block_number == block_number) {
-                return;
-            }
-        }
+        return true;
     }
 
-    coap_blockwise_payload_s *stored_blockwise_payload_ptr = NULL;
+    coap_blockwise_payload_s *stored_blockwise_payload_ptr = sn_coap_protocol_linked_list_blockwise_payload_search(handle, addr_ptr, token_ptr, token_len);
 
-    /* * * * Allocating memory for stored Payload  * * * */
+    if (stored_blockwise_payload_ptr == NULL) {
+        /* * * * Allocating memory for new transfer, address and token are stored after the structure * * * */
+        if (!token_ptr) {
+            token_len = 0;
+        }
+        stored_blockwise_payload_ptr = handle->sn_coap_protocol_malloc(sizeof(coap_blockwise_payload_s) + addr_ptr->addr_len + token_len);
 
-    /* Allocate memory for stored Payload's structure */
-    stored_blockwise_payload_ptr = handle->sn_coap_protocol_malloc(sizeof(coap_blockwise_payload_s));
+        if (stored_blockwise_payload_ptr == NULL) {
+            tr_error("sn_coap_protocol_linked_list_blockwise_payload_store - failed to allocate blockwise!");
+            return false;
+        }
+        memset(stored_blockwise_payload_ptr, 0, sizeof(coap_blockwise_payload_s));
 
-    if (stored_blockwise_payload_ptr == NULL) {
-        tr_error("sn_coap_protocol_linked_list_blockwise_payload_store - failed to allocate blockwise!");
-        return;
-    }
+        stored_blockwise_payload_ptr->addr_ptr = stored_blockwise_payload_ptr->data;
+        stored_blockwise_payload_ptr->addr_len = addr_ptr->addr_len;
+        memcpy(stored_blockwise_payload_ptr->addr_ptr, addr_ptr->addr_ptr, addr_ptr->addr_len);
+        stored_blockwise_payload_ptr->port = addr_ptr->port;
 
+        if (token_len) {
+            stored_blockwise_payload_ptr->token_ptr = stored_blockwise_payload_ptr->data + addr_ptr->addr_len;
+            memcpy(stored_blockwise_payload_ptr->token_ptr, token_ptr, token_len);
+            stored_blockwise_payload_ptr->token_len = token_len;
+        }
 
-    /* Allocate memory for stored Payload's data */
-    stored_blockwise_payload_ptr->payload_ptr = handle->sn_coap_protocol_malloc(stored_payload_len);
+        stored_blockwise_payload_ptr->coap = handle;
 
-    if (stored_blockwise_payload_ptr->payload_ptr == NULL) {
-        tr_error("sn_coap_protocol_linked_list_blockwise_payload_store - failed to allocate payload!");
-        handle->sn_coap_protocol_free(stored_blockwise_payload_ptr);
-        stored_blockwise_payload_ptr = 0;
-        return;
+        /* * * * Storing transfer to Linked list  * * * */
+        ns_list_add_to_end(&handle->linked_list_blockwise_received_payloads, stored_blockwise_payload_ptr);
     }
 
-    /* Allocate memory for stored Payload's address */
-    stored_blockwise_payload_ptr->addr_ptr = handle->sn_coap_protocol_malloc(addr_ptr->addr_len);
-
-    if (stored_blockwise_payload_ptr->addr_ptr == NULL) {
-        tr_error("sn_coap_protocol_linked_list_blockwise_payload_store - failed to allocate address pointer!");
-        handle->sn_coap_protocol_free(stored_blockwise_payload_ptr->payload_ptr);
-        stored_blockwise_payload_ptr->payload_ptr = 0;
-        handle->sn_coap_protocol_free(stored_blockwise_payload_ptr);
-        stored_blockwise_payload_ptr = 0;
+    const uint32_t block_offset = block_number * block_size;
 
-        return;
+    // Block has already been released to application, this could happen if server needs to retransmit block message again
+    if (block_offset < stored_blockwise_payload_ptr->payload_offset) {
+        return true;
     }
 
-    /* Allocate & copy token number */
-    if (token_ptr && token_len) {
-        stored_blockwise_payload_ptr->token_ptr = handle->sn_coap_protocol_malloc(token_len);
+    const uint32_t offset = block_offset - stored_blockwise_payload_ptr->payload_offset;
+    const uint32_t end = offset + stored_payload_len;
 
-        if(!stored_blockwise_payload_ptr->token_ptr) {
-            tr_error("sn_coap_protocol_linked_list_blockwise_payload_store - failed to allocate token pointer!");
-            handle->sn_coap_protocol_free(stored_blockwise_payload_ptr->addr_ptr);
-            handle->sn_coap_protocol_free(stored_blockwise_payload_ptr->payload_ptr);
-            handle->sn_coap_protocol_free(stored_blockwise_payload_ptr);
-            return;
-        }
-
-        memcpy(stored_blockwise_payload_ptr->token_ptr, token_ptr, token_len);
-        stored_blockwise_payload_ptr->token_len = token_len;
-    } else {
-        stored_blockwise_payload_ptr->token_ptr = NULL;
-        stored_blockwise_payload_ptr->token_len = 0;
+    if (!sn_coap_protocol_linked_list_blockwise_payload_alloc(handle, stored_blockwise_payload_ptr, end, total_size)) {
+        tr_error("sn_coap_protocol_linked_list_blockwise_payload_store - failed to allocate payload!");
+        sn_coap_protocol_linked_list_blockwise_payload_remove(handle, stored_blockwise_payload_ptr);
+        return false;
     }
 
-    /* * * * Filling fields of stored Payload  * * * */
+    /* * * * Copy block to its place and mark it received * * * */
+    memcpy(stored_blockwise_payload_ptr->payload_ptr + offset, stored_payload_ptr, stored_payload_len);
+    for (uint32_t unit = offset / SN_COAP_BLOCKWISE_UNIT_SIZE; unit * SN_COAP_BLOCKWISE_UNIT_SIZE < end; unit++) {
+        stored_blockwise_payload_ptr->block_bitmap[unit >> 3] |= 1u << (unit & 7);
+    }
+    if (end > stored_blockwise_payload_ptr->payload_len) {
+        stored_blockwise_payload_ptr->payload_len = end;
+    }
 
     stored_blockwise_payload_ptr->timestamp = handle->system_time;
-
-    memcpy(stored_blockwise_payload_ptr->addr_ptr, addr_ptr->addr_ptr, addr_ptr->addr_len);
-    stored_blockwise_payload_ptr->port = addr_ptr->port;
-    memcpy(stored_blockwise_payload_ptr->payload_ptr, stored_payload_ptr, stored_payload_len);
-    stored_blockwise_payload_ptr->payload_len = stored_payload_len;
-
-    stored_blockwise_payload_ptr->coap = handle;
-
     stored_blockwise_payload_ptr->block_number = block_number;
-
-    /* * * * Storing Payload to Linked list  * * * */
-    ns_list_add_to_end(&handle->linked_list_blockwise_received_payloads, stored_blockwise_payload_ptr);
+    stored_blockwise_payload_ptr->block_offset = block_offset;
+    stored_blockwise_payload_ptr->block_size = block_size;
+    return true;
 }
 
 /**************************************************************************//**
- * \fn static uint8_t *sn_coap_protocol_linked_list_blockwise_payload_search(sn_nsdl_addr_s *src_addr_ptr, uint16_t *payload_length)
+ * \fn static coap_blockwise_payload_s *sn_coap_protocol_linked_list_blockwise_payload_search(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint8_t *token_ptr, uint8_t token_len)
  *
- * \brief Searches stored blockwise payload from Linked list (Address as key)
+ * \brief Searches blockwise transfer from Linked list (Address and token as key)
  *
  * \param *addr_ptr is pointer to Address key to be searched
- * \param *payload_length is pointer to returned Payload length
  *
- * \return Return value is pointer to found stored blockwise payload in Linked
- *         list or NULL if payload not found
+ * \return Return value is pointer to found transfer in Linked list or NULL if transfer not found
  *****************************************************************************/
 
-static uint8_t *sn_coap_protocol_linked_list_blockwise_payload_search(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint16_t *payload_length, uint8_t *token_ptr, uint8_t token_len)
+static coap_blockwise_payload_s *sn_coap_protocol_linked_list_blockwise_payload_search(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint8_t *token_ptr, uint8_t token_len)
 {
-    /* Loop all stored blockwise payloads in Linked list */
+    /* Loop all stored blockwise transfers in Linked list */
     ns_list_foreach(coap_blockwise_payload_s, stored_payload_info_ptr, &handle->linked_list_blockwise_received_payloads) {
         /* If payload's Source address and port is same than is searched */
         if ((0 == memcmp(src_addr_ptr->addr_ptr, stored_payload_info_ptr->addr_ptr, src_addr_ptr->addr_len)) && (stored_payload_info_ptr->port == src_addr_ptr->port)) {
@@ -1418,9 +1577,8 @@ static uint8_t *sn_coap_protocol_linked_list_blockwise_payload_search(struct coa
             } else if (stored_payload_info_ptr->token_ptr) {
                 continue;
             }
-            /* * * Correct Payload found * * * */
-            *payload_length = stored_payload_info_ptr->payload_len;
-            return stored_payload_info_ptr->payload_ptr;
+            /* * * Correct transfer found * * * */
+            return stored_payload_info_ptr;
         }
     }
 
@@ -1433,118 +1591,102 @@ static bool sn_coap_protocol_linked_list_blockwise_payload_compare_block_number(
                                                                                    uint8_t token_len,
                                                                                    uint32_t block_number)
 {
-    /* Loop all stored blockwise payloads in Linked list */
-    ns_list_foreach(coap_blockwise_payload_s, stored_payload_info_ptr, &handle->linked_list_blockwise_received_payloads) {
-        /* If payload's Source address and port is same than is searched */
-        if ((0 == memcmp(src_addr_ptr->addr_ptr, stored_payload_info_ptr->addr_ptr, src_addr_ptr->addr_len)) && (stored_payload_info_ptr->port == src_addr_ptr->port)) {
-            /* Check token number */
-            if (token_ptr) {
-                if (!stored_payload_info_ptr->token_ptr || (token_len != stored_payload_info_ptr->token_len) || (memcmp(stored_payload_info_ptr->token_ptr, token_ptr, token_len))) {
-                    continue;
-                }
-            } else if (stored_payload_info_ptr->token_ptr) {
-                continue;
-            }
-            // Check that incoming block number matches to last received one
-            if (block_number - 1 == stored_payload_info_ptr->block_number) {
-                return true;
-            }
-        }
-    }
+    coap_blockwise_payload_s *stored_payload_info_ptr = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr, token_ptr, token_len);
 
-    return false;
+    // Check that incoming block number matches to last received one
+    return stored_payload_info_ptr && (block_number - 1 == stored_payload_info_ptr->block_number);
 }
 
 /**************************************************************************//**
- * \fn static void sn_coap_protocol_linked_list_blockwise_payload_remove_oldest(struct coap_s *handle)
+ * \fn static uint8_t *sn_coap_protocol_linked_list_blockwise_payload_take(struct coap_s *handle, coap_blockwise_payload_s *payload_info_ptr, uint16_t *payload_length)
+ *
+ * \brief Takes reassembled payload of a finished transfer and removes the transfer from Linked list
+ *
+ * \param *payload_length is pointer to returned Payload length
  *
- * \brief Removes current stored blockwise paylod from Linked list
+ * \return Return value is pointer to reassembled payload, which must be freed by the caller,
+ *         or NULL if some blocks are missing
  *****************************************************************************/
 
-static void sn_coap_protocol_linked_list_blockwise_payload_remove_oldest(struct coap_s *handle, uint8_t *token_ptr, uint8_t token_len)
+static uint8_t *sn_coap_protocol_linked_list_blockwise_payload_take(struct coap_s *handle, coap_blockwise_payload_s *payload_info_ptr, uint16_t *payload_length)
 {
-    /* Remove oldest node in Linked list*/
-    if (token_ptr) {
-        ns_list_foreach(coap_blockwise_payload_s, removed_payload_ptr, &handle->linked_list_blockwise_received_payloads) {
-            if ((token_len == removed_payload_ptr->token_len) && !memcmp(removed_payload_ptr->token_ptr, token_ptr, token_len)) {
-                sn_coap_protocol_linked_list_blockwise_payload_remove(handle, removed_payload_ptr);
-                return;
-            }
-        }
-    } else {
-        ns_list_foreach(coap_blockwise_payload_s, removed_payload_ptr, &handle->linked_list_blockwise_received_payloads) {
-            if (!removed_payload_ptr->token_ptr) {
-                sn_coap_protocol_linked_list_blockwise_payload_remove(handle, removed_payload_ptr);
-                return;
-            }
+    uint8_t *payload_ptr = NULL;
+    uint16_t unit;
+
+    for (unit = 0; unit * SN_COAP_BLOCKWISE_UNIT_SIZE < payload_info_ptr->payload_len; unit++) {
+        if (!(payload_info_ptr->block_bitmap[unit >> 3] & (1u << (unit & 7)))) {
+            break;
         }
     }
+
+    if (unit * SN_COAP_BLOCKWISE_UNIT_SIZE >= payload_info_ptr->payload_len) {
+        payload_ptr = payload_info_ptr->payload_ptr;
+        *payload_length = payload_info_ptr->payload_len;
+        payload_info_ptr->payload_ptr = NULL;
+    }
+
+    sn_coap_protocol_linked_list_blockwise_payload_remove(handle, payload_info_ptr);
+    return payload_ptr;
 }
 
 /**************************************************************************//**
- * \fn static void sn_coap_protocol_linked_list_blockwise_payload_remove(struct coap_s *handle,
- *                                                      coap_blockwise_msg_s *removed_msg_ptr)
+ * \fn void sn_coap_protocol_linked_list_blockwise_payload_release(coap_blockwise_payload_s *payload_info_ptr, uint16_t released_len)
  *
- * \brief Removes stored blockwise payload from Linked list
+ * \brief Releases beginning of reassembled payload, which application has already stored to other place
  *
- * \param removed_payload_ptr is payload to be removed
+ * \param released_len is length of released data, rounded down to SN_COAP_BLOCKWISE_UNIT_SIZE
+ *                     unless all stored data is released
  *****************************************************************************/
 
-static void sn_coap_protocol_linked_list_blockwise_payload_remove(struct coap_s *handle,
-                                                                  coap_blockwise_payload_s *removed_payload_ptr)
+void sn_coap_protocol_linked_list_blockwise_payload_release(coap_blockwise_payload_s *payload_info_ptr, uint16_t released_len)
 {
-    ns_list_remove(&handle->linked_list_blockwise_received_payloads, removed_payload_ptr);
-    /* Free memory of stored payload */
-    if (removed_payload_ptr->addr_ptr != NULL) {
-        handle->sn_coap_protocol_free(removed_payload_ptr->addr_ptr);
-        removed_payload_ptr->addr_ptr = 0;
-    }
+    const uint16_t units = (payload_info_ptr->payload_size + SN_COAP_BLOCKWISE_UNIT_SIZE - 1) / SN_COAP_BLOCKWISE_UNIT_SIZE;
+    uint16_t released_units = (released_len + SN_COAP_BLOCKWISE_UNIT_SIZE - 1) / SN_COAP_BLOCKWISE_UNIT_SIZE;
 
-    if (removed_payload_ptr->payload_ptr != NULL) {
-        handle->sn_coap_protocol_free(removed_payload_ptr->payload_ptr);
-        removed_payload_ptr->payload_ptr = 0;
+    if (released_len < payload_info_ptr->payload_len) {
+        released_units = released_len / SN_COAP_BLOCKWISE_UNIT_SIZE;
+        released_len = released_units * SN_COAP_BLOCKWISE_UNIT_SIZE;
     }
-
-    if (removed_payload_ptr->token_ptr != NULL) {
-        handle->sn_coap_protocol_free(removed_payload_ptr->token_ptr);
-        removed_payload_ptr->token_ptr = 0;
+    if (released_len == 0) {
+        return;
     }
 
-    handle->sn_coap_protocol_free(removed_payload_ptr);
-    removed_payload_ptr = 0;
+    memmove(payload_info_ptr->payload_ptr, payload_info_ptr->payload_ptr + released_len, payload_info_ptr->payload_len - released_len);
+    payload_info_ptr->payload_len -= released_len;
+    payload_info_ptr->payload_offset += released_len;
+
+    /* Shift bitmap to match the moved data */
+    for (uint16_t unit = 0; unit < units; unit++) {
+        const uint16_t src_unit = unit + released_units;
+        if (src_unit < units && (payload_info_ptr->block_bitmap[src_unit >> 3] & (1u << (src_unit & 7)))) {
+            payload_info_ptr->block_bitmap[unit >> 3] |= 1u << (unit & 7);
+        } else {
+            payload_info_ptr->block_bitmap[unit >> 3] &= ~(1u << (unit & 7));
+        }
+    }
 }
 
 /**************************************************************************//**
- * \fn static uint32_t sn_coap_protocol_linked_list_blockwise_payloads_get_len(sn_nsdl_addr_s *src_addr_ptr)
- *
- * \brief Counts length of Payloads in Linked list (Address as key)
+ * \fn static void sn_coap_protocol_linked_list_blockwise_payload_remove(struct coap_s *handle,
+ *                                                      coap_blockwise_msg_s *removed_msg_ptr)
  *
- * \param *addr_ptr is pointer to Address key
+ * \brief Removes stored blockwise transfer from Linked list
  *
- * \return Return value is length of Payloads as bytes
+ * \param removed_payload_ptr is transfer to be removed
  *****************************************************************************/
 
-static uint32_t sn_coap_protocol_linked_list_blockwise_payloads_get_len(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint8_t *token_ptr, uint8_t token_len)
+static void sn_coap_protocol_linked_list_blockwise_payload_remove(struct coap_s *handle,
+                                                                  coap_blockwise_payload_s *removed_payload_ptr)
 {
-    uint32_t ret_whole_payload_len = 0;
-    /* Loop all stored blockwise payloads in Linked list */
-    ns_list_foreach(coap_blockwise_payload_s, searched_payload_info_ptr, &handle->linked_list_blockwise_received_payloads) {
-        /* If payload's Source address and port is same than is searched */
-        if ((0 == memcmp(src_addr_ptr->addr_ptr, searched_payload_info_ptr->addr_ptr, src_addr_ptr->addr_len)) && (searched_payload_info_ptr->port == src_addr_ptr->port)) {
-            /* Check token */
-            if (token_ptr) {
-                if(!searched_payload_info_ptr->token_ptr || (token_len != searched_payload_info_ptr->token_len) || (memcmp(searched_payload_info_ptr->token_ptr, token_ptr, token_len))) {
-                    continue;
-                }
-            } else if (searched_payload_info_ptr->token_ptr) {
-                continue;
-            }
-            /* * * Correct Payload found * * * */
-            ret_whole_payload_len += searched_payload_info_ptr->payload_len;
-        }
-    }
+    ns_list_remove(&handle->linked_list_blockwise_received_payloads, removed_payload_ptr);
+    /* Free memory of stored transfer, address and token are in the same allocation */
+    handle->sn_coap_protocol_free(removed_payload_ptr->payload_ptr);
+    removed_payload_ptr->payload_ptr = 0;
+    handle->sn_coap_protocol_free(removed_payload_ptr->block_bitmap);
+    removed_payload_ptr->block_bitmap = 0;
 
-    return ret_whole_payload_len;
+    handle->sn_coap_protocol_free(removed_payload_ptr);
+    removed_payload_ptr = 0;
 }
 
 /**************************************************************************//**
@@ -1675,26 +1817,6 @@ static void sn_coap_protocol_release_allocated_send_msg_mem(struct coap_s *handl
     }
 }
 
-/**************************************************************************//**
- * \fn static uint16_t sn_coap_count_linked_list_size(const coap_send_msg_list_t *linked_list_ptr)
- *
- * \brief Counts total message size of all messages in linked list
- *
- * \param const coap_send_msg_list_t *linked_list_ptr pointer to linked list
- *****************************************************************************/
-static uint16_t sn_coap_count_linked_list_size(const coap_send_msg_list_t *linked_list_ptr)
-{
-    uint16_t total_size = 0;
-
-    ns_list_foreach(coap_send_msg_s, stored_msg_ptr, linked_list_ptr) {
-        if (stored_msg_ptr->send_msg_ptr) {
-            total_size += stored_msg_ptr->send_msg_ptr->packet_len;
-        }
-    }
-
-    return total_size;
-}
-
 #endif
 
 #if SN_COAP_BLOCKWISE_ENABLED || SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
@@ -1717,11 +1839,11 @@ void sn_coap_protocol_remove_sent_blockwise_message(struct coap_s *handle, uint1
 
 void sn_coap_protocol_block_remove(struct coap_s *handle, sn_nsdl_addr_s *source_address, uint16_t payload_length, void *payload)
 {
-    if (!handle || !source_address || !payload) {
+    if (!handle || !source_address || !payload || !payload_length) {
         return;
     }
 
-    /* Loop all stored blockwise payloads in Linked list */
+    /* Loop all stored blockwise transfers in Linked list */
     ns_list_foreach(coap_blockwise_payload_s, stored_payload_info_ptr, &handle->linked_list_blockwise_received_payloads) {
         /* If payload's Source address is not the same than is searched */
         if (memcmp(source_address->addr_ptr, stored_payload_info_ptr->addr_ptr, source_address->addr_len)) {
@@ -1733,15 +1855,19 @@ void sn_coap_protocol_block_remove(struct coap_s *handle, sn_nsdl_addr_s *source
             continue;
         }
 
-        /* Check the payload */
-        if(payload_length != stored_payload_info_ptr->payload_len){
+        /* Blocks are reassembled contiguously, only the first block still stored can be removed */
+        if (payload_length != stored_payload_info_ptr->block_size &&
+            payload_length != stored_payload_info_ptr->payload_len) {
+            continue;
+        }
+        if (payload_length > stored_payload_info_ptr->payload_len) {
             continue;
         }
 
-        if(!memcmp(stored_payload_info_ptr->payload_ptr, payload, stored_payload_info_ptr->payload_len))
+        if (!memcmp(stored_payload_info_ptr->payload_ptr, payload, payload_length))
         {
-            /* Everything matches, remove and return. */
-            sn_coap_protocol_linked_list_blockwise_payload_remove(handle, stored_payload_info_ptr);
+            /* Everything matches, release and return. */
+            sn_coap_protocol_linked_list_blockwise_payload_release(stored_payload_info_ptr, payload_length);
             return;
         }
     }
@@ -1768,6 +1894,53 @@ static coap_blockwise_msg_s *sn_coap_stored_blockwise_msg_get(struct coap_s *han
     return ns_list_get_first(&handle->linked_list_blockwise_sent_msgs);
 }
 
+/**************************************************************************//**
+ * \fn static void sn_coap_protocol_send_block1_error(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, const sn_coap_hdr_s *received_coap_msg_ptr, sn_coap_msg_code_e msg_code, void *param)
+ *
+ * \brief Sends an error response to the last block of a Block1 request which could not be reassembled
+ *
+ * \param *src_addr_ptr pointer to source address of the request
+ * \param *received_coap_msg_ptr pointer to the received last block, its Message ID and token are used
+ * \param msg_code is response code, 4.08 for missing blocks or 4.13 if memory ran out
+ *****************************************************************************/
+
+static void sn_coap_protocol_send_block1_error(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, const sn_coap_hdr_s *received_coap_msg_ptr, sn_coap_msg_code_e msg_code, void *param)
+{
+    sn_coap_hdr_s *response_ptr = sn_coap_parser_alloc_message(handle);
+    uint8_t *packet_ptr;
+    uint16_t packet_len;
+
+    if (!response_ptr) {
+        tr_error("sn_coap_protocol_send_block1_error - failed to allocate message!");
+        return;
+    }
+
+    response_ptr->msg_type = COAP_MSG_TYPE_ACKNOWLEDGEMENT;
+    response_ptr->msg_code = msg_code;
+    response_ptr->msg_id = received_coap_msg_ptr->msg_id;
+    // The token is only referred to, so it must not be freed with the message
+    response_ptr->token_ptr = received_coap_msg_ptr->token_ptr;
+    response_ptr->token_len = received_coap_msg_ptr->token_len;
+
+    packet_len = sn_coap_builder_calc_needed_packet_data_size_2(response_ptr, handle->sn_coap_block_data_size);
+    packet_ptr = handle->sn_coap_protocol_malloc(packet_len);
+    if (packet_ptr) {
+        if (sn_coap_builder_2(packet_ptr, response_ptr, handle->sn_coap_block_data_size) > 0) {
+#if SN_COAP_DUPLICATION_MAX_MSGS_COUNT
+            // A duplicate of the last block gets the same response
+            (void)sn_coap_protocol_update_duplicate_package_data(handle, src_addr_ptr, response_ptr, packet_len, packet_ptr);
+#endif
+            handle->sn_coap_tx_callback(packet_ptr, packet_len, src_addr_ptr, param);
+        }
+        handle->sn_coap_protocol_free(packet_ptr);
+    } else {
+        tr_error("sn_coap_protocol_send_block1_error - failed to allocate packet!");
+    }
+
+    response_ptr->token_ptr = NULL;
+    sn_coap_parser_release_allocated_coap_msg_mem(handle, response_ptr);
+}
+
 /**************************************************************************//**
  * \fn static int8_t sn_coap_handle_blockwise_message(void)
  *
@@ -1863,17 +2036,14 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                         sn_coap_parser_release_allocated_coap_msg_mem(handle, received_coap_msg_ptr);
                         return NULL;
                     }
-                    src_coap_blockwise_ack_msg_ptr->msg_id = message_id++;
-                    if (message_id == 0) {
-                        message_id = 1;
-                    }
+                    src_coap_blockwise_ack_msg_ptr->msg_id = sn_coap_protocol_next_message_id(handle);
 
                     sn_coap_builder_2(dst_ack_packet_data_ptr, src_coap_blockwise_ack_msg_ptr, handle->sn_coap_block_data_size);
 
                     handle->sn_coap_tx_callback(dst_ack_packet_data_ptr, dst_packed_data_needed_mem, src_addr_ptr, param);
 
 #if ENABLE_RESENDINGS
-                    uint32_t resend_time = sn_coap_calculate_new_resend_time(handle->system_time, handle->sn_coap_resending_intervall, 0);
+                    uint32_t resend_time = sn_coap_calculate_new_resend_time(handle, handle->system_time, handle->sn_coap_resending_intervall, 0);
                     if (src_coap_blockwise_ack_msg_ptr->msg_type == COAP_MSG_TYPE_CONFIRMABLE) {
                         sn_coap_protocol_linked_list_send_msg_store(handle, src_addr_ptr,
                                 dst_packed_data_needed_mem,
@@ -1921,13 +2091,15 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                 blocks_in_order = false;
             }
 
-            sn_coap_protocol_linked_list_blockwise_payload_store(handle,
+            const bool stored = sn_coap_protocol_linked_list_blockwise_payload_store(handle,
                                                                  src_addr_ptr,
                                                                  received_coap_msg_ptr->payload_len,
                                                                  received_coap_msg_ptr->payload_ptr,
                                                                  received_coap_msg_ptr->token_ptr,
                                                                  received_coap_msg_ptr->token_len,
-                                                                 block_number);
+                                                                 block_number,
+                                                                 1u << ((received_coap_msg_ptr->options_list_ptr->block1 & 0x07) + 4),
+                                                                 received_coap_msg_ptr->options_list_ptr->size1);
 
             /* If not last block (more value is set) */
             /* Block option length can be 1-3 bytes. First 4-20 bits are for block number. Last 4 bits are ALWAYS more bit + block size. */
@@ -1961,7 +2133,13 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                 }
 
                 // Response with COAP_MSG_CODE_RESPONSE_REQUEST_ENTITY_TOO_LARGE if the payload size is more than we can handle
-                if (received_coap_msg_ptr->options_list_ptr->size1 > SN_COAP_MAX_INCOMING_BLOCK_MESSAGE_SIZE) {
+                if (!stored) {
+                    // The reassembly buffer could not be allocated and the transfer was dropped
+                    tr_error("sn_coap_handle_blockwise_message - (recv block1) out of memory, COAP_MSG_CODE_RESPONSE_REQUEST_ENTITY_TOO_LARGE!");
+                    src_coap_blockwise_ack_msg_ptr->msg_code = COAP_MSG_CODE_RESPONSE_REQUEST_ENTITY_TOO_LARGE;
+                    src_coap_blockwise_ack_msg_ptr->msg_type = COAP_MSG_TYPE_ACKNOWLEDGEMENT;
+                }
+                else if (received_coap_msg_ptr->options_list_ptr->size1 > SN_COAP_MAX_INCOMING_BLOCK_MESSAGE_SIZE) {
                     // Include maximum size that stack can handle into response
                     tr_error("sn_coap_handle_blockwise_message - (recv block1) COAP_MSG_CODE_RESPONSE_REQUEST_ENTITY_TOO_LARGE!");
                     src_coap_blockwise_ack_msg_ptr->msg_code = COAP_MSG_CODE_RESPONSE_REQUEST_ENTITY_TOO_LARGE;
@@ -1978,7 +2156,10 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                          tr_error("sn_coap_handle_blockwise_message - (recv block1) COAP_MSG_CODE_RESPONSE_REQUEST_ENTITY_TOO_LARGE!");
                          src_coap_blockwise_ack_msg_ptr->msg_code = COAP_MSG_CODE_RESPONSE_REQUEST_ENTITY_TOO_LARGE;
                          src_coap_blockwise_ack_msg_ptr->options_list_ptr->size1 = handle->sn_coap_block_data_size;
-                         sn_coap_protocol_linked_list_blockwise_payload_remove_oldest(handle, received_coap_msg_ptr->token_ptr, received_coap_msg_ptr->token_len);
+                         coap_blockwise_payload_s *stored_payload_info_ptr = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr, received_coap_msg_ptr->token_ptr, received_coap_msg_ptr->token_len);
+                         if (stored_payload_info_ptr) {
+                             sn_coap_protocol_linked_list_blockwise_payload_remove(handle, stored_payload_info_ptr);
+                         }
                     }
 
                     if (block_temp > sn_coap_convert_block_size(handle->sn_coap_block_data_size)) {
@@ -2035,31 +2216,32 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                 /* * * This is the last block when whole Blockwise payload from received * * */
                 /* * * blockwise messages is gathered and returned to User               * * */
 
-                /* Store last Blockwise payload to Linked list */
-                uint16_t payload_len            = 0;
-                uint8_t *payload_ptr            = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr, &payload_len, received_coap_msg_ptr->token_ptr, received_coap_msg_ptr->token_len);
-                uint32_t whole_payload_len      = sn_coap_protocol_linked_list_blockwise_payloads_get_len(handle, src_addr_ptr, received_coap_msg_ptr->token_ptr, received_coap_msg_ptr->token_len);
-                uint8_t *temp_whole_payload_ptr = NULL;
+                /* Last Blockwise payload is already stored, hand the reassembled payload over as such */
+                uint16_t whole_payload_len      = 0;
+                uint8_t *whole_payload_ptr      = NULL;
+                coap_blockwise_payload_s *stored_payload_info_ptr = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr, received_coap_msg_ptr->token_ptr, received_coap_msg_ptr->token_len);
 
-                temp_whole_payload_ptr = handle->sn_coap_protocol_malloc(whole_payload_len);
-                if (temp_whole_payload_ptr == NULL || whole_payload_len > UINT16_MAX) {
-                    tr_error("sn_coap_handle_blockwise_message - (recv block1) failed to allocate all blocks!");
+                if (stored_payload_info_ptr) {
+                    whole_payload_ptr = sn_coap_protocol_linked_list_blockwise_payload_take(handle, stored_payload_info_ptr, &whole_payload_len);
+                }
+                if (whole_payload_ptr == NULL) {
+                    // Tell the sender why the request is not processed, instead of leaving it without a response
+                    if (stored) {
+                        tr_error("sn_coap_handle_blockwise_message - (recv block1) blocks missing, COAP_MSG_CODE_RESPONSE_REQUEST_ENTITY_INCOMPLETE!");
+                        sn_coap_protocol_send_block1_error(handle, src_addr_ptr, received_coap_msg_ptr,
+                                                           COAP_MSG_CODE_RESPONSE_REQUEST_ENTITY_INCOMPLETE, param);
+                    } else {
+                        tr_error("sn_coap_handle_blockwise_message - (recv block1) out of memory, COAP_MSG_CODE_RESPONSE_REQUEST_ENTITY_TOO_LARGE!");
+                        sn_coap_protocol_send_block1_error(handle, src_addr_ptr, received_coap_msg_ptr,
+                                                           COAP_MSG_CODE_RESPONSE_REQUEST_ENTITY_TOO_LARGE, param);
+                    }
                     sn_coap_parser_release_allocated_coap_msg_mem(handle, received_coap_msg_ptr);
-                    handle->sn_coap_protocol_free(temp_whole_payload_ptr);
                     return 0;
                 }
 
                 // In block message case, payload_ptr freeing must be done in application level
-                received_coap_msg_ptr->payload_ptr = temp_whole_payload_ptr;
+                received_coap_msg_ptr->payload_ptr = whole_payload_ptr;
                 received_coap_msg_ptr->payload_len = whole_payload_len;
-
-                /* Copy stored Blockwise payloads to returned whole Blockwise payload pointer */
-                while (payload_ptr != NULL) {
-                    memcpy(temp_whole_payload_ptr, payload_ptr, payload_len);
-                    temp_whole_payload_ptr += payload_len;
-                    sn_coap_protocol_linked_list_blockwise_payload_remove_oldest(handle, received_coap_msg_ptr->token_ptr, received_coap_msg_ptr->token_len);
-                    payload_ptr = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr, &payload_len, received_coap_msg_ptr->token_ptr, received_coap_msg_ptr->token_len);
-                }
                 received_coap_msg_ptr->coap_status = COAP_STATUS_PARSER_BLOCKWISE_MSG_RECEIVED;
             }
         }
@@ -2082,7 +2264,9 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                                                                      received_coap_msg_ptr->payload_ptr,
                                                                      received_coap_msg_ptr->token_ptr,
                                                                      received_coap_msg_ptr->token_len,
-                                                                     received_coap_msg_ptr->options_list_ptr->block2 >> 4);
+                                                                     received_coap_msg_ptr->options_list_ptr->block2 >> 4,
+                                                                     1u << ((received_coap_msg_ptr->options_list_ptr->block2 & 0x07) + 4),
+                                                                     received_coap_msg_ptr->options_list_ptr->size2);
                 /* If not last block (more value is set) */
                 if (received_coap_msg_ptr->options_list_ptr->block2 & 0x08) {
                     coap_blockwise_msg_s *previous_blockwise_msg_ptr = NULL;
@@ -2118,10 +2302,7 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                         return NULL;
                     }
 
-                    src_coap_blockwise_ack_msg_ptr->msg_id = message_id++;
-                    if (message_id == 0) {
-                        message_id = 1;
-                    }
+                    src_coap_blockwise_ack_msg_ptr->msg_id = sn_coap_protocol_next_message_id(handle);
 
                     /* Update block option */
                     block_temp = received_coap_msg_ptr->options_list_ptr->block2 & 0x07;
@@ -2218,7 +2399,7 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                                                 dst_packed_data_needed_mem, src_addr_ptr, param);
 
 #if ENABLE_RESENDINGS
-                    uint32_t resend_time = sn_coap_calculate_new_resend_time(handle->system_time, handle->sn_coap_resending_intervall, 0);
+                    uint32_t resend_time = sn_coap_calculate_new_resend_time(handle, handle->system_time, handle->sn_coap_resending_intervall, 0);
                     sn_coap_protocol_linked_list_send_msg_store(handle, src_addr_ptr,
                             dst_packed_data_needed_mem,
                             dst_ack_packet_data_ptr,
@@ -2233,30 +2414,22 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                     /* * * This is the last block when whole Blockwise payload from received * * */
                     /* * * blockwise messages is gathered and returned to User               * * */
 
-                    /* Store last Blockwise payload to Linked list */
-                    uint16_t payload_len            = 0;
-                    uint8_t *payload_ptr            = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr, &payload_len, received_coap_msg_ptr->token_ptr, received_coap_msg_ptr->token_len);
-                    uint16_t whole_payload_len      = sn_coap_protocol_linked_list_blockwise_payloads_get_len(handle, src_addr_ptr, received_coap_msg_ptr->token_ptr, received_coap_msg_ptr->token_len);
-                    uint8_t *temp_whole_payload_ptr = NULL;
+                    /* Last Blockwise payload is already stored, hand the reassembled payload over as such */
+                    uint16_t whole_payload_len      = 0;
+                    uint8_t *whole_payload_ptr      = NULL;
+                    coap_blockwise_payload_s *stored_payload_info_ptr = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr, received_coap_msg_ptr->token_ptr, received_coap_msg_ptr->token_len);
 
-                    temp_whole_payload_ptr = handle->sn_coap_protocol_malloc(whole_payload_len);
-                    if (!temp_whole_payload_ptr) {
-                        tr_error("sn_coap_handle_blockwise_message - (send block2) failed to allocate whole payload!");
+                    if (stored_payload_info_ptr) {
+                        whole_payload_ptr = sn_coap_protocol_linked_list_blockwise_payload_take(handle, stored_payload_info_ptr, &whole_payload_len);
+                    }
+                    if (whole_payload_ptr == NULL) {
+                        tr_error("sn_coap_handle_blockwise_message - (send block2) failed to reassemble whole payload!");
+                        sn_coap_parser_release_allocated_coap_msg_mem(handle, received_coap_msg_ptr);
                         return 0;
                     }
 
-                    received_coap_msg_ptr->payload_ptr = temp_whole_payload_ptr;
+                    received_coap_msg_ptr->payload_ptr = whole_payload_ptr;
                     received_coap_msg_ptr->payload_len = whole_payload_len;
-
-                    /* Copy stored Blockwise payloads to returned whole Blockwise payload pointer */
-                    while (payload_ptr != NULL) {
-                        memcpy(temp_whole_payload_ptr, payload_ptr, payload_len);
-
-                        temp_whole_payload_ptr += payload_len;
-
-                        sn_coap_protocol_linked_list_blockwise_payload_remove_oldest(handle, received_coap_msg_ptr->token_ptr, received_coap_msg_ptr->token_len);
-                        payload_ptr = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr, &payload_len, received_coap_msg_ptr->token_ptr, received_coap_msg_ptr->token_len);
-                    }
                     received_coap_msg_ptr->coap_status = COAP_STATUS_PARSER_BLOCKWISE_MSG_RECEIVED;
 
                     //todo: remove previous msg from list
@@ -2548,3 +2721,31 @@ static bool sn_coap_protocol_update_duplicate_package_data(const struct coap_s *
     return true;
 }
 #endif
+
+/**************************************************************************//**
+ * \fn static uint16_t sn_coap_protocol_next_message_id(struct coap_s *handle)
+ *
+ * \brief Takes next Message ID of the handle
+ *
+ * Counter is advanced with compare-and-swap, so concurrent callers on the same handle
+ * never get the same Message ID. Zero is skipped, it marks a message without ID.
+ *
+ * \param *handle Pointer to CoAP library handle
+ *
+ * \return Message ID for a new Confirmable or Non-confirmable message
+ *****************************************************************************/
+static uint16_t sn_coap_protocol_next_message_id(struct coap_s *handle)
+{
+    uint16_t msg_id;
+    uint16_t next_msg_id;
+
+    do {
+        msg_id = handle->message_id;
+        next_msg_id = msg_id + 1;
+        if (next_msg_id == 0) {
+            next_msg_id = 1;
+        }
+    } while (!SN_COAP_ATOMIC_CAS_16(&handle->message_id, msg_id, next_msg_id));
+
+    return msg_id;
+}
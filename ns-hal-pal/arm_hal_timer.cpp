@@ -51,7 +51,12 @@ static void tick_timer_create(void)
     palStatus_t status;
     status = pal_init();
     assert(PAL_SUCCESS == status);
+#ifdef NS_EVENTLOOP_TICKLESS
+    // in tickless mode the eventloop reprograms the timer for each deadline
+    status = pal_osTimerCreate(timer_callback, NULL, palOsTimerOnce, &tick_timer_id);
+#else
     status = pal_osTimerCreate(timer_callback, NULL, palOsTimerPeriodic, &tick_timer_id);
+#endif
     assert(PAL_SUCCESS == status);
     
 }
@@ -92,4 +97,31 @@ int8_t platform_tick_timer_stop(void)
     return retval;
 }
 
+#ifdef NS_EVENTLOOP_TICKLESS
+extern "C"
+int8_t platform_tick_timer_set_timeout(uint32_t timeout_ms)
+{
+    int8_t retval = -1;
+    palStatus_t status;
+
+    if (tick_timer_id != 0) {
+        if (timeout_ms == 0) {
+            status = pal_osTimerStop(tick_timer_id);
+        } else {
+            status = pal_osTimerStart(tick_timer_id, timeout_ms);
+        }
+        if (PAL_SUCCESS == status) {
+            retval = 0;
+        }
+    }
+    return retval;
+}
+
+extern "C"
+uint32_t platform_tick_timer_read_ms(void)
+{
+    return (uint32_t)pal_osKernelSysMilliSecTick(pal_osKernelSysTick());
+}
+#endif // NS_EVENTLOOP_TICKLESS
+
 
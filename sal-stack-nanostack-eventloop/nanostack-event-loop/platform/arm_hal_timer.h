@@ -86,6 +86,27 @@ extern int8_t platform_tick_timer_start(uint32_t period_ms);
  */
 extern int8_t platform_tick_timer_stop(void);
 
+#ifdef NS_EVENTLOOP_TICKLESS
+/**
+ * \brief This function is API for programming the low resolution tick timer in tickless mode.
+ *        The callback set with platform_tick_timer_register gets called once after the
+ *        given time, replacing any earlier programmed timeout.
+ *
+ * \param timeout_ms define after how many milliseconds the callback is called, 0 cancels
+ *        the pending timeout
+ * \return -1 for failure, success otherwise
+ */
+extern int8_t platform_tick_timer_set_timeout(uint32_t timeout_ms);
+
+/**
+ * \brief This function is API for reading the free running millisecond counter the
+ *        tickless event timer keeps its time with. The counter may wrap around.
+ *
+ * \return current time in milliseconds
+ */
+extern uint32_t platform_tick_timer_read_ms(void);
+#endif // NS_EVENTLOOP_TICKLESS
+
 #endif // NS_EVENTLOOP_USE_TICK_TIMER
 
 #ifdef __cplusplus
@@ -27,6 +27,9 @@
 #undef NS_EVENTLOOP_USE_TICK_TIMER
 /* Exclude high resolution timer from build (removes need for "platform_timer" API) */
 #undef NS_EXCLUDE_HIGHRES_TIMER
+/* Program the tick timer for the next event timer deadline instead of ticking periodically
+ * (requires NS_EVENTLOOP_USE_TICK_TIMER and the "platform_tick_timer" tickless API) */
+#undef NS_EVENTLOOP_TICKLESS
 
 /*
  * mbedOS 5 specific configuration flag mapping to internal flags
@@ -39,6 +42,10 @@
 #define NS_EXCLUDE_HIGHRES_TIMER        1
 #endif
 
+#ifdef MBED_CONF_NANOSTACK_EVENTLOOP_USE_TICKLESS_TIMER
+#define NS_EVENTLOOP_TICKLESS           1
+#endif
+
 /*
  * For mbedOS 3 and minar use platform tick timer by default, highres timers should come from eventloop adaptor
  */
@@ -53,4 +60,8 @@
 #include NS_EVENTLOOP_USER_CONFIG_FILE
 #endif
 
+#if defined(NS_EVENTLOOP_TICKLESS) && !defined(NS_EVENTLOOP_USE_TICK_TIMER)
+#error "Tickless eventloop requires the platform tick timer (NS_EVENTLOOP_USE_TICK_TIMER)"
+#endif
+
 #endif /* EVENTLOOP_CONFIG_H_ */
@@ -40,6 +40,17 @@ NS_STATIC_ASSERT(1000 % EVENTOS_EVENT_TIMER_HZ == 0, "Need whole number of ms pe
 // atomicity on 16-bit platforms
 static volatile uint32_t timer_sys_ticks;
 
+#ifdef NS_EVENTLOOP_TICKLESS
+// Platform time in milliseconds at which the current tick started. In tickless mode
+// the tick timer only fires when a timer is due, and timer_sys_ticks is brought up
+// to date from the platform clock whenever it is read.
+static uint32_t timer_sys_tick_start_ms;
+
+// Longest timeout programmed at a time, keeps the millisecond value from overflowing.
+// A timer further away just gets a wakeup which finds nothing to do and reprograms.
+#define TIMER_SYS_TICKLESS_MAX_TICKS    (INT32_MAX / TIMER_SYS_TICK_PERIOD)
+#endif
+
 static NS_LIST_DEFINE(system_timer_free, sys_timer_struct_s, event.link);
 static NS_LIST_DEFINE(system_timer_list, sys_timer_struct_s, event.link);
 
@@ -47,6 +58,10 @@ static NS_LIST_DEFINE(system_timer_list, sys_timer_struct_s, event.link);
 static sys_timer_struct_s *sys_timer_dynamically_allocate(void);
 static void timer_sys_interrupt(void);
 static void timer_sys_add(sys_timer_struct_s *timer);
+static uint32_t timer_sys_ticks_now(void);
+#ifdef NS_EVENTLOOP_TICKLESS
+static void timer_sys_program(void);
+#endif
 
 #ifndef NS_EVENTLOOP_USE_TICK_TIMER
 static int8_t platform_tick_timer_start(uint32_t period_ms);
@@ -95,7 +110,12 @@ void timer_sys_init(void)
     }
 
     platform_tick_timer_register(timer_sys_interrupt);
+#ifdef NS_EVENTLOOP_TICKLESS
+    // Nothing is pending yet, so the tick timer stays idle until the first timer is requested
+    timer_sys_tick_start_ms = platform_tick_timer_read_ms();
+#else
     platform_tick_timer_start(TIMER_SYS_TICK_PERIOD);
+#endif
 }
 
 
@@ -111,15 +131,68 @@ void timer_sys_disable(void)
  */
 int8_t timer_sys_wakeup(void)
 {
+#ifdef NS_EVENTLOOP_TICKLESS
+    platform_enter_critical();
+    timer_sys_program();
+    platform_exit_critical();
+    return 0;
+#else
     return platform_tick_timer_start(TIMER_SYS_TICK_PERIOD);
+#endif
 }
 
 
 static void timer_sys_interrupt(void)
 {
+#ifdef NS_EVENTLOOP_TICKLESS
+    // The elapsed time is read from the platform clock, not counted from interrupts
+    system_timer_tick_update(0);
+#else
     system_timer_tick_update(1);
+#endif
 }
 
+/* Called internally with lock held */
+static uint32_t timer_sys_ticks_now(void)
+{
+#ifdef NS_EVENTLOOP_TICKLESS
+    uint32_t ticks = (platform_tick_timer_read_ms() - timer_sys_tick_start_ms) / TIMER_SYS_TICK_PERIOD;
+
+    timer_sys_ticks += ticks;
+    timer_sys_tick_start_ms += ticks * TIMER_SYS_TICK_PERIOD;
+#endif
+    return timer_sys_ticks;
+}
+
+#ifdef NS_EVENTLOOP_TICKLESS
+/* Called internally with lock held */
+static void timer_sys_program(void)
+{
+    sys_timer_struct_s *first = ns_list_get_first(&system_timer_list);
+    uint32_t timeout_ms = 0;
+
+    if (first) {
+        uint32_t now = timer_sys_ticks_now();
+
+        if (TICKS_BEFORE_OR_AT(first->launch_time, now)) {
+            timeout_ms = 1;
+        } else {
+            uint32_t ticks = first->launch_time - now;
+            uint32_t elapsed_ms = platform_tick_timer_read_ms() - timer_sys_tick_start_ms;
+
+            if (ticks > TIMER_SYS_TICKLESS_MAX_TICKS) {
+                ticks = TIMER_SYS_TICKLESS_MAX_TICKS;
+            }
+            timeout_ms = ticks * TIMER_SYS_TICK_PERIOD;
+            // Wake up at the start of the launch tick, not a full tick period from now
+            timeout_ms = (elapsed_ms < timeout_ms) ? (timeout_ms - elapsed_ms) : 1;
+        }
+    }
+
+    platform_tick_timer_set_timeout(timeout_ms);
+}
+#endif
+
 
 
 /* * * * * * * * * */
@@ -153,7 +226,7 @@ void timer_sys_event_free(arm_event_storage_t *event)
     } else {
         // Periodic - check due time of next launch
         timer->launch_time += timer->period;
-        if (TICKS_BEFORE_OR_AT(timer->launch_time, timer_sys_ticks)) {
+        if (TICKS_BEFORE_OR_AT(timer->launch_time, timer_sys_ticks_now())) {
             // next event is overdue - queue event now
             eventOS_event_send_timer_allocated(&timer->event);
         } else {
@@ -180,7 +253,7 @@ uint32_t eventOS_event_timer_ticks(void)
     // Enter/exit critical is a bit clunky, but necessary on 16-bit platforms,
     // which won't be able to do an atomic 32-bit read.
     platform_enter_critical();
-    ret_val = timer_sys_ticks;
+    ret_val = timer_sys_ticks_now();
     platform_exit_critical();
     return ret_val;
 }
@@ -195,12 +268,24 @@ static void timer_sys_add(sys_timer_struct_s *timer)
     ns_list_foreach(sys_timer_struct_s, t, &system_timer_list) {
         if (TICKS_BEFORE(at, t->launch_time)) {
             ns_list_add_before(&system_timer_list, t, timer);
+#ifdef NS_EVENTLOOP_TICKLESS
+            if (ns_list_get_first(&system_timer_list) == timer) {
+                timer_sys_program();
+            }
+#endif
             return;
         }
     }
 
     // Didn't insert before another timer, so must be last.
     ns_list_add_to_end(&system_timer_list, timer);
+
+#ifdef NS_EVENTLOOP_TICKLESS
+    // New earliest deadline, move the tick timer earlier
+    if (ns_list_get_first(&system_timer_list) == timer) {
+        timer_sys_program();
+    }
+#endif
 }
 
 /* Called internally with lock held */
@@ -224,7 +309,7 @@ static arm_event_storage_t *eventOS_event_timer_request_at_(const arm_event_t *e
     timer->launch_time = at;
     timer->period = period;
 
-    if (TICKS_BEFORE_OR_AT(at, timer_sys_ticks)) {
+    if (TICKS_BEFORE_OR_AT(at, timer_sys_ticks_now())) {
         eventOS_event_send_timer_allocated(&timer->event);
     } else {
         timer_sys_add(timer);
@@ -248,7 +333,7 @@ arm_event_storage_t *eventOS_event_timer_request_in(const arm_event_t *event, in
 {
     platform_enter_critical();
 
-    arm_event_storage_t *ret = eventOS_event_timer_request_at_(event, timer_sys_ticks + in, 0);
+    arm_event_storage_t *ret = eventOS_event_timer_request_at_(event, timer_sys_ticks_now() + in, 0);
 
     platform_exit_critical();
 
@@ -264,7 +349,7 @@ arm_event_storage_t *eventOS_event_timer_request_every(const arm_event_t *event,
 
     platform_enter_critical();
 
-    arm_event_storage_t *ret = eventOS_event_timer_request_at_(event, timer_sys_ticks + period, period);
+    arm_event_storage_t *ret = eventOS_event_timer_request_at_(event, timer_sys_ticks_now() + period, period);
 
     platform_exit_critical();
 
@@ -297,7 +382,7 @@ int8_t eventOS_event_timer_request(uint8_t event_id, uint8_t event_type, int8_t
     }
 
     platform_enter_critical();
-    arm_event_storage_t *ret = eventOS_event_timer_request_at_(&event, timer_sys_ticks + time, 0);
+    arm_event_storage_t *ret = eventOS_event_timer_request_at_(&event, timer_sys_ticks_now() + time, 0);
     platform_exit_critical();
     return ret?0:-1;
 }
@@ -336,14 +421,15 @@ uint32_t eventOS_event_timer_shortest_active_timer(void)
 
     platform_enter_critical();
     sys_timer_struct_s *first = ns_list_get_first(&system_timer_list);
+    uint32_t now = timer_sys_ticks_now();
     if (first == NULL) {
         // Weird API has 0 for "no events"
         ret_val = 0;
-    } else if (TICKS_BEFORE_OR_AT(first->launch_time, timer_sys_ticks)) {
+    } else if (TICKS_BEFORE_OR_AT(first->launch_time, now)) {
         // Which means an immediate/overdue event has to be 1
         ret_val = 1;
     } else {
-        ret_val = first->launch_time - timer_sys_ticks;
+        ret_val = first->launch_time - now;
     }
 
     platform_exit_critical();
@@ -353,8 +439,14 @@ uint32_t eventOS_event_timer_shortest_active_timer(void)
 void system_timer_tick_update(uint32_t ticks)
 {
     platform_enter_critical();
+#ifdef NS_EVENTLOOP_TICKLESS
+    // The platform clock keeps running also while sleeping, so it already covers these ticks
+    (void)ticks;
+    timer_sys_ticks_now();
+#else
     //Keep runtime time
     timer_sys_ticks += ticks;
+#endif
     ns_list_foreach_safe(sys_timer_struct_s, cur, &system_timer_list) {
         if (TICKS_BEFORE_OR_AT(cur->launch_time, timer_sys_ticks)) {
             // Unthread from our list
@@ -368,6 +460,10 @@ void system_timer_tick_update(uint32_t ticks)
         }
     }
 
+#ifdef NS_EVENTLOOP_TICKLESS
+    timer_sys_program();
+#endif
+
     platform_exit_critical();
 }
 
@@ -0,0 +1,489 @@
+// ----------------------------------------------------------------------------
+// Copyright 2019 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "update-client-delta-paal/arm_uc_pal_delta_paal_pipeline.h"
+#include "update-client-common/arm_uc_scheduler.h"
+#include "delta-tool-internal/include/bspatch.h"
+#include "delta-tool-internal/include/bspatch_private.h"
+#include "delta-tool-internal/include/lz4.h"
+#include "delta-tool-internal/include/varint.h"
+
+#include "pal.h"
+#include "unity.h"
+#include "unity_fixture.h"
+#include "test_runners.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+TEST_GROUP(uc_delta_pipeline);
+
+#define UC_DELTA_TEST_OLD_SIZE      (48 * 1024)
+#define UC_DELTA_TEST_NEW_SIZE      (40 * 1024)
+// Uncompressed bytes in each LZ4 frame of the patch, and the frame size in the header. Both
+// bspatch buffers hold a frame and must fit BS_PATCH_COMPILE_TIME_MEMORY_ALLOC together, and
+// a frame that does not compress still fits the header size.
+#define UC_DELTA_TEST_FRAME_SIZE    480
+#define UC_DELTA_TEST_FRAME_MAX     (BS_PATCH_COMPILE_TIME_MEMORY_ALLOC / 2)
+// Patch bytes downloaded at a time, and new image bytes the serial path writes at a time.
+#define UC_DELTA_TEST_FRAGMENT_SIZE 512
+#define UC_DELTA_TEST_BLOCK_SIZE    (ARM_UC_BUFFER_SIZE / 2)
+#define UC_DELTA_TEST_TIMEOUT_MS    10000
+
+static uint8_t *uc_delta_test_old = NULL;
+static uint8_t *uc_delta_test_new = NULL;
+static uint8_t *uc_delta_test_patch = NULL;
+static uint32_t uc_delta_test_patch_size = 0;
+static uint8_t *uc_delta_test_output = NULL;
+static uint32_t uc_delta_test_output_size = 0;
+
+static palSemaphoreID_t uc_delta_test_semaphore = 0;
+static uint32_t uc_delta_test_write_ms = 0;
+static uint32_t uc_delta_test_fragments_done = 0;
+static bool uc_delta_test_error = false;
+
+/*************************************************************************************
+ * Patch in the bspatch format, built from a few hundred control entries
+ */
+
+static void uc_delta_test_offtout(int64_t value, uint8_t *buffer)
+{
+    uint64_t magnitude = (value < 0) ? (uint64_t)(-value) : (uint64_t) value;
+
+    for (int index = 0; index < 8; index++) {
+        buffer[index] = (uint8_t) magnitude;
+        magnitude >>= 8;
+    }
+    if (value < 0) {
+        buffer[7] |= 0x80;
+    }
+}
+
+/**
+ * @brief Append data to the patch as LZ4 frames of UC_DELTA_TEST_FRAME_SIZE bytes.
+ */
+static void uc_delta_test_add_frames(const uint8_t *data, uint32_t length)
+{
+    for (uint32_t offset = 0; offset < length; offset += UC_DELTA_TEST_FRAME_SIZE) {
+        uint8_t frame[UC_DELTA_TEST_FRAME_MAX];
+        uint32_t size = length - offset;
+
+        if (size > UC_DELTA_TEST_FRAME_SIZE) {
+            size = UC_DELTA_TEST_FRAME_SIZE;
+        }
+        int compressed = LZ4_compress_default((const char *) &data[offset], (char *) frame,
+                                              size, UC_DELTA_TEST_FRAME_MAX);
+        TEST_ASSERT_TRUE(compressed > 0);
+
+        uc_delta_test_patch_size += encode_unsigned_varint(compressed, &uc_delta_test_patch[uc_delta_test_patch_size], 8);
+        memcpy(&uc_delta_test_patch[uc_delta_test_patch_size], frame, compressed);
+        uc_delta_test_patch_size += compressed;
+    }
+}
+
+/**
+ * @brief Build the original and new images and the patch between them.
+ * @details Each control entry copies a run of the original image with a few
+ *          bytes changed, adds some new bytes and jumps backwards or forwards
+ *          in the original image.
+ */
+static void uc_delta_test_build_patch(void)
+{
+    uint8_t diff[4096];
+    uint32_t old_offset = 0;
+    uint32_t new_offset = 0;
+
+    for (uint32_t index = 0; index < UC_DELTA_TEST_OLD_SIZE; index++) {
+        uc_delta_test_old[index] = (uint8_t)((index * 7) + (index / 251));
+    }
+
+    memcpy(uc_delta_test_patch, FILE_MAGIC, FILE_MAGIC_LEN);
+    uc_delta_test_offtout(UC_DELTA_TEST_NEW_SIZE, &uc_delta_test_patch[FILE_MAGIC_LEN]);
+    uc_delta_test_offtout(UC_DELTA_TEST_FRAME_MAX, &uc_delta_test_patch[FILE_MAGIC_LEN + 8]);
+    uc_delta_test_offtout(UC_DELTA_TEST_FRAME_MAX, &uc_delta_test_patch[FILE_MAGIC_LEN + 16]);
+    uc_delta_test_patch_size = FILE_HEADER_LEN;
+
+    for (uint32_t entry = 0; new_offset < UC_DELTA_TEST_NEW_SIZE; entry++) {
+        uint32_t diff_length = 100 + ((entry * 733) % 3000);
+        uint32_t extra_length = (entry * 97) % 600;
+        uint32_t target = (entry * 5113) % (UC_DELTA_TEST_OLD_SIZE - sizeof(diff));
+
+        if (diff_length > UC_DELTA_TEST_NEW_SIZE - new_offset) {
+            diff_length = UC_DELTA_TEST_NEW_SIZE - new_offset;
+        }
+        if (extra_length > UC_DELTA_TEST_NEW_SIZE - new_offset - diff_length) {
+            extra_length = UC_DELTA_TEST_NEW_SIZE - new_offset - diff_length;
+        }
+
+        for (uint32_t index = 0; index < diff_length; index++) {
+            diff[index] = ((index % 61) == 0) ? (uint8_t)(entry + index) : 0;
+            uc_delta_test_new[new_offset + index] = uc_delta_test_old[old_offset + index] + diff[index];
+        }
+        for (uint32_t index = 0; index < extra_length; index++) {
+            uc_delta_test_new[new_offset + diff_length + index] = (uint8_t)((entry * 31) ^ (index * 13));
+        }
+
+        uc_delta_test_patch_size += encode_unsigned_varint(diff_length, &uc_delta_test_patch[uc_delta_test_patch_size], 8);
+        uc_delta_test_patch_size += encode_unsigned_varint(extra_length, &uc_delta_test_patch[uc_delta_test_patch_size], 8);
+        uc_delta_test_patch_size += encode_signed_varint((int64_t) target - (old_offset + diff_length),
+                                                         &uc_delta_test_patch[uc_delta_test_patch_size], 8);
+        uc_delta_test_add_frames(diff, diff_length);
+        uc_delta_test_add_frames(&uc_delta_test_new[new_offset + diff_length], extra_length);
+
+        new_offset += diff_length + extra_length;
+        old_offset = target;
+    }
+}
+
+/*************************************************************************************
+ * Pipeline, fed a fragment at a time from the hub thread as the download arrives
+ */
+
+static void uc_delta_test_notify(void)
+{
+    pal_osSemaphoreRelease(uc_delta_test_semaphore);
+}
+
+static void uc_delta_test_signal(uintptr_t event)
+{
+    if (event == ARM_UC_PAAL_EVENT_WRITE_DONE) {
+        uc_delta_test_fragments_done++;
+    } else {
+        uc_delta_test_error = true;
+    }
+}
+
+static int uc_delta_test_read_old(void *buffer, uint64_t length, uint32_t offset)
+{
+    if (offset + length > UC_DELTA_TEST_OLD_SIZE) {
+        return ERR_INVALID_PARAMETER;
+    }
+    memcpy(buffer, &uc_delta_test_old[offset], length);
+    return ERR_NONE;
+}
+
+/**
+ * @brief Storage taking uc_delta_test_write_ms for each write, reporting it done
+ *        from within the call as the Linux storage does.
+ */
+static arm_uc_error_t uc_delta_test_storage_write(uint32_t slot_id, uint32_t offset, const arm_uc_buffer_t *buffer)
+{
+    arm_uc_error_t result = { .code = ERR_INVALID_PARAMETER };
+    (void)slot_id;
+
+    if (offset + buffer->size <= UC_DELTA_TEST_NEW_SIZE) {
+        memcpy(&uc_delta_test_output[offset], buffer->ptr, buffer->size);
+        if (offset + buffer->size > uc_delta_test_output_size) {
+            uc_delta_test_output_size = offset + buffer->size;
+        }
+        if (uc_delta_test_write_ms > 0) {
+            pal_osDelay(uc_delta_test_write_ms);
+        }
+        arm_uc_deltapaal_pipeline_storage_event(ARM_UC_PAAL_EVENT_WRITE_DONE);
+        result.code = ERR_NONE;
+    }
+    return result;
+}
+
+static const ARM_UC_PAAL_UPDATE uc_delta_test_storage = {
+    .Write = uc_delta_test_storage_write
+};
+
+/**
+ * @brief Apply the first patch_size bytes of the patch through the pipeline.
+ * @param patch_size Patch bytes given, the last fragment is flagged as such.
+ * @param download_ms Time each fragment takes to arrive after the last one is done.
+ * @param elapsed_ms (out) Time until the last fragment is done.
+ * @return true if every fragment was done and no error was signalled.
+ */
+static bool uc_delta_test_pipeline(uint32_t patch_size, uint32_t download_ms, uint32_t *elapsed_ms)
+{
+    arm_uc_buffer_t fragment = { 0 };
+    uint32_t fragment_count = (patch_size + UC_DELTA_TEST_FRAGMENT_SIZE - 1) / UC_DELTA_TEST_FRAGMENT_SIZE;
+    uint32_t sent = 0;
+    uint64_t ready_ticks = 0;
+    bool downloading = false;
+    bool success = true;
+
+    uc_delta_test_fragments_done = 0;
+    uc_delta_test_error = false;
+    uc_delta_test_output_size = 0;
+    memset(uc_delta_test_output, 0, UC_DELTA_TEST_NEW_SIZE);
+
+    uint64_t start_ticks = pal_osKernelSysTick();
+    uint64_t timeout_ticks = pal_osKernelSysTickMicroSec(UC_DELTA_TEST_TIMEOUT_MS * 1000ULL);
+    uint64_t download_ticks = pal_osKernelSysTickMicroSec(download_ms * 1000ULL);
+
+    arm_uc_error_t status = arm_uc_deltapaal_pipeline_start(0, &uc_delta_test_storage, uc_delta_test_read_old,
+                                                            uc_delta_test_signal);
+    TEST_ASSERT_EQUAL_HEX(ERR_NONE, status.code);
+
+    while (success && (uc_delta_test_fragments_done < fragment_count) && !uc_delta_test_error) {
+        ARM_UC_ProcessQueue();
+
+        // the next fragment is requested once the last one is done
+        uint64_t now_ticks = pal_osKernelSysTick();
+        if ((uc_delta_test_fragments_done == sent) && (sent < fragment_count)) {
+            if (!downloading) {
+                downloading = true;
+                ready_ticks = now_ticks + download_ticks;
+            } else if (now_ticks >= ready_ticks) {
+                downloading = false;
+                fragment.ptr = &uc_delta_test_patch[sent * UC_DELTA_TEST_FRAGMENT_SIZE];
+                fragment.size = patch_size - (sent * UC_DELTA_TEST_FRAGMENT_SIZE);
+                if (fragment.size > UC_DELTA_TEST_FRAGMENT_SIZE) {
+                    fragment.size = UC_DELTA_TEST_FRAGMENT_SIZE;
+                }
+                fragment.size_max = fragment.size;
+                sent++;
+                status = arm_uc_deltapaal_pipeline_write(&fragment, sent == fragment_count);
+                success = (status.code == ERR_NONE);
+                continue;
+            }
+        }
+
+        if ((now_ticks - start_ticks) > timeout_ticks) {
+            TEST_PRINTF("pipeline stopped after %" PRIu32 " fragments\r\n", uc_delta_test_fragments_done);
+            success = false;
+        }
+        int32_t available = 0;
+        pal_osSemaphoreWait(uc_delta_test_semaphore, 1, &available);
+    }
+
+    *elapsed_ms = (uint32_t) pal_osKernelSysMilliSecTick(pal_osKernelSysTick() - start_ticks);
+
+    arm_uc_deltapaal_pipeline_stop();
+    ARM_UC_ProcessQueue();
+    return success && !uc_delta_test_error;
+}
+
+/*************************************************************************************
+ * Serial reference, bspatch reading, patching and writing on one thread as the hub does
+ */
+
+static struct {
+    uint32_t patch_offset;
+    uint32_t patch_fetched;
+    uint32_t download_ms;
+    int64_t  old_offset;
+    uint32_t new_offset;
+    uint32_t block_size;
+    uint8_t  block[UC_DELTA_TEST_BLOCK_SIZE];
+} uc_delta_test_serial_state;
+
+static bs_patch_api_return_code_t uc_delta_test_serial_read_patch(const struct bspatch_stream *stream,
+                                                                  void *buffer, uint64_t length)
+{
+    (void)stream;
+    if (uc_delta_test_serial_state.patch_offset + length > uc_delta_test_patch_size) {
+        return EBSAPI_ERR_CORRUPTED_PATCH;
+    }
+    while (uc_delta_test_serial_state.patch_offset + length > uc_delta_test_serial_state.patch_fetched) {
+        pal_osDelay(uc_delta_test_serial_state.download_ms);
+        uc_delta_test_serial_state.patch_fetched += UC_DELTA_TEST_FRAGMENT_SIZE;
+    }
+    memcpy(buffer, &uc_delta_test_patch[uc_delta_test_serial_state.patch_offset], length);
+    uc_delta_test_serial_state.patch_offset += length;
+    return EBSAPI_OPERATION_DONE_IMMEDIATELY;
+}
+
+static bs_patch_api_return_code_t uc_delta_test_serial_read_old(const struct bspatch_stream *stream,
+                                                                void *buffer, uint64_t length)
+{
+    (void)stream;
+    if (uc_delta_test_read_old(buffer, length, (uint32_t) uc_delta_test_serial_state.old_offset) != ERR_NONE) {
+        return EBSAPI_ERR_FILE_IO;
+    }
+    uc_delta_test_serial_state.old_offset += length;
+    return EBSAPI_OPERATION_DONE_IMMEDIATELY;
+}
+
+static bs_patch_api_return_code_t uc_delta_test_serial_seek_old(const struct bspatch_stream *stream, int64_t seek_diff)
+{
+    (void)stream;
+    uc_delta_test_serial_state.old_offset += seek_diff;
+    return EBSAPI_OPERATION_DONE_IMMEDIATELY;
+}
+
+static void uc_delta_test_serial_flush(void)
+{
+    memcpy(&uc_delta_test_output[uc_delta_test_serial_state.new_offset], uc_delta_test_serial_state.block,
+           uc_delta_test_serial_state.block_size);
+    uc_delta_test_serial_state.new_offset += uc_delta_test_serial_state.block_size;
+    uc_delta_test_serial_state.block_size = 0;
+    if (uc_delta_test_write_ms > 0) {
+        pal_osDelay(uc_delta_test_write_ms);
+    }
+}
+
+static bs_patch_api_return_code_t uc_delta_test_serial_write_new(const struct bspatch_stream *stream,
+                                                                 void *buffer, uint64_t length)
+{
+    const uint8_t *input = (const uint8_t *) buffer;
+    (void)stream;
+
+    if (uc_delta_test_serial_state.new_offset + uc_delta_test_serial_state.block_size + length > UC_DELTA_TEST_NEW_SIZE) {
+        return EBSAPI_ERR_FILE_IO;
+    }
+    while (length > 0) {
+        uint32_t copy_size = UC_DELTA_TEST_BLOCK_SIZE - uc_delta_test_serial_state.block_size;
+        if (copy_size > length) {
+            copy_size = (uint32_t) length;
+        }
+        memcpy(&uc_delta_test_serial_state.block[uc_delta_test_serial_state.block_size], input, copy_size);
+        uc_delta_test_serial_state.block_size += copy_size;
+        input += copy_size;
+        length -= copy_size;
+        if (uc_delta_test_serial_state.block_size == UC_DELTA_TEST_BLOCK_SIZE) {
+            uc_delta_test_serial_flush();
+        }
+    }
+    return EBSAPI_OPERATION_DONE_IMMEDIATELY;
+}
+
+static bool uc_delta_test_serial(uint32_t download_ms, uint32_t *elapsed_ms)
+{
+    struct bspatch_stream stream;
+
+    memset(&uc_delta_test_serial_state, 0, sizeof(uc_delta_test_serial_state));
+    uc_delta_test_serial_state.download_ms = download_ms;
+    memset(uc_delta_test_output, 0, UC_DELTA_TEST_NEW_SIZE);
+
+    uint64_t start_ticks = pal_osKernelSysTick();
+
+    ARM_BS_Init(&stream, NULL,
+                uc_delta_test_serial_read_patch,
+                uc_delta_test_serial_read_old,
+                uc_delta_test_serial_seek_old,
+                uc_delta_test_serial_write_new);
+    bs_patch_api_return_code_t result = ARM_BS_ProcessPatchEvent(&stream, EBSAPI_START_PATCH_PROCESSING);
+    if ((result == EBSAPI_PATCH_DONE) && (uc_delta_test_serial_state.block_size > 0)) {
+        uc_delta_test_serial_flush();
+    }
+    ARM_BS_Free(&stream);
+
+    *elapsed_ms = (uint32_t) pal_osKernelSysMilliSecTick(pal_osKernelSysTick() - start_ticks);
+    uc_delta_test_output_size = uc_delta_test_serial_state.new_offset;
+    return (result == EBSAPI_PATCH_DONE);
+}
+
+TEST_SETUP(uc_delta_pipeline)
+{
+    palStatus_t status = pal_init();
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    ARM_UC_SchedulerInit();
+    status = pal_osSemaphoreCreate(0, &uc_delta_test_semaphore);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    ARM_UC_AddNotificationHandler(uc_delta_test_notify);
+
+    uc_delta_test_old = malloc(UC_DELTA_TEST_OLD_SIZE);
+    uc_delta_test_new = malloc(UC_DELTA_TEST_NEW_SIZE);
+    uc_delta_test_output = malloc(UC_DELTA_TEST_NEW_SIZE);
+    // frames never grow the data by more than the LZ4 bound, and each entry adds a few bytes of control
+    uc_delta_test_patch = malloc(2 * UC_DELTA_TEST_NEW_SIZE);
+    TEST_ASSERT_NOT_NULL(uc_delta_test_old);
+    TEST_ASSERT_NOT_NULL(uc_delta_test_new);
+    TEST_ASSERT_NOT_NULL(uc_delta_test_output);
+    TEST_ASSERT_NOT_NULL(uc_delta_test_patch);
+
+    uc_delta_test_build_patch();
+    uc_delta_test_write_ms = 0;
+}
+
+TEST_TEAR_DOWN(uc_delta_pipeline)
+{
+    arm_uc_deltapaal_pipeline_stop();
+    ARM_UC_AddNotificationHandler(NULL);
+    pal_osSemaphoreDelete(&uc_delta_test_semaphore);
+
+    free(uc_delta_test_old);
+    free(uc_delta_test_new);
+    free(uc_delta_test_output);
+    free(uc_delta_test_patch);
+    uc_delta_test_old = NULL;
+    uc_delta_test_new = NULL;
+    uc_delta_test_output = NULL;
+    uc_delta_test_patch = NULL;
+}
+
+/**
+ * @brief The pipeline writes the same new image as bspatch on one thread.
+ */
+TEST(uc_delta_pipeline, matchesSerialPatch)
+{
+    uint32_t elapsed_ms = 0;
+
+    TEST_ASSERT_TRUE(uc_delta_test_serial(0, &elapsed_ms));
+    TEST_ASSERT_EQUAL_UINT32(UC_DELTA_TEST_NEW_SIZE, uc_delta_test_output_size);
+    TEST_ASSERT_EQUAL_MEMORY(uc_delta_test_new, uc_delta_test_output, UC_DELTA_TEST_NEW_SIZE);
+
+    TEST_ASSERT_TRUE(uc_delta_test_pipeline(uc_delta_test_patch_size, 0, &elapsed_ms));
+    TEST_ASSERT_EQUAL_UINT32(UC_DELTA_TEST_NEW_SIZE, uc_delta_test_output_size);
+    TEST_ASSERT_EQUAL_MEMORY(uc_delta_test_new, uc_delta_test_output, UC_DELTA_TEST_NEW_SIZE);
+}
+
+/**
+ * @brief A patch that ends early is reported with WRITE_ERROR, and the threads stop.
+ */
+TEST(uc_delta_pipeline, truncatedPatchFails)
+{
+    uint32_t elapsed_ms = 0;
+
+    TEST_ASSERT_FALSE(uc_delta_test_pipeline(uc_delta_test_patch_size - 100, 0, &elapsed_ms));
+    TEST_ASSERT_TRUE(uc_delta_test_error);
+    TEST_ASSERT_TRUE(uc_delta_test_output_size < UC_DELTA_TEST_NEW_SIZE);
+}
+
+/**
+ * @brief Time to apply the patch serially and through the pipeline, with a
+ *        delay on each downloaded fragment and on each write.
+ */
+TEST(uc_delta_pipeline, latencyBenchmark)
+{
+    const uint32_t download_ms = 2;
+    const uint32_t write_ms = 2;
+    const int runs = 3;
+    uint32_t serial_ms = UINT32_MAX;
+    uint32_t pipeline_ms = UINT32_MAX;
+
+    uc_delta_test_write_ms = write_ms;
+    // Best of a few runs, the scheduling of the threads varies.
+    for (int run = 0; run < runs; run++) {
+        uint32_t run_ms = 0;
+
+        TEST_ASSERT_TRUE(uc_delta_test_serial(download_ms, &run_ms));
+        TEST_ASSERT_EQUAL_MEMORY(uc_delta_test_new, uc_delta_test_output, UC_DELTA_TEST_NEW_SIZE);
+        if (run_ms < serial_ms) {
+            serial_ms = run_ms;
+        }
+
+        TEST_ASSERT_TRUE(uc_delta_test_pipeline(uc_delta_test_patch_size, download_ms, &run_ms));
+        TEST_ASSERT_EQUAL_MEMORY(uc_delta_test_new, uc_delta_test_output, UC_DELTA_TEST_NEW_SIZE);
+        if (run_ms < pipeline_ms) {
+            pipeline_ms = run_ms;
+        }
+    }
+    TEST_PRINTF("%" PRIu32 " byte patch to %" PRIu32 " bytes, %" PRIu32 " ms per fragment, %" PRIu32 " ms writes: "
+                "serial %" PRIu32 " ms, pipeline %" PRIu32 " ms\r\n",
+                uc_delta_test_patch_size, (uint32_t) UC_DELTA_TEST_NEW_SIZE, download_ms, write_ms,
+                serial_ms, pipeline_ms);
+    // The next fragment downloads and earlier blocks are written while the patch is applied.
+    TEST_ASSERT_TRUE(pipeline_ms < serial_ms);
+}
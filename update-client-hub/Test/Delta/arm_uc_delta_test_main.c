@@ -0,0 +1,34 @@
+// ----------------------------------------------------------------------------
+// Copyright 2019 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "test_runners.h"
+
+#include "unity.h"
+#include "unity_fixture.h"
+
+static void TEST_uc_delta_all_GROUPS_RUNNER(void)
+{
+    RUN_TEST_GROUP(uc_delta_pipeline);
+}
+
+int updateClientDeltaTestMain(void)
+{
+    // The images and patch are in memory, so no connection is needed.
+    int init_flags = PAL_TEST_PLATFORM_INIT_BASE;
+    return palTestMain(TEST_uc_delta_all_GROUPS_RUNNER, init_flags);
+}
@@ -0,0 +1,236 @@
+// ----------------------------------------------------------------------------
+// Copyright 2019 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "update-client-source-manager/arm_uc_source_manager.h"
+#include "update-client-source-http/arm_uc_source_http.h"
+#include "update-client-common/arm_uc_scheduler.h"
+#include "arm_uc_http_test_server.h"
+
+#include "pal.h"
+#include "unity.h"
+#include "unity_fixture.h"
+#include "test_runners.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+TEST_GROUP(uc_fragment_ring);
+
+#define UC_RING_TEST_FRAGMENT_SIZE  512
+#define UC_RING_TEST_FILE_SIZE      ((40 * UC_RING_TEST_FRAGMENT_SIZE) + 300)
+// Most buffers benchmarked, the source manager queues one request per buffer.
+#define UC_RING_TEST_MAX_BUFFERS    8
+#define UC_RING_TEST_TIMEOUT_MS     10000
+
+#if ARM_UC_FRAGMENT_BUFFER_COUNT < UC_RING_TEST_MAX_BUFFERS
+#error ARM_UC_FRAGMENT_BUFFER_COUNT must be at least UC_RING_TEST_MAX_BUFFERS for these tests
+#endif
+
+static uint8_t *uc_ring_test_file = NULL;
+static uint8_t uc_ring_test_message[UC_RING_TEST_MAX_BUFFERS][UC_RING_TEST_FRAGMENT_SIZE];
+static arm_uc_http_test_server_t uc_ring_test_server;
+
+static volatile uint32_t uc_ring_test_fragments_received = 0;
+static volatile bool uc_ring_test_error = false;
+
+static void uc_ring_test_event_handler(uintptr_t event)
+{
+    if (event == ARM_UC_SM_EVENT_FIRMWARE) {
+        uc_ring_test_fragments_received++;
+    } else {
+        uc_ring_test_error = true;
+    }
+}
+
+/**
+ * @brief Download the served file through the source manager into a ring of
+ *        buffers, as the hub does, writing each fragment to a storage that
+ *        takes write_ms to finish.
+ * @param buffer_count Number of buffers in the ring.
+ * @param write_ms Time each write takes.
+ * @param elapsed_ms (out) Time from the first fragment to the last write, so
+ *                   the connection set-up does not count.
+ * @return true if every fragment arrived in order and matched the file.
+ */
+static bool uc_ring_test_download(uint32_t buffer_count, uint32_t write_ms, uint32_t *elapsed_ms)
+{
+    char host[] = "127.0.0.1";
+    char path[] = "/firmware";
+    arm_uc_uri_t uri = { 0 };
+    arm_uc_buffer_t ring[UC_RING_TEST_MAX_BUFFERS];
+    uint32_t ring_offset[UC_RING_TEST_MAX_BUFFERS];
+    uint32_t fetch_index = 0;
+    uint32_t fetch_count = 0;
+    uint32_t write_index = 0;
+    uint32_t filled = 0;
+    uint32_t request_offset = 0;
+    uint32_t stored_offset = 0;
+    uint32_t handled = 0;
+    bool write_pending = false;
+    uint64_t write_done_ticks = 0;
+    uint64_t first_ticks = 0;
+    bool success = true;
+
+    uri.scheme = URI_SCHEME_HTTP;
+    uri.port = uc_ring_test_server.port;
+    uri.host = host;
+    uri.path = path;
+    for (uint32_t index = 0; index < buffer_count; index++) {
+        ring[index].size_max = UC_RING_TEST_FRAGMENT_SIZE;
+        ring[index].size = 0;
+        ring[index].ptr = uc_ring_test_message[index];
+    }
+
+    uc_ring_test_fragments_received = 0;
+    uc_ring_test_error = false;
+
+    arm_uc_error_t status = ARM_UC_SourceManager.Initialize(uc_ring_test_event_handler);
+    TEST_ASSERT_EQUAL_HEX(ERR_NONE, status.code);
+    status = ARM_UC_SourceManager.AddSource(&ARM_UCS_HTTPSource);
+    TEST_ASSERT_EQUAL_HEX(ERR_NONE, status.code);
+
+    uint64_t start_ticks = pal_osKernelSysTick();
+    uint64_t timeout_ticks = pal_osKernelSysTickMicroSec(UC_RING_TEST_TIMEOUT_MS * 1000ULL);
+    uint64_t write_ticks = pal_osKernelSysTickMicroSec(write_ms * 1000ULL);
+
+    while (success && (stored_offset < uc_ring_test_server.file_size)) {
+        // request a fragment into every free buffer
+        while (success && (filled + fetch_count < buffer_count)
+                && (request_offset < uc_ring_test_server.file_size)) {
+            uint32_t index = (fetch_index + fetch_count) % buffer_count;
+
+            ring[index].size = 0;
+            ring_offset[index] = request_offset;
+            status = ARM_UC_SourceManager.GetFirmwareFragment(&uri, &ring[index], request_offset);
+            success = (status.code == ERR_NONE);
+            fetch_count++;
+            request_offset += UC_RING_TEST_FRAGMENT_SIZE;
+        }
+
+        ARM_UC_ProcessQueue();
+        success = success && !uc_ring_test_error;
+
+        // fragments complete in the order they were requested
+        while (success && (handled < uc_ring_test_fragments_received)) {
+            arm_uc_buffer_t *fragment = &ring[fetch_index];
+            uint32_t offset = ring_offset[fetch_index];
+            uint32_t expected = uc_ring_test_server.file_size - offset;
+
+            if (expected > UC_RING_TEST_FRAGMENT_SIZE) {
+                expected = UC_RING_TEST_FRAGMENT_SIZE;
+            }
+            if ((fragment->size != expected)
+                    || (memcmp(fragment->ptr, &uc_ring_test_server.file[offset], fragment->size) != 0)) {
+                TEST_PRINTF("fragment at %" PRIu32 " has wrong content\r\n", offset);
+                success = false;
+            }
+            if (handled == 0) {
+                first_ticks = pal_osKernelSysTick();
+            }
+            handled++;
+            fetch_count--;
+            filled++;
+            fetch_index = (fetch_index + 1) % buffer_count;
+        }
+
+        // storage finishes a write, then starts on the oldest fragment
+        uint64_t now_ticks = pal_osKernelSysTick();
+        if (write_pending && (now_ticks >= write_done_ticks)) {
+            write_pending = false;
+            stored_offset += ring[write_index].size;
+            filled--;
+            write_index = (write_index + 1) % buffer_count;
+        }
+        if (!write_pending && (filled > 0)) {
+            write_pending = true;
+            write_done_ticks = now_ticks + write_ticks;
+        }
+
+        if ((now_ticks - start_ticks) > timeout_ticks) {
+            TEST_PRINTF("download stopped at %" PRIu32 "\r\n", stored_offset);
+            success = false;
+        }
+        pal_osDelay(1);
+    }
+
+    *elapsed_ms = (uint32_t) pal_osKernelSysMilliSecTick(pal_osKernelSysTick() - first_ticks);
+
+    ARM_UC_SourceManager.Uninitialize();
+    ARM_UC_ProcessQueue();
+    return success;
+}
+
+TEST_SETUP(uc_fragment_ring)
+{
+    palStatus_t status = pal_init();
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    ARM_UC_SchedulerInit();
+
+    uc_ring_test_file = malloc(UC_RING_TEST_FILE_SIZE);
+    TEST_ASSERT_NOT_NULL(uc_ring_test_file);
+    for (uint32_t index = 0; index < UC_RING_TEST_FILE_SIZE; index++) {
+        uc_ring_test_file[index] = (uint8_t)((index * 7) + (index / 251));
+    }
+
+    memset(&uc_ring_test_server, 0, sizeof(uc_ring_test_server));
+    uc_ring_test_server.file = uc_ring_test_file;
+    uc_ring_test_server.file_size = UC_RING_TEST_FILE_SIZE;
+}
+
+TEST_TEAR_DOWN(uc_fragment_ring)
+{
+    free(uc_ring_test_file);
+    uc_ring_test_file = NULL;
+}
+
+/**
+ * @brief Download time with 1, 2, 4 and 8 buffers, with a delay on each
+ *        response and on each write.
+ */
+TEST(uc_fragment_ring, bufferCountBenchmark)
+{
+    const uint32_t latency_ms = 20;
+    const uint32_t write_ms = 5;
+    const uint32_t buffer_count[] = { 1, 2, 4, 8 };
+    const int runs = 3;
+    uint32_t elapsed_ms[4] = { UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX };
+
+    for (int index = 0; index < 4; index++) {
+        // Best of a few runs, the scheduling of the server thread varies.
+        for (int run = 0; run < runs; run++) {
+            uint32_t run_ms = 0;
+            uc_ring_test_server.latency_ms = latency_ms;
+            palStatus_t status = arm_uc_http_test_server_start(&uc_ring_test_server);
+            TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+            bool success = uc_ring_test_download(buffer_count[index], write_ms, &run_ms);
+            arm_uc_http_test_server_stop(&uc_ring_test_server);
+            TEST_ASSERT_TRUE(success);
+
+            if (run_ms < elapsed_ms[index]) {
+                elapsed_ms[index] = run_ms;
+            }
+        }
+        TEST_PRINTF("%" PRIu32 " bytes, %" PRIu32 " ms latency, %" PRIu32 " ms writes, %" PRIu32 " buffers: %" PRIu32 " ms\r\n",
+                    (uint32_t) UC_RING_TEST_FILE_SIZE, latency_ms, write_ms, buffer_count[index], elapsed_ms[index]);
+    }
+    // With a second buffer the next fragment downloads while the last one is written.
+    TEST_ASSERT_TRUE(elapsed_ms[1] < elapsed_ms[0]);
+}
@@ -0,0 +1,308 @@
+// ----------------------------------------------------------------------------
+// Copyright 2019 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "update-client-source-http-socket/arm_uc_http_socket.h"
+#include "update-client-common/arm_uc_scheduler.h"
+#include "arm_uc_http_test_server.h"
+
+#include "pal.h"
+#include "unity.h"
+#include "unity_fixture.h"
+#include "test_runners.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+TEST_GROUP(uc_http_socket);
+
+// Tunables of the HTTP socket source.
+extern uint32_t frags_per_burst;
+extern uint32_t http_pipeline_depth;
+
+#define UC_HTTP_TEST_FRAGMENT_SIZE  512
+// Not a multiple of the burst size, so the last burst is short.
+#define UC_HTTP_TEST_FILE_SIZE      ((10 * 4 * UC_HTTP_TEST_FRAGMENT_SIZE) + 700)
+// Long enough for a resume attempt, which waits at least a second.
+#define UC_HTTP_TEST_FRAGMENT_TIMEOUT_MS 10000
+
+static uint8_t *uc_http_test_file = NULL;
+static uint8_t uc_http_test_fragment[UC_HTTP_TEST_FRAGMENT_SIZE];
+static arm_uc_http_socket_context_t uc_http_test_context;
+static arm_uc_http_test_server_t uc_http_test_server;
+static uint32_t uc_http_test_default_frags_per_burst;
+static uint32_t uc_http_test_default_pipeline_depth;
+
+static volatile bool uc_http_test_event_received = false;
+static volatile uintptr_t uc_http_test_event = 0;
+
+static void uc_http_test_event_handler(uintptr_t event)
+{
+    uc_http_test_event = event;
+    uc_http_test_event_received = true;
+}
+
+/**
+ * @brief Download the served file a fragment at a time, as the source manager does.
+ * @param elapsed_ms (out) Time taken by the download.
+ * @return true if every fragment arrived and matched the file.
+ */
+static bool uc_http_test_download(uint32_t *elapsed_ms)
+{
+    char host[] = "127.0.0.1";
+    char path[] = "/firmware";
+    arm_uc_uri_t uri = { 0 };
+    arm_uc_buffer_t buffer = { 0 };
+    uint32_t offset = 0;
+    bool success = true;
+
+    uri.scheme = URI_SCHEME_HTTP;
+    uri.port = uc_http_test_server.port;
+    uri.host = host;
+    uri.path = path;
+    buffer.size_max = sizeof(uc_http_test_fragment);
+    buffer.ptr = uc_http_test_fragment;
+
+    memset(&uc_http_test_context, 0, sizeof(uc_http_test_context));
+    arm_uc_error_t status = ARM_UCS_HttpSocket_Initialize(&uc_http_test_context, uc_http_test_event_handler);
+    TEST_ASSERT_EQUAL_HEX(ERR_NONE, status.code);
+
+    uint64_t start_ticks = pal_osKernelSysTick();
+    uint64_t timeout_ticks = pal_osKernelSysTickMicroSec(UC_HTTP_TEST_FRAGMENT_TIMEOUT_MS * 1000ULL);
+
+    while (success && (offset < uc_http_test_server.file_size)) {
+        uc_http_test_event_received = false;
+        status = ARM_UCS_HttpSocket_GetFragment(&uri, &buffer, offset);
+        success = (status.code == ERR_NONE);
+
+        uint64_t request_ticks = pal_osKernelSysTick();
+        while (success && !uc_http_test_event_received) {
+            ARM_UC_ProcessQueue();
+            if (!uc_http_test_event_received) {
+                if ((pal_osKernelSysTick() - request_ticks) > timeout_ticks) {
+                    TEST_PRINTF("no response for the fragment at %" PRIu32 "\r\n", offset);
+                    success = false;
+                } else {
+                    pal_osDelay(1);
+                }
+            }
+        }
+
+        if (success && (uc_http_test_event != UCS_HTTP_EVENT_DOWNLOAD)) {
+            TEST_PRINTF("event %" PRIu32 " for the fragment at %" PRIu32 "\r\n", (uint32_t) uc_http_test_event, offset);
+            success = false;
+        }
+        if (success) {
+            uint32_t expected = uc_http_test_server.file_size - offset;
+            if (expected > buffer.size_max) {
+                expected = buffer.size_max;
+            }
+            if ((buffer.size != expected)
+                    || (memcmp(buffer.ptr, &uc_http_test_server.file[offset], buffer.size) != 0)) {
+                TEST_PRINTF("fragment at %" PRIu32 " has wrong content\r\n", offset);
+                success = false;
+            }
+            offset += buffer.size;
+        }
+    }
+
+    *elapsed_ms = (uint32_t) pal_osKernelSysMilliSecTick(pal_osKernelSysTick() - start_ticks);
+
+    ARM_UCS_HttpSocket_Terminate();
+    ARM_UC_ProcessQueue();
+    return success;
+}
+
+TEST_SETUP(uc_http_socket)
+{
+    palStatus_t status = pal_init();
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    ARM_UC_SchedulerInit();
+
+    uc_http_test_file = malloc(UC_HTTP_TEST_FILE_SIZE);
+    TEST_ASSERT_NOT_NULL(uc_http_test_file);
+    for (uint32_t index = 0; index < UC_HTTP_TEST_FILE_SIZE; index++) {
+        // Not periodic in any fragment or burst size, so misplaced data shows.
+        uc_http_test_file[index] = (uint8_t)((index * 7) + (index / 251));
+    }
+
+    memset(&uc_http_test_server, 0, sizeof(uc_http_test_server));
+    uc_http_test_server.file = uc_http_test_file;
+    uc_http_test_server.file_size = UC_HTTP_TEST_FILE_SIZE;
+
+    uc_http_test_default_frags_per_burst = frags_per_burst;
+    uc_http_test_default_pipeline_depth = http_pipeline_depth;
+}
+
+TEST_TEAR_DOWN(uc_http_socket)
+{
+    frags_per_burst = uc_http_test_default_frags_per_burst;
+    http_pipeline_depth = uc_http_test_default_pipeline_depth;
+
+    free(uc_http_test_file);
+    uc_http_test_file = NULL;
+
+    // PAL is not destroyed, the resume engine of the HTTP source keeps its timer between downloads.
+}
+
+/**
+ * @brief Bursts are requested ahead and read from a single connection.
+ */
+TEST(uc_http_socket, pipelinedBursts)
+{
+#if (ARM_UC_HTTP_PIPELINE_DEPTH > 1) && !ARM_UC_HTTP_STREAM_DOWNLOAD
+    uint32_t elapsed_ms = 0;
+    uint32_t burst_size = frags_per_burst * UC_HTTP_TEST_FRAGMENT_SIZE;
+    uint32_t bursts = (UC_HTTP_TEST_FILE_SIZE + burst_size - 1) / burst_size;
+
+    // Without a delay each request could be answered before the next one arrives.
+    uc_http_test_server.latency_ms = 5;
+    palStatus_t status = arm_uc_http_test_server_start(&uc_http_test_server);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    bool success = uc_http_test_download(&elapsed_ms);
+    arm_uc_http_test_server_stop(&uc_http_test_server);
+
+    TEST_ASSERT_TRUE(success);
+    TEST_ASSERT_EQUAL_UINT32(1, uc_http_test_server.connections);
+    // The last full burst may pipeline a request past the end of the file.
+    TEST_ASSERT_TRUE(uc_http_test_server.requests >= bursts);
+    TEST_ASSERT_TRUE(uc_http_test_server.requests <= bursts + ARM_UC_HTTP_PIPELINE_DEPTH - 1);
+    TEST_ASSERT_TRUE(uc_http_test_server.max_queued >= 2);
+    for (uint32_t index = 0; index < bursts; index++) {
+        TEST_ASSERT_EQUAL_UINT32(index * burst_size, uc_http_test_server.request_start[index]);
+    }
+#else
+    TEST_IGNORE_MESSAGE("Ignored, HTTP pipelining is not enabled");
+#endif
+}
+
+/**
+ * @brief Responses are split across reads and a read ends one response and starts the next.
+ * @details 300 bytes is not a divisor of the header, fragment or burst sizes, so
+ *          headers are split and the tail of each burst arrives with the next header.
+ */
+TEST(uc_http_socket, partialInterleavedResponses)
+{
+#if (ARM_UC_HTTP_PIPELINE_DEPTH > 1) && !ARM_UC_HTTP_STREAM_DOWNLOAD
+    uint32_t elapsed_ms = 0;
+
+    uc_http_test_server.chunk_size = 300;
+    palStatus_t status = arm_uc_http_test_server_start(&uc_http_test_server);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    bool success = uc_http_test_download(&elapsed_ms);
+    arm_uc_http_test_server_stop(&uc_http_test_server);
+
+    TEST_ASSERT_TRUE(success);
+    TEST_ASSERT_EQUAL_UINT32(1, uc_http_test_server.connections);
+    TEST_ASSERT_TRUE(uc_http_test_server.max_queued >= 2);
+#else
+    TEST_IGNORE_MESSAGE("Ignored, HTTP pipelining is not enabled");
+#endif
+}
+
+/**
+ * @brief Download time with and without pipelining, with a delay on each response.
+ */
+TEST(uc_http_socket, pipelineLatencyBenchmark)
+{
+#if (ARM_UC_HTTP_PIPELINE_DEPTH > 1) && !ARM_UC_HTTP_STREAM_DOWNLOAD
+    const uint32_t latency_ms = 20;
+    const int runs = 3;
+    uint32_t elapsed_ms[2] = { UINT32_MAX, UINT32_MAX };
+    uint32_t depth[2] = { 1, ARM_UC_HTTP_PIPELINE_DEPTH };
+
+    for (int index = 0; index < 2; index++) {
+        http_pipeline_depth = depth[index];
+        // Best of a few runs, a connect event missed by the source costs a resume interval.
+        for (int run = 0; run < runs; run++) {
+            uint32_t run_ms = 0;
+            uc_http_test_server.latency_ms = latency_ms;
+            palStatus_t status = arm_uc_http_test_server_start(&uc_http_test_server);
+            TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+            bool success = uc_http_test_download(&run_ms);
+            arm_uc_http_test_server_stop(&uc_http_test_server);
+            TEST_ASSERT_TRUE(success);
+
+            if (run_ms < elapsed_ms[index]) {
+                elapsed_ms[index] = run_ms;
+            }
+        }
+        TEST_PRINTF("%" PRIu32 " bytes with %" PRIu32 " ms latency, pipeline depth %" PRIu32 ": %" PRIu32 " ms\r\n",
+                    (uint32_t) UC_HTTP_TEST_FILE_SIZE, latency_ms, depth[index], elapsed_ms[index]);
+    }
+    // Each burst after the first is requested before it is needed.
+    TEST_ASSERT_TRUE(elapsed_ms[1] < elapsed_ms[0]);
+#else
+    TEST_IGNORE_MESSAGE("Ignored, HTTP pipelining is not enabled");
+#endif
+}
+
+/**
+ * @brief The whole file is read off a single open-ended Range request.
+ */
+TEST(uc_http_socket, streamSingleRequest)
+{
+#if ARM_UC_HTTP_STREAM_DOWNLOAD
+    uint32_t elapsed_ms = 0;
+
+    uc_http_test_server.chunk_size = 300;
+    palStatus_t status = arm_uc_http_test_server_start(&uc_http_test_server);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    bool success = uc_http_test_download(&elapsed_ms);
+    arm_uc_http_test_server_stop(&uc_http_test_server);
+
+    TEST_ASSERT_TRUE(success);
+    TEST_ASSERT_EQUAL_UINT32(1, uc_http_test_server.connections);
+    TEST_ASSERT_EQUAL_UINT32(1, uc_http_test_server.requests);
+    TEST_ASSERT_EQUAL_UINT32(0, uc_http_test_server.request_start[0]);
+#else
+    TEST_IGNORE_MESSAGE("Ignored, HTTP streaming is not enabled");
+#endif
+}
+
+/**
+ * @brief A stream dropped part way through a fragment is reopened at that fragment.
+ */
+TEST(uc_http_socket, streamResumeAfterDisconnect)
+{
+#if ARM_UC_HTTP_STREAM_DOWNLOAD
+    uint32_t elapsed_ms = 0;
+    const uint32_t fragments_before_close = 5;
+
+    uc_http_test_server.close_after = (fragments_before_close * UC_HTTP_TEST_FRAGMENT_SIZE) + 100;
+    palStatus_t status = arm_uc_http_test_server_start(&uc_http_test_server);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    bool success = uc_http_test_download(&elapsed_ms);
+    arm_uc_http_test_server_stop(&uc_http_test_server);
+
+    TEST_ASSERT_TRUE(success);
+    TEST_ASSERT_EQUAL_UINT32(2, uc_http_test_server.connections);
+    TEST_ASSERT_EQUAL_UINT32(2, uc_http_test_server.requests);
+    TEST_ASSERT_EQUAL_UINT32(0, uc_http_test_server.request_start[0]);
+    TEST_ASSERT_EQUAL_UINT32(fragments_before_close * UC_HTTP_TEST_FRAGMENT_SIZE,
+                             uc_http_test_server.request_start[1]);
+#else
+    TEST_IGNORE_MESSAGE("Ignored, HTTP streaming is not enabled");
+#endif
+}
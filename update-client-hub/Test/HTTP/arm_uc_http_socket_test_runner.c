@@ -0,0 +1,36 @@
+// ----------------------------------------------------------------------------
+// Copyright 2019 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "unity.h"
+#include "unity_fixture.h"
+
+// HTTP socket source tests, run against a server on the loopback interface
+TEST_GROUP_RUNNER(uc_http_socket)
+{
+    RUN_TEST_CASE(uc_http_socket, pipelinedBursts);
+    RUN_TEST_CASE(uc_http_socket, partialInterleavedResponses);
+    RUN_TEST_CASE(uc_http_socket, pipelineLatencyBenchmark);
+    RUN_TEST_CASE(uc_http_socket, streamSingleRequest);
+    RUN_TEST_CASE(uc_http_socket, streamResumeAfterDisconnect);
+}
+
+// Source manager and HTTP source feeding a ring of fragment buffers
+TEST_GROUP_RUNNER(uc_fragment_ring)
+{
+    RUN_TEST_CASE(uc_fragment_ring, bufferCountBenchmark);
+}
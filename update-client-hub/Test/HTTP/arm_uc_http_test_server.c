@@ -0,0 +1,345 @@
+// ----------------------------------------------------------------------------
+// Copyright 2019 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "arm_uc_http_test_server.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARM_UC_HTTP_TEST_SERVER_FIRST_PORT  35400
+#define ARM_UC_HTTP_TEST_SERVER_PORTS       200
+#define ARM_UC_HTTP_TEST_SERVER_REQUEST_MAX 1024
+#define ARM_UC_HTTP_TEST_SERVER_SEND_MAX    4096
+#define ARM_UC_HTTP_TEST_SERVER_STACK_SIZE  (8 * 1024)
+
+typedef struct {
+    char header[160];
+    uint32_t header_size;
+    uint32_t header_sent;
+    /* file offsets of the body still to write */
+    uint32_t body_offset;
+    uint32_t body_end;
+    uint64_t due_ticks;
+} arm_uc_http_test_response_t;
+
+typedef struct {
+    palSocket_t socket;
+    char request[ARM_UC_HTTP_TEST_SERVER_REQUEST_MAX + 1];
+    uint32_t request_size;
+    arm_uc_http_test_response_t queue[ARM_UC_HTTP_TEST_SERVER_MAX_QUEUED];
+    uint32_t queue_head;
+    uint32_t queue_count;
+    uint32_t body_sent;
+    uint8_t send_buffer[ARM_UC_HTTP_TEST_SERVER_SEND_MAX];
+} arm_uc_http_test_connection_t;
+
+static void arm_uc_http_test_server_socket_callback(void *argument)
+{
+    // The server thread polls, socket events are not needed.
+    (void) argument;
+}
+
+static void arm_uc_http_test_server_close(arm_uc_http_test_connection_t *connection)
+{
+    if (connection->socket != 0) {
+        pal_close(&connection->socket);
+    }
+    connection->socket = 0;
+    connection->request_size = 0;
+    connection->queue_head = 0;
+    connection->queue_count = 0;
+    connection->body_sent = 0;
+}
+
+/**
+ * @brief Queue the response to a request.
+ * @details Ranges are answered with 206, ranges past the end with 416 and
+ *          anything else with the whole file.
+ */
+static bool arm_uc_http_test_server_queue(arm_uc_http_test_server_t *server,
+                                          arm_uc_http_test_connection_t *connection,
+                                          const char *request)
+{
+    if (connection->queue_count >= ARM_UC_HTTP_TEST_SERVER_MAX_QUEUED) {
+        return false;
+    }
+
+    uint32_t index = (connection->queue_head + connection->queue_count) % ARM_UC_HTTP_TEST_SERVER_MAX_QUEUED;
+    arm_uc_http_test_response_t *response = &connection->queue[index];
+    uint32_t start = 0;
+    uint32_t end = server->file_size;
+    bool partial = false;
+
+    const char *range = strstr(request, "Range: bytes=");
+    if (range != NULL) {
+        char *next = NULL;
+        partial = true;
+        start = strtoul(range + strlen("Range: bytes="), &next, 10);
+        if ((next != NULL) && (next[0] == '-') && (next[1] >= '0') && (next[1] <= '9')) {
+            end = strtoul(next + 1, NULL, 10) + 1;
+        }
+        if (end > server->file_size) {
+            end = server->file_size;
+        }
+    }
+
+    if (server->requests < sizeof(server->request_start) / sizeof(server->request_start[0])) {
+        server->request_start[server->requests] = start;
+    }
+    server->requests++;
+
+    if (start >= server->file_size) {
+        response->header_size = snprintf(response->header, sizeof(response->header),
+                                         "HTTP/1.1 416 Range Not Satisfiable\r\n"
+                                         "Content-Length: 0\r\n"
+                                         "\r\n");
+        start = end = 0;
+    } else if (partial) {
+        response->header_size = snprintf(response->header, sizeof(response->header),
+                                         "HTTP/1.1 206 Partial Content\r\n"
+                                         "Content-Range: bytes %" PRIu32 "-%" PRIu32 "/%" PRIu32 "\r\n"
+                                         "Content-Length: %" PRIu32 "\r\n"
+                                         "\r\n",
+                                         start, end - 1, server->file_size, end - start);
+    } else {
+        response->header_size = snprintf(response->header, sizeof(response->header),
+                                         "HTTP/1.1 200 OK\r\n"
+                                         "Content-Length: %" PRIu32 "\r\n"
+                                         "\r\n",
+                                         end - start);
+    }
+    response->header_sent = 0;
+    response->body_offset = start;
+    response->body_end = end;
+    response->due_ticks = pal_osKernelSysTick() + pal_osKernelSysTickMicroSec(server->latency_ms * 1000ULL);
+    connection->queue_count++;
+
+    if (connection->queue_count > server->max_queued) {
+        server->max_queued = connection->queue_count;
+    }
+    return true;
+}
+
+/**
+ * @brief Read the requests that have arrived.
+ * @return false if the connection was closed.
+ */
+static bool arm_uc_http_test_server_receive(arm_uc_http_test_server_t *server,
+                                            arm_uc_http_test_connection_t *connection)
+{
+    size_t received = 0;
+    palStatus_t status = pal_recv(connection->socket,
+                                  &connection->request[connection->request_size],
+                                  ARM_UC_HTTP_TEST_SERVER_REQUEST_MAX - connection->request_size,
+                                  &received);
+    if (status == PAL_ERR_SOCKET_WOULD_BLOCK) {
+        return true;
+    } else if ((status != PAL_SUCCESS) || (received == 0)) {
+        return false;
+    }
+    connection->request_size += received;
+    connection->request[connection->request_size] = '\0';
+
+    char *request_end = NULL;
+    while ((request_end = strstr(connection->request, "\r\n\r\n")) != NULL) {
+        request_end += 4;
+        if (!arm_uc_http_test_server_queue(server, connection, connection->request)) {
+            return false;
+        }
+        connection->request_size -= request_end - connection->request;
+        memmove(connection->request, request_end, connection->request_size + 1);
+    }
+    // A request that doesn't fit is not one this server can answer.
+    return connection->request_size < ARM_UC_HTTP_TEST_SERVER_REQUEST_MAX;
+}
+
+/**
+ * @brief Write the next chunk of the response stream.
+ * @details A chunk is filled from as many due responses as it can hold, so it
+ *          may carry the end of one response and the start of the next.
+ * @return false if the connection should be closed.
+ */
+static bool arm_uc_http_test_server_send(arm_uc_http_test_server_t *server,
+                                         arm_uc_http_test_connection_t *connection)
+{
+    uint32_t chunk_size = server->chunk_size;
+    if ((chunk_size == 0) || (chunk_size > ARM_UC_HTTP_TEST_SERVER_SEND_MAX)) {
+        chunk_size = ARM_UC_HTTP_TEST_SERVER_SEND_MAX;
+    }
+
+    uint64_t now = pal_osKernelSysTick();
+    uint32_t size = 0;
+    bool close_after_send = false;
+
+    while ((size < chunk_size) && (connection->queue_count > 0)) {
+        arm_uc_http_test_response_t *response = &connection->queue[connection->queue_head];
+        if (response->due_ticks > now) {
+            break;
+        }
+        if (response->header_sent < response->header_size) {
+            uint32_t length = response->header_size - response->header_sent;
+            if (length > chunk_size - size) {
+                length = chunk_size - size;
+            }
+            memcpy(&connection->send_buffer[size], &response->header[response->header_sent], length);
+            response->header_sent += length;
+            size += length;
+        }
+        if (response->body_offset < response->body_end) {
+            uint32_t length = response->body_end - response->body_offset;
+            if (length > chunk_size - size) {
+                length = chunk_size - size;
+            }
+            if (server->close_after && (server->connections == 1)
+                    && (length >= server->close_after - connection->body_sent)) {
+                length = server->close_after - connection->body_sent;
+                close_after_send = true;
+            }
+            memcpy(&connection->send_buffer[size], &server->file[response->body_offset], length);
+            response->body_offset += length;
+            connection->body_sent += length;
+            size += length;
+            if (close_after_send) {
+                break;
+            }
+        }
+        if ((response->header_sent == response->header_size)
+                && (response->body_offset == response->body_end)) {
+            connection->queue_head = (connection->queue_head + 1) % ARM_UC_HTTP_TEST_SERVER_MAX_QUEUED;
+            connection->queue_count--;
+        }
+    }
+
+    uint32_t sent = 0;
+    while (sent < size) {
+        size_t bytes_sent = 0;
+        palStatus_t status = pal_send(connection->socket, &connection->send_buffer[sent], size - sent, &bytes_sent);
+        if (status == PAL_SUCCESS) {
+            sent += bytes_sent;
+        } else if (status == PAL_ERR_SOCKET_WOULD_BLOCK) {
+            pal_osDelay(1);
+        } else {
+            return false;
+        }
+    }
+    return !close_after_send;
+}
+
+static void arm_uc_http_test_server_thread(void const *argument)
+{
+    arm_uc_http_test_server_t *server = (arm_uc_http_test_server_t *) argument;
+    arm_uc_http_test_connection_t *connection = calloc(1, sizeof(arm_uc_http_test_connection_t));
+
+    while ((connection != NULL) && !server->stop) {
+        if (connection->socket == 0) {
+            palSocketAddress_t address = { 0 };
+            palSocketLength_t address_length = sizeof(address);
+            palStatus_t status = pal_accept(server->listener, &address, &address_length, &connection->socket,
+                                            arm_uc_http_test_server_socket_callback, server);
+            if (status == PAL_SUCCESS) {
+                // The accepted socket blocks, so bound the wait for requests.
+                int timeout_ms = 1;
+                pal_setSocketOptions(connection->socket, PAL_SO_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+                server->connections++;
+            } else {
+                connection->socket = 0;
+                pal_osDelay(1);
+            }
+            continue;
+        }
+
+        if (!arm_uc_http_test_server_receive(server, connection)
+                || !arm_uc_http_test_server_send(server, connection)) {
+            arm_uc_http_test_server_close(connection);
+            continue;
+        }
+        if (server->chunk_size != 0) {
+            // Space the chunks out so that they arrive as separate reads.
+            pal_osDelay(1);
+        }
+    }
+
+    if (connection != NULL) {
+        arm_uc_http_test_server_close(connection);
+        free(connection);
+    }
+    server->stopped = true;
+}
+
+palStatus_t arm_uc_http_test_server_start(arm_uc_http_test_server_t *server)
+{
+    palStatus_t status = PAL_SUCCESS;
+    palSocketAddress_t address = { 0 };
+    palIpV4Addr_t loopback = { 127, 0, 0, 1 };
+
+    server->port = 0;
+    server->connections = 0;
+    server->requests = 0;
+    server->max_queued = 0;
+    server->listener = 0;
+    server->thread = NULLPTR;
+    server->stop = false;
+    server->stopped = false;
+
+    status = pal_asynchronousSocket(PAL_AF_INET, PAL_SOCK_STREAM_SERVER, true, 0,
+                                    arm_uc_http_test_server_socket_callback, &server->listener);
+    if (status == PAL_SUCCESS) {
+        status = pal_setSockAddrIPV4Addr(&address, loopback);
+    }
+    // Earlier runs may still hold a port, so take the first one that is free.
+    if (status == PAL_SUCCESS) {
+        for (uint16_t index = 0; index < ARM_UC_HTTP_TEST_SERVER_PORTS; index++) {
+            uint16_t port = ARM_UC_HTTP_TEST_SERVER_FIRST_PORT + index;
+            status = pal_setSockAddrPort(&address, port);
+            if (status == PAL_SUCCESS) {
+                status = pal_bind(server->listener, &address, sizeof(address));
+            }
+            if (status == PAL_SUCCESS) {
+                server->port = port;
+                break;
+            }
+        }
+    }
+    if (status == PAL_SUCCESS) {
+        status = pal_listen(server->listener, 1);
+    }
+    if (status == PAL_SUCCESS) {
+        status = pal_osThreadCreateWithAlloc(arm_uc_http_test_server_thread, server, PAL_osPriorityNormal,
+                                             ARM_UC_HTTP_TEST_SERVER_STACK_SIZE, NULL, &server->thread);
+    }
+    if ((status != PAL_SUCCESS) && (server->listener != 0)) {
+        pal_close(&server->listener);
+    }
+    return status;
+}
+
+void arm_uc_http_test_server_stop(arm_uc_http_test_server_t *server)
+{
+    server->stop = true;
+    for (int wait = 0; !server->stopped && (wait < 1000); wait++) {
+        pal_osDelay(1);
+    }
+    if (server->thread != NULLPTR) {
+        pal_osThreadTerminate(&server->thread);
+    }
+    if (server->listener != 0) {
+        pal_close(&server->listener);
+    }
+}
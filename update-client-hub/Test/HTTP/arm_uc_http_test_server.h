@@ -0,0 +1,81 @@
+// ----------------------------------------------------------------------------
+// Copyright 2019 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef ARM_UC_HTTP_TEST_SERVER_H
+#define ARM_UC_HTTP_TEST_SERVER_H
+
+#include "pal.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Most Range requests the server holds before answering, deeper pipelines are refused.
+#define ARM_UC_HTTP_TEST_SERVER_MAX_QUEUED 8
+
+/**
+ * @brief Minimal HTTP/1.1 server on the loopback interface, serving one file
+ *        to Range requests from a PAL thread.
+ * @details Responses are written as one byte stream, so with a chunk size set a single
+ *          send can end one response and start the next, as a real server may do.
+ */
+typedef struct {
+    /* configuration, set before arm_uc_http_test_server_start() */
+
+    /* content served for any path */
+    const uint8_t *file;
+    uint32_t file_size;
+    /* bytes written per send, 0 writes each response at once */
+    uint32_t chunk_size;
+    /* delay between a request arriving and its response being written */
+    uint32_t latency_ms;
+    /* drop the first connection once this many body bytes were written on it, 0 never */
+    uint32_t close_after;
+
+    /* results */
+
+    /* port the server listens on */
+    uint16_t port;
+    /* connections accepted */
+    volatile uint32_t connections;
+    /* Range requests received, and their start offsets in order */
+    volatile uint32_t requests;
+    uint32_t request_start[64];
+    /* most requests received but not yet answered in full */
+    volatile uint32_t max_queued;
+
+    /* internal state */
+    palSocket_t listener;
+    palThreadID_t thread;
+    volatile bool stop;
+    volatile bool stopped;
+} arm_uc_http_test_server_t;
+
+/**
+ * @brief Bind a loopback port and start serving.
+ * @param server Configured server, results are cleared.
+ * @return PAL_SUCCESS once the server is listening.
+ */
+palStatus_t arm_uc_http_test_server_start(arm_uc_http_test_server_t *server);
+
+/**
+ * @brief Stop the server thread and close its sockets.
+ * @param server Server started with arm_uc_http_test_server_start().
+ */
+void arm_uc_http_test_server_stop(arm_uc_http_test_server_t *server);
+
+#endif // ARM_UC_HTTP_TEST_SERVER_H
@@ -0,0 +1,333 @@
+// ----------------------------------------------------------------------------
+// Copyright 2019 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+// Note: this macro is needed on armcc to get the the PRI*32 macros
+// from inttypes.h in a C++ code.
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+extern "C" {
+#include "unity.h"
+#include "unity_fixture.h"
+}
+
+#include "update-lwm2m-mbed-apis.h"
+#include "update-client-lwm2m/lwm2m-source.h"
+#include "update-client-lwm2m/FirmwareUpdateResource.h"
+#include "update-client-lwm2m/DeviceMetadataResource.h"
+#include "update-client-common/arm_uc_scheduler.h"
+#include "update-client-source/arm_uc_source.h"
+#include "mbed-client/m2minterface.h"
+#include "test_runners.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+TEST_GROUP(uc_lwm2m_source);
+
+#define UC_LWM2M_TEST_BLOCK_SIZE    SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
+// Not a multiple of the block size, so the last block is short.
+#define UC_LWM2M_TEST_BLOCKS        13
+#define UC_LWM2M_TEST_FILE_SIZE     (((UC_LWM2M_TEST_BLOCKS - 1) * UC_LWM2M_TEST_BLOCK_SIZE) + 300)
+#define UC_LWM2M_TEST_MAX_REQUESTS  16
+
+// The LwM2M resources are not under test, the source only registers with them.
+namespace FirmwareUpdateResource {
+void Initialize(void) {}
+void Uninitialize(void) {}
+int32_t addPackageCallback(void (*)(const uint8_t *, uint16_t))
+{
+    return 0;
+}
+#if defined(ARM_UC_PROFILE_MBED_CLIENT_LITE) && (ARM_UC_PROFILE_MBED_CLIENT_LITE == 1)
+int32_t setM2MInterface(M2MInterface *)
+{
+    return 0;
+}
+#endif
+}
+
+namespace DeviceMetadataResource {
+void Initialize(void) {}
+void Uninitialize(void) {}
+#if defined(ARM_UC_PROFILE_MBED_CLIENT_LITE) && (ARM_UC_PROFILE_MBED_CLIENT_LITE == 1)
+int32_t setM2MInterface(M2MInterface *)
+{
+    return 0;
+}
+#endif
+}
+
+typedef struct {
+    uint32_t offset;
+    get_data_cb data_cb;
+    get_data_error_cb error_cb;
+    void *context;
+} uc_lwm2m_test_request_t;
+
+// Holds the block requests of the source until the test answers or loses them.
+class TestM2MInterface : public M2MInterface {
+public:
+    TestM2MInterface() : in_flight(0), requests(0), max_in_flight(0) {}
+
+    void get_data_request(DownloadType, const char *uri, const size_t offset, const bool,
+                          get_data_cb data_cb, get_data_error_cb error_cb, void *context)
+    {
+        TEST_ASSERT_EQUAL_STRING("coaps://example.com/firmware", uri);
+        TEST_ASSERT_TRUE(in_flight < UC_LWM2M_TEST_MAX_REQUESTS);
+
+        uc_lwm2m_test_request_t *request = &request_list[in_flight++];
+        request->offset = offset;
+        request->data_cb = data_cb;
+        request->error_cb = error_cb;
+        request->context = context;
+
+        requests++;
+        if (in_flight > max_in_flight) {
+            max_in_flight = in_flight;
+        }
+    }
+
+    // Answer the request at the index with its block of the file, or with an error if lost.
+    void respond(uint32_t index, const uint8_t *file, bool lost)
+    {
+        uc_lwm2m_test_request_t request = request_list[index];
+        memmove(&request_list[index], &request_list[index + 1],
+                (in_flight - index - 1) * sizeof(uc_lwm2m_test_request_t));
+        in_flight--;
+
+        if (lost) {
+            request.error_cb(FAILED_TO_SEND_MSG, request.context);
+        } else {
+            uint32_t size = UC_LWM2M_TEST_FILE_SIZE - request.offset;
+            bool last_block = (size <= UC_LWM2M_TEST_BLOCK_SIZE);
+            if (!last_block) {
+                size = UC_LWM2M_TEST_BLOCK_SIZE;
+            }
+            request.data_cb(&file[request.offset], size, UC_LWM2M_TEST_FILE_SIZE, last_block, request.context);
+        }
+    }
+
+    uc_lwm2m_test_request_t request_list[UC_LWM2M_TEST_MAX_REQUESTS];
+    uint32_t in_flight;
+    uint32_t requests;
+    uint32_t max_in_flight;
+
+    void bootstrap(M2MSecurity *) {}
+    void cancel_bootstrap() {}
+    void finish_bootstrap() {}
+    void register_object(M2MSecurity *, const M2MBaseList &) {}
+    void register_object(M2MSecurity *, const M2MObjectList &) {}
+    bool remove_object(M2MBase *)
+    {
+        return false;
+    }
+    void update_registration(M2MSecurity *, const uint32_t) {}
+    void update_registration(M2MSecurity *, const M2MBaseList &, const uint32_t) {}
+    void update_registration(M2MSecurity *, const M2MObjectList &, const uint32_t) {}
+    void unregister_object(M2MSecurity *) {}
+    void set_queue_sleep_handler(callback_handler) {}
+    void set_random_number_callback(random_number_cb) {}
+    void set_entropy_callback(entropy_cb) {}
+    void set_platform_network_handler(void *) {}
+    void update_endpoint(const String &) {}
+    void update_domain(const String &) {}
+    const String internal_endpoint_name() const
+    {
+        return String();
+    }
+    const char *error_description() const
+    {
+        return "";
+    }
+    void post_data_request(const char *, const bool, const uint16_t, uint8_t *,
+                           get_data_cb, get_data_error_cb, void *) {}
+    bool set_uri_query_parameters(const char *)
+    {
+        return false;
+    }
+    void pause() {}
+    void resume(void *, const M2MBaseList &) {}
+};
+
+// Order in which the test answers the requests in flight.
+typedef enum {
+    UC_LWM2M_TEST_NEWEST_FIRST,
+    UC_LWM2M_TEST_OLDEST_FIRST_LOSE_EVERY_THIRD
+} uc_lwm2m_test_policy_t;
+
+static TestM2MInterface *uc_lwm2m_test_interface = NULL;
+static uint8_t uc_lwm2m_test_file[UC_LWM2M_TEST_FILE_SIZE];
+static uint8_t uc_lwm2m_test_fragment[UC_LWM2M_TEST_BLOCK_SIZE];
+static bool uc_lwm2m_test_lost[UC_LWM2M_TEST_BLOCKS];
+static uint32_t uc_lwm2m_test_lost_count = 0;
+
+static volatile bool uc_lwm2m_test_event_received = false;
+static volatile uintptr_t uc_lwm2m_test_event = 0;
+
+static void uc_lwm2m_test_event_handler(uintptr_t event)
+{
+    uc_lwm2m_test_event = event;
+    uc_lwm2m_test_event_received = true;
+}
+
+/**
+ * @brief Answer one of the requests in flight, as picked by the policy.
+ */
+static void uc_lwm2m_test_respond(uc_lwm2m_test_policy_t policy)
+{
+    uint32_t index = 0;
+    bool lost = false;
+
+    if (policy == UC_LWM2M_TEST_NEWEST_FIRST) {
+        index = uc_lwm2m_test_interface->in_flight - 1;
+    } else {
+        uint32_t block = uc_lwm2m_test_interface->request_list[index].offset / UC_LWM2M_TEST_BLOCK_SIZE;
+        // Only the first request for a block is lost, as a retransmission would get through.
+        if (((block % 3) == 2) && !uc_lwm2m_test_lost[block]) {
+            uc_lwm2m_test_lost[block] = true;
+            uc_lwm2m_test_lost_count++;
+            lost = true;
+        }
+    }
+    uc_lwm2m_test_interface->respond(index, uc_lwm2m_test_file, lost);
+}
+
+/**
+ * @brief Download the file a fragment at a time, as the source manager does.
+ * @details A fragment that fails is asked for again.
+ * @return true if every fragment arrived and matched the file.
+ */
+static bool uc_lwm2m_test_download(uc_lwm2m_test_policy_t policy)
+{
+    char host[] = "example.com";
+    char path[] = "/firmware";
+    uint8_t uri_buffer[64] = { 0 };
+    arm_uc_uri_t uri = { 0 };
+    arm_uc_buffer_t buffer = { 0 };
+    uint32_t offset = 0;
+    uint32_t retries = 0;
+
+    uri.size_max = sizeof(uri_buffer);
+    uri.ptr = uri_buffer;
+    uri.scheme = URI_SCHEME_COAPS;
+    uri.host = host;
+    uri.path = path;
+    buffer.size_max = sizeof(uc_lwm2m_test_fragment);
+    buffer.ptr = uc_lwm2m_test_fragment;
+
+    while (offset < UC_LWM2M_TEST_FILE_SIZE) {
+        uc_lwm2m_test_event_received = false;
+        arm_uc_error_t status = ARM_UCS_LWM2M_SOURCE_GetFirmwareFragment(&uri, &buffer, offset);
+        if (status.code != ERR_NONE) {
+            return false;
+        }
+
+        ARM_UC_ProcessQueue();
+        while (!uc_lwm2m_test_event_received) {
+            if (uc_lwm2m_test_interface->in_flight == 0) {
+                TEST_PRINTF("nothing in flight for the fragment at %" PRIu32 "\r\n", offset);
+                return false;
+            }
+            uc_lwm2m_test_respond(policy);
+            ARM_UC_ProcessQueue();
+        }
+
+        if (uc_lwm2m_test_event == EVENT_ERROR) {
+            if (++retries > UC_LWM2M_TEST_BLOCKS) {
+                return false;
+            }
+            continue;
+        }
+        if (uc_lwm2m_test_event != EVENT_FIRMWARE) {
+            return false;
+        }
+
+        uint32_t expected = UC_LWM2M_TEST_FILE_SIZE - offset;
+        if (expected > UC_LWM2M_TEST_BLOCK_SIZE) {
+            expected = UC_LWM2M_TEST_BLOCK_SIZE;
+        }
+        if ((buffer.size != expected) || (memcmp(buffer.ptr, &uc_lwm2m_test_file[offset], buffer.size) != 0)) {
+            TEST_PRINTF("fragment at %" PRIu32 " has wrong content\r\n", offset);
+            return false;
+        }
+        offset += buffer.size;
+    }
+
+    // Nothing was requested past the end of the file.
+    return (uc_lwm2m_test_interface->in_flight == 0);
+}
+
+TEST_SETUP(uc_lwm2m_source)
+{
+    ARM_UC_SchedulerInit();
+
+    for (uint32_t index = 0; index < UC_LWM2M_TEST_FILE_SIZE; index++) {
+        // Not periodic in the block size, so misplaced blocks show.
+        uc_lwm2m_test_file[index] = (uint8_t)((index * 7) + (index / 251));
+    }
+    memset(uc_lwm2m_test_lost, 0, sizeof(uc_lwm2m_test_lost));
+    uc_lwm2m_test_lost_count = 0;
+
+    uc_lwm2m_test_interface = new TestM2MInterface();
+    arm_uc_error_t status = ARM_UCS_LWM2M_SOURCE_Initialize(uc_lwm2m_test_event_handler);
+    TEST_ASSERT_EQUAL_HEX(ERR_NONE, status.code);
+    status = ARM_UCS_LWM2M_SOURCE_SetM2MInterface(uc_lwm2m_test_interface);
+    TEST_ASSERT_EQUAL_HEX(ERR_NONE, status.code);
+}
+
+TEST_TEAR_DOWN(uc_lwm2m_source)
+{
+    // Uninitializing drops the firmware URI, so the next test starts a new download.
+    ARM_UCS_LWM2M_SOURCE_Uninitialize();
+    delete uc_lwm2m_test_interface;
+    uc_lwm2m_test_interface = NULL;
+}
+
+/**
+ * @brief Blocks answered newest first reach the hub in file order.
+ */
+TEST(uc_lwm2m_source, blockWindowOutOfOrder)
+{
+#if ARM_UC_COAP_BLOCK_WINDOW > 1
+    TEST_ASSERT_TRUE(uc_lwm2m_test_download(UC_LWM2M_TEST_NEWEST_FIRST));
+
+    // Each block is requested once, and the window is kept full.
+    TEST_ASSERT_EQUAL_UINT32(UC_LWM2M_TEST_BLOCKS, uc_lwm2m_test_interface->requests);
+    TEST_ASSERT_EQUAL_UINT32(ARM_UC_COAP_BLOCK_WINDOW, uc_lwm2m_test_interface->max_in_flight);
+#else
+    TEST_IGNORE_MESSAGE("Ignored, the CoAP block window is not enabled");
+#endif
+}
+
+/**
+ * @brief Lost blocks are requested again, whether the hub was waiting for them or not.
+ */
+TEST(uc_lwm2m_source, blockWindowLostBlocks)
+{
+#if ARM_UC_COAP_BLOCK_WINDOW > 1
+    TEST_ASSERT_TRUE(uc_lwm2m_test_download(UC_LWM2M_TEST_OLDEST_FIRST_LOSE_EVERY_THIRD));
+
+    TEST_ASSERT_EQUAL_UINT32(UC_LWM2M_TEST_BLOCKS / 3, uc_lwm2m_test_lost_count);
+    TEST_ASSERT_EQUAL_UINT32(UC_LWM2M_TEST_BLOCKS + uc_lwm2m_test_lost_count, uc_lwm2m_test_interface->requests);
+    TEST_ASSERT_EQUAL_UINT32(ARM_UC_COAP_BLOCK_WINDOW, uc_lwm2m_test_interface->max_in_flight);
+#else
+    TEST_IGNORE_MESSAGE("Ignored, the CoAP block window is not enabled");
+#endif
+}
@@ -0,0 +1,29 @@
+// ----------------------------------------------------------------------------
+// Copyright 2019 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+extern "C" {
+#include "unity.h"
+#include "unity_fixture.h"
+}
+
+// LwM2M source tests, run against a stand-in for the M2M interface
+TEST_GROUP_RUNNER(uc_lwm2m_source)
+{
+    RUN_TEST_CASE(uc_lwm2m_source, blockWindowOutOfOrder);
+    RUN_TEST_CASE(uc_lwm2m_source, blockWindowLostBlocks);
+}
@@ -90,6 +90,7 @@ typedef bs_patch_api_return_code_t (*read_patch_f)(const bspatch_stream* stream,
 typedef bs_patch_api_return_code_t (*read_old_f)(const bspatch_stream* stream, void* buffer, uint64_t length);
 typedef bs_patch_api_return_code_t (*seek_old_f)(const bspatch_stream* stream, int64_t seek_diff);
 typedef bs_patch_api_return_code_t (*write_new_f)(const bspatch_stream* stream, void* buffer, uint64_t length);
+typedef bs_patch_api_return_code_t (*write_diff_f)(const bspatch_stream* stream, const void* buffer, uint64_t length);
 
 /**
  * Initialize the bspatch control structure.
@@ -105,6 +106,24 @@ void ARM_BS_Init( bspatch_stream* stream, void* opaque,
                   read_patch_f rpf, read_old_f rof,
                   seek_old_f sof, write_new_f wnf);
 
+/**
+ * Decode the patch without applying it. Decompressed diff bytes are given to wdf instead of being
+ * added to bytes read from the old file, so the caller can apply them elsewhere, e.g. on another thread.
+ * Extra bytes still go to write_new and old file jumps to seek_old, in patch order. read_old is not
+ * called and may be NULL.
+ * @param stream, bspatch control structure initialized with ARM_BS_Init, before patching is started
+ * @param wdf, a function pointer to a function receiving the diff bytes to add to the old file at its current position
+ */
+void ARM_BS_SetDiffWriter(bspatch_stream* stream, write_diff_f wdf);
+
+/**
+ * Add diff bytes given to write_diff_f to the old file bytes in place, as bspatch does when applying the patch itself.
+ * @param old, bytes read from the old file, replaced with the new file bytes
+ * @param diff, diff bytes
+ * @param length, number of bytes in old and diff
+ */
+void ARM_BS_AddDiff(uint8_t* old, const uint8_t* diff, uint32_t length);
+
 /**
  * Handles patch processing events.
  * @param stream control structure, with callbacks for data i/o
@@ -73,6 +73,7 @@ typedef enum {
  *   read_old    When called, should read next length bytes from the base file into buffer and return 0 on success.
  *   seek_old    When called, should reposition the old file with seek_diff amount in relation to current position and return 0 on success.
  *   write_new   When called, should write length bytes from buffer into end of the new file and return 0 on success.
+ *   write_diff  Optional, set with ARM_BS_SetDiffWriter. When set, called with the diff bytes instead of read_old and write_new.
  */
 struct bspatch_stream {
 
@@ -82,6 +83,7 @@ struct bspatch_stream {
     read_old_f read_old;
     seek_old_f seek_old;
     write_new_f write_new;
+    write_diff_f write_diff;
 
     // private members to BS patching. // not to be used by API implementor for other than debug
     int64_t undeCompressBuffer_len;
@@ -100,6 +100,7 @@ int setExpectedExternalEventByState(struct bspatch_stream* stream, int status, b
 int sendWriteNewRequest(const struct bspatch_stream* stream, void* buffer, uint64_t length);
 int sendSeekOldRequest(const struct bspatch_stream* stream, int64_t seek_diff);
 int sendReadOldRequest(const struct bspatch_stream* stream, void* buffer, uint64_t length);
+int sendWriteDiffRequest(const struct bspatch_stream* stream, const void* buffer, uint64_t length);
 int bspatch_processDiffBytesPost(struct bspatch_stream* stream);
 
 int isPatchingDone(bspatch_stream* stream);
@@ -340,6 +341,17 @@ int bspatch_allocWorkingBuffers(struct bspatch_stream* stream)
 #endif // BS_PATCH_COMPILE_TIME_MEMORY_ALLOC
 }
 
+/* Add diff bytes to the old bytes in place. Kept out of the state machine so the
+ * loop works on local pointers: byte stores through stream->... may alias the
+ * stream itself, which forces a reload of every field per byte and keeps the
+ * compiler from unrolling or vectorizing the loop. */
+static void bspatch_addDiffBytes(uint8_t* old, const uint8_t* diff, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; i++) {
+        old[i] = (uint8_t)(old[i] + diff[i]);
+    }
+}
+
 int bspatch_processDiffBytesPost(struct bspatch_stream* stream)
 {
     /* Adjust pointers */
@@ -380,9 +392,15 @@ int sendWriteNewRequest(const struct bspatch_stream* stream, void* buffer, uint6
     return stream->write_new(stream, buffer, length);
 }
 
+int sendWriteDiffRequest(const struct bspatch_stream* stream, const void* buffer, uint64_t length)
+{
+    return stream->write_diff(stream, buffer, length);
+}
+
 int bspatch_readInitialHeaderAndContinue(bspatch_stream* stream)
 {
-    if (stream->read_old == 0 || stream->read_patch == 0 || stream->seek_old == 0 || stream->write_new == 0)
+    if ((stream->read_old == 0 && stream->write_diff == 0) || stream->read_patch == 0 || stream->seek_old == 0
+            || stream->write_new == 0)
         return EBSAPI_ERR_PARAMETERS;
 
     if (stream->new_size == 0) {
@@ -479,11 +497,22 @@ void ARM_BS_Init(bspatch_stream* stream, void* opaque, read_patch_f rpf, read_ol
     stream->read_old = rof;
     stream->seek_old = sof;
     stream->write_new = wnf;
+    stream->write_diff = 0;
     stream->expectedExternalEvent = EBSAPI_START_PATCH_PROCESSING;
     stream->next_state = EBsInitial;
     stream->frame_len = 0;
 }
 
+void ARM_BS_SetDiffWriter(bspatch_stream* stream, write_diff_f wdf)
+{
+    stream->write_diff = wdf;
+}
+
+void ARM_BS_AddDiff(uint8_t* old, const uint8_t* diff, uint32_t length)
+{
+    bspatch_addDiffBytes(old, diff, length);
+}
+
 /**
  * Main state machine functionality for eventified BS patching. Currently all state transitions are visible inside this
  * function with below helper macros
@@ -615,7 +644,13 @@ bs_patch_api_return_code_t ARM_BS_ProcessPatchEvent(bspatch_stream* stream, bs_p
                 break;
             case EBspatch_processDiffBytes_processSinglePieceInit:
                 stream->i = 0;
-                SET_NEXT_STATE(EBspatch_processDiffBytes_processSinglePieceContinue2)
+                if (stream->write_diff) {
+                    // decode only, the caller adds the whole frame to the old file
+                    status = sendWriteDiffRequest(stream, stream->nonCompressedDataBuffer, stream->undeCompressBuffer_len);
+                    WAIT_FOR_WRITE_NEW(EBspatch_processDiffBytes_processSinglePieceContinue_postActions)
+                } else {
+                    SET_NEXT_STATE(EBspatch_processDiffBytes_processSinglePieceContinue2)
+                }
                 break;
             case EBspatch_processDiffBytes_processSinglePieceContinue2:
                 if (stream->i < stream->undeCompressBuffer_len) {
@@ -635,11 +670,8 @@ bs_patch_api_return_code_t ARM_BS_ProcessPatchEvent(bspatch_stream* stream, bs_p
                 break;
             case EBspatch_processDiffBytes_processSinglePieceContinue_writePart:
 
-                for (uint32_t i = 0; i < stream->readRequestSize; i++) {
-                    uint8_t newByte = stream->bufferForCompressedData[i]
-                            + stream->nonCompressedDataBuffer[stream->i + i];
-                    stream->bufferForCompressedData[i] = newByte;
-                }
+                bspatch_addDiffBytes(stream->bufferForCompressedData, stream->nonCompressedDataBuffer + stream->i,
+                        stream->readRequestSize);
                 status = sendWriteNewRequest(stream, stream->bufferForCompressedData, stream->readRequestSize);
                 stream->i += stream->readRequestSize;
                 WAIT_FOR_WRITE_NEW(EBspatch_processDiffBytes_processSinglePieceContinue2)
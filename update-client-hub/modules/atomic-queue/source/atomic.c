@@ -52,7 +52,12 @@ int aq_atomic_cas_deref_uintptr(uintptr_t *volatile *ptrAddr,
 #endif
 
 
-#if !defined(__SXOS__) && defined(__GNUC__) && (!defined(__CORTEX_M) || (__CORTEX_M >= 0x03))
+/* Where aq_atomic_cas_deref_uintptr above takes the critical section, the plain
+   CAS must take it too: a hardware CAS from another thread does not wait for the
+   critical section, and a push landing between its read and write of the tail
+   is lost.
+*/
+#if !defined(__SXOS__) && defined(__GNUC__) && defined(__CORTEX_M) && (__CORTEX_M >= 0x03)
 int aq_atomic_cas_uintptr(uintptr_t *ptr, uintptr_t oldval, uintptr_t newval)
 {
     return __sync_bool_compare_and_swap(ptr, oldval, newval);
@@ -360,6 +360,117 @@ ARM_UC_FEATURE_SIMPLE_COAP_SOURCE
 #define ARM_UC_BUFFER_SIZE 1024
 #endif
 
+/* Number of fragment buffers in the download ring. Each buffer holds
+   ARM_UC_BUFFER_SIZE / 2 bytes, so the default keeps the total at
+   ARM_UC_BUFFER_SIZE. More buffers let the network fetch run further
+   ahead of storage writes, with one fragment request outstanding per free
+   buffer.
+*/
+#ifndef ARM_UC_FRAGMENT_BUFFER_COUNT
+#define ARM_UC_FRAGMENT_BUFFER_COUNT 2
+#endif
+
+#if ARM_UC_FRAGMENT_BUFFER_COUNT < 1
+#error ARM_UC_FRAGMENT_BUFFER_COUNT must be 1 or more
+#endif
+
+/* Compute the firmware SHA-256 incrementally while fragments are written
+   instead of re-reading the whole image from storage during finalize.
+   Delta updates always verify the reconstructed image from storage.
+*/
+#ifndef ARM_UC_FEATURE_HASH_ON_WRITE
+#define ARM_UC_FEATURE_HASH_ON_WRITE 0
+#endif
+
+/* When hashing on write, additionally verify the image read back from
+   storage before reporting finalize done.
+*/
+#ifndef ARM_UC_FEATURE_HASH_ON_WRITE_VERIFY_STORAGE
+#define ARM_UC_FEATURE_HASH_ON_WRITE_VERIFY_STORAGE 0
+#endif
+
+/* Number of CoAP Block2 requests kept in flight when downloading firmware
+   over CoAP. Blocks ahead of the one the hub asked for are buffered until
+   the hub reaches them, which takes (ARM_UC_COAP_BLOCK_WINDOW - 1) times
+   SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE bytes. 1 requests one block at a time.
+*/
+#ifndef ARM_UC_COAP_BLOCK_WINDOW
+#define ARM_UC_COAP_BLOCK_WINDOW 1
+#endif
+
+#if ARM_UC_COAP_BLOCK_WINDOW < 1
+#error ARM_UC_COAP_BLOCK_WINDOW must be 1 or more
+#endif
+
+/* Number of blocks cached in front of the original image reader used by
+   delta updates. Each miss loads a whole aligned block, reading ahead of the
+   small bspatch reads, and recently used blocks serve short backward jumps.
+   0 reads the original image directly on every call.
+*/
+#ifndef ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCKS
+#define ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCKS 0
+#endif
+
+#ifndef ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCK_SIZE
+#define ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCK_SIZE 1024
+#endif
+
+#if ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCK_SIZE < 1
+#error ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCK_SIZE must be 1 or more
+#endif
+
+/* Number of blocks a prefetch thread reads ahead of the original image
+   reader on Linux. After a cache miss the thread reads the following blocks
+   into a bounded queue while bspatch runs on the hub thread, and later
+   misses are served from the queue. Needs the block cache. 0 reads every
+   block on the hub thread.
+*/
+#ifndef ARM_UC_DELTA_PAAL_ORIGINAL_PREFETCH_BLOCKS
+#define ARM_UC_DELTA_PAAL_ORIGINAL_PREFETCH_BLOCKS 0
+#endif
+
+/* Map the original image into memory on Linux instead of reading it
+   through the block cache.
+*/
+#ifndef ARM_UC_FEATURE_DELTA_PAAL_ORIGINAL_MMAP
+#define ARM_UC_FEATURE_DELTA_PAAL_ORIGINAL_MMAP 0
+#endif
+
+/* Apply delta updates on three threads on Linux: one decompresses the patch
+   stream, one reads the original image and adds the diff bytes, and one
+   writes the new image. The hub thread only queues patch fragments and gets
+   their completion back. 0 runs bspatch on the hub thread.
+*/
+#ifndef ARM_UC_FEATURE_DELTA_PAAL_PIPELINE
+#if !defined(TARGET_LIKE_MBED) && defined(ARM_UC_FEATURE_PAL_LINUX) && (ARM_UC_FEATURE_PAL_LINUX == 1)
+#define ARM_UC_FEATURE_DELTA_PAAL_PIPELINE 1
+#else
+#define ARM_UC_FEATURE_DELTA_PAAL_PIPELINE 0
+#endif
+#endif
+
+/* Decompressed diff and extra runs queued between the decompress and patch
+   threads of the delta pipeline, and the most bytes in each run.
+*/
+#ifndef ARM_UC_DELTA_PAAL_PIPELINE_RUNS
+#define ARM_UC_DELTA_PAAL_PIPELINE_RUNS 16
+#endif
+
+#ifndef ARM_UC_DELTA_PAAL_PIPELINE_RUN_SIZE
+#define ARM_UC_DELTA_PAAL_PIPELINE_RUN_SIZE 1024
+#endif
+
+/* New image blocks of ARM_UC_BUFFER_SIZE / 2 bytes queued between the patch
+   and write threads of the delta pipeline.
+*/
+#ifndef ARM_UC_DELTA_PAAL_PIPELINE_WRITE_BLOCKS
+#define ARM_UC_DELTA_PAAL_PIPELINE_WRITE_BLOCKS 4
+#endif
+
+#if (ARM_UC_DELTA_PAAL_PIPELINE_RUNS < 1) || (ARM_UC_DELTA_PAAL_PIPELINE_RUN_SIZE < 1) || (ARM_UC_DELTA_PAAL_PIPELINE_WRITE_BLOCKS < 1)
+#error ARM_UC_DELTA_PAAL_PIPELINE_RUNS, ARM_UC_DELTA_PAAL_PIPELINE_RUN_SIZE and ARM_UC_DELTA_PAAL_PIPELINE_WRITE_BLOCKS must be 1 or more
+#endif
+
 #define MBED_CLOUD_CLIENT_UPDATE_CERTIFICATE_PREFIX "mbed.UpdateAuthCert."
 #define MBED_CLOUD_CLIENT_UPDATE_CERTIFICATE_DEFAULT "mbed.UpdateAuthCert"
 #define MBED_CLOUD_SHA256_BYTES (256/8)
@@ -31,6 +31,7 @@
 #include "update-client-delta-paal/arm_uc_pal_delta_paal_implementation.h"
 #include "update-client-delta-paal/arm_uc_pal_delta_paal.h"
 #include "update-client-delta-paal/arm_uc_pal_delta_paal_original_reader.h"
+#include "update-client-delta-paal/arm_uc_pal_delta_paal_pipeline.h"
 #include "update-client-metadata-header/arm_uc_metadata_header_v2.h"
 #include "update-client-common/arm_uc_common.h"
 #include "update-client-hub/source/update_client_hub_state_machine.h"
@@ -311,6 +312,10 @@ static bs_patch_api_return_code_t arm_uc_deltapaal_new_write(const struct bspatc
 static void arm_uc_deltapaal_reset_internals(void)
 {
     UC_PAAL_TRACE("arm_uc_deltapaal_reset_internals");
+#if defined(ARM_UC_DELTA_PAAL_PIPELINE)
+    arm_uc_deltapaal_pipeline_stop();
+#endif
+    arm_uc_deltapaal_original_reader_reset();
     arm_uc_pal_deltapaal_bspatch_seek_diff = 0;
     arm_uc_pal_deltapaal_bspatch_new_offset = 0;
     arm_uc_pal_deltapaal_incoming_hub_buf_ref_offset = 0;
@@ -462,6 +467,14 @@ static void arm_uc_deltapaal_internal_event_handler(uintptr_t event)
 static void ARM_UC_DeltaPaal_PALEventHandler(uintptr_t event)
 {
     UC_PAAL_TRACE("ARM_UC_DeltaPaal_PALEventHandler");
+#if defined(ARM_UC_DELTA_PAAL_PIPELINE)
+    if (delta_incoming && arm_uc_deltapaal_pipeline_is_running() &&
+            ((event == ARM_UC_PAAL_EVENT_WRITE_DONE) || (event == ARM_UC_PAAL_EVENT_WRITE_ERROR))) {
+        /* new image writes are issued by the pipeline write thread, which waits for them */
+        arm_uc_deltapaal_pipeline_storage_event(event);
+        return;
+    }
+#endif
     /* decouple event handler from callback */
     ARM_UC_PostCallback(&arm_uc_deltapaal_event_handler_callback,
                         arm_uc_deltapaal_internal_event_handler, event);
@@ -758,6 +771,19 @@ arm_uc_error_t ARM_UC_PAL_DeltaPaal_Write(uint32_t slot_id,
         // Delta processing
         UC_PAAL_TRACE("ARM_UC_PAL_DeltaPaal_Write We have DELTA PAYLOAD! ");
 
+#if defined(ARM_UC_DELTA_PAAL_PIPELINE)
+        // Decompress, patch and write on their own threads, patching on the hub thread below
+        // is the fallback if they cannot be started
+        if (offset == 0) {
+            arm_uc_deltapaal_pipeline_start(slot_id, paal_storage_implementation,
+                                            arm_uc_deltapaal_original_reader,
+                                            arm_uc_deltapaal_signal_ucfm_handler);
+        }
+        if (arm_uc_deltapaal_pipeline_is_running()) {
+            return arm_uc_deltapaal_pipeline_write(buffer, delta_patch_full_offset >= delta_patch_full_size);
+        }
+#endif
+
         // Decouple to event handler for async handling
         if ( ARM_UC_PostCallback(&arm_uc_deltapaal_write_async_callback,
                                  ARM_UC_DeltaPaal_AsyncWrite_Handler, ARM_UC_PAAL_EVENT_WRITE_DONE) ) {
@@ -788,7 +814,11 @@ arm_uc_error_t ARM_UC_PAL_DeltaPaal_Finalize(uint32_t slot_id)
                  arm_uc_pal_deltapaal_bspatch_new_offset);
     arm_uc_error_t result = { .code = ERR_NONE };
 
+#if defined(ARM_UC_DELTA_PAAL_PIPELINE)
+    arm_uc_deltapaal_pipeline_stop();
+#endif
     ARM_BS_Free(&delta_paal_bs_patch);
+    arm_uc_deltapaal_original_reader_finish();
 
     if (paal_storage_implementation) {
         result = paal_storage_implementation->Finalize(slot_id);
@@ -22,7 +22,9 @@
 
 #if defined(ARM_UC_FEATURE_DELTA_PAAL) && (ARM_UC_FEATURE_DELTA_PAAL == 1)
 #include "update-client-common/arm_uc_common.h"
+#include "update-client-delta-paal/arm_uc_pal_delta_paal_original_reader.h"
 #include <inttypes.h>
+#include <string.h>
 #if defined(TARGET_LIKE_MBED)
 #include "update-client-pal-flashiap/arm_uc_pal_flashiap_platform.h"
 // TODO: do we need something different for old style definition of mbed app start?
@@ -50,19 +52,74 @@
 
 static int flash_init_done = 0;
 
+#if !defined(TARGET_LIKE_MBED)
+#if defined(ARM_UC_FEATURE_DELTA_PAAL_ORIGINAL_MMAP) && (ARM_UC_FEATURE_DELTA_PAAL_ORIGINAL_MMAP == 1)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if (ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCKS > 0) && (ARM_UC_DELTA_PAAL_ORIGINAL_PREFETCH_BLOCKS > 0)
+#define ARM_UC_DELTA_PAAL_ORIGINAL_PREFETCH 1
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#endif
+
+/* read statistics, reset on every new patch */
+static arm_uc_deltapaal_original_reader_stats_t arm_uc_deltapaal_original_stats = { 0 };
+
+#if !defined(TARGET_LIKE_MBED)
 /**
- * @brief arm_uc_deltapaal_original_reader - helper function to read bytes from original reader.
- * @param stream
+ * @brief Construct the path of the original firmware file.
+ * @param file_path Buffer of ORIG_FILENAME_MAX_PATH bytes for the path.
+ * @return ERR_NONE on success.
+ */
+static int arm_uc_deltapaal_original_file_path(char *file_path)
+{
+    arm_uc_error_t result;
+
+    /* construct firmware file path */
+    result = arm_uc_pal_linux_internal_file_path(file_path,
+                                                 ORIG_FILENAME_MAX_PATH,
+#if defined(ARM_UC_FEATURE_PAL_LINUX) && (ARM_UC_FEATURE_PAL_LINUX == 1)
+#if defined(TARGET_X86_X64)
+#if !defined(ARM_UC_PROFILE_MBED_CLIENT_LITE) || (ARM_UC_PROFILE_MBED_CLIENT_LITE==0)
+
+
+                                                 pal_imageGetFolder(),
+#else
+                                                 ORIG_FIRMWARE_DIR,
+#endif
+#else                                                 // For Yocto Linux devices, expect original firmware
+                                                 //  .tar-package (with same name original_image.bin
+                                                 // is done in Prepare-script into /mnt/root/original_image.bin
+                                                 "/mnt/root",
+#endif // TARGET_X86_X64
+#else
+                                                 pal_imageGetFolder(),
+#endif // ARM_UC_FEATURE_PAL_LINUX
+                                                 "original_image",
+                                                 NULL);
+
+    if (result.error != ERR_NONE) {
+        UC_PAAL_ERR_MSG("arm_uc_pal_linux_internal_file_path failed with %d\n", result.error);
+        return ERR_UNSPECIFIED;
+    }
+    return ERR_NONE;
+}
+#endif
+
+/**
+ * @brief Read bytes from the original image, without caching.
  * @param buffer
  * @param length
- * @return
+ * @param offset
+ * @return ERR_NONE on success.
  */
-int arm_uc_deltapaal_original_reader(void* buffer, uint64_t length, uint32_t offset)
+static int arm_uc_deltapaal_original_direct_read(void* buffer, uint64_t length, uint32_t offset)
 {
-    //arm_uc_error_t result = { .code = ERR_INVALID_PARAMETER };
-    //UC_PAAL_TRACE("arm_uc_deltapaal_original_reader: offset %d  size %" PRIu64,
-    //              offset, length);
-
 #if defined(TARGET_LIKE_MBED)
     uint32_t appStart = MBED_CONF_APP_APPLICATION_START_ADDRESS;
 
@@ -99,41 +156,520 @@ int arm_uc_deltapaal_original_reader(void* buffer, uint64_t length, uint32_t off
         .ptr      = buffer
     };
 
-    /* construct firmware file path */
-    result = arm_uc_pal_linux_internal_file_path(file_path,
-                                                 ORIG_FILENAME_MAX_PATH,
-#if defined(ARM_UC_FEATURE_PAL_LINUX) && (ARM_UC_FEATURE_PAL_LINUX == 1)
-#if defined(TARGET_X86_X64)
-#if !defined(ARM_UC_PROFILE_MBED_CLIENT_LITE) || (ARM_UC_PROFILE_MBED_CLIENT_LITE==0)
+    if (arm_uc_deltapaal_original_file_path(file_path) != ERR_NONE) {
+        return ERR_UNSPECIFIED;
+    }
+    result = arm_uc_pal_linux_internal_read((const char *)file_path, offset, &uc_buffer);
 
+    if (result.error != ERR_NONE) {
+        UC_PAAL_ERR_MSG("arm_uc_pal_linux_internal_read failed with %d %s\n", result.error, file_path);
+        return ERR_UNSPECIFIED;
+    }
+#endif
+    return (ERR_NONE);
+}
 
-                                                 pal_imageGetFolder(),
-#else
-                                                 ORIG_FIRMWARE_DIR,
+#if !defined(TARGET_LIKE_MBED) && defined(ARM_UC_FEATURE_DELTA_PAAL_ORIGINAL_MMAP) && (ARM_UC_FEATURE_DELTA_PAAL_ORIGINAL_MMAP == 1)
+/* original image mapped into memory, NULL if not mapped */
+static const uint8_t *arm_uc_deltapaal_original_map = NULL;
+static size_t arm_uc_deltapaal_original_map_size = 0;
+static bool arm_uc_deltapaal_original_map_failed = false;
+
+/**
+ * @brief Map the original image into memory, once per patch.
+ * @return true if the image is mapped.
+ */
+static bool arm_uc_deltapaal_original_map_image(void)
+{
+    if ((arm_uc_deltapaal_original_map == NULL) && !arm_uc_deltapaal_original_map_failed) {
+        char file_path[ORIG_FILENAME_MAX_PATH] = { 0 };
+        int fd = -1;
+        struct stat file_stat;
+
+        /* only try once, fall back to plain reads if mapping is not possible */
+        arm_uc_deltapaal_original_map_failed = true;
+
+        if (arm_uc_deltapaal_original_file_path(file_path) == ERR_NONE) {
+            fd = open(file_path, O_RDONLY);
+        }
+        if (fd < 0) {
+            UC_PAAL_ERR_MSG("failed to open %s for mapping", file_path);
+        } else {
+            if ((fstat(fd, &file_stat) == 0) && (file_stat.st_size > 0)) {
+                void *map = mmap(NULL, (size_t) file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+                if (map != MAP_FAILED) {
+                    arm_uc_deltapaal_original_map = (const uint8_t *) map;
+                    arm_uc_deltapaal_original_map_size = (size_t) file_stat.st_size;
+                    arm_uc_deltapaal_original_map_failed = false;
+                    UC_PAAL_TRACE("mapped original image %s size %" PRIu32,
+                                  file_path, (uint32_t) arm_uc_deltapaal_original_map_size);
+                } else {
+                    UC_PAAL_ERR_MSG("failed to map %s", file_path);
+                }
+            }
+            /* the mapping stays valid after the descriptor is closed */
+            close(fd);
+        }
+    }
+
+    return (arm_uc_deltapaal_original_map != NULL);
+}
+
+/**
+ * @brief Unmap the original image.
+ */
+static void arm_uc_deltapaal_original_unmap_image(void)
+{
+    if (arm_uc_deltapaal_original_map) {
+        munmap((void *) arm_uc_deltapaal_original_map, arm_uc_deltapaal_original_map_size);
+    }
+    arm_uc_deltapaal_original_map = NULL;
+    arm_uc_deltapaal_original_map_size = 0;
+    arm_uc_deltapaal_original_map_failed = false;
+}
 #endif
-#else                                                 // For Yocto Linux devices, expect original firmware
-                                                 //  .tar-package (with same name original_image.bin
-                                                 // is done in Prepare-script into /mnt/root/original_image.bin
-                                                 "/mnt/root",
-#endif // TARGET_X86_X64
+
+#if ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCKS > 0
+typedef struct {
+    uint32_t offset;    // offset of the block in the original image
+    uint32_t size;      // valid bytes in the block, 0 if the block is empty
+    uint32_t used;      // last use, for replacing the least recently used block
+    uint8_t data[ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCK_SIZE];
+} arm_uc_deltapaal_original_block_t;
+
+static arm_uc_deltapaal_original_block_t arm_uc_deltapaal_original_cache[ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCKS];
+static uint32_t arm_uc_deltapaal_original_cache_use = 0;
+
+#if !defined(TARGET_LIKE_MBED)
+/* original image kept open while patching, so blocks are read without reopening it */
+static FILE *arm_uc_deltapaal_original_file = NULL;
+#endif
+
+/**
+ * @brief Load one block of the original image into the cache.
+ * @param block Block to fill.
+ * @param offset Block aligned offset in the original image.
+ * @return ERR_NONE on success.
+ */
+static int arm_uc_deltapaal_original_fill_block(arm_uc_deltapaal_original_block_t *block, uint32_t offset)
+{
+    block->size = 0;
+    arm_uc_deltapaal_original_stats.misses++;
+
+#if defined(TARGET_LIKE_MBED)
+    if (arm_uc_deltapaal_original_direct_read(block->data, sizeof(block->data), offset) != ERR_NONE) {
+        return ERR_UNSPECIFIED;
+    }
+    block->size = sizeof(block->data);
 #else
-                                                 pal_imageGetFolder(),
-#endif // ARM_UC_FEATURE_PAL_LINUX
-                                                 "original_image",
-                                                 NULL);
+    if (arm_uc_deltapaal_original_file == NULL) {
+        char file_path[ORIG_FILENAME_MAX_PATH] = { 0 };
 
-    if (result.error != ERR_NONE) {
-        UC_PAAL_ERR_MSG("arm_uc_pal_linux_internal_file_path failed with %d\n", result.error);
+        if (arm_uc_deltapaal_original_file_path(file_path) != ERR_NONE) {
+            return ERR_UNSPECIFIED;
+        }
+        arm_uc_deltapaal_original_file = fopen(file_path, "rb");
+        if (arm_uc_deltapaal_original_file == NULL) {
+            UC_PAAL_ERR_MSG("failed to open %s", file_path);
+            return ERR_UNSPECIFIED;
+        }
+    }
+
+    if (fseeko(arm_uc_deltapaal_original_file, offset, SEEK_SET) != 0) {
+        UC_PAAL_ERR_MSG("failed to seek original image to %" PRIu32, offset);
         return ERR_UNSPECIFIED;
     }
-    result = arm_uc_pal_linux_internal_read((const char *)file_path, offset, &uc_buffer);
 
-    if (result.error != ERR_NONE) {
-        UC_PAAL_ERR_MSG("arm_uc_pal_linux_internal_read failed with %d %s\n", result.error, file_path);
+    /* short reads only happen at the end of the image */
+    block->size = fread(block->data, sizeof(uint8_t), sizeof(block->data), arm_uc_deltapaal_original_file);
+    if (ferror(arm_uc_deltapaal_original_file)) {
+        UC_PAAL_ERR_MSG("failed to read original image at %" PRIu32, offset);
+        clearerr(arm_uc_deltapaal_original_file);
+        block->size = 0;
         return ERR_UNSPECIFIED;
     }
 #endif
-    return (ERR_NONE);
+
+    block->offset = offset;
+    arm_uc_deltapaal_original_stats.bytes_loaded += block->size;
+    return ERR_NONE;
+}
+
+#if defined(ARM_UC_DELTA_PAAL_ORIGINAL_PREFETCH)
+typedef struct {
+    uint32_t offset;    // offset of the block in the original image
+    uint32_t size;      // valid bytes in the block
+    uint8_t data[ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCK_SIZE];
+} arm_uc_deltapaal_original_prefetch_block_t;
+
+/* Blocks read ahead by the prefetch thread. Everything except the block being
+   read by the thread is protected by the mutex. When the queue is full the
+   thread waits until half of it has been taken, so it is not woken for every
+   block. The hub thread waits only for the block the thread is reading.
+*/
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+    pthread_t       thread;
+    int             fd;             // used only by the thread
+    bool            started;
+    bool            failed;         // thread could not be started, read on the hub thread only
+    bool            stop;
+    bool            end;            // end of the image or read error, nothing more to read
+    bool            thread_waiting;
+    bool            hub_waiting;
+    uint32_t        generation;     // changed on restart, a block read for an old position is dropped
+    uint32_t        next_offset;    // offset of the next block the thread reads
+    uint32_t        head;
+    uint32_t        count;
+    arm_uc_deltapaal_original_prefetch_block_t queue[ARM_UC_DELTA_PAAL_ORIGINAL_PREFETCH_BLOCKS];
+} arm_uc_deltapaal_original_prefetch = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+    .fd = -1
+};
+
+/**
+ * @brief Prefetch thread, reads the blocks following next_offset into the queue.
+ */
+static void *arm_uc_deltapaal_original_prefetch_thread(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&arm_uc_deltapaal_original_prefetch.mutex);
+    while (!arm_uc_deltapaal_original_prefetch.stop) {
+        if (arm_uc_deltapaal_original_prefetch.end ||
+                (arm_uc_deltapaal_original_prefetch.count == ARM_UC_DELTA_PAAL_ORIGINAL_PREFETCH_BLOCKS)) {
+            arm_uc_deltapaal_original_prefetch.thread_waiting = true;
+            pthread_cond_wait(&arm_uc_deltapaal_original_prefetch.cond, &arm_uc_deltapaal_original_prefetch.mutex);
+            arm_uc_deltapaal_original_prefetch.thread_waiting = false;
+            continue;
+        }
+
+        /* the slot after the queued blocks is not read by the hub thread until it is queued */
+        const uint32_t generation = arm_uc_deltapaal_original_prefetch.generation;
+        const uint32_t offset = arm_uc_deltapaal_original_prefetch.next_offset;
+        arm_uc_deltapaal_original_prefetch_block_t *block =
+            &arm_uc_deltapaal_original_prefetch.queue[(arm_uc_deltapaal_original_prefetch.head +
+                                                       arm_uc_deltapaal_original_prefetch.count) %
+                                                      ARM_UC_DELTA_PAAL_ORIGINAL_PREFETCH_BLOCKS];
+        pthread_mutex_unlock(&arm_uc_deltapaal_original_prefetch.mutex);
+
+        size_t size = 0;
+        bool error = false;
+        while (size < sizeof(block->data)) {
+            ssize_t result = pread(arm_uc_deltapaal_original_prefetch.fd, &block->data[size],
+                                   sizeof(block->data) - size, (off_t) offset + size);
+            if (result <= 0) {
+                error = (result < 0);
+                break;
+            }
+            size += (size_t) result;
+        }
+
+        pthread_mutex_lock(&arm_uc_deltapaal_original_prefetch.mutex);
+        if (generation == arm_uc_deltapaal_original_prefetch.generation) {
+            /* on an error the hub thread reads the block itself and reports it */
+            if (!error && (size > 0)) {
+                block->offset = offset;
+                block->size = (uint32_t) size;
+                arm_uc_deltapaal_original_prefetch.count++;
+                arm_uc_deltapaal_original_prefetch.next_offset += ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCK_SIZE;
+            }
+            if (error || (size < sizeof(block->data))) {
+                arm_uc_deltapaal_original_prefetch.end = true;
+            }
+            if (arm_uc_deltapaal_original_prefetch.hub_waiting) {
+                pthread_cond_broadcast(&arm_uc_deltapaal_original_prefetch.cond);
+            }
+        }
+    }
+    pthread_mutex_unlock(&arm_uc_deltapaal_original_prefetch.mutex);
+
+    return NULL;
+}
+
+/**
+ * @brief Start the prefetch thread with its own handle to the original image.
+ * @return true if the thread is running.
+ */
+static bool arm_uc_deltapaal_original_prefetch_start(void)
+{
+    if (!arm_uc_deltapaal_original_prefetch.started && !arm_uc_deltapaal_original_prefetch.failed) {
+        char file_path[ORIG_FILENAME_MAX_PATH] = { 0 };
+
+        /* only try once, read on the hub thread if the thread cannot be started */
+        arm_uc_deltapaal_original_prefetch.failed = true;
+
+        if (arm_uc_deltapaal_original_file_path(file_path) == ERR_NONE) {
+            arm_uc_deltapaal_original_prefetch.fd = open(file_path, O_RDONLY);
+        }
+        if (arm_uc_deltapaal_original_prefetch.fd < 0) {
+            UC_PAAL_ERR_MSG("failed to open %s for prefetch", file_path);
+        } else {
+            /* nothing to read until the first miss sets the position */
+            arm_uc_deltapaal_original_prefetch.stop = false;
+            arm_uc_deltapaal_original_prefetch.end = true;
+            arm_uc_deltapaal_original_prefetch.head = 0;
+            arm_uc_deltapaal_original_prefetch.count = 0;
+
+            if (pthread_create(&arm_uc_deltapaal_original_prefetch.thread, NULL,
+                               arm_uc_deltapaal_original_prefetch_thread, NULL) == 0) {
+                arm_uc_deltapaal_original_prefetch.started = true;
+                arm_uc_deltapaal_original_prefetch.failed = false;
+            } else {
+                UC_PAAL_ERR_MSG("failed to start original image prefetch thread");
+                close(arm_uc_deltapaal_original_prefetch.fd);
+                arm_uc_deltapaal_original_prefetch.fd = -1;
+            }
+        }
+    }
+
+    return arm_uc_deltapaal_original_prefetch.started;
+}
+
+/**
+ * @brief Stop the prefetch thread and drop the queued blocks.
+ */
+static void arm_uc_deltapaal_original_prefetch_stop(void)
+{
+    if (arm_uc_deltapaal_original_prefetch.started) {
+        pthread_mutex_lock(&arm_uc_deltapaal_original_prefetch.mutex);
+        arm_uc_deltapaal_original_prefetch.stop = true;
+        pthread_cond_broadcast(&arm_uc_deltapaal_original_prefetch.cond);
+        pthread_mutex_unlock(&arm_uc_deltapaal_original_prefetch.mutex);
+
+        pthread_join(arm_uc_deltapaal_original_prefetch.thread, NULL);
+        close(arm_uc_deltapaal_original_prefetch.fd);
+        arm_uc_deltapaal_original_prefetch.fd = -1;
+    }
+    arm_uc_deltapaal_original_prefetch.started = false;
+    arm_uc_deltapaal_original_prefetch.failed = false;
+    arm_uc_deltapaal_original_prefetch.count = 0;
+}
+
+/**
+ * @brief Take a block missing from the cache from the prefetch queue.
+ * @details The queue follows the last miss. If the block is not queued or
+ *          being read, reading ahead restarts after it.
+ * @param block Cache block to fill.
+ * @param offset Block aligned offset in the original image.
+ * @return true if the block was filled from the queue.
+ */
+static bool arm_uc_deltapaal_original_prefetch_take(arm_uc_deltapaal_original_block_t *block, uint32_t offset)
+{
+    bool found = false;
+
+    if (!arm_uc_deltapaal_original_prefetch_start()) {
+        return false;
+    }
+
+    pthread_mutex_lock(&arm_uc_deltapaal_original_prefetch.mutex);
+
+    /* drop blocks skipped by bspatch */
+    while ((arm_uc_deltapaal_original_prefetch.count > 0) &&
+            (arm_uc_deltapaal_original_prefetch.queue[arm_uc_deltapaal_original_prefetch.head].offset < offset)) {
+        arm_uc_deltapaal_original_prefetch.head = (arm_uc_deltapaal_original_prefetch.head + 1) %
+                                                  ARM_UC_DELTA_PAAL_ORIGINAL_PREFETCH_BLOCKS;
+        arm_uc_deltapaal_original_prefetch.count--;
+    }
+
+    /* wait if the thread is reading the block */
+    while ((arm_uc_deltapaal_original_prefetch.count == 0) &&
+            !arm_uc_deltapaal_original_prefetch.end &&
+            (arm_uc_deltapaal_original_prefetch.next_offset == offset)) {
+        if (arm_uc_deltapaal_original_prefetch.thread_waiting) {
+            pthread_cond_broadcast(&arm_uc_deltapaal_original_prefetch.cond);
+        }
+        arm_uc_deltapaal_original_prefetch.hub_waiting = true;
+        pthread_cond_wait(&arm_uc_deltapaal_original_prefetch.cond, &arm_uc_deltapaal_original_prefetch.mutex);
+        arm_uc_deltapaal_original_prefetch.hub_waiting = false;
+    }
+
+    if ((arm_uc_deltapaal_original_prefetch.count > 0) &&
+            (arm_uc_deltapaal_original_prefetch.queue[arm_uc_deltapaal_original_prefetch.head].offset == offset)) {
+        const arm_uc_deltapaal_original_prefetch_block_t *queued =
+            &arm_uc_deltapaal_original_prefetch.queue[arm_uc_deltapaal_original_prefetch.head];
+
+        memcpy(block->data, queued->data, queued->size);
+        block->offset = offset;
+        block->size = queued->size;
+        arm_uc_deltapaal_original_prefetch.head = (arm_uc_deltapaal_original_prefetch.head + 1) %
+                                                  ARM_UC_DELTA_PAAL_ORIGINAL_PREFETCH_BLOCKS;
+        arm_uc_deltapaal_original_prefetch.count--;
+        found = true;
+    } else {
+        /* jump outside the queue, the caller reads the block and the thread continues after it */
+        arm_uc_deltapaal_original_prefetch.generation++;
+        arm_uc_deltapaal_original_prefetch.head = 0;
+        arm_uc_deltapaal_original_prefetch.count = 0;
+        arm_uc_deltapaal_original_prefetch.next_offset = offset + ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCK_SIZE;
+        arm_uc_deltapaal_original_prefetch.end = false;
+    }
+
+    if (arm_uc_deltapaal_original_prefetch.thread_waiting &&
+            (arm_uc_deltapaal_original_prefetch.count <= (ARM_UC_DELTA_PAAL_ORIGINAL_PREFETCH_BLOCKS / 2))) {
+        pthread_cond_broadcast(&arm_uc_deltapaal_original_prefetch.cond);
+    }
+    pthread_mutex_unlock(&arm_uc_deltapaal_original_prefetch.mutex);
+
+    if (found) {
+        arm_uc_deltapaal_original_stats.prefetched++;
+        arm_uc_deltapaal_original_stats.bytes_loaded += block->size;
+    }
+    return found;
+}
+#endif // ARM_UC_DELTA_PAAL_ORIGINAL_PREFETCH
+
+/**
+ * @brief Get the cached block holding the given block aligned offset, loading it on a miss.
+ * @return Block, NULL if it could not be read.
+ */
+static arm_uc_deltapaal_original_block_t *arm_uc_deltapaal_original_get_block(uint32_t offset)
+{
+    arm_uc_deltapaal_original_block_t *victim = &arm_uc_deltapaal_original_cache[0];
+
+    for (size_t index = 0; index < ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCKS; index++) {
+        arm_uc_deltapaal_original_block_t *block = &arm_uc_deltapaal_original_cache[index];
+
+        if ((block->size > 0) && (block->offset == offset)) {
+            arm_uc_deltapaal_original_stats.hits++;
+            block->used = ++arm_uc_deltapaal_original_cache_use;
+            return block;
+        }
+        if ((block->size == 0) || ((victim->size > 0) && (block->used < victim->used))) {
+            victim = block;
+        }
+    }
+
+#if defined(ARM_UC_DELTA_PAAL_ORIGINAL_PREFETCH)
+    if (arm_uc_deltapaal_original_prefetch_take(victim, offset)) {
+        victim->used = ++arm_uc_deltapaal_original_cache_use;
+        return victim;
+    }
+#endif
+    if (arm_uc_deltapaal_original_fill_block(victim, offset) != ERR_NONE) {
+        return NULL;
+    }
+    victim->used = ++arm_uc_deltapaal_original_cache_use;
+    return victim;
+}
+#endif // ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCKS
+
+/**
+ * @brief arm_uc_deltapaal_original_reader - helper function to read bytes from original reader.
+ * @param stream
+ * @param buffer
+ * @param length
+ * @return
+ */
+int arm_uc_deltapaal_original_reader(void* buffer, uint64_t length, uint32_t offset)
+{
+    //arm_uc_error_t result = { .code = ERR_INVALID_PARAMETER };
+    //UC_PAAL_TRACE("arm_uc_deltapaal_original_reader: offset %d  size %" PRIu64,
+    //              offset, length);
+
+    arm_uc_deltapaal_original_stats.reads++;
+
+#if !defined(TARGET_LIKE_MBED) && defined(ARM_UC_FEATURE_DELTA_PAAL_ORIGINAL_MMAP) && (ARM_UC_FEATURE_DELTA_PAAL_ORIGINAL_MMAP == 1)
+    if (arm_uc_deltapaal_original_map_image()) {
+        /* like a file read, a read past the end of the image is cut short */
+        if (offset < arm_uc_deltapaal_original_map_size) {
+            uint64_t available = arm_uc_deltapaal_original_map_size - offset;
+
+            memcpy(buffer, &arm_uc_deltapaal_original_map[offset], (length < available) ? length : available);
+        }
+        arm_uc_deltapaal_original_stats.hits++;
+        return ERR_NONE;
+    }
+#endif
+
+#if ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCKS > 0
+    uint8_t *output = (uint8_t *) buffer;
+
+    while (length > 0) {
+        uint32_t block_offset = offset - (offset % ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCK_SIZE);
+        arm_uc_deltapaal_original_block_t *block = arm_uc_deltapaal_original_get_block(block_offset);
+
+        if (block == NULL) {
+            return ERR_UNSPECIFIED;
+        }
+
+        uint32_t index = offset - block_offset;
+
+        /* end of the image */
+        if (index >= block->size) {
+            break;
+        }
+
+        uint32_t copy_size = block->size - index;
+        if (copy_size > length) {
+            copy_size = (uint32_t) length;
+        }
+
+        memcpy(output, &block->data[index], copy_size);
+        output += copy_size;
+        offset += copy_size;
+        length -= copy_size;
+    }
+
+    return ERR_NONE;
+#else
+    return arm_uc_deltapaal_original_direct_read(buffer, length, offset);
+#endif
+}
+
+/**
+ * @brief Drop cached data and reset statistics before patching with a new original image.
+ */
+void arm_uc_deltapaal_original_reader_reset(void)
+{
+    memset(&arm_uc_deltapaal_original_stats, 0, sizeof(arm_uc_deltapaal_original_stats));
+    arm_uc_deltapaal_original_reader_finish();
+}
+
+/**
+ * @brief Report statistics and release the original image after patching.
+ */
+void arm_uc_deltapaal_original_reader_finish(void)
+{
+    if (arm_uc_deltapaal_original_stats.reads) {
+        UC_PAAL_TRACE("original reader: reads %" PRIu32 " hits %" PRIu32 " misses %" PRIu32
+                      " prefetched %" PRIu32 " loaded %" PRIu64,
+                      arm_uc_deltapaal_original_stats.reads,
+                      arm_uc_deltapaal_original_stats.hits,
+                      arm_uc_deltapaal_original_stats.misses,
+                      arm_uc_deltapaal_original_stats.prefetched,
+                      arm_uc_deltapaal_original_stats.bytes_loaded);
+    }
+
+#if ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCKS > 0
+#if defined(ARM_UC_DELTA_PAAL_ORIGINAL_PREFETCH)
+    arm_uc_deltapaal_original_prefetch_stop();
+#endif
+    for (size_t index = 0; index < ARM_UC_DELTA_PAAL_ORIGINAL_CACHE_BLOCKS; index++) {
+        arm_uc_deltapaal_original_cache[index].size = 0;
+    }
+#if !defined(TARGET_LIKE_MBED)
+    if (arm_uc_deltapaal_original_file) {
+        fclose(arm_uc_deltapaal_original_file);
+        arm_uc_deltapaal_original_file = NULL;
+    }
+#endif
+#endif
+
+#if !defined(TARGET_LIKE_MBED) && defined(ARM_UC_FEATURE_DELTA_PAAL_ORIGINAL_MMAP) && (ARM_UC_FEATURE_DELTA_PAAL_ORIGINAL_MMAP == 1)
+    arm_uc_deltapaal_original_unmap_image();
+#endif
+}
+
+/**
+ * @brief Get the read statistics of the current or last patch.
+ */
+arm_uc_deltapaal_original_reader_stats_t arm_uc_deltapaal_original_reader_get_stats(void)
+{
+    return arm_uc_deltapaal_original_stats;
 }
 
 #endif
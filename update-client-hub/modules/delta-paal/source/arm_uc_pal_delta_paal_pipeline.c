@@ -0,0 +1,679 @@
+// ----------------------------------------------------------------------------
+// Copyright 2019 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+#include "arm_uc_config.h"
+
+#if defined(ARM_UC_FEATURE_DELTA_PAAL) && (ARM_UC_FEATURE_DELTA_PAAL == 1)
+#include "update-client-delta-paal/arm_uc_pal_delta_paal_pipeline.h"
+
+#if defined(ARM_UC_DELTA_PAAL_PIPELINE)
+#include "delta-tool-internal/include/bspatch.h"
+#include "delta-tool-internal/include/bspatch_private.h"
+#include "update-client-common/arm_uc_common.h"
+#include <inttypes.h>
+#include <pthread.h>
+#include <string.h>
+
+#define TRACE_GROUP  "UCPI"
+
+/* new image blocks are the size of the buffer bspatch output is collected in on the hub thread */
+#define ARM_UC_DELTA_PAAL_PIPELINE_BLOCK_SIZE (ARM_UC_BUFFER_SIZE / 2)
+/* room for a whole fragment while the previous one is decompressed */
+#define ARM_UC_DELTA_PAAL_PIPELINE_PATCH_SIZE (2 * ARM_UC_BUFFER_SIZE)
+#define ARM_UC_DELTA_PAAL_PIPELINE_THREADS 3
+
+typedef enum {
+    ARM_UC_DELTA_PAAL_PIPELINE_RUN_DIFF,    // add data to the original image at the current position
+    ARM_UC_DELTA_PAAL_PIPELINE_RUN_EXTRA,   // copy data to the new image
+    ARM_UC_DELTA_PAAL_PIPELINE_RUN_SEEK,    // move the current position in the original image
+    ARM_UC_DELTA_PAAL_PIPELINE_RUN_END      // new image complete
+} arm_uc_deltapaal_pipeline_run_type_t;
+
+typedef struct {
+    arm_uc_deltapaal_pipeline_run_type_t type;
+    uint32_t length;    // bytes in data
+    int64_t  seek;      // jump in the original image
+    uint8_t  data[ARM_UC_DELTA_PAAL_PIPELINE_RUN_SIZE];
+} arm_uc_deltapaal_pipeline_run_t;
+
+typedef struct {
+    uint32_t offset;    // offset of the block in the new image
+    uint32_t size;      // valid bytes in the block
+    bool     last;      // last block of the new image, may be empty
+    uint8_t  data[ARM_UC_DELTA_PAAL_PIPELINE_BLOCK_SIZE];
+} arm_uc_deltapaal_pipeline_block_t;
+
+/* Patch stream, decompressed runs and new image blocks, each queue with one
+   producer and one consumer. Runs and blocks are filled and emptied outside
+   the mutex by the thread owning the slot; a slot changes owner only when the
+   counters, which the mutex protects, are updated. The patch stream is small
+   and copied under the mutex, as both the hub thread and the decompress
+   thread, for a fragment left pending, add to it.
+*/
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t  patch_cond;     // patch bytes queued or taken
+    pthread_cond_t  run_cond;       // run queued or taken
+    pthread_cond_t  block_cond;     // block queued or taken, or storage write completed
+    pthread_t       threads[ARM_UC_DELTA_PAAL_PIPELINE_THREADS];
+    uint32_t        thread_count;
+    bool            stop;
+    bool            failed;         // WRITE_ERROR signalled, nothing more is signalled
+
+    uint32_t        slot_id;
+    const ARM_UC_PAAL_UPDATE *storage;
+    arm_uc_deltapaal_pipeline_read_old_t read_old;
+    ARM_UC_PAAL_UPDATE_SignalEvent_t signal;
+    arm_uc_callback_t signal_callback;
+
+    uint32_t        patch_head;
+    uint32_t        patch_count;
+    bool            patch_end;      // last fragment queued
+    bool            decoded;        // whole patch decoded, later fragments are dropped
+    bool            written;        // whole new image written
+    const arm_uc_buffer_t *pending; // fragment waiting for room in the patch queue
+    bool            pending_last;
+    uint8_t         patch[ARM_UC_DELTA_PAAL_PIPELINE_PATCH_SIZE];
+
+    uint32_t        run_head;
+    uint32_t        run_count;
+    arm_uc_deltapaal_pipeline_run_t runs[ARM_UC_DELTA_PAAL_PIPELINE_RUNS];
+
+    uint32_t        block_head;
+    uint32_t        block_count;
+    bool            write_done;
+    uintptr_t       write_event;
+    arm_uc_deltapaal_pipeline_block_t blocks[ARM_UC_DELTA_PAAL_PIPELINE_WRITE_BLOCKS];
+
+    /* used by the decompress thread only */
+    struct bspatch_stream decoder;
+} arm_uc_deltapaal_pipeline = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .patch_cond = PTHREAD_COND_INITIALIZER,
+    .run_cond = PTHREAD_COND_INITIALIZER,
+    .block_cond = PTHREAD_COND_INITIALIZER
+};
+
+/**
+ * @brief Signal the handler on the hub thread.
+ * @param event WRITE_DONE for a fragment or WRITE_ERROR.
+ */
+static void arm_uc_deltapaal_pipeline_signal(uintptr_t event)
+{
+    ARM_UC_PostCallback(&arm_uc_deltapaal_pipeline.signal_callback,
+                        arm_uc_deltapaal_pipeline.signal, event);
+}
+
+/**
+ * @brief Stop the threads after an error and signal WRITE_ERROR, unless they are being stopped anyway.
+ */
+static void arm_uc_deltapaal_pipeline_fail(void)
+{
+    bool signal = false;
+
+    pthread_mutex_lock(&arm_uc_deltapaal_pipeline.mutex);
+    if (!arm_uc_deltapaal_pipeline.stop && !arm_uc_deltapaal_pipeline.failed) {
+        arm_uc_deltapaal_pipeline.failed = true;
+        signal = true;
+    }
+    arm_uc_deltapaal_pipeline.stop = true;
+    pthread_cond_broadcast(&arm_uc_deltapaal_pipeline.patch_cond);
+    pthread_cond_broadcast(&arm_uc_deltapaal_pipeline.run_cond);
+    pthread_cond_broadcast(&arm_uc_deltapaal_pipeline.block_cond);
+    pthread_mutex_unlock(&arm_uc_deltapaal_pipeline.mutex);
+
+    if (signal) {
+        UC_PAAL_ERR_MSG("delta pipeline failed");
+        arm_uc_deltapaal_pipeline_signal(ARM_UC_PAAL_EVENT_WRITE_ERROR);
+    }
+}
+
+/**
+ * @brief Copy a fragment into the patch queue, or drop it once the patch is decoded.
+ * @details Called with the mutex held and room for the fragment.
+ * @return true if WRITE_DONE is to be signalled for the fragment. The last
+ *         fragment is signalled once the new image is written.
+ */
+static bool arm_uc_deltapaal_pipeline_accept(const arm_uc_buffer_t *buffer, bool last)
+{
+    if (!arm_uc_deltapaal_pipeline.decoded) {
+        uint32_t tail = (arm_uc_deltapaal_pipeline.patch_head + arm_uc_deltapaal_pipeline.patch_count) %
+                        ARM_UC_DELTA_PAAL_PIPELINE_PATCH_SIZE;
+        uint32_t first = ARM_UC_DELTA_PAAL_PIPELINE_PATCH_SIZE - tail;
+
+        if (first > buffer->size) {
+            first = buffer->size;
+        }
+        memcpy(&arm_uc_deltapaal_pipeline.patch[tail], buffer->ptr, first);
+        memcpy(arm_uc_deltapaal_pipeline.patch, buffer->ptr + first, buffer->size - first);
+        arm_uc_deltapaal_pipeline.patch_count += buffer->size;
+        pthread_cond_broadcast(&arm_uc_deltapaal_pipeline.patch_cond);
+    }
+
+    if (last) {
+        arm_uc_deltapaal_pipeline.patch_end = true;
+        pthread_cond_broadcast(&arm_uc_deltapaal_pipeline.patch_cond);
+        return arm_uc_deltapaal_pipeline.written;
+    }
+    return true;
+}
+
+/**
+ * @brief Accept the pending fragment if there is room for it now.
+ * @details Called with the mutex held.
+ * @return true if WRITE_DONE is to be signalled for the fragment.
+ */
+static bool arm_uc_deltapaal_pipeline_accept_pending(void)
+{
+    const arm_uc_buffer_t *pending = arm_uc_deltapaal_pipeline.pending;
+
+    if (pending && (arm_uc_deltapaal_pipeline.decoded ||
+                    (arm_uc_deltapaal_pipeline.patch_count + pending->size <= ARM_UC_DELTA_PAAL_PIPELINE_PATCH_SIZE))) {
+        arm_uc_deltapaal_pipeline.pending = NULL;
+        return arm_uc_deltapaal_pipeline_accept(pending, arm_uc_deltapaal_pipeline.pending_last);
+    }
+    return false;
+}
+
+/*************************************************************************************
+ * Decompress thread, bspatch decodes the patch stream into runs
+ */
+
+/**
+ * @brief BsPatch callback reading the patch stream, waits for the hub to queue more.
+ */
+static bs_patch_api_return_code_t arm_uc_deltapaal_pipeline_read_patch(const struct bspatch_stream *stream,
+                                                                       void *buffer, uint64_t length)
+{
+    bs_patch_api_return_code_t result = EBSAPI_OPERATION_DONE_IMMEDIATELY;
+    uint8_t *output = (uint8_t *) buffer;
+    bool signal = false;
+    (void)stream;
+
+    pthread_mutex_lock(&arm_uc_deltapaal_pipeline.mutex);
+    while ((length > 0) && (result == EBSAPI_OPERATION_DONE_IMMEDIATELY)) {
+        if (arm_uc_deltapaal_pipeline.stop) {
+            result = EBSAPI_ERR_FILE_IO;
+        } else if (arm_uc_deltapaal_pipeline.patch_count > 0) {
+            uint32_t copy_size = ARM_UC_DELTA_PAAL_PIPELINE_PATCH_SIZE - arm_uc_deltapaal_pipeline.patch_head;
+
+            if (copy_size > arm_uc_deltapaal_pipeline.patch_count) {
+                copy_size = arm_uc_deltapaal_pipeline.patch_count;
+            }
+            if (copy_size > length) {
+                copy_size = (uint32_t) length;
+            }
+            memcpy(output, &arm_uc_deltapaal_pipeline.patch[arm_uc_deltapaal_pipeline.patch_head], copy_size);
+            output += copy_size;
+            length -= copy_size;
+            arm_uc_deltapaal_pipeline.patch_head = (arm_uc_deltapaal_pipeline.patch_head + copy_size) %
+                                                   ARM_UC_DELTA_PAAL_PIPELINE_PATCH_SIZE;
+            arm_uc_deltapaal_pipeline.patch_count -= copy_size;
+            signal = arm_uc_deltapaal_pipeline_accept_pending() || signal;
+        } else if (arm_uc_deltapaal_pipeline.patch_end) {
+            UC_PAAL_ERR_MSG("delta pipeline: patch ends early");
+            result = EBSAPI_ERR_CORRUPTED_PATCH;
+        } else {
+            pthread_cond_wait(&arm_uc_deltapaal_pipeline.patch_cond, &arm_uc_deltapaal_pipeline.mutex);
+        }
+    }
+    pthread_mutex_unlock(&arm_uc_deltapaal_pipeline.mutex);
+
+    if (signal) {
+        arm_uc_deltapaal_pipeline_signal(ARM_UC_PAAL_EVENT_WRITE_DONE);
+    }
+    return result;
+}
+
+/**
+ * @brief Queue a run for the patch thread, split into as many runs as its data needs.
+ * @param data Run data, NULL for a seek or the end.
+ */
+static bs_patch_api_return_code_t arm_uc_deltapaal_pipeline_queue_run(arm_uc_deltapaal_pipeline_run_type_t type,
+                                                                      const uint8_t *data, uint64_t length,
+                                                                      int64_t seek)
+{
+    do {
+        pthread_mutex_lock(&arm_uc_deltapaal_pipeline.mutex);
+        while ((arm_uc_deltapaal_pipeline.run_count == ARM_UC_DELTA_PAAL_PIPELINE_RUNS) &&
+                !arm_uc_deltapaal_pipeline.stop) {
+            pthread_cond_wait(&arm_uc_deltapaal_pipeline.run_cond, &arm_uc_deltapaal_pipeline.mutex);
+        }
+        if (arm_uc_deltapaal_pipeline.stop) {
+            pthread_mutex_unlock(&arm_uc_deltapaal_pipeline.mutex);
+            return EBSAPI_ERR_FILE_IO;
+        }
+        /* the slot after the queued runs is not read by the patch thread until it is queued */
+        arm_uc_deltapaal_pipeline_run_t *run =
+            &arm_uc_deltapaal_pipeline.runs[(arm_uc_deltapaal_pipeline.run_head + arm_uc_deltapaal_pipeline.run_count) %
+                                            ARM_UC_DELTA_PAAL_PIPELINE_RUNS];
+        pthread_mutex_unlock(&arm_uc_deltapaal_pipeline.mutex);
+
+        run->type = type;
+        run->seek = seek;
+        run->length = (length < ARM_UC_DELTA_PAAL_PIPELINE_RUN_SIZE) ? (uint32_t) length : ARM_UC_DELTA_PAAL_PIPELINE_RUN_SIZE;
+        if (data) {
+            memcpy(run->data, data, run->length);
+            data += run->length;
+        }
+        length -= run->length;
+
+        pthread_mutex_lock(&arm_uc_deltapaal_pipeline.mutex);
+        arm_uc_deltapaal_pipeline.run_count++;
+        pthread_cond_broadcast(&arm_uc_deltapaal_pipeline.run_cond);
+        pthread_mutex_unlock(&arm_uc_deltapaal_pipeline.mutex);
+    } while (length > 0);
+
+    return EBSAPI_OPERATION_DONE_IMMEDIATELY;
+}
+
+/**
+ * @brief BsPatch callback for a jump in the original image.
+ */
+static bs_patch_api_return_code_t arm_uc_deltapaal_pipeline_seek_old(const struct bspatch_stream *stream, int64_t seek_diff)
+{
+    (void)stream;
+    return arm_uc_deltapaal_pipeline_queue_run(ARM_UC_DELTA_PAAL_PIPELINE_RUN_SEEK, NULL, 0, seek_diff);
+}
+
+/**
+ * @brief BsPatch callback for extra bytes, copied to the new image as they are.
+ */
+static bs_patch_api_return_code_t arm_uc_deltapaal_pipeline_write_extra(const struct bspatch_stream *stream,
+                                                                        void *buffer, uint64_t length)
+{
+    (void)stream;
+    return arm_uc_deltapaal_pipeline_queue_run(ARM_UC_DELTA_PAAL_PIPELINE_RUN_EXTRA, buffer, length, 0);
+}
+
+/**
+ * @brief BsPatch callback for diff bytes, added to the original image by the patch thread.
+ */
+static bs_patch_api_return_code_t arm_uc_deltapaal_pipeline_write_diff(const struct bspatch_stream *stream,
+                                                                       const void *buffer, uint64_t length)
+{
+    (void)stream;
+    return arm_uc_deltapaal_pipeline_queue_run(ARM_UC_DELTA_PAAL_PIPELINE_RUN_DIFF, buffer, length, 0);
+}
+
+/**
+ * @brief Decompress thread, runs bspatch over the whole patch stream.
+ */
+static void *arm_uc_deltapaal_pipeline_decompress_thread(void *arg)
+{
+    bs_patch_api_return_code_t result;
+    bool signal;
+    (void)arg;
+
+    result = ARM_BS_ProcessPatchEvent(&arm_uc_deltapaal_pipeline.decoder, EBSAPI_START_PATCH_PROCESSING);
+    ARM_BS_Free(&arm_uc_deltapaal_pipeline.decoder);
+
+    if (result == EBSAPI_PATCH_DONE) {
+        pthread_mutex_lock(&arm_uc_deltapaal_pipeline.mutex);
+        arm_uc_deltapaal_pipeline.decoded = true;
+        signal = arm_uc_deltapaal_pipeline_accept_pending();
+        pthread_mutex_unlock(&arm_uc_deltapaal_pipeline.mutex);
+
+        if (signal) {
+            arm_uc_deltapaal_pipeline_signal(ARM_UC_PAAL_EVENT_WRITE_DONE);
+        }
+        result = arm_uc_deltapaal_pipeline_queue_run(ARM_UC_DELTA_PAAL_PIPELINE_RUN_END, NULL, 0, 0);
+    } else {
+        UC_PAAL_TRACE("delta pipeline: bspatch returned %d", result);
+    }
+
+    if (result != EBSAPI_OPERATION_DONE_IMMEDIATELY) {
+        arm_uc_deltapaal_pipeline_fail();
+    }
+    return NULL;
+}
+
+/*************************************************************************************
+ * Patch thread, adds diff runs to the original image and collects new image blocks
+ */
+
+/**
+ * @brief Wait for a free block after the queued ones.
+ * @param offset Offset of the block in the new image.
+ * @return Empty block, NULL if the threads are stopping.
+ */
+static arm_uc_deltapaal_pipeline_block_t *arm_uc_deltapaal_pipeline_next_block(uint32_t offset)
+{
+    arm_uc_deltapaal_pipeline_block_t *block = NULL;
+
+    pthread_mutex_lock(&arm_uc_deltapaal_pipeline.mutex);
+    while ((arm_uc_deltapaal_pipeline.block_count == ARM_UC_DELTA_PAAL_PIPELINE_WRITE_BLOCKS) &&
+            !arm_uc_deltapaal_pipeline.stop) {
+        pthread_cond_wait(&arm_uc_deltapaal_pipeline.block_cond, &arm_uc_deltapaal_pipeline.mutex);
+    }
+    if (!arm_uc_deltapaal_pipeline.stop) {
+        block = &arm_uc_deltapaal_pipeline.blocks[(arm_uc_deltapaal_pipeline.block_head + arm_uc_deltapaal_pipeline.block_count) %
+                                                  ARM_UC_DELTA_PAAL_PIPELINE_WRITE_BLOCKS];
+    }
+    pthread_mutex_unlock(&arm_uc_deltapaal_pipeline.mutex);
+
+    if (block) {
+        block->offset = offset;
+        block->size = 0;
+        block->last = false;
+    }
+    return block;
+}
+
+/**
+ * @brief Hand a filled block to the write thread.
+ */
+static void arm_uc_deltapaal_pipeline_queue_block(void)
+{
+    pthread_mutex_lock(&arm_uc_deltapaal_pipeline.mutex);
+    arm_uc_deltapaal_pipeline.block_count++;
+    pthread_cond_broadcast(&arm_uc_deltapaal_pipeline.block_cond);
+    pthread_mutex_unlock(&arm_uc_deltapaal_pipeline.mutex);
+}
+
+/**
+ * @brief Patch thread, applies the runs in order.
+ */
+static void *arm_uc_deltapaal_pipeline_patch_thread(void *arg)
+{
+    arm_uc_deltapaal_pipeline_block_t *block = NULL;
+    int64_t old_offset = 0;
+    uint32_t new_offset = 0;
+    bool success = true;
+    bool end = false;
+    (void)arg;
+
+    while (success && !end) {
+        pthread_mutex_lock(&arm_uc_deltapaal_pipeline.mutex);
+        while ((arm_uc_deltapaal_pipeline.run_count == 0) && !arm_uc_deltapaal_pipeline.stop) {
+            pthread_cond_wait(&arm_uc_deltapaal_pipeline.run_cond, &arm_uc_deltapaal_pipeline.mutex);
+        }
+        success = !arm_uc_deltapaal_pipeline.stop;
+        const arm_uc_deltapaal_pipeline_run_t *run = &arm_uc_deltapaal_pipeline.runs[arm_uc_deltapaal_pipeline.run_head];
+        pthread_mutex_unlock(&arm_uc_deltapaal_pipeline.mutex);
+
+        if (!success) {
+            break;
+        }
+
+        if (run->type == ARM_UC_DELTA_PAAL_PIPELINE_RUN_SEEK) {
+            old_offset += run->seek;
+        } else if (run->type == ARM_UC_DELTA_PAAL_PIPELINE_RUN_END) {
+            if (block == NULL) {
+                block = arm_uc_deltapaal_pipeline_next_block(new_offset);
+            }
+            if (block) {
+                block->last = true;
+                arm_uc_deltapaal_pipeline_queue_block();
+                end = true;
+            } else {
+                success = false;
+            }
+        } else {
+            uint32_t index = 0;
+
+            while (success && (index < run->length)) {
+                if (block == NULL) {
+                    block = arm_uc_deltapaal_pipeline_next_block(new_offset);
+                    if (block == NULL) {
+                        success = false;
+                        break;
+                    }
+                }
+
+                uint32_t copy_size = ARM_UC_DELTA_PAAL_PIPELINE_BLOCK_SIZE - block->size;
+                if (copy_size > run->length - index) {
+                    copy_size = run->length - index;
+                }
+
+                if (run->type == ARM_UC_DELTA_PAAL_PIPELINE_RUN_DIFF) {
+                    /* read the original bytes straight into the block and add the diff there */
+                    if (arm_uc_deltapaal_pipeline.read_old(&block->data[block->size], copy_size,
+                                                           (uint32_t) old_offset) != ERR_NONE) {
+                        UC_PAAL_ERR_MSG("delta pipeline: original read failed at %" PRIu32, (uint32_t) old_offset);
+                        success = false;
+                        break;
+                    }
+                    ARM_BS_AddDiff(&block->data[block->size], &run->data[index], copy_size);
+                    old_offset += copy_size;
+                } else {
+                    memcpy(&block->data[block->size], &run->data[index], copy_size);
+                }
+                block->size += copy_size;
+                new_offset += copy_size;
+                index += copy_size;
+
+                if (block->size == ARM_UC_DELTA_PAAL_PIPELINE_BLOCK_SIZE) {
+                    arm_uc_deltapaal_pipeline_queue_block();
+                    block = NULL;
+                }
+            }
+        }
+
+        pthread_mutex_lock(&arm_uc_deltapaal_pipeline.mutex);
+        arm_uc_deltapaal_pipeline.run_head = (arm_uc_deltapaal_pipeline.run_head + 1) % ARM_UC_DELTA_PAAL_PIPELINE_RUNS;
+        arm_uc_deltapaal_pipeline.run_count--;
+        pthread_cond_broadcast(&arm_uc_deltapaal_pipeline.run_cond);
+        pthread_mutex_unlock(&arm_uc_deltapaal_pipeline.mutex);
+    }
+
+    if (!success) {
+        arm_uc_deltapaal_pipeline_fail();
+    }
+    return NULL;
+}
+
+/*************************************************************************************
+ * Write thread, writes the new image blocks to the storage one at a time
+ */
+
+/**
+ * @brief Write thread, completes the last fragment once every block is written.
+ */
+static void *arm_uc_deltapaal_pipeline_write_thread(void *arg)
+{
+    bool success = true;
+    bool last = false;
+    bool signal = false;
+    (void)arg;
+
+    while (success && !last) {
+        pthread_mutex_lock(&arm_uc_deltapaal_pipeline.mutex);
+        while ((arm_uc_deltapaal_pipeline.block_count == 0) && !arm_uc_deltapaal_pipeline.stop) {
+            pthread_cond_wait(&arm_uc_deltapaal_pipeline.block_cond, &arm_uc_deltapaal_pipeline.mutex);
+        }
+        success = !arm_uc_deltapaal_pipeline.stop;
+        arm_uc_deltapaal_pipeline_block_t *block = &arm_uc_deltapaal_pipeline.blocks[arm_uc_deltapaal_pipeline.block_head];
+        arm_uc_deltapaal_pipeline.write_done = false;
+        pthread_mutex_unlock(&arm_uc_deltapaal_pipeline.mutex);
+
+        if (success && (block->size > 0)) {
+            /* the storage keeps the buffer until it reports the write done */
+            arm_uc_buffer_t buffer = {
+                .size_max = ARM_UC_DELTA_PAAL_PIPELINE_BLOCK_SIZE,
+                .size     = block->size,
+                .ptr      = block->data
+            };
+            arm_uc_error_t result = arm_uc_deltapaal_pipeline.storage->Write(arm_uc_deltapaal_pipeline.slot_id,
+                                                                             block->offset, &buffer);
+
+            pthread_mutex_lock(&arm_uc_deltapaal_pipeline.mutex);
+            if (result.code == ERR_NONE) {
+                while (!arm_uc_deltapaal_pipeline.write_done && !arm_uc_deltapaal_pipeline.stop) {
+                    pthread_cond_wait(&arm_uc_deltapaal_pipeline.block_cond, &arm_uc_deltapaal_pipeline.mutex);
+                }
+            } else {
+                UC_PAAL_ERR_MSG("delta pipeline: write at %" PRIu32 " failed with %" PRIx32, block->offset, result.code);
+            }
+            success = (result.code == ERR_NONE) && arm_uc_deltapaal_pipeline.write_done &&
+                      (arm_uc_deltapaal_pipeline.write_event == ARM_UC_PAAL_EVENT_WRITE_DONE);
+            pthread_mutex_unlock(&arm_uc_deltapaal_pipeline.mutex);
+        }
+
+        if (success) {
+            last = block->last;
+
+            pthread_mutex_lock(&arm_uc_deltapaal_pipeline.mutex);
+            arm_uc_deltapaal_pipeline.block_head = (arm_uc_deltapaal_pipeline.block_head + 1) %
+                                                   ARM_UC_DELTA_PAAL_PIPELINE_WRITE_BLOCKS;
+            arm_uc_deltapaal_pipeline.block_count--;
+            pthread_cond_broadcast(&arm_uc_deltapaal_pipeline.block_cond);
+            if (last) {
+                UC_PAAL_TRACE("delta pipeline: new image written, %" PRIu32 " bytes", block->offset + block->size);
+                arm_uc_deltapaal_pipeline.written = true;
+                signal = arm_uc_deltapaal_pipeline.patch_end;
+            }
+            pthread_mutex_unlock(&arm_uc_deltapaal_pipeline.mutex);
+        }
+    }
+
+    if (signal) {
+        arm_uc_deltapaal_pipeline_signal(ARM_UC_PAAL_EVENT_WRITE_DONE);
+    }
+    if (!success) {
+        arm_uc_deltapaal_pipeline_fail();
+    }
+    return NULL;
+}
+
+/*************************************************************************************
+ * Hub thread functions
+ */
+
+arm_uc_error_t arm_uc_deltapaal_pipeline_start(uint32_t slot_id,
+                                               const ARM_UC_PAAL_UPDATE *storage,
+                                               arm_uc_deltapaal_pipeline_read_old_t read_old,
+                                               ARM_UC_PAAL_UPDATE_SignalEvent_t signal)
+{
+    void *(*thread_function[ARM_UC_DELTA_PAAL_PIPELINE_THREADS])(void *) = {
+        arm_uc_deltapaal_pipeline_write_thread,
+        arm_uc_deltapaal_pipeline_patch_thread,
+        arm_uc_deltapaal_pipeline_decompress_thread
+    };
+    arm_uc_error_t result = { .code = ERR_INVALID_PARAMETER };
+
+    arm_uc_deltapaal_pipeline_stop();
+
+    if (storage && read_old && signal) {
+        arm_uc_deltapaal_pipeline.stop = false;
+        arm_uc_deltapaal_pipeline.failed = false;
+        arm_uc_deltapaal_pipeline.slot_id = slot_id;
+        arm_uc_deltapaal_pipeline.storage = storage;
+        arm_uc_deltapaal_pipeline.read_old = read_old;
+        arm_uc_deltapaal_pipeline.signal = signal;
+        arm_uc_deltapaal_pipeline.patch_head = 0;
+        arm_uc_deltapaal_pipeline.patch_count = 0;
+        arm_uc_deltapaal_pipeline.patch_end = false;
+        arm_uc_deltapaal_pipeline.decoded = false;
+        arm_uc_deltapaal_pipeline.written = false;
+        arm_uc_deltapaal_pipeline.pending = NULL;
+        arm_uc_deltapaal_pipeline.run_head = 0;
+        arm_uc_deltapaal_pipeline.run_count = 0;
+        arm_uc_deltapaal_pipeline.block_head = 0;
+        arm_uc_deltapaal_pipeline.block_count = 0;
+        arm_uc_deltapaal_pipeline.write_done = false;
+
+        ARM_BS_Init(&arm_uc_deltapaal_pipeline.decoder, NULL,
+                    arm_uc_deltapaal_pipeline_read_patch,
+                    NULL,
+                    arm_uc_deltapaal_pipeline_seek_old,
+                    arm_uc_deltapaal_pipeline_write_extra);
+        ARM_BS_SetDiffWriter(&arm_uc_deltapaal_pipeline.decoder, arm_uc_deltapaal_pipeline_write_diff);
+
+        result.code = ERR_NONE;
+        for (uint32_t index = 0; index < ARM_UC_DELTA_PAAL_PIPELINE_THREADS; index++) {
+            if (pthread_create(&arm_uc_deltapaal_pipeline.threads[index], NULL, thread_function[index], NULL) != 0) {
+                UC_PAAL_ERR_MSG("failed to start delta pipeline thread");
+                result.code = ERR_INVALID_STATE;
+                break;
+            }
+            arm_uc_deltapaal_pipeline.thread_count++;
+        }
+
+        if (result.code != ERR_NONE) {
+            arm_uc_deltapaal_pipeline_stop();
+        } else {
+            UC_PAAL_TRACE("delta pipeline started for slot %" PRIu32, slot_id);
+        }
+    }
+
+    return result;
+}
+
+arm_uc_error_t arm_uc_deltapaal_pipeline_write(const arm_uc_buffer_t *buffer, bool last)
+{
+    arm_uc_error_t result = { .code = ERR_INVALID_PARAMETER };
+    bool signal = false;
+
+    if (buffer && buffer->ptr && (buffer->size <= ARM_UC_DELTA_PAAL_PIPELINE_PATCH_SIZE)) {
+        pthread_mutex_lock(&arm_uc_deltapaal_pipeline.mutex);
+        if ((arm_uc_deltapaal_pipeline.thread_count == 0) || arm_uc_deltapaal_pipeline.stop ||
+                arm_uc_deltapaal_pipeline.pending || arm_uc_deltapaal_pipeline.patch_end) {
+            result.code = ERR_INVALID_STATE;
+        } else {
+            result.code = ERR_NONE;
+            arm_uc_deltapaal_pipeline.pending = buffer;
+            arm_uc_deltapaal_pipeline.pending_last = last;
+            /* otherwise the decompress thread takes the fragment when it has made room */
+            signal = arm_uc_deltapaal_pipeline_accept_pending();
+        }
+        pthread_mutex_unlock(&arm_uc_deltapaal_pipeline.mutex);
+    }
+
+    if (signal) {
+        arm_uc_deltapaal_pipeline_signal(ARM_UC_PAAL_EVENT_WRITE_DONE);
+    }
+    return result;
+}
+
+void arm_uc_deltapaal_pipeline_storage_event(uintptr_t event)
+{
+    pthread_mutex_lock(&arm_uc_deltapaal_pipeline.mutex);
+    arm_uc_deltapaal_pipeline.write_event = event;
+    arm_uc_deltapaal_pipeline.write_done = true;
+    pthread_cond_broadcast(&arm_uc_deltapaal_pipeline.block_cond);
+    pthread_mutex_unlock(&arm_uc_deltapaal_pipeline.mutex);
+}
+
+void arm_uc_deltapaal_pipeline_stop(void)
+{
+    if (arm_uc_deltapaal_pipeline.thread_count > 0) {
+        pthread_mutex_lock(&arm_uc_deltapaal_pipeline.mutex);
+        arm_uc_deltapaal_pipeline.stop = true;
+        pthread_cond_broadcast(&arm_uc_deltapaal_pipeline.patch_cond);
+        pthread_cond_broadcast(&arm_uc_deltapaal_pipeline.run_cond);
+        pthread_cond_broadcast(&arm_uc_deltapaal_pipeline.block_cond);
+        pthread_mutex_unlock(&arm_uc_deltapaal_pipeline.mutex);
+
+        for (uint32_t index = 0; index < arm_uc_deltapaal_pipeline.thread_count; index++) {
+            pthread_join(arm_uc_deltapaal_pipeline.threads[index], NULL);
+        }
+    }
+    arm_uc_deltapaal_pipeline.thread_count = 0;
+    arm_uc_deltapaal_pipeline.pending = NULL;
+}
+
+bool arm_uc_deltapaal_pipeline_is_running(void)
+{
+    return (arm_uc_deltapaal_pipeline.thread_count > 0);
+}
+
+#endif // ARM_UC_DELTA_PAAL_PIPELINE
+#endif // ARM_UC_FEATURE_DELTA_PAAL
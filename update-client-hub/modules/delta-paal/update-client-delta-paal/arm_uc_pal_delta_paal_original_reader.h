@@ -8,8 +8,27 @@
 extern "C" {
 #endif
 
+/* Original image read statistics. Cache lookups served without touching
+   storage count as hits, blocks loaded from storage as misses. Blocks taken
+   from the prefetch queue on a cache miss count as prefetched instead of
+   misses. With the image mapped into memory every read is a hit.
+*/
+typedef struct {
+    uint32_t reads;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t prefetched;
+    uint64_t bytes_loaded;
+} arm_uc_deltapaal_original_reader_stats_t;
+
 int arm_uc_deltapaal_original_reader(void* buffer, uint64_t length, uint32_t offset);
 
+void arm_uc_deltapaal_original_reader_reset(void);
+
+void arm_uc_deltapaal_original_reader_finish(void);
+
+arm_uc_deltapaal_original_reader_stats_t arm_uc_deltapaal_original_reader_get_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,91 @@
+// ----------------------------------------------------------------------------
+// Copyright 2019 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef ARM_UC_PAL_DELTA_PAAL_PIPELINE_H
+#define ARM_UC_PAL_DELTA_PAAL_PIPELINE_H
+
+#include "arm_uc_config.h"
+#include "update-client-paal/arm_uc_paal_update_api.h"
+
+#include <stdbool.h>
+
+#if !defined(TARGET_LIKE_MBED) && defined(ARM_UC_FEATURE_DELTA_PAAL_PIPELINE) && (ARM_UC_FEATURE_DELTA_PAAL_PIPELINE == 1)
+#define ARM_UC_DELTA_PAAL_PIPELINE 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Reads length bytes of the original image at offset, as arm_uc_deltapaal_original_reader does.
+   Called on the patch thread only. Returns ERR_NONE on success.
+*/
+typedef int (*arm_uc_deltapaal_pipeline_read_old_t)(void *buffer, uint64_t length, uint32_t offset);
+
+/**
+ * @brief Start the decompress, patch and write threads for a new patch.
+ * @details Patch fragments given to arm_uc_deltapaal_pipeline_write are
+ *          decompressed on one thread, added to the original image on a
+ *          second and written to the storage on a third. Bounded queues
+ *          connect the threads.
+ * @param slot_id Storage location ID the new image is written to.
+ * @param storage Storage the new image is written to. Its events must be
+ *        passed to arm_uc_deltapaal_pipeline_storage_event.
+ * @param read_old Original image reader.
+ * @param signal Handler called on the hub thread with WRITE_DONE for each
+ *        fragment, or WRITE_ERROR if the patch cannot be applied.
+ * @return ERR_NONE if the threads are running.
+ */
+arm_uc_error_t arm_uc_deltapaal_pipeline_start(uint32_t slot_id,
+                                               const ARM_UC_PAAL_UPDATE *storage,
+                                               arm_uc_deltapaal_pipeline_read_old_t read_old,
+                                               ARM_UC_PAAL_UPDATE_SignalEvent_t signal);
+
+/**
+ * @brief Queue the next patch fragment.
+ * @details The fragment is copied before WRITE_DONE is signalled for it, so
+ *          the caller may reuse the buffer then. WRITE_DONE for the last
+ *          fragment is signalled once the whole new image is written.
+ * @param buffer Patch fragment.
+ * @param last True for the last fragment of the patch.
+ * @return ERR_NONE on accept, and the handler is signalled later.
+ */
+arm_uc_error_t arm_uc_deltapaal_pipeline_write(const arm_uc_buffer_t *buffer, bool last);
+
+/**
+ * @brief Pass a WRITE_DONE or WRITE_ERROR event of the storage to the write thread.
+ * @details May be called from any thread, also from within the storage Write call.
+ * @param event Storage event.
+ */
+void arm_uc_deltapaal_pipeline_storage_event(uintptr_t event);
+
+/**
+ * @brief Stop and join the threads, dropping any queued data.
+ */
+void arm_uc_deltapaal_pipeline_stop(void);
+
+/**
+ * @brief Check whether the threads were started for the current patch.
+ */
+bool arm_uc_deltapaal_pipeline_is_running(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARM_UC_PAL_DELTA_PAAL_PIPELINE_H */
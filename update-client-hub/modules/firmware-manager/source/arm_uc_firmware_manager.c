@@ -28,6 +28,8 @@ static ARM_UCFM_SignalEvent_t ucfm_handler = NULL;
 
 static ARM_UCFM_Setup_t *package_configuration = NULL;
 static uint32_t package_offset = 0;
+/* end of the plaintext produced so far, ahead of package_offset when Decrypt runs ahead of Write */
+static uint32_t decrypt_offset = 0;
 static bool ready_to_receive = false;
 
 static arm_uc_callback_t arm_uc_event_handler_callback = { 0 };
@@ -37,6 +39,12 @@ static arm_uc_cipherHandle_t cipherHandle = { 0 };
 static arm_uc_buffer_t *front_buffer = NULL;
 static arm_uc_buffer_t *back_buffer = NULL;
 
+#if defined(ARM_UC_FEATURE_HASH_ON_WRITE) && (ARM_UC_FEATURE_HASH_ON_WRITE == 1)
+/* hash context updated by ARM_UCFM_Write, valid when write_hash_active is set */
+static arm_uc_mdHandle_t write_mdHandle = { 0 };
+static bool write_hash_active = false;
+#endif
+
 #define UCFM_DEBUG_OUTPUT 0
 
 
@@ -118,6 +126,93 @@ static void debug_output_validation(arm_uc_buffer_t *hash,
 
 /******************************************************************************/
 
+/* Finish the hash calculation in handle and compare the result with the hash
+   in the package configuration. Returns the event to signal:
+   UCFM_EVENT_FINALIZE_DONE on match, UCFM_EVENT_FINALIZE_INVALID_HASH_ERROR
+   on mismatch and UCFM_EVENT_FINALIZE_ERROR if the digest could not be
+   compared.
+*/
+static uint32_t arm_uc_internal_finish_hash(arm_uc_mdHandle_t *handle)
+{
+    uint32_t event = UCFM_EVENT_FINALIZE_ERROR;
+
+    uint8_t hash_output_ptr[2 * UCFM_MAX_BLOCK_SIZE];
+    arm_uc_buffer_t hash_buffer = {
+        .size_max = sizeof(hash_output_ptr),
+        .size = 0,
+        .ptr = hash_output_ptr
+    };
+
+    ARM_UC_cryptoHashFinish(handle, &hash_buffer);
+
+    /* size check before memcmp call */
+    if (hash_buffer.size == package_configuration->hash->size) {
+        int diff = memcmp(hash_buffer.ptr,
+                          package_configuration->hash->ptr,
+                          package_configuration->hash->size);
+
+#if UCFM_DEBUG_OUTPUT
+        debug_output_validation(package_configuration->hash,
+                                &hash_buffer);
+#endif
+
+        /* hash matches */
+        if (diff == 0) {
+            event = UCFM_EVENT_FINALIZE_DONE;
+        } else {
+            /* use specific event for "invalid hash" */
+            UC_FIRM_ERR_MSG("Invalid image hash");
+
+            event = UCFM_EVENT_FINALIZE_INVALID_HASH_ERROR;
+        }
+    }
+
+    return event;
+}
+
+#if defined(ARM_UC_FEATURE_HASH_ON_WRITE) && (ARM_UC_FEATURE_HASH_ON_WRITE == 1)
+/* Release the write hash context, e.g. left over from an aborted download. */
+static void arm_uc_internal_discard_write_hash(void)
+{
+    if (write_hash_active) {
+        uint8_t scratch_ptr[ARM_UC_SHA256_SIZE];
+        arm_uc_buffer_t scratch = {
+            .size_max = sizeof(scratch_ptr),
+            .size = 0,
+            .ptr = scratch_ptr
+        };
+
+        ARM_UC_cryptoHashFinish(&write_mdHandle, &scratch);
+        write_hash_active = false;
+    }
+}
+
+/* Start hashing written fragments. Delta updates write the patch, not the
+   image, so their hash is always calculated from storage during finalize.
+*/
+static void arm_uc_internal_setup_write_hash(const ARM_UCFM_Setup_t *configuration)
+{
+    arm_uc_internal_discard_write_hash();
+
+#if defined(ARM_UC_FEATURE_DELTA_PAAL) && (ARM_UC_FEATURE_DELTA_PAAL == 1)
+    if (configuration->is_delta) {
+        return;
+    }
+#else
+    (void) configuration;
+#endif
+
+    arm_uc_error_t result = ARM_UC_cryptoHashSetup(&write_mdHandle, ARM_UC_CU_SHA256);
+
+    if (result.error == ERR_NONE) {
+        write_hash_active = true;
+    } else {
+        /* not fatal, finalize falls back to hashing the stored image */
+        UC_FIRM_ERR_MSG("ARM_UC_cryptoHashSetup failed, hashing from storage");
+    }
+}
+#endif
+
 /* Hash calculation is performed using the output buffer. This function fills
    the output buffer with data from the PAL.
 */
@@ -169,42 +264,16 @@ static void arm_uc_internal_process_hash(void)
                                       back_buffer);
             }
         } else {
-            /* invert status code so that it has to be set explicitly for success */
-            status.code = FIRM_ERR_INVALID_PARAMETER;
+            /* finalize hash calculation and compare with the manifest */
+            uint32_t event = arm_uc_internal_finish_hash(&mdHandle);
 
-            /* finalize hash calculation */
-            uint8_t hash_output_ptr[2 * UCFM_MAX_BLOCK_SIZE];
-            arm_uc_buffer_t hash_buffer = {
-                .size_max = sizeof(hash_output_ptr),
-                .size = 0,
-                .ptr = hash_output_ptr
-            };
+            if (event == UCFM_EVENT_FINALIZE_DONE) {
+                UC_FIRM_TRACE("UCFM_EVENT_FINALIZE_DONE");
 
-            ARM_UC_cryptoHashFinish(&mdHandle, &hash_buffer);
-
-            /* size check before memcmp call */
-            if (hash_buffer.size == package_configuration->hash->size) {
-                int diff = memcmp(hash_buffer.ptr,
-                                  package_configuration->hash->ptr,
-                                  package_configuration->hash->size);
-
-#if UCFM_DEBUG_OUTPUT
-                debug_output_validation(package_configuration->hash,
-                                        &hash_buffer);
-#endif
-
-                /* hash matches */
-                if (diff == 0) {
-                    UC_FIRM_TRACE("UCFM_EVENT_FINALIZE_DONE");
-
-                    arm_uc_signal_ucfm_handler(UCFM_EVENT_FINALIZE_DONE);
-                    status.code = ERR_NONE;
-                } else {
-                    /* use specific event for "invalid hash" */
-                    UC_FIRM_ERR_MSG("Invalid image hash");
-
-                    error_event = UCFM_EVENT_FINALIZE_INVALID_HASH_ERROR;
-                }
+                arm_uc_signal_ucfm_handler(UCFM_EVENT_FINALIZE_DONE);
+            } else {
+                status.code = FIRM_ERR_INVALID_PARAMETER;
+                error_event = event;
             }
         }
 
@@ -231,6 +300,29 @@ static void event_handler_finalize(void)
 {
     UC_FIRM_TRACE("event_handler_finalize");
 
+#if defined(ARM_UC_FEATURE_HASH_ON_WRITE) && (ARM_UC_FEATURE_HASH_ON_WRITE == 1)
+    /* hash was calculated while writing, only the digests need comparing */
+    if (write_hash_active) {
+        write_hash_active = false;
+
+        uint32_t event = arm_uc_internal_finish_hash(&write_mdHandle);
+
+        if (event != UCFM_EVENT_FINALIZE_DONE) {
+            UC_FIRM_TRACE("UCFM_EVENT_FINALIZE_ERROR");
+            arm_uc_signal_ucfm_handler(event);
+            return;
+        }
+
+#if !(defined(ARM_UC_FEATURE_HASH_ON_WRITE_VERIFY_STORAGE) && \
+      (ARM_UC_FEATURE_HASH_ON_WRITE_VERIFY_STORAGE == 1))
+        UC_FIRM_TRACE("UCFM_EVENT_FINALIZE_DONE");
+        arm_uc_signal_ucfm_handler(UCFM_EVENT_FINALIZE_DONE);
+        return;
+#endif
+        /* paranoid mode: also verify what was actually stored */
+    }
+#endif
+
     /* setup mandatory hash */
     arm_uc_mdType_t mdtype = ARM_UC_CU_SHA256;
     arm_uc_error_t result = ARM_UC_cryptoHashSetup(&mdHandle, mdtype);
@@ -390,7 +482,12 @@ static arm_uc_error_t ARM_UCFM_Prepare(ARM_UCFM_Setup_t *configuration,
     if (result.error == ERR_NONE) {
         package_configuration = configuration;
         package_offset = 0;
+        decrypt_offset = 0;
         ready_to_receive = true;
+
+#if defined(ARM_UC_FEATURE_HASH_ON_WRITE) && (ARM_UC_FEATURE_HASH_ON_WRITE == 1)
+        arm_uc_internal_setup_write_hash(configuration);
+#endif
     } else {
         if (result.code == PAAL_ERR_FIRMWARE_TOO_LARGE) {
             arm_uc_signal_ucfm_handler(UCFM_EVENT_FIRMWARE_TOO_LARGE_ERROR);
@@ -402,9 +499,51 @@ static arm_uc_error_t ARM_UCFM_Prepare(ARM_UCFM_Setup_t *configuration,
     return result;
 }
 
-static arm_uc_error_t ARM_UCFM_Write(const arm_uc_buffer_t *fragment)
+/* Decrypt fragment in place, continuing the cipher stream where the last call ended. */
+static void arm_uc_internal_decrypt(const arm_uc_buffer_t *fragment)
 {
-    UC_FIRM_TRACE("ARM_UCFM_Write");
+    /* temporary buffer for decrypting in place */
+    uint8_t decrypt_output_ptr[2 * UCFM_MAX_BLOCK_SIZE];
+    arm_uc_buffer_t decrypt_buffer = {
+        .size_max = sizeof(decrypt_output_ptr),
+        .size = 0,
+        .ptr = decrypt_output_ptr
+    };
+
+    uint32_t fragment_offset = 0;
+    while (fragment_offset < fragment->size) {
+        /* default to max length */
+        uint32_t length_update = decrypt_buffer.size_max;
+
+        /* adjust size to not overshoot */
+        if (fragment_offset + length_update > fragment->size) {
+            length_update = fragment->size - fragment_offset;
+        }
+
+        /* decrypt part of the fragment using the offset */
+        ARM_UC_cryptoDecryptUpdate(&cipherHandle,
+                                   &fragment->ptr[fragment_offset],
+                                   length_update,
+                                   &decrypt_buffer);
+
+#if UCFM_DEBUG_OUTPUT
+        debug_output_decryption(&fragment->ptr[fragment_offset],
+                                &decrypt_buffer);
+#endif
+
+        /* overwrite the encrypted data with the decrypted data */
+        memcpy(&fragment->ptr[fragment_offset],
+               decrypt_buffer.ptr,
+               length_update);
+
+        /* update offset */
+        fragment_offset += length_update;
+    }
+}
+
+static arm_uc_error_t ARM_UCFM_Decrypt(arm_uc_buffer_t *fragment)
+{
+    UC_FIRM_TRACE("ARM_UCFM_Decrypt");
 
     arm_uc_error_t result = (arm_uc_error_t) { ERR_NONE };
 
@@ -412,46 +551,30 @@ static arm_uc_error_t ARM_UCFM_Write(const arm_uc_buffer_t *fragment)
         result = (arm_uc_error_t) { FIRM_ERR_INVALID_PARAMETER };
     } else if (!ready_to_receive) {
         result = (arm_uc_error_t) { FIRM_ERR_UNINITIALIZED };
-    } else {
-        /* decrypt fragment before writing to PAL */
-        if (package_configuration->mode != UCFM_MODE_NONE_SHA_256) {
-            /* temporary buffer for decrypting in place */
-            uint8_t decrypt_output_ptr[2 * UCFM_MAX_BLOCK_SIZE];
-            arm_uc_buffer_t decrypt_buffer = {
-                .size_max = sizeof(decrypt_output_ptr),
-                .size = 0,
-                .ptr = decrypt_output_ptr
-            };
-
-            uint32_t fragment_offset = 0;
-            while (fragment_offset < fragment->size) {
-                /* default to max length */
-                uint32_t length_update = decrypt_buffer.size_max;
-
-                /* adjust size to not overshoot */
-                if (fragment_offset + length_update > fragment->size) {
-                    length_update = fragment->size - fragment_offset;
-                }
+    } else if (package_configuration->mode != UCFM_MODE_NONE_SHA_256) {
+        arm_uc_internal_decrypt(fragment);
+        decrypt_offset += fragment->size;
+    }
 
-                /* decrypt part of the fragment using the offset */
-                ARM_UC_cryptoDecryptUpdate(&cipherHandle,
-                                           &fragment->ptr[fragment_offset],
-                                           length_update,
-                                           &decrypt_buffer);
+    return result;
+}
 
-#if UCFM_DEBUG_OUTPUT
-                debug_output_decryption(&fragment->ptr[fragment_offset],
-                                        &decrypt_buffer);
-#endif
+static arm_uc_error_t ARM_UCFM_Write(const arm_uc_buffer_t *fragment)
+{
+    UC_FIRM_TRACE("ARM_UCFM_Write");
 
-                /* overwrite the encrypted data with the decrypted data */
-                memcpy(&fragment->ptr[fragment_offset],
-                       decrypt_buffer.ptr,
-                       length_update);
+    arm_uc_error_t result = (arm_uc_error_t) { ERR_NONE };
 
-                /* update offset */
-                fragment_offset += length_update;
-            }
+    if (!fragment || fragment->size_max == 0 || fragment->size > fragment->size_max || !fragment->ptr) {
+        result = (arm_uc_error_t) { FIRM_ERR_INVALID_PARAMETER };
+    } else if (!ready_to_receive) {
+        result = (arm_uc_error_t) { FIRM_ERR_UNINITIALIZED };
+    } else {
+        /* decrypt fragment before writing to PAL, unless Decrypt already did */
+        if ((package_configuration->mode != UCFM_MODE_NONE_SHA_256) &&
+                (decrypt_offset <= package_offset)) {
+            arm_uc_internal_decrypt(fragment);
+            decrypt_offset = package_offset + fragment->size;
         }
 
         /* store fragment using PAL */
@@ -460,6 +583,26 @@ static arm_uc_error_t ARM_UCFM_Write(const arm_uc_buffer_t *fragment)
                                fragment);
 
         if (result.error == ERR_NONE) {
+#if defined(ARM_UC_FEATURE_HASH_ON_WRITE) && (ARM_UC_FEATURE_HASH_ON_WRITE == 1)
+            if (write_hash_active) {
+                /* hash the plaintext, ignoring anything past the package size */
+                arm_uc_buffer_t plaintext = *fragment;
+
+                if (package_offset >= package_configuration->package_size) {
+                    plaintext.size = 0;
+                } else if (plaintext.size > package_configuration->package_size - package_offset) {
+                    plaintext.size = package_configuration->package_size - package_offset;
+                }
+
+                arm_uc_error_t hash_result = ARM_UC_cryptoHashUpdate(&write_mdHandle, &plaintext);
+
+                if (hash_result.error != ERR_NONE) {
+                    /* fall back to hashing the stored image during finalize */
+                    UC_FIRM_ERR_MSG("ARM_UC_cryptoHashUpdate failed, hashing from storage");
+                    arm_uc_internal_discard_write_hash();
+                }
+            }
+#endif
             package_offset += fragment->size;
         }
     }
@@ -557,6 +700,7 @@ static arm_uc_error_t ARM_UCFM_GetInstallerDetails(arm_uc_installer_details_t *d
 ARM_UC_FIRMWARE_MANAGER_t ARM_UC_FirmwareManager = {
     .Initialize               = ARM_UCFM_Initialize,
     .Prepare                  = ARM_UCFM_Prepare,
+    .Decrypt                  = ARM_UCFM_Decrypt,
     .Write                    = ARM_UCFM_Write,
     .Finalize                 = ARM_UCFM_Finalize,
     .Activate                 = ARM_UCFM_Activate,
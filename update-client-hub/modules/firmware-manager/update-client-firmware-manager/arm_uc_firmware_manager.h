@@ -85,6 +85,18 @@ typedef struct _ARM_UC_FIRMWARE_MANAGER {
                               const arm_uc_firmware_details_t *details,
                               arm_uc_buffer_t *buffer);
 
+    /**
+     * @brief Function for decrypting a package fragment ahead of writing it.
+     * @details Decrypts in place, so the fragment can be passed to Write later
+     *          while other fragments are still being received. Fragments must
+     *          be decrypted in package order, and Write skips decryption for
+     *          fragments that went through this call. Does nothing in
+     *          UCFM_MODE_NONE_SHA_256.
+     * @param fragment Buffer struct.
+     * @return Error code.
+     */
+    arm_uc_error_t (*Decrypt)(arm_uc_buffer_t *fragment);
+
     /**
      * @brief Function for adding a package fragment.
      * @details Generates either UCFM_EVENT_WRITE_DONE or UCFM_EVENT_WRITE_ERROR.
@@ -79,11 +79,58 @@ static void arm_uc_get_data_req_error_callback(get_data_req_error_t error_code,
 #error SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE must be divisible by the block page size
 #endif
 
+/* Blocks requested ahead are buffered at the maximum CoAP block size */
+#if (ARM_UC_COAP_BLOCK_WINDOW > 1) && !(SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE > 0)
+#error SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE must be set to use ARM_UC_COAP_BLOCK_WINDOW
+#endif
+
 #ifndef LWM2M_SOURCE_USE_C_API
 /* M2MInterface */
 static M2MInterface *arm_ucs_m2m_interface = NULL;
 #endif
 
+/* firmware URI string, built once per download */
+static char *arm_ucs_firmware_uri = NULL;
+
+#if ARM_UC_COAP_BLOCK_WINDOW > 1
+static void arm_uc_get_data_req_window_callback(const uint8_t *buffer, size_t buffer_size, size_t total_size,
+                                                bool last_block, void *context);
+static void arm_uc_get_data_req_window_error_callback(get_data_req_error_t error_code, void *context);
+
+typedef enum {
+    ARM_UCS_BLOCK_FREE,
+    ARM_UCS_BLOCK_PENDING,
+    ARM_UCS_BLOCK_READY,
+    ARM_UCS_BLOCK_FAILED,
+    ARM_UCS_BLOCK_STALE     // response still in flight, but no longer wanted
+} arm_ucs_block_state_t;
+
+typedef struct {
+    arm_ucs_block_state_t state;
+    uint32_t download;
+    uint32_t offset;
+    uint32_t size;
+    uint8_t data[SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE];
+} arm_ucs_block_slot_t;
+
+/* blocks requested ahead of the hub, kept until the hub asks for them */
+static arm_ucs_block_slot_t arm_ucs_block_window[ARM_UC_COAP_BLOCK_WINDOW - 1];
+
+/* hub buffer waiting for a block that is still in flight */
+static arm_uc_buffer_t *arm_ucs_block_waiting_buffer = NULL;
+static arm_ucs_block_slot_t *arm_ucs_block_waiting_slot = NULL;
+
+/* changes with the firmware URI, so stale blocks of an old download are not reused */
+static uint32_t arm_ucs_block_download = 0;
+
+/* offset of the block requested straight into the hub buffer */
+static uint32_t arm_ucs_block_direct_offset = 0;
+
+/* block size chosen by the server and firmware size, learnt from responses */
+static uint32_t arm_ucs_block_size = 0;
+static uint32_t arm_ucs_firmware_size = 0;
+#endif
+
 #endif // ARM_UC_FEATURE_FW_SOURCE_COAP
 
 #ifdef LWM2M_SOURCE_USE_C_API
@@ -195,6 +242,10 @@ arm_uc_error_t ARM_UCS_LWM2M_SOURCE_Initialize(ARM_SOURCE_SignalEvent_t cb_event
 arm_uc_error_t ARM_UCS_LWM2M_SOURCE_Uninitialize(void)
 {
     ARM_UC_INIT_ERROR(retval, ERR_NONE);
+#if defined(ARM_UC_FEATURE_FW_SOURCE_COAP) && (ARM_UC_FEATURE_FW_SOURCE_COAP == 1)
+    delete[] arm_ucs_firmware_uri;
+    arm_ucs_firmware_uri = NULL;
+#endif
 #ifndef LWM2M_SOURCE_USE_C_API
     DeviceMetadataResource::Uninitialize();
     FirmwareUpdateResource::Uninitialize();
@@ -368,6 +419,265 @@ arm_uc_error_t ARM_UCS_LWM2M_SOURCE_GetFirmwareURLCost(arm_uc_uri_t *uri,
 }
 
 
+#if defined(ARM_UC_FEATURE_FW_SOURCE_COAP) && (ARM_UC_FEATURE_FW_SOURCE_COAP == 1)
+/**
+ * @brief Check if the cached firmware URI string was built from the URI struct.
+ */
+static bool arm_ucs_firmware_uri_matches(const char *scheme, arm_uc_uri_t *uri)
+{
+    const char *cached = arm_ucs_firmware_uri;
+    size_t length = strlen(scheme);
+
+    if (strncmp(cached, scheme, length) != 0) {
+        return false;
+    }
+    cached += length;
+
+    length = strlen(uri->host);
+    if (strncmp(cached, uri->host, length) != 0) {
+        return false;
+    }
+    cached += length;
+
+    return (strcmp(cached, uri->path) == 0);
+}
+
+/**
+ * @brief Get the firmware URI string for a fragment request.
+ * @details The string is built once per download and reused for all fragments
+ *          until the URI changes.
+ *
+ * @param uri URI struct with firmware location.
+ * @param rebuilt Set to true if the string was built for a new URI.
+ * @return URI string, NULL if the scheme is not supported or allocation failed.
+ */
+static const char *arm_ucs_get_firmware_uri(arm_uc_uri_t *uri, bool *rebuilt)
+{
+    const char *scheme = NULL;
+
+    *rebuilt = false;
+
+    if (uri->scheme == URI_SCHEME_COAPS) {
+        scheme = "coaps://";
+    } else if (uri->scheme == URI_SCHEME_HTTP) {
+        scheme = "http://";
+    }
+
+    if ((scheme == NULL) ||
+        (arm_ucs_firmware_uri == NULL) ||
+        !arm_ucs_firmware_uri_matches(scheme, uri)) {
+
+        delete[] arm_ucs_firmware_uri;
+        arm_ucs_firmware_uri = NULL;
+
+        if (scheme) {
+            int length = snprintf(NULL, 0, "%s%s%s", scheme, uri->host, uri->path);
+
+            if (length > 0) {
+                arm_ucs_firmware_uri = new char[length + 1];
+
+                if (arm_ucs_firmware_uri) {
+                    snprintf(arm_ucs_firmware_uri, length + 1, "%s%s%s", scheme, uri->host, uri->path);
+                }
+            }
+        }
+
+        *rebuilt = true;
+    }
+
+    return arm_ucs_firmware_uri;
+}
+
+/**
+ * @brief Request one firmware block through the M2M interface.
+ */
+static void arm_ucs_send_get_data_request(const char *firmware_uri,
+                                          uint32_t offset,
+                                          get_data_cb data_cb,
+                                          get_data_error_cb error_cb,
+                                          void *context)
+{
+    /* Requested length defaults to the CoAP packet size when the asynchronous flag is set to true. */
+#ifndef LWM2M_SOURCE_USE_C_API
+    arm_ucs_m2m_interface->get_data_request(FIRMWARE_DOWNLOAD,
+                                            firmware_uri,
+                                            offset,
+                                            true,
+                                            data_cb,
+                                            error_cb,
+                                            context);
+#else
+    get_handler_send_get_data_request(endpoint,
+                                      FIRMWARE_DOWNLOAD,
+                                      firmware_uri,
+                                      offset,
+                                      true,
+                                      data_cb,
+                                      error_cb,
+                                      context);
+#endif
+}
+
+#if ARM_UC_COAP_BLOCK_WINDOW > 1
+/**
+ * @brief Give up on a block in the window.
+ * @details A block still in flight is kept as stale until its response arrives,
+ *          so the slot is not reused for another block in the meantime.
+ */
+static void arm_ucs_block_release(arm_ucs_block_slot_t *slot)
+{
+    if (slot->state == ARM_UCS_BLOCK_PENDING) {
+        slot->state = ARM_UCS_BLOCK_STALE;
+    } else if (slot->state != ARM_UCS_BLOCK_STALE) {
+        slot->state = ARM_UCS_BLOCK_FREE;
+    }
+
+    if (slot == arm_ucs_block_waiting_slot) {
+        arm_ucs_block_waiting_slot = NULL;
+        arm_ucs_block_waiting_buffer = NULL;
+    }
+}
+
+/**
+ * @brief Drop all blocks in the window and forget what was learnt about the download.
+ */
+static void arm_ucs_block_window_reset(void)
+{
+    for (size_t index = 0; index < ARM_UC_COAP_BLOCK_WINDOW - 1; index++) {
+        arm_ucs_block_release(&arm_ucs_block_window[index]);
+    }
+
+    arm_ucs_block_size = 0;
+    arm_ucs_firmware_size = 0;
+}
+
+/**
+ * @brief Record the block size and firmware size from a response.
+ */
+static void arm_ucs_block_learn(uint32_t offset, size_t buffer_size, size_t total_size, bool last_block)
+{
+    if (last_block) {
+        arm_ucs_firmware_size = offset + buffer_size;
+    } else if (buffer_size > 0) {
+        /* blocks requested with the old size no longer line up with the hub */
+        if (arm_ucs_block_size && (arm_ucs_block_size != buffer_size)) {
+            arm_ucs_block_window_reset();
+        }
+        arm_ucs_block_size = buffer_size;
+
+        if (total_size > 0) {
+            arm_ucs_firmware_size = total_size;
+        }
+    }
+}
+
+/**
+ * @brief Find the block starting at the given offset in the window.
+ * @details A stale request for the block is taken back, since the M2M interface
+ *          merges a new request for the same block into the one in flight.
+ * @return Slot holding or fetching the block, NULL if not in the window.
+ */
+static arm_ucs_block_slot_t *arm_ucs_block_window_find(uint32_t offset)
+{
+    for (size_t index = 0; index < ARM_UC_COAP_BLOCK_WINDOW - 1; index++) {
+        arm_ucs_block_slot_t *slot = &arm_ucs_block_window[index];
+
+        if ((slot->state != ARM_UCS_BLOCK_FREE) &&
+            (slot->download == arm_ucs_block_download) &&
+            (slot->offset == offset)) {
+            if (slot->state == ARM_UCS_BLOCK_STALE) {
+                slot->state = ARM_UCS_BLOCK_PENDING;
+            }
+            return slot;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Move the window to start at the given offset.
+ * @details Blocks outside the window are released and the free slots are used to
+ *          request the blocks following the offset.
+ */
+static void arm_ucs_block_window_move(const char *firmware_uri, uint32_t offset)
+{
+    uint32_t window_end = offset + (ARM_UC_COAP_BLOCK_WINDOW * arm_ucs_block_size);
+
+    for (size_t index = 0; index < ARM_UC_COAP_BLOCK_WINDOW - 1; index++) {
+        arm_ucs_block_slot_t *slot = &arm_ucs_block_window[index];
+
+        if ((slot->state != ARM_UCS_BLOCK_FREE) &&
+            ((slot->offset < offset) || (slot->offset >= window_end))) {
+            arm_ucs_block_release(slot);
+        }
+    }
+
+    /* the block size is only known once the server has sent a full block */
+    if (arm_ucs_block_size == 0) {
+        return;
+    }
+
+    for (uint32_t block = 1; block < ARM_UC_COAP_BLOCK_WINDOW; block++) {
+        uint32_t block_offset = offset + (block * arm_ucs_block_size);
+
+        if ((block_offset < offset) ||
+            (arm_ucs_firmware_size && (block_offset >= arm_ucs_firmware_size))) {
+            break;
+        }
+
+        if (arm_ucs_block_window_find(block_offset) == NULL) {
+            arm_ucs_block_slot_t *slot = NULL;
+
+            for (size_t index = 0; index < ARM_UC_COAP_BLOCK_WINDOW - 1; index++) {
+                if (arm_ucs_block_window[index].state == ARM_UCS_BLOCK_FREE) {
+                    slot = &arm_ucs_block_window[index];
+                    break;
+                }
+            }
+
+            if (slot == NULL) {
+                break;
+            }
+
+            slot->state = ARM_UCS_BLOCK_PENDING;
+            slot->download = arm_ucs_block_download;
+            slot->offset = block_offset;
+            slot->size = 0;
+
+            arm_ucs_send_get_data_request(firmware_uri,
+                                          block_offset,
+                                          arm_uc_get_data_req_window_callback,
+                                          arm_uc_get_data_req_window_error_callback,
+                                          slot);
+        }
+    }
+}
+
+/**
+ * @brief Hand a received block from the window over to the hub.
+ */
+static void arm_ucs_block_deliver(arm_ucs_block_slot_t *slot, arm_uc_buffer_t *output_buffer)
+{
+    uint32_t event = EVENT_ERROR;
+
+    if (output_buffer->size_max >= slot->size) {
+        memcpy(output_buffer->ptr, slot->data, slot->size);
+        output_buffer->size = slot->size;
+        event = EVENT_FIRMWARE;
+    }
+
+    slot->state = ARM_UCS_BLOCK_FREE;
+
+    if (ARM_UCS_EventHandler) {
+        ARM_UC_PostCallback(&callbackNodeData,
+                            ARM_UCS_EventHandler,
+                            event);
+    }
+}
+#endif // ARM_UC_COAP_BLOCK_WINDOW
+#endif // ARM_UC_FEATURE_FW_SOURCE_COAP
+
 /**
  * @brief Retrieve firmware fragment.
  * @details Firmware fragment is stored in supplied buffer.
@@ -399,35 +709,49 @@ arm_uc_error_t ARM_UCS_LWM2M_SOURCE_GetFirmwareFragment(arm_uc_uri_t *uri,
                       " offset: %" PRIu32, (const char *) uri->host, uri->path, buffer->size, buffer->size_max, offset);
 
         /* Convert URI struct back to URI string. */
-        buffer->size = 0;
-        if (uri->scheme == URI_SCHEME_COAPS) {
-            buffer->size = snprintf((char*) buffer->ptr, buffer->size_max, "coaps://%s%s", uri->host, uri->path);
-        } else if (uri->scheme == URI_SCHEME_HTTP) {
-            buffer->size = snprintf((char*) buffer->ptr, buffer->size_max, "http://%s%s", uri->host, uri->path);
-        }
-        buffer->ptr[buffer->size] = '\0';
-
-        if (buffer->size) {
-            /* Request data fragment through M2M interface from offset. Requested length defaults
-               to the CoAP packet size when the asynchronous flag is set to true.
-            */
-#ifndef LWM2M_SOURCE_USE_C_API
-            arm_ucs_m2m_interface->get_data_request(FIRMWARE_DOWNLOAD,
-                                                    (const char*) buffer->ptr,
-                                                    offset,
-                                                    true,
-                                                    arm_uc_get_data_req_callback,
-                                                    arm_uc_get_data_req_error_callback,
-                                                    buffer);
-#else
-            get_handler_send_get_data_request(endpoint,
-                                              FIRMWARE_DOWNLOAD,
-                                              (const char*) buffer->ptr,
+        bool rebuilt = false;
+        const char *firmware_uri = arm_ucs_get_firmware_uri(uri, &rebuilt);
+
+        if (firmware_uri) {
+#if ARM_UC_COAP_BLOCK_WINDOW > 1
+            if (rebuilt) {
+                arm_ucs_block_window_reset();
+                arm_ucs_block_download++;
+            }
+            arm_ucs_block_waiting_slot = NULL;
+            arm_ucs_block_waiting_buffer = NULL;
+
+            /* Use the block if it was requested ahead, otherwise request it straight into the buffer. */
+            arm_ucs_block_slot_t *slot = arm_ucs_block_window_find(offset);
+
+            if (slot && (slot->state == ARM_UCS_BLOCK_READY)) {
+                arm_ucs_block_deliver(slot, buffer);
+            } else if (slot && (slot->state == ARM_UCS_BLOCK_PENDING)) {
+                arm_ucs_block_waiting_slot = slot;
+                arm_ucs_block_waiting_buffer = buffer;
+            } else {
+                if (slot) {
+                    slot->state = ARM_UCS_BLOCK_FREE;
+                }
+                arm_ucs_block_direct_offset = offset;
+                arm_ucs_send_get_data_request(firmware_uri,
                                               offset,
-                                              true,
                                               arm_uc_get_data_req_callback,
                                               arm_uc_get_data_req_error_callback,
                                               buffer);
+            }
+
+            /* Keep the blocks following this one in flight. */
+            arm_ucs_block_window_move(firmware_uri, offset);
+#else
+            (void) rebuilt;
+
+            /* Request data fragment through M2M interface from offset. */
+            arm_ucs_send_get_data_request(firmware_uri,
+                                          offset,
+                                          arm_uc_get_data_req_callback,
+                                          arm_uc_get_data_req_error_callback,
+                                          buffer);
 #endif
 
             retval.code = ERR_NONE;
@@ -467,6 +791,10 @@ void arm_uc_get_data_req_callback(const uint8_t *buffer,
     UC_SRCE_TRACE("get_data_req_callback: %" PRIu32 ", %" PRIu32,
                   (uint32_t) buffer_size, (uint32_t) total_size);
 
+#if ARM_UC_COAP_BLOCK_WINDOW > 1
+    arm_ucs_block_learn(arm_ucs_block_direct_offset, buffer_size, total_size, last_block);
+#endif
+
     /* Cast context back to buffer pointer. */
     arm_uc_buffer_t *output_buffer = (arm_uc_buffer_t *) context;
 
@@ -530,6 +858,95 @@ void arm_uc_get_data_req_error_callback(get_data_req_error_t error_code, void *c
     }
 }
 
+#if ARM_UC_COAP_BLOCK_WINDOW > 1
+/**
+ * @brief      Internal function for handling data reception of blocks requested ahead.
+ *
+ * @param[in]  buffer       Pointer to buffer with received data.
+ * @param[in]  buffer_size  Buffer size.
+ * @param[in]  total_size   Total size of requested resource.
+ * @param[in]  last_block   Boolean to indicate if this is the last block of the resource.
+ * @param      context      Pointer to the window slot passed in the originating call.
+ */
+void arm_uc_get_data_req_window_callback(const uint8_t *buffer,
+                                         size_t buffer_size,
+                                         size_t total_size,
+                                         bool last_block,
+                                         void *context)
+{
+    arm_ucs_block_slot_t *slot = (arm_ucs_block_slot_t *) context;
+
+    UC_SRCE_TRACE("get_data_req_window_callback: %" PRIu32 ", %" PRIu32,
+                  (uint32_t) buffer_size, (uint32_t) total_size);
+
+    if (slot->state == ARM_UCS_BLOCK_STALE) {
+        slot->state = ARM_UCS_BLOCK_FREE;
+    } else if (slot->state == ARM_UCS_BLOCK_PENDING) {
+        if (buffer && (buffer_size <= sizeof(slot->data))) {
+            memcpy(slot->data, buffer, buffer_size);
+            slot->size = buffer_size;
+            slot->state = ARM_UCS_BLOCK_READY;
+
+            arm_ucs_block_learn(slot->offset, buffer_size, total_size, last_block);
+        } else {
+            slot->state = ARM_UCS_BLOCK_FAILED;
+        }
+
+        /* Hand the block over if the hub is already waiting for it. */
+        if (slot == arm_ucs_block_waiting_slot) {
+            arm_uc_buffer_t *output_buffer = arm_ucs_block_waiting_buffer;
+
+            arm_ucs_block_waiting_slot = NULL;
+            arm_ucs_block_waiting_buffer = NULL;
+
+            if (slot->state == ARM_UCS_BLOCK_READY) {
+                arm_ucs_block_deliver(slot, output_buffer);
+            } else {
+                slot->state = ARM_UCS_BLOCK_FREE;
+
+                if (ARM_UCS_EventHandler) {
+                    ARM_UC_PostCallback(&callbackNodeData,
+                                        ARM_UCS_EventHandler,
+                                        EVENT_ERROR);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief      Internal function for handling errors of blocks requested ahead.
+ * @details    The error only reaches the hub if it is waiting for the block.
+ *
+ * @param[in]  error_code  Error code.
+ * @param      context     Pointer to the window slot passed in the originating call.
+ */
+void arm_uc_get_data_req_window_error_callback(get_data_req_error_t error_code, void *context)
+{
+    arm_ucs_block_slot_t *slot = (arm_ucs_block_slot_t *) context;
+
+    UC_SRCE_TRACE("get_data_req_window_error_callback: ERROR: %u offset: %" PRIu32, error_code, slot->offset);
+
+    if (slot->state == ARM_UCS_BLOCK_STALE) {
+        slot->state = ARM_UCS_BLOCK_FREE;
+    } else if (slot->state == ARM_UCS_BLOCK_PENDING) {
+        if (slot == arm_ucs_block_waiting_slot) {
+            arm_ucs_block_waiting_slot = NULL;
+            arm_ucs_block_waiting_buffer = NULL;
+            slot->state = ARM_UCS_BLOCK_FREE;
+
+            if (ARM_UCS_EventHandler) {
+                ARM_UC_PostCallback(&callbackNodeData,
+                                    ARM_UCS_EventHandler,
+                                    EVENT_ERROR);
+            }
+        } else {
+            slot->state = ARM_UCS_BLOCK_FAILED;
+        }
+    }
+}
+#endif // ARM_UC_COAP_BLOCK_WINDOW
+
 /**
  * @brief      Function for providing access to the M2M interface.
  * @param      interface  Pointer to M2M interface.
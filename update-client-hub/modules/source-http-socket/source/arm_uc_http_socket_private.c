@@ -85,6 +85,12 @@ static arm_uc_http_socket_context_t *context = NULL;
 /* Number of frags to be requested per GET request (burst) */
 uint32_t frags_per_burst = ARM_UC_MULTI_FRAGS_PER_HTTP_BURST;
 
+/* Number of bursts requested at a time, capped by ARM_UC_HTTP_PIPELINE_DEPTH */
+uint32_t http_pipeline_depth = ARM_UC_HTTP_PIPELINE_DEPTH;
+
+/* Space for a pipelined Range request, requests with longer URIs are not pipelined */
+#define ARM_UC_HTTP_PIPELINE_REQUEST_SIZE (256 + 80)
+
 // This fills in the values from the header if specified non-default.
 
 // Exponentiation factor tries to balance speed with power considerations.
@@ -372,11 +378,18 @@ static void arm_uc_http_clear_cached_request_fields(void)
     context->open_request_uri = NULL;
     context->open_burst_received = 0;
 }
+static void arm_uc_http_clear_pipeline_fields(void)
+{
+    context->open_pipeline_count = 0;
+    context->open_pipeline_offset = 0;
+    context->open_pipeline_close = false;
+}
 static void arm_uc_http_clear_socket_fields(void)
 {
     context->socket = NULL;
     context->socket_state = STATE_DISCONNECTED;
     context->expected_socket_event = SOCKET_EVENT_UNDEFINED;
+    arm_uc_http_clear_pipeline_fields();
 }
 
 static void arm_uc_http_clear_dns_cache_fields(void)
@@ -436,6 +449,8 @@ arm_uc_error_t arm_uc_http_socket_close(void)
         ARM_UC_SET_ERROR(status, SRCE_ERR_UNINITIALIZED);
     }
     if (ARM_UC_IS_NOT_ERROR(status)) {
+        /* Pipelined responses are lost with the socket */
+        arm_uc_http_clear_pipeline_fields();
         /* Close socket if not NULL */
         if (context->socket != NULL) {
             context->socket_state = STATE_DISCONNECTED;
@@ -971,6 +986,92 @@ arm_uc_error_t arm_uc_http_socket_send_request(void)
     return status;
 }
 
+/**
+ * @brief Send the Range requests for the bursts following the current one.
+ * @details Called once the response header of a burst has been processed. HTTP/1.1
+ *          servers answer pipelined requests in order, so each following response is
+ *          read from the socket as the next fragment continues where the last burst ended.
+ *          Failing to send is not an error, the next burst is then requested as usual.
+ */
+static void arm_uc_http_socket_send_pipelined_requests(void)
+{
+#if ARM_UC_HTTP_PIPELINE_DEPTH > 1
+    if ((context == NULL)
+            || (frags_per_burst == 0)
+            || (context->request_type != RQST_TYPE_GET_FRAG)
+            || (context->socket == NULL)
+            || context->open_pipeline_close) {
+        return;
+    }
+    // A short burst is the last one in the file, anything requested after it is past the end.
+    if (context->open_burst_expected < context->open_burst_requested) {
+        if (context->open_pipeline_count > 0) {
+            context->open_pipeline_close = true;
+        }
+        return;
+    }
+    if (context->open_pipeline_count == 0) {
+        context->open_pipeline_offset = context->request_offset + context->open_burst_expected;
+    }
+
+    uint32_t pipeline_depth = http_pipeline_depth;
+    if (pipeline_depth > ARM_UC_HTTP_PIPELINE_DEPTH) {
+        pipeline_depth = ARM_UC_HTTP_PIPELINE_DEPTH;
+    }
+
+    // The requests go out in a single send. Sent one by one, the stack may hold back
+    //   all but the first until the server acknowledges it with the next response.
+    char request[ARM_UC_HTTP_PIPELINE_REQUEST_SIZE * (ARM_UC_HTTP_PIPELINE_DEPTH - 1)];
+    size_t request_end[ARM_UC_HTTP_PIPELINE_DEPTH - 1];
+    uint32_t request_count = 0;
+    size_t length = 0;
+    uint32_t burst_default = context->open_burst_requested - 1;
+    uint32_t offset = context->open_pipeline_offset;
+
+    while ((context->open_pipeline_count + request_count + 1) < pipeline_depth) {
+        if (offset > UINT32_MAX - burst_default) {
+            break;
+        }
+        int added = snprintf(&request[length], sizeof(request) - length,
+                             "GET %s HTTP/1.1\r\n"
+                             "Host: %s\r\n"
+                             "Range: bytes=%" PRIu32 "-%" PRIu32 "\r\n"
+                             "\r\n",
+                             context->request_uri->path,
+                             context->request_uri->host,
+                             offset,
+                             offset + burst_default);
+        if ((added < 0) || ((size_t) added >= sizeof(request) - length)) {
+            break;
+        }
+        length += added;
+        request_end[request_count++] = length;
+        offset += context->open_burst_requested;
+    }
+    if (request_count == 0) {
+        return;
+    }
+
+    size_t bytes_sent = 0;
+    palStatus_t pal_result = pal_send(context->socket, request, length, &bytes_sent);
+    if (pal_result != PAL_SUCCESS) {
+        bytes_sent = 0;
+    }
+    for (uint32_t index = 0; (index < request_count) && (request_end[index] <= bytes_sent); index++) {
+        UC_SRCE_TRACE("pipelined request for offset %" PRIu32, context->open_pipeline_offset);
+        context->open_pipeline_count++;
+        context->open_pipeline_offset += context->open_burst_requested;
+    }
+    // A request cut short breaks the request stream, no more can follow it on this connection.
+    //   If the socket would block nothing was sent, and the requests are tried again later.
+    if ((bytes_sent != 0) && (bytes_sent < length)) {
+        context->open_pipeline_close = true;
+    } else if ((pal_result != PAL_SUCCESS) && (pal_result != PAL_ERR_SOCKET_WOULD_BLOCK)) {
+        context->open_pipeline_close = true;
+    }
+#endif
+}
+
 // RECEIVE HANDLING.
 // -----------------
 
@@ -1012,6 +1113,17 @@ arm_uc_error_t arm_uc_http_socket_receive(void)
         }
     }
 
+    /* Do not read into the response of a pipelined request while receiving a body */
+    if (ARM_UC_IS_NOT_ERROR(status)
+            && (context->open_pipeline_count > 0)
+            && (context->resume_socket_phase == SOCKET_EVENT_FRAG_MORE)
+            && (context->open_burst_received < context->open_burst_expected)) {
+        uint32_t burst_remaining = context->open_burst_expected - context->open_burst_received;
+        if (available_space > burst_remaining) {
+            available_space = burst_remaining;
+        }
+    }
+
     if (ARM_UC_IS_NOT_ERROR(status)) {
         size_t received_bytes = 0;
         /* Append data from socket receive buffer to request buffer. */
@@ -1333,6 +1445,16 @@ arm_uc_error_t arm_uc_http_socket_process_header_return_codes(
                     /* Replace HTTP header with body */
                     uint32_t header_size = context->header_end_index + 4;
                     uint32_t body_size = current_size - header_size;
+
+                    /* Anything past the content belongs to a pipelined response.
+                       It has been consumed from the socket, so the stream can't be used after this burst.
+                    */
+                    if (body_size > content_length) {
+                        UC_SRCE_TRACE("received %" PRIu32 " bytes past content, dropping pipelined responses",
+                                      body_size - content_length);
+                        body_size = content_length;
+                        context->open_pipeline_close = true;
+                    }
                     memmove(request_buffer->ptr,
                             &(request_buffer->ptr[context->header_end_index + 4]),
                             body_size);
@@ -1580,6 +1702,42 @@ bool arm_uc_open_http_socket_matches_request(void)
     return result;
 }
 
+/**
+ * @brief Check if the request continues the fragment stream where the last burst ended.
+ * @details Such a request is for the same resource, so the DNS lookup can be reused.
+ * @return Whether or not the request continues the last burst.
+ */
+static bool arm_uc_open_http_socket_continues_request(void)
+{
+    bool result = false;
+
+    if ((context != NULL)
+            && (context->request_uri != NULL)
+            && (context->open_request_uri != NULL)
+            && (context->request_type == RQST_TYPE_GET_FRAG)
+            && (context->open_request_type == RQST_TYPE_GET_FRAG)
+            && (context->open_burst_expected != 0)
+            && (context->open_burst_received >= context->open_burst_expected)
+            && (context->request_offset == context->open_request_offset)) {
+        result = !strcmp((const char *) context->request_uri->host, (const char *) context->open_request_uri->host)
+                 && !strcmp((const char *) context->request_uri->path, (const char *) context->open_request_uri->path);
+    }
+    return result;
+}
+
+/**
+ * @brief Check if the response to this request was already requested by pipelining.
+ * @return Whether or not the next response header on the socket belongs to this request.
+ */
+static bool arm_uc_open_http_socket_has_pipelined_response(void)
+{
+    return (context != NULL)
+           && (context->socket_state == STATE_CONNECTED_IDLE)
+           && (context->open_pipeline_count > 0)
+           && !context->open_pipeline_close
+           && arm_uc_open_http_socket_continues_request();
+}
+
 // EVENT HANDLING.
 // ---------------
 
@@ -1592,6 +1750,13 @@ bool arm_uc_open_http_socket_matches_request(void)
 #define MAX_EMPTY_RECEIVES 2
 #endif
 
+// Minimum time between restarts of the resume timer on received data.
+// The resume engine only needs to see activity well within its interval delay, so
+//   restarting its timer on every receive of a long stream is wasted effort.
+#if !defined(ARM_UC_HTTP_RESUME_RESYNCH_PERIOD_MSECS)
+#define ARM_UC_HTTP_RESUME_RESYNCH_PERIOD_MSECS 250
+#endif
+
 #if defined(ARM_UC_QA_TRACE_ENABLE) && (ARM_UC_QA_TRACE_ENABLE == 1)
 uint64_t qaTicksLastAttempt = 0;
 #endif
@@ -1729,6 +1894,25 @@ static void arm_uc_http_resume_initialize(void)
     }
 }
 
+/**
+ * @brief Note activity to the resume engine, at most once per resynch period.
+ * @param a_force Resynch regardless of the time since the last one.
+ */
+static uint64_t last_resynch_ticks = 0;
+static void arm_uc_http_resynch_resume_monitoring(bool a_force)
+{
+    static uint64_t resynch_period_ticks = 0;
+    uint64_t ticks_now = pal_osKernelSysTick();
+
+    if (resynch_period_ticks == 0) {
+        resynch_period_ticks = pal_osKernelSysTickMicroSec(ARM_UC_HTTP_RESUME_RESYNCH_PERIOD_MSECS * 1000ULL);
+    }
+    if (a_force || ((ticks_now - last_resynch_ticks) >= resynch_period_ticks)) {
+        arm_uc_resume_resynch_monitoring(&resume_http);
+        last_resynch_ticks = ticks_now;
+    }
+}
+
 static uint32_t empty_receive = 0;
 static bool received_enough = false;
 
@@ -1783,16 +1967,40 @@ void arm_uc_http_socket_callback(
                         NULL
                     );
                     arm_uc_resume_start_monitoring(&resume_http);
+                    last_resynch_ticks = pal_osKernelSysTick();
 
                     context->resume_socket_phase = SOCKET_EVENT_UNDEFINED;
-                    status = arm_uc_http_prepare_skip_to_event(SOCKET_EVENT_LOOKUP_START);
+#if ARM_UC_HTTP_STREAM_DOWNLOAD
+                    // Next fragment of the open stream, so there is nothing to look up or request.
+                    if (arm_uc_open_http_socket_matches_request() && arm_uc_dns_lookup_is_cached()) {
+                        status = arm_uc_http_prepare_skip_to_event(SOCKET_EVENT_CONNECT_START);
+                    } else
+#endif
+                    {
+                        status = arm_uc_http_prepare_skip_to_event(SOCKET_EVENT_LOOKUP_START);
+                    }
                     arm_uc_display_http_resume_settings(&resume_http);
                     break;
 
                 case SOCKET_EVENT_LOOKUP_START:
                     UC_SRCE_TRACE_SM("event: lookup start");
                     context->resume_socket_phase = SOCKET_EVENT_LOOKUP_START;
-                    if (arm_uc_open_http_socket_matches_request() && arm_uc_dns_lookup_is_cached()) {
+                    if ((arm_uc_open_http_socket_matches_request()
+                            || arm_uc_open_http_socket_has_pipelined_response())
+                            && arm_uc_dns_lookup_is_cached()) {
+                        status = arm_uc_http_prepare_skip_to_event(SOCKET_EVENT_LOOKUP_DONE);
+                    } else if (arm_uc_open_http_socket_continues_request() && arm_uc_dns_lookup_is_cached()) {
+                        // Next burst of the same resource, the host address is still valid.
+#if ARM_UC_HTTP_PIPELINE_DEPTH > 1
+                        // Keep an idle connection alive for the new request, unless it carries stale responses.
+                        if ((context->socket_state != STATE_CONNECTED_IDLE)
+                                || (context->open_pipeline_count > 0)
+                                || context->open_pipeline_close) {
+                            arm_uc_http_socket_close();
+                        }
+#else
+                        arm_uc_http_socket_close();
+#endif
                         status = arm_uc_http_prepare_skip_to_event(SOCKET_EVENT_LOOKUP_DONE);
                     } else {
                         // clear previous dns cache
@@ -1844,6 +2052,15 @@ void arm_uc_http_socket_callback(
                         } else {
                             UC_SRCE_TRACE_VERBOSE("    error on soft-connect %" PRIx32, status);
                         }
+                    } else if (arm_uc_open_http_socket_has_pipelined_response()) {
+                        // Request was sent ahead, go straight to reading its response.
+                        UC_SRCE_TRACE_VERBOSE("    read pipelined response");
+                        context->open_pipeline_count--;
+                        context->open_request_uri = context->request_uri;
+                        context->open_request_type = context->request_type;
+                        context->open_request_offset = context->request_offset;
+                        context->socket_state = STATE_PROCESS_HEADER;
+                        status = arm_uc_http_prepare_skip_to_event(SOCKET_EVENT_HEADER_START);
                     } else {
                         status = arm_uc_http_socket_connect();
                     }
@@ -1948,8 +2165,9 @@ void arm_uc_http_socket_callback(
 
                 case SOCKET_EVENT_HEADER_DONE:
                     UC_SRCE_TRACE_SM("event: header done. Reset resume engine");
-                    arm_uc_resume_resynch_monitoring(&resume_http);
+                    arm_uc_http_resynch_resume_monitoring(true);
                     empty_receive = 0;
+                    arm_uc_http_socket_send_pipelined_requests();
                     status = arm_uc_http_prepare_skip_to_event(SOCKET_EVENT_FRAG_START);
                     break;
 
@@ -1997,7 +2215,7 @@ void arm_uc_http_socket_callback(
                                 break;
                             case ERR_NONE:
                                 UC_SRCE_TRACE_VERBOSE("http socket receive event: no error. Reset resume engine");
-                                arm_uc_resume_resynch_monitoring(&resume_http);
+                                arm_uc_http_resynch_resume_monitoring(false);
                                 ++context->number_of_pieces;
                                 empty_receive = 0;
 
@@ -2040,6 +2258,11 @@ void arm_uc_http_socket_callback(
 
                         arm_uc_http_socket_close();
                     }
+                    // Pipelined responses no longer line up with the requests.
+                    else if (context->open_pipeline_close
+                             && (context->open_burst_received >= context->open_burst_expected)) {
+                        arm_uc_http_socket_close();
+                    }
                     break;
 
                 case SOCKET_EVENT_TIMER_FIRED:
@@ -102,12 +102,39 @@ typedef void (*ARM_UCS_HttpEvent_t)(uintptr_t event);
 #define ARM_UC_MULTI_FRAGS_PER_HTTP_BURST__HEAVY            256
 #define ARM_UC_MULTI_FRAGS_PER_HTTP_BURST__EXTREME          1024
 
+// Stream the firmware over a single "Range: bytes=offset-" request instead of bursts.
+// Fragments are read straight off the open response as they arrive, so there is no
+//   request or header per fragment. Only after a disconnect does the resume engine
+//   open a new stream, starting from the offset of the fragment being fetched.
+#if !defined(ARM_UC_HTTP_STREAM_DOWNLOAD)
+#if defined(ARM_UC_MULTI_FRAGS_PER_HTTP_BURST)
+#define ARM_UC_HTTP_STREAM_DOWNLOAD                 (ARM_UC_MULTI_FRAGS_PER_HTTP_BURST == 0)
+#elif defined(TARGET_IS_PC_LINUX)
+#define ARM_UC_HTTP_STREAM_DOWNLOAD                 1
+#else
+#define ARM_UC_HTTP_STREAM_DOWNLOAD                 0
+#endif
+#endif
+
 #if !defined(ARM_UC_MULTI_FRAGS_PER_HTTP_BURST)
-#if defined(TARGET_IS_PC_LINUX)
+#if ARM_UC_HTTP_STREAM_DOWNLOAD
 #define ARM_UC_MULTI_FRAGS_PER_HTTP_BURST           ARM_UC_MULTI_FRAGS_PER_HTTP_BURST__DISABLED
 #else
 #define ARM_UC_MULTI_FRAGS_PER_HTTP_BURST           ARM_UC_MULTI_FRAGS_PER_HTTP_BURST__MODERATE
 #endif
+#elif ARM_UC_HTTP_STREAM_DOWNLOAD && (ARM_UC_MULTI_FRAGS_PER_HTTP_BURST != 0)
+#error "ARM_UC_HTTP_STREAM_DOWNLOAD requires ARM_UC_MULTI_FRAGS_PER_HTTP_BURST to be 0."
+#endif
+
+// Number of burst requests kept in flight on the socket using HTTP/1.1 pipelining.
+// While one burst is received, the Range requests for the following bursts are
+//   already sent, so the next response follows without a request round trip.
+// 1 disables pipelining. Has no effect if bursts are disabled, since then a single
+//   request already covers the rest of the file.
+#if !defined(ARM_UC_HTTP_PIPELINE_DEPTH)
+#define ARM_UC_HTTP_PIPELINE_DEPTH                  1
+#elif ARM_UC_HTTP_PIPELINE_DEPTH < 1
+#error "ARM_UC_HTTP_PIPELINE_DEPTH must be 1 or more."
 #endif
 
 // Developer-facing #defines allow easier testing of parameterised resume.
@@ -156,6 +183,13 @@ typedef struct {
     uint32_t open_burst_expected;
     uint32_t open_burst_received;
 
+    /* pipelined burst requests whose response header has not been read yet */
+    uint32_t open_pipeline_count;
+    /* offset following the last pipelined burst request */
+    uint32_t open_pipeline_offset;
+    /* stream is out of step with requests, close once current burst is read */
+    bool open_pipeline_close;
+
     uint32_t header_end_index;
     uint32_t number_of_pieces;
 
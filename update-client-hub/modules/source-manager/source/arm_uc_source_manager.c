@@ -72,6 +72,26 @@ typedef struct {
 // Hold information about the request in flight, there will always only be one request in flight
 static request_t request_in_flight;
 
+// Firmware fragment requests made while another is in flight, oldest first.
+// Each is passed to a source as soon as the one before it completes, so the
+// source does not sit idle while the hub handles the completed fragment.
+typedef struct {
+    arm_uc_uri_t *uri;
+    arm_uc_buffer_t *buffer;
+    uint32_t offset;
+} fragment_request_t;
+
+#if ARM_UC_FRAGMENT_BUFFER_COUNT > 1
+static fragment_request_t fragment_queue[ARM_UC_FRAGMENT_BUFFER_COUNT - 1];
+static uint32_t fragment_queue_head = 0;
+#endif
+static uint32_t fragment_queue_count = 0;
+
+// storage for the fragment events, one per buffer since the next fragment
+// can complete before the hub has handled the previous one
+static arm_uc_callback_t fragment_cb_storage[ARM_UC_FRAGMENT_BUFFER_COUNT] = {{0}};
+static uint32_t fragment_cb_index = 0;
+
 // FORWARD DECLARATIONS.
 // ---------------------
 
@@ -115,6 +135,12 @@ static arm_uc_error_t ARM_UCSM_Get(request_t *req);
  */
 static void ARM_UCSM_CallbackWrapper(uintptr_t event);
 
+/**
+ * @brief Drop the queued firmware fragment requests, called when the
+ *        download is aborted by an error
+ */
+static void ARM_UCSM_FlushFragmentQueue(void);
+
 #if defined(ARM_UC_PROFILE_MBED_CLOUD_CLIENT) && (ARM_UC_PROFILE_MBED_CLOUD_CLIENT == 1)
 
 static void ARM_UCSM_ScheduleAsyncBusyRetryGet(void);
@@ -155,6 +181,7 @@ static void ARM_UCSM_DoAsyncBusyRetryGet(uintptr_t unused)
         //      the resume engine is *really* only designed to protect a single fragment,
         //        but this seems way too fragile to have around.
         ARM_UCSM_SetError(ARM_UC_ERROR(SOMA_ERR_UNSPECIFIED));
+        ARM_UCSM_FlushFragmentQueue();
         ARM_UC_PostCallback(&event_cb_storage, event_cb, ARM_UC_SM_EVENT_ERROR);
     } else if (ARM_UCSM_Get(&request_in_flight).error != ERR_NONE) {
         ARM_UCSM_ScheduleAsyncBusyRetryGet();
@@ -558,6 +585,7 @@ static void ARM_UCSM_AsyncRetryGet(uintptr_t unused)
     if (retval.error != ERR_NONE) {
         ARM_UCSM_RequestStructInit(&request_in_flight);
         ARM_UCSM_SetError(retval);
+        ARM_UCSM_FlushFragmentQueue();
         ARM_UC_PostCallback(&event_cb_storage, event_cb, ARM_UC_SM_EVENT_ERROR);
     }
     UC_SRCE_TRACE_EXIT(".. %s", __func__);
@@ -599,6 +627,47 @@ static ARM_UC_SM_Event_t ARM_UCSM_TranslateEvent(uintptr_t source_event)
     return event;
 }
 
+static void ARM_UCSM_FlushFragmentQueue(void)
+{
+#if ARM_UC_FRAGMENT_BUFFER_COUNT > 1
+    fragment_queue_head = 0;
+#endif
+    fragment_queue_count = 0;
+}
+
+/**
+ * @brief Pass the oldest queued firmware fragment request to a source.
+ * @return error status, ERR_NONE also when nothing was queued.
+ */
+static arm_uc_error_t ARM_UCSM_GetNextFragment(void)
+{
+    arm_uc_error_t retval = (arm_uc_error_t) { ERR_NONE };
+
+#if ARM_UC_FRAGMENT_BUFFER_COUNT > 1
+    if (fragment_queue_count > 0) {
+        fragment_request_t *next = &fragment_queue[fragment_queue_head];
+
+        fragment_queue_head = (fragment_queue_head + 1) % (ARM_UC_FRAGMENT_BUFFER_COUNT - 1);
+        fragment_queue_count--;
+
+        ARM_UCSM_RequestStructInit(&request_in_flight);
+        request_in_flight.uri    = next->uri;
+        request_in_flight.buffer = next->buffer;
+        request_in_flight.offset = next->offset;
+        request_in_flight.type   = QUERY_TYPE_FIRMWARE;
+
+        UC_SRCE_TRACE_VERBOSE("%s offset %" PRIu32, __func__, request_in_flight.offset);
+        retval = ARM_UCSM_Get(&request_in_flight);
+        if (retval.code != ERR_NONE) {
+            ARM_UCSM_SetError(retval);
+            ARM_UCSM_RequestStructInit(&request_in_flight);
+        }
+    }
+#endif
+
+    return retval;
+}
+
 /**
  * @brief Catch callbacks from sources to enable error handling
  */
@@ -617,10 +686,23 @@ static void ARM_UCSM_CallbackWrapper(uintptr_t source_event)
             UC_SRCE_TRACE("ARM_UCSM_Get() retval.code == %" PRIx32, retval.code);
             ARM_UCSM_RequestStructInit(&request_in_flight);
             ARM_UCSM_SetError(retval);
+            ARM_UCSM_FlushFragmentQueue();
             ARM_UC_PostCallback(&event_cb_storage, event_cb, event);
         }
+    } else if ((event == ARM_UC_SM_EVENT_FIRMWARE)
+               && (request_in_flight.type == QUERY_TYPE_FIRMWARE)) {
+        ARM_UCSM_RequestStructInit(&request_in_flight);
+        ARM_UC_PostCallback(&fragment_cb_storage[fragment_cb_index], event_cb, event);
+        fragment_cb_index = (fragment_cb_index + 1) % ARM_UC_FRAGMENT_BUFFER_COUNT;
+
+        // start on the next fragment before the hub has seen this one
+        if (ARM_UCSM_GetNextFragment().code != ERR_NONE) {
+            ARM_UCSM_FlushFragmentQueue();
+            ARM_UC_PostCallback(&event_cb_storage, event_cb, ARM_UC_SM_EVENT_ERROR);
+        }
     } else {
         ARM_UCSM_RequestStructInit(&request_in_flight);
+        ARM_UCSM_FlushFragmentQueue();
         ARM_UC_PostCallback(&event_cb_storage, event_cb, event);
     }
     UC_SRCE_TRACE_EXIT(".. %s", __func__);
@@ -718,6 +800,23 @@ arm_uc_error_t ARM_UCSM_GetFirmwareFragment(arm_uc_uri_t *uri,
                                             arm_uc_buffer_t *buffer,
                                             uint32_t offset)
 {
+#if ARM_UC_FRAGMENT_BUFFER_COUNT > 1
+    /* queue behind the fragment in flight, it is requested when that completes */
+    if (request_in_flight.type == QUERY_TYPE_FIRMWARE) {
+        if (fragment_queue_count >= ARM_UC_FRAGMENT_BUFFER_COUNT - 1) {
+            return ARM_UCSM_SetError((arm_uc_error_t) { SOMA_ERR_INVALID_REQUEST });
+        }
+
+        uint32_t tail = (fragment_queue_head + fragment_queue_count) % (ARM_UC_FRAGMENT_BUFFER_COUNT - 1);
+        fragment_queue[tail].uri    = uri;
+        fragment_queue[tail].buffer = buffer;
+        fragment_queue[tail].offset = offset;
+        fragment_queue_count++;
+
+        return (arm_uc_error_t) { ERR_NONE };
+    }
+#endif
+
     arm_uc_error_t retval = ARM_UCSM_GetCommon(
                                 uri, buffer, offset, QUERY_TYPE_FIRMWARE);
     return retval;
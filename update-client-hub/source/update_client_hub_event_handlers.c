@@ -55,29 +55,18 @@ void ARM_UC_HUB_FirmwareManagerEventHandler(uintptr_t event)
 
             /* Firmware fragment stored */
 
-            /* Fragment stored before network could finish,
-               i.e., network is the bottleneck:
+            /* Fragment stored while downloading, or while storing the
+               remaining buffered fragments after the last one was fetched.
                Action:
-                - wait for network to complete
+                - release the buffer
+                - store the next buffered fragment, if any
+                - download the next fragment if a buffer became free
             */
-            if (arm_uc_hub_state == ARM_UC_HUB_STATE_STORE_AND_DOWNLOAD) {
-                ARM_UC_HUB_setState(ARM_UC_HUB_STATE_WAIT_FOR_NETWORK);
-            }
-            /* Fragment stored after network finished,
-               i.e, storage is the bottleneck:
-               Action:
-                - store fragment
-                - download next fragment
-            */
-            else if (arm_uc_hub_state == ARM_UC_HUB_STATE_WAIT_FOR_STORAGE) {
+            if ((arm_uc_hub_state == ARM_UC_HUB_STATE_STORE_AND_DOWNLOAD) ||
+                    (arm_uc_hub_state == ARM_UC_HUB_STATE_WAIT_FOR_STORAGE) ||
+                    (arm_uc_hub_state == ARM_UC_HUB_STATE_AWAIT_LAST_FRAGMENT_STORED)) {
+                ARM_UC_HUB_markFragmentStored();
                 ARM_UC_HUB_setState(ARM_UC_HUB_STATE_STORE_AND_DOWNLOAD);
-            }
-            /* Last fragment stored.
-               Action:
-                - finalize storage
-            */
-            else if (arm_uc_hub_state == ARM_UC_HUB_STATE_AWAIT_LAST_FRAGMENT_STORED) {
-                ARM_UC_HUB_setState(ARM_UC_HUB_STATE_LAST_FRAGMENT_STORE_DONE);
             } else {
                 /* Invalid state, abort and report error. */
                 ARM_UC_HUB_ErrorHandler(FIRM_ERR_INVALID_STATE, arm_uc_hub_state);
@@ -339,23 +328,18 @@ void ARM_UC_HUB_SourceManagerEventHandler(uintptr_t event)
 
             /* Received firmware fragment */
 
-            /* 1. First fragment received, source and storage idle, or,
-               2. N fragment received after storage went idle.
+            /* First fragment received, or N fragment received while
+               storage is busy or idle.
                Action:
-                - store fragment
-                - download next fragment
+                - queue fragment for storage
+                - download next fragment if a buffer is free
             */
             if ((arm_uc_hub_state == ARM_UC_HUB_STATE_FETCH_FIRST_FRAGMENT) ||
-                    (arm_uc_hub_state == ARM_UC_HUB_STATE_WAIT_FOR_NETWORK)) {
+                    (arm_uc_hub_state == ARM_UC_HUB_STATE_WAIT_FOR_NETWORK) ||
+                    (arm_uc_hub_state == ARM_UC_HUB_STATE_STORE_AND_DOWNLOAD)) {
+                ARM_UC_HUB_markFragmentFetched();
                 ARM_UC_HUB_setState(ARM_UC_HUB_STATE_STORE_AND_DOWNLOAD);
             }
-            /* 1. N fragment received, storing still in progress,
-               i.e., the storage is the bottleneck:
-               - All buffers are in use, wait for storage
-            */
-            else if (arm_uc_hub_state == ARM_UC_HUB_STATE_STORE_AND_DOWNLOAD) {
-                ARM_UC_HUB_setState(ARM_UC_HUB_STATE_WAIT_FOR_STORAGE);
-            }
             /* Invalid state, abort and report error. */
             else {
                 ARM_UC_HUB_ErrorHandler(SOMA_ERR_INVALID_FW_STATE, arm_uc_hub_state);
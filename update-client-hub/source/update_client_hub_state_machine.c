@@ -56,8 +56,9 @@ static arm_uc_hub_state_t arm_uc_hub_state = ARM_UC_HUB_STATE_UNINITIALIZED;
 // the call back function registered by the user to signal end of initialisation
 static void (*arm_uc_hub_init_cb)(uintptr_t) = NULL;
 
-// The hub uses a double buffer system to speed up firmware download and storage
-#define BUFFER_SIZE_MAX (ARM_UC_BUFFER_SIZE / 2) //  define size of the double buffers
+// The hub uses a ring of fragment buffers to speed up firmware download and storage.
+// The front and back buffers are also used for the manifest and for finalizing.
+#define BUFFER_SIZE_MAX (ARM_UC_BUFFER_SIZE / 2) //  define size of each fragment buffer
 static uint8_t message[BUFFER_SIZE_MAX];
 static arm_uc_buffer_t front_buffer = {
     .size_max = BUFFER_SIZE_MAX,
@@ -72,6 +73,34 @@ static arm_uc_buffer_t back_buffer = {
     .ptr = message2
 };
 
+#if ARM_UC_FRAGMENT_BUFFER_COUNT > 2
+#define FRAGMENT_EXTRA_BUFFERS (ARM_UC_FRAGMENT_BUFFER_COUNT - 2)
+static uint8_t fragment_extra_message[FRAGMENT_EXTRA_BUFFERS][BUFFER_SIZE_MAX];
+static arm_uc_buffer_t fragment_extra_buffer[FRAGMENT_EXTRA_BUFFERS];
+#endif
+
+/* Download ring. Fragments are fetched in order into the slots from
+   fragment_fetch_index, with fragment_fetch_count requests outstanding, and
+   written from the slot at fragment_write_index. fragment_filled counts
+   slots holding fetched data that has not finished writing yet, the first
+   fragment_decrypted of which are decrypted and ready to write.
+   Requests are made fragment_request_size apart from fragment_request_offset.
+   A fragment of another size means the outstanding requests asked for the
+   wrong offsets, so their results are discarded (fragment_fetch_discard)
+   before fetching resumes from firmware_offset.
+*/
+static arm_uc_buffer_t *fragment_ring[ARM_UC_FRAGMENT_BUFFER_COUNT];
+static uint32_t fragment_fetch_index = 0;
+static uint32_t fragment_write_index = 0;
+static uint32_t fragment_filled = 0;
+static uint32_t fragment_decrypted = 0;
+static uint32_t fragment_fetch_count = 0;
+static uint32_t fragment_fetch_discard = 0;
+static uint32_t fragment_request_offset = 0;
+static uint32_t fragment_request_size = 0;
+static bool fragment_write_pending = false;
+static uint32_t fragment_reported_offset = 0;
+
 // version (timestamp) of the current running application
 static arm_uc_firmware_details_t arm_uc_active_details = { 0 };
 static bool arm_uc_active_details_available = false;
@@ -81,7 +110,8 @@ static arm_uc_delta_details_t arm_uc_hub_delta_details = { 0 };
 // bootloader information
 static arm_uc_installer_details_t arm_uc_installer_details = { 0 };
 
-// variable to keep track of the offset into the firmware image during download
+// variable to keep track of the offset into the firmware image during download,
+// i.e., the number of bytes fetched so far
 static uint32_t firmware_offset = 0;
 
 // variable to store the firmware config during firmware manager setup
@@ -238,6 +268,81 @@ static void arm_uc_hub_printStackStats()
         break;                                          \
     }
 
+static void arm_uc_hub_reset_fragment_ring(void)
+{
+    fragment_ring[0] = &front_buffer;
+#if ARM_UC_FRAGMENT_BUFFER_COUNT > 1
+    fragment_ring[1] = &back_buffer;
+#endif
+#if ARM_UC_FRAGMENT_BUFFER_COUNT > 2
+    for (uint32_t index = 0; index < FRAGMENT_EXTRA_BUFFERS; index++) {
+        fragment_extra_buffer[index].size_max = BUFFER_SIZE_MAX;
+        fragment_extra_buffer[index].ptr = fragment_extra_message[index];
+        fragment_ring[index + 2] = &fragment_extra_buffer[index];
+    }
+#endif
+
+    for (uint32_t index = 0; index < ARM_UC_FRAGMENT_BUFFER_COUNT; index++) {
+        fragment_ring[index]->size = 0;
+    }
+
+    fragment_fetch_index = 0;
+    fragment_write_index = 0;
+    fragment_filled = 0;
+    fragment_decrypted = 0;
+    fragment_fetch_count = 0;
+    fragment_fetch_discard = 0;
+    fragment_request_offset = firmware_offset;
+    fragment_request_size = 0;
+    fragment_write_pending = false;
+    fragment_reported_offset = firmware_offset;
+}
+
+void ARM_UC_HUB_markFragmentFetched(void)
+{
+    if (fragment_fetch_count > 0) {
+        fragment_fetch_count--;
+    }
+
+    /* requested from an offset that turned out wrong, drop it */
+    if (fragment_fetch_discard > 0) {
+        fragment_fetch_discard--;
+        return;
+    }
+
+    arm_uc_buffer_t *fragment = fragment_ring[fragment_fetch_index];
+
+    /* an empty fragment is fetched again from the same offset */
+    if (fragment->size > 0) {
+        firmware_offset += fragment->size;
+        fragment_filled++;
+        fragment_fetch_index = (fragment_fetch_index + 1) % ARM_UC_FRAGMENT_BUFFER_COUNT;
+    }
+
+    /* the source decides the fragment size, the first fragment tells what it is.
+       Any other size moves the following fragments, so the requests still
+       outstanding are discarded and fetching restarts after this fragment.
+    */
+    if (fragment->size != fragment_request_size) {
+        if (fragment->size > 0) {
+            fragment_request_size = fragment->size;
+        }
+        fragment_fetch_discard = fragment_fetch_count;
+        fragment_request_offset = firmware_offset;
+    }
+}
+
+void ARM_UC_HUB_markFragmentStored(void)
+{
+    fragment_write_pending = false;
+
+    if (fragment_filled > 0) {
+        fragment_filled--;
+        fragment_decrypted--;
+        fragment_write_index = (fragment_write_index + 1) % ARM_UC_FRAGMENT_BUFFER_COUNT;
+    }
+}
+
 arm_uc_hub_state_t ARM_UC_HUB_getState()
 {
     return arm_uc_hub_state;
@@ -627,34 +732,36 @@ void ARM_UC_HUB_setState(arm_uc_hub_state_t new_state)
             /* Download firmware                                             */
             /*****************************************************************/
 
-            /* The firmware is downloaded in fragments. While one fragment is
-               written to storage, the next fragment is being downloaded.
+            /* The firmware is downloaded in fragments into a ring of
+               ARM_UC_FRAGMENT_BUFFER_COUNT buffers. While fragments are
+               written to storage, the following fragments are downloaded
+               into the free buffers.
 
-               In the ARM_UC_HUB_STATE_FETCH_FIRST_FRAGMENT state, the first
-               fragment is being downloaded. Once completed, the first fragment
-               will be in the front_buffer and both the network stack and
-               storage stack will be idle.
+               In the ARM_UC_HUB_STATE_FETCH_FIRST_FRAGMENT state, the ring is
+               reset and the first fragment is being downloaded.
 
-               In the ARM_UC_HUB_STATE_STORE_AND_DOWNLOAD state, the front and
-               back buffers are swapped. The front buffer is being used for
-               downloading the next fragment while the back buffer is being
-               written to storage.
+               The ARM_UC_HUB_STATE_STORE_AND_DOWNLOAD state advances the
+               ring: every free buffer gets a fragment requested into it, so
+               up to ARM_UC_FRAGMENT_BUFFER_COUNT requests are outstanding at
+               the source manager, which passes each to the source as soon as
+               the one before it completes. Downloaded fragments are decrypted
+               on arrival, and if storage is idle the oldest decrypted
+               fragment is written. A full ring stops the download until
+               storage catches up, an empty ring leaves storage idle.
 
                ARM_UC_FirmwareManager.Write and
-               ARM_UC_SourceManager.GetFirmwareFragment will both finish
-               asynchronously generating two events:
-               ARM_UC_SM_EVENT_FIRMWARE and UCFM_EVENT_UPDATE_DONE.
-
-               If the ARM_UC_SM_EVENT_FIRMWARE event is generated first, the
-               system enters the ARM_UC_HUB_STATE_WAIT_FOR_STORAGE state.
-               If the UCFM_EVENT_UPDATE_DONE event is generated first, the
-               system enters the ARM_UC_HUB_STATE_WAIT_FOR_NETWORK state.
-               The second generated event will move the system back to the
-               ARM_UC_HUB_STATE_STORE_AND_DOWNLOAD state.
-
-               The download will stop once the fragment offset is larger than
-               the firmware size written in the manifest. This moves the system
-               to the ARM_UC_HUB_STATE_STORE_LAST_FRAGMENT state.
+               ARM_UC_SourceManager.GetFirmwareFragment both finish
+               asynchronously, generating the events UCFM_EVENT_WRITE_DONE
+               and ARM_UC_SM_EVENT_FIRMWARE. Each event updates the ring and
+               re-enters ARM_UC_HUB_STATE_STORE_AND_DOWNLOAD, which then rests in:
+                - ARM_UC_HUB_STATE_STORE_AND_DOWNLOAD when both are busy,
+                - ARM_UC_HUB_STATE_WAIT_FOR_NETWORK when only the download is busy,
+                - ARM_UC_HUB_STATE_WAIT_FOR_STORAGE when only the write is busy.
+
+               Once the fragment offset reaches the firmware size written in
+               the manifest, the system waits in the
+               ARM_UC_HUB_STATE_AWAIT_LAST_FRAGMENT_STORED state until all
+               buffered fragments are written.
 
                Once the last fragment is written, the newly written firmware
                committed in the ARM_UC_HUB_STATE_FINALIZE_STORAGE state.
@@ -752,13 +859,15 @@ void ARM_UC_HUB_setState(arm_uc_hub_state_t new_state)
                     ARM_UC_ControlCenter_ReportState(ARM_UC_UPDATE_STATE_DOWNLOADED_UPDATE);
                     new_state = ARM_UC_HUB_STATE_FINALIZE_STORAGE;
                 } else {
+                    /* reset download values */
+                    arm_uc_hub_reset_fragment_ring();
+
                     UC_HUB_TRACE("loading %" PRIu32 " byte first fragment at %" PRIu32,
                                  front_buffer.size_max, firmware_offset);
-                    /* reset download values */
-                    front_buffer.size = 0;
-                    back_buffer.size = 0;
+                    fragment_fetch_count = 1;
                     retval = ARM_UC_SourceManager.GetFirmwareFragment(&uri, &front_buffer, firmware_offset);
                     if (retval.code !=ERR_NONE) {
+                        fragment_fetch_count = 0;
                         // @todo: no separate error for Prepare ?
                         ARM_UC_HUB_ErrorHandler(SOMA_ERR_NO_ROUTE_TO_SOURCE,
                                                 ARM_UC_HUB_STATE_FETCH_FIRST_FRAGMENT);
@@ -780,48 +889,84 @@ void ARM_UC_HUB_setState(arm_uc_hub_state_t new_state)
 #endif
 #endif
 
-                /* swap the front and back buffers
-                   the back buffer contained just downloaded firmware chunk
-                   the front buffer can now be cleared and used to download new chunk
-                */
-                {
-                    arm_uc_buffer_t temp_buf_ptr = front_buffer;
-                    front_buffer = back_buffer;
-                    back_buffer = temp_buf_ptr;
+                /* go fetch new chunks into the free buffers if more are expected,
+                   one at a time until the fragment size is known */
+                retval = (arm_uc_error_t) { ERR_NONE };
+                while ((fragment_fetch_discard == 0) &&
+                        (fragment_filled + fragment_fetch_count < ARM_UC_FRAGMENT_BUFFER_COUNT) &&
+                        ((fragment_request_size > 0) || (fragment_fetch_count == 0)) &&
+                        (fragment_request_offset < fw_downloadSize)) {
+                    uint32_t index = (fragment_fetch_index + fragment_fetch_count) % ARM_UC_FRAGMENT_BUFFER_COUNT;
+                    arm_uc_buffer_t *fragment = fragment_ring[index];
+
+                    fragment->size = 0;
+                    UC_HUB_TRACE("Getting next fragment at offset: %" PRIu32, fragment_request_offset);
+                    retval = ARM_UC_SourceManager.GetFirmwareFragment(&uri, fragment, fragment_request_offset);
+                    if (retval.code != ERR_NONE) {
+                        break;
+                    }
+                    fragment_fetch_count++;
+                    fragment_request_offset += fragment_request_size;
+                }
+                if (retval.code != ERR_NONE) {
+                    // @todo: no separate error for Prepare ?
+                    ARM_UC_HUB_ErrorHandler(SOMA_ERR_NO_ROUTE_TO_SOURCE,
+                                            ARM_UC_HUB_STATE_STORE_AND_DOWNLOAD);
+                    HANDLE_ERROR(retval, "GetFirmwareFragment failed")
+                }
+
+                /* decrypt downloaded fragments in order while storage is busy */
+                while (fragment_decrypted < fragment_filled) {
+                    uint32_t index = (fragment_write_index + fragment_decrypted) % ARM_UC_FRAGMENT_BUFFER_COUNT;
+
+                    retval = ARM_UC_FirmwareManager.Decrypt(fragment_ring[index]);
+                    if (retval.code != ERR_NONE) {
+                        break;
+                    }
+                    fragment_decrypted++;
                 }
-                /* store the downloaded chunk in the back buffer */
-                if (back_buffer.size > 0) {
-                    UC_HUB_TRACE("writing %" PRIu32 " byte fragment at %" PRIu32,
-                                 back_buffer.size, firmware_offset);
-
-                    /* increase offset by the amount that we just downloaded */
-                    firmware_offset += back_buffer.size;
-                    retval = ARM_UC_FirmwareManager.Write(&back_buffer);
+                if (retval.code != ERR_NONE) {
+                    ARM_UC_HUB_ErrorHandler(FIRM_ERR_WRITE,
+                                            ARM_UC_HUB_STATE_STORE_AND_DOWNLOAD);
+                    HANDLE_ERROR(retval, "ARM_UC_FirmwareManager Decrypt failed")
+                }
+
+                /* store the oldest decrypted fragment if storage is idle */
+                if (!fragment_write_pending && (fragment_decrypted > 0)) {
+                    arm_uc_buffer_t *fragment = fragment_ring[fragment_write_index];
+
+                    UC_HUB_TRACE("writing %" PRIu32 " byte fragment from buffer %" PRIu32,
+                                 fragment->size, fragment_write_index);
+
+                    fragment_write_pending = true;
+                    retval = ARM_UC_FirmwareManager.Write(fragment);
                     if (retval.code != ERR_NONE) {
+                        fragment_write_pending = false;
                         // @todo: no separate error for Prepare ?
                         ARM_UC_HUB_ErrorHandler(FIRM_ERR_WRITE,
                                                 ARM_UC_HUB_STATE_STORE_AND_DOWNLOAD);
                         HANDLE_ERROR(retval, "ARM_UC_FirmwareManager Update failed")
                     }
                 }
-                /* go fetch a new chunk using the front buffer if more are expected */
-                if (firmware_offset < fw_downloadSize) {
-                    front_buffer.size = 0;
-                    UC_HUB_TRACE("Getting next fragment at offset: %" PRIu32, firmware_offset);
-                    retval = ARM_UC_SourceManager.GetFirmwareFragment(&uri, &front_buffer, firmware_offset);
-                    if (retval.code != ERR_NONE) {
-                        // @todo: no separate error for Prepare ?
-                        ARM_UC_HUB_ErrorHandler(SOMA_ERR_NO_ROUTE_TO_SOURCE,
-                                                ARM_UC_HUB_STATE_STORE_AND_DOWNLOAD);
-                        HANDLE_ERROR(retval, "GetFirmwareFragment failed")
+
+                if ((firmware_offset >= fw_downloadSize) && (fragment_fetch_count == 0)) {
+                    if (fragment_write_pending) {
+                        // Terminate the process, but first ensure all fragments have been stored.
+                        UC_HUB_TRACE("Last fragment fetched.");
+                        new_state = ARM_UC_HUB_STATE_AWAIT_LAST_FRAGMENT_STORED;
+                    } else {
+                        new_state = ARM_UC_HUB_STATE_LAST_FRAGMENT_STORE_DONE;
                     }
-                } else {
-                    // Terminate the process, but first ensure the last fragment has been stored.
-                    UC_HUB_TRACE("Last fragment fetched.");
-                    new_state = ARM_UC_HUB_STATE_AWAIT_LAST_FRAGMENT_STORED;
+                } else if ((fragment_fetch_count > 0) && !fragment_write_pending) {
+                    new_state = ARM_UC_HUB_STATE_WAIT_FOR_NETWORK;
+                } else if ((fragment_fetch_count == 0) && fragment_write_pending) {
+                    new_state = ARM_UC_HUB_STATE_WAIT_FOR_STORAGE;
+                }
+                /* report progress once per downloaded fragment */
+                if (firmware_offset != fragment_reported_offset) {
+                    fragment_reported_offset = firmware_offset;
+                    ARM_UC_ControlCenter_ReportProgress(firmware_offset, fw_downloadSize);
                 }
-                /* report progress */
-                ARM_UC_ControlCenter_ReportProgress(firmware_offset, fw_downloadSize);
                 break;
 
             case ARM_UC_HUB_STATE_WAIT_FOR_STORAGE:
@@ -105,6 +105,18 @@ arm_uc_firmware_details_t *ARM_UC_HUB_getActiveFirmwareDetails(void);
 
 arm_uc_delta_details_t *ARM_UC_HUB_getDeltaDetails(void);
 
+/**
+ * @brief Release the download buffer of the firmware fragment that was
+ *        just received, queueing it for storage.
+ */
+void ARM_UC_HUB_markFragmentFetched(void);
+
+/**
+ * @brief Release the download buffer of the firmware fragment that was
+ *        just written to storage.
+ */
+void ARM_UC_HUB_markFragmentStored(void);
+
 #ifdef __cplusplus
 }
 #endif